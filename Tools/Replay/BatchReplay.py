@@ -0,0 +1,143 @@
+#!/usr/bin/env python
+'''
+run Replay over many logs at once, one process per log, and gather
+a machine readable summary of each run
+
+Each Replay process runs in its own directory under --outdir, as
+Replay keeps global state and writes its output logs and storage
+into the current directory. Logs are given on the command line, with
+--logdir or in a --list file, and parameters given with --parm are
+passed to every run, for example:
+
+  BatchReplay.py --logdir testlogs --parm EK3_VELPOS_BATCH=1
+
+The per log summaries are written to summary.json in --outdir. With
+--logged-only the EKF3 outputs recorded in each log are summarised
+without replaying it, which is much quicker for a first look over a
+large set of logs
+'''
+
+import glob, json, multiprocessing, optparse, os, subprocess, sys, time
+
+parser = optparse.OptionParser("BatchReplay [options] [LOGS...]")
+parser.add_option("--logdir", type='string', default=None, help='directory of logs to use')
+parser.add_option("--list", type='string', default=None, help='file with a list of logs to use, one per line')
+parser.add_option("--outdir", type='string', default='batch_results', help='directory for results')
+parser.add_option("--replay", type='string', default='./Replay.elf', help='Replay executable')
+parser.add_option("--jobs", type=int, default=multiprocessing.cpu_count(), help='number of logs to replay at once')
+parser.add_option("--timeout", type=float, default=None, help='timeout in seconds for each log')
+parser.add_option("--check", action='store_true', default=False, help="check solution against CHEK messages")
+parser.add_option("--logged-only", action='store_true', default=False, help="only summarise the EKF3 outputs recorded in each log, without replaying it")
+parser.add_option("--parm", action='append', default=[], help="set parameter NAME=VALUE in Replay")
+
+opts, args = parser.parse_args()
+
+def get_log_list():
+    '''get a list of log files to process'''
+    file_list = list(args)
+    if opts.logdir is not None:
+        for pattern in ["*.bin", "*.BIN"]:
+            file_list.extend(glob.glob(os.path.join(opts.logdir, pattern)))
+    if opts.list is not None:
+        for line in open(opts.list):
+            line = line.strip()
+            if line and not line.startswith('#'):
+                file_list.append(line)
+    return sorted(set([os.path.abspath(f) for f in file_list]))
+
+def run_replay(job):
+    '''run Replay on one logfile in its own directory, returning its summary'''
+    (idx, logfile) = job
+    rundir = os.path.join(os.path.abspath(opts.outdir), "%04u-%s" % (idx, os.path.basename(logfile)))
+    if not os.path.isdir(rundir):
+        os.makedirs(rundir)
+    summary_file = os.path.join(rundir, "summary.json")
+    if os.path.exists(summary_file):
+        os.unlink(summary_file)
+    # the logs are already spread over the CPUs, so each Replay runs
+    # its log pre-pass in one thread
+    cmd = [os.path.abspath(opts.replay), "--", "--threads", "1", "--summary", summary_file]
+    if opts.check:
+        cmd.append("--check")
+    if opts.logged_only:
+        cmd.append("--logged-only")
+    for p in opts.parm:
+        cmd.extend(["--parm", p])
+    cmd.append(logfile)
+
+    start = time.time()
+    output = open(os.path.join(rundir, "replay.out"), "w")
+    proc = subprocess.Popen(cmd, cwd=rundir, stdout=output, stderr=subprocess.STDOUT)
+    timed_out = False
+    while proc.poll() is None:
+        if opts.timeout is not None and time.time() - start > opts.timeout:
+            proc.kill()
+            proc.wait()
+            timed_out = True
+            break
+        time.sleep(0.1)
+    output.close()
+    runtime = time.time() - start
+
+    summary = None
+    if os.path.exists(summary_file):
+        try:
+            summary = json.loads(open(summary_file).read().strip().split('\n')[-1])
+        except ValueError as ex:
+            print("Bad summary for %s: %s" % (logfile, ex))
+    if summary is None:
+        # Replay died without writing a summary
+        summary = { "log" : logfile, "result" : "timeout" if timed_out else "crashed" }
+    summary["exit_code"] = proc.returncode
+    summary["wall_time_s"] = round(runtime, 3)
+    summary["rundir"] = rundir
+    return summary
+
+def show_summary(results):
+    '''print a table of results'''
+    print("%-40s %-14s %8s %8s %8s %8s %8s %6s %6s" % ("Log", "Result", "Time(s)", "VelInnov", "LogVInn",
+                                                      "PosInnov", "LogPInn", "Faults", "Unhlth"))
+    for r in results:
+        ekf3 = r.get("ekf3", {})
+        logged = r.get("logged_ekf3", {})
+        print("%-40s %-14s %8.1f %8.3f %8.3f %8.3f %8.3f %6s %6s" % (
+            os.path.basename(r["log"])[-40:],
+            r["result"],
+            r["wall_time_s"],
+            ekf3.get("vel_innov", {}).get("max", 0),
+            logged.get("vel_innov", {}).get("max", 0),
+            ekf3.get("pos_innov", {}).get("max", 0),
+            logged.get("pos_innov", {}).get("max", 0),
+            ekf3.get("fault_events", "-"),
+            ekf3.get("unhealthy_events", "-")))
+
+def batch_replay():
+    '''replay all the logs'''
+    log_list = get_log_list()
+    if len(log_list) == 0:
+        print("No logs to process")
+        sys.exit(1)
+    print("Replaying %u logs with %u jobs" % (len(log_list), opts.jobs))
+    if not os.path.isdir(opts.outdir):
+        os.makedirs(opts.outdir)
+
+    start = time.time()
+    pool = multiprocessing.Pool(opts.jobs)
+    results = []
+    for r in pool.imap(run_replay, enumerate(log_list)):
+        print("%s: %s in %.1fs" % (r["log"], r["result"], r["wall_time_s"]))
+        results.append(r)
+    pool.close()
+    pool.join()
+
+    show_summary(results)
+    f = open(os.path.join(opts.outdir, "summary.json"), "w")
+    json.dump(results, f, indent=2)
+    f.close()
+
+    failures = [r for r in results if r["result"] != "ok"]
+    print("Replayed %u logs in %.1fs, %u failures" % (len(results), time.time() - start, len(failures)))
+    if len(failures) != 0:
+        sys.exit(1)
+
+batch_replay()
@@ -1,6 +1,12 @@
 #!/usr/bin/env python
 '''
 run Replay over a set of logs to check for code regressions
+
+Parameters given with --parm are passed to Replay, which allows two
+code paths selected by a parameter to be compared, for example:
+
+  CheckLogs.py --create-checked-logs --parm EK3_VELPOS_BATCH=0
+  CheckLogs.py --parm EK3_VELPOS_BATCH=1
 '''
 
 import optparse, os, sys
@@ -11,6 +17,7 @@ parser.add_option("--create-checked-logs", action='store_true', default=False, h
 parser.add_option("--tolerance-euler", type=float, default=3, help="tolerance for euler angles in degrees");
 parser.add_option("--tolerance-pos", type=float, default=2, help="tolerance for position angles in meters");
 parser.add_option("--tolerance-vel", type=float, default=2, help="tolerance for velocity in meters/second");
+parser.add_option("--parm", action='append', default=[], help="set parameter NAME=VALUE in Replay");
 
 opts, args = parser.parse_args()
 
@@ -26,14 +33,19 @@ def run_cmd(cmd, dir=".", show=False, output=False, checkfail=True):
     else:
         return call(cmd, shell=True, cwd=dir)
 
+def parm_args():
+    '''return Replay arguments for the user parameters'''
+    return "".join([" --parm %s" % p for p in opts.parm])
+
 def run_replay(logfile):
     '''run Replay on one logfile'''
     print("Processing %s" % logfile)
-    cmd = "./Replay.elf -- --check %s --tolerance-euler=%f --tolerance-pos=%f --tolerance-vel=%f " % (
+    cmd = "./Replay.elf -- --check %s --tolerance-euler=%f --tolerance-pos=%f --tolerance-vel=%f%s " % (
         logfile,
         opts.tolerance_euler,
         opts.tolerance_pos,
-        opts.tolerance_vel)
+        opts.tolerance_vel,
+        parm_args())
     run_cmd(cmd, checkfail=False)
 
 def get_log_list():
@@ -172,7 +184,7 @@ def create_checked_logs():
     for f in file_list:
         print("Processing %s" % f)
         log_list_current = set(glob.glob("logs/*.BIN"))
-        cmd = "./Replay.elf -- --check-generate %s" % f
+        cmd = "./Replay.elf -- --check-generate %s%s" % (f, parm_args())
         run_cmd(cmd, checkfail=True)
         log_list_after = set(glob.glob("logs/*.BIN"))
         changed = log_list_after.difference(log_list_current)
@@ -3,9 +3,13 @@
 #include <fcntl.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <time.h>
+#include <limits.h>
 #include <cinttypes>
 
 #ifndef PRIu64
@@ -25,6 +29,13 @@ AP_LoggerFileReader::AP_LoggerFileReader() :
 
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
+    free(frame_data);
+    free(frame_raw);
+    free(index);
+    if (map_data != nullptr) {
+        munmap((void *)map_data, map_len);
+    }
+
     const uint64_t micros = now();
     const uint64_t delta = micros - start_micros;
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
@@ -37,13 +48,317 @@ bool AP_LoggerFileReader::open_log(const char *logfile)
     if (fd == -1) {
         return false;
     }
+    uint8_t magic[2];
+    compressed = ::read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+        AP_Logger_Compress::is_frame_start(magic, sizeof(magic));
+    if (::lseek(fd, 0, SEEK_SET) == -1) {
+        return false;
+    }
+    struct stat st;
+    if (!compressed && fstat(fd, &st) == 0 && st.st_size > 0) {
+        // reading the log through a mapping avoids two system calls
+        // per message. If it can't be mapped we fall back to read()
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            map_data = (const uint8_t *)p;
+            map_len = st.st_size;
+            madvise(p, map_len, MADV_SEQUENTIAL);
+        }
+    }
+    if (load_index(logfile)) {
+        ::printf("Using log index with %u entries\n", (unsigned)index_count);
+        start_block(0);
+    }
+    return true;
+}
+
+/*
+  load the index written alongside a log as NNN.IDX
+ */
+bool AP_LoggerFileReader::load_index(const char *logfile)
+{
+    const size_t len = strlen(logfile);
+    char idxname[PATH_MAX];
+    if (len < 4 || len >= sizeof(idxname) || strcasecmp(&logfile[len-4], ".bin") != 0) {
+        return false;
+    }
+    memcpy(idxname, logfile, len+1);
+    memcpy(&idxname[len-3], logfile[len-3]=='b'?"idx":"IDX", 3);
+
+    const int ifd = ::open(idxname, O_RDONLY|O_CLOEXEC);
+    if (ifd == -1) {
+        return false;
+    }
+    struct stat st;
+    struct log_index_header hdr;
+    if (fstat(ifd, &st) != 0 ||
+        ::read(ifd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+        memcmp(hdr.magic, LOG_INDEX_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != LOG_INDEX_VERSION ||
+        hdr.entry_size != sizeof(struct log_index_entry)) {
+        ::printf("Ignoring bad log index %s\n", idxname);
+        close(ifd);
+        return false;
+    }
+    const uint32_t count = (st.st_size - sizeof(hdr)) / hdr.entry_size;
+    index = (struct log_index_entry *)calloc(count, sizeof(struct log_index_entry));
+    if (index == nullptr) {
+        close(ifd);
+        return false;
+    }
+    while (index_count < count &&
+           ::read(ifd, &index[index_count], sizeof(struct log_index_entry)) == sizeof(struct log_index_entry)) {
+        if (index_count > 0 && index[index_count].offset <= index[index_count-1].offset) {
+            break;
+        }
+        index_count++;
+    }
+    close(ifd);
+    index_stop = index_count;
+    return index_count != 0;
+}
+
+/*
+  position the block tracking so the next message read starts the
+  first wanted block from block onwards
+ */
+void AP_LoggerFileReader::start_block(uint32_t block)
+{
+    index_block = int32_t(block) - 1;
+    block_end = index[block].offset;
+}
+
+bool AP_LoggerFileReader::block_wanted(const struct log_index_entry &entry) const
+{
+    if (filter_names == nullptr || entry.has_type(LOG_FORMAT_MSG)) {
+        return true;
+    }
+    for (uint8_t i=0; i<ARRAY_SIZE(filter_types); i++) {
+        if (entry.types[i] & filter_types[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  move on to the next wanted index block when the current one has
+  been read, returning false if there are no more blocks to read
+ */
+bool AP_LoggerFileReader::next_block()
+{
+    while (index_count != 0 && raw_offset >= block_end) {
+        uint32_t next = index_block + 1;
+        while (next < index_stop && !block_wanted(index[next])) {
+            next++;
+        }
+        if (next >= index_stop) {
+            return false;
+        }
+        if (index[next].offset != raw_offset && !seek_raw(index[next].offset)) {
+            return false;
+        }
+        index_block = next;
+        block_end = next+1 < index_count ? index[next+1].offset : UINT32_MAX;
+    }
+    return true;
+}
+
+bool AP_LoggerFileReader::in_list(const char *name, const char **list)
+{
+    for (uint16_t i=0; list[i] != nullptr; i++) {
+        if (strcmp(name, list[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AP_LoggerFileReader::type_wanted(uint8_t type) const
+{
+    return filter_names == nullptr || (filter_types[type/8] & (1U<<(type%8)));
+}
+
+void AP_LoggerFileReader::set_type_filter(const char **types)
+{
+    filter_names = types;
+    memset(filter_types, 0, sizeof(filter_types));
+    if (types == nullptr) {
+        return;
+    }
+    // formats seen later are added as their FMT messages are read
+    for (uint16_t i=0; i<LOGREADER_MAX_FORMATS; i++) {
+        char name[5];
+        format_type(i, name);
+        if (in_list(name, types)) {
+            filter_types[i/8] |= (1U<<(i%8));
+        }
+    }
+}
+
+bool AP_LoggerFileReader::seek_time(uint64_t time_us, const char **keep_types)
+{
+    if (index_count == 0) {
+        return false;
+    }
+    // blocks written before the clock started have no time, and
+    // the rest have rising times. Find the last block starting at or
+    // before time_us, or the last block without a time if there is
+    // none
+    uint32_t lo = 0, hi = index_count;
+    while (lo < hi && index[lo].time_us == 0) {
+        lo++;
+    }
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        if (index[mid].time_us <= time_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const uint32_t target = lo > 0 ? lo - 1 : 0;
+
+    // formats and kept messages from before the target block
+    static const char *no_types[] = { nullptr };
+    const char **saved_filter = filter_names;
+    set_type_filter(keep_types != nullptr ? keep_types : no_types);
+    index_stop = target;
+    if (!seek_raw(index[0].offset)) {
+        return false;
+    }
+    start_block(0);
+    char type[5];
+    while (update(type)) {
+    }
+    index_stop = index_count;
+    set_type_filter(saved_filter);
+
+    if (!seek_raw(index[target].offset)) {
+        return false;
+    }
+    start_block(target);
+    return true;
+}
+
+/*
+  move to an offset in the raw log. In compressed logs frames before
+  the offset are skipped using their headers
+ */
+bool AP_LoggerFileReader::seek_raw(uint32_t ofs)
+{
+    if (map_data != nullptr) {
+        if (ofs > map_len) {
+            return false;
+        }
+        raw_offset = ofs;
+        return true;
+    }
+    if (!compressed) {
+        if (::lseek(fd, ofs, SEEK_SET) == -1) {
+            return false;
+        }
+        raw_offset = ofs;
+        return true;
+    }
+    if (ofs < frame_raw_start) {
+        // start again from the first frame
+        if (::lseek(fd, 0, SEEK_SET) == -1) {
+            return false;
+        }
+        frame_raw_start = 0;
+        frame_raw_len = 0;
+        frame_raw_ofs = 0;
+    }
+    while (ofs >= frame_raw_start + frame_raw_len) {
+        struct log_compressed_frame frame;
+        if (::read(fd, &frame, sizeof(frame)) != sizeof(frame)) {
+            return false;
+        }
+        if (ofs < frame_raw_start + frame_raw_len + frame.raw_len) {
+            // ofs is in this frame
+            if (::lseek(fd, -(off_t)sizeof(frame), SEEK_CUR) == -1 ||
+                !read_frame()) {
+                return false;
+            }
+            break;
+        }
+        frame_raw_start += frame_raw_len + frame.raw_len;
+        frame_raw_len = 0;
+        frame_raw_ofs = 0;
+        if (::lseek(fd, frame.data_len, SEEK_CUR) == -1) {
+            return false;
+        }
+    }
+    frame_raw_ofs = ofs - frame_raw_start;
+    raw_offset = ofs;
+    return true;
+}
+
+/*
+  read and decode the next frame of a compressed log
+ */
+bool AP_LoggerFileReader::read_frame()
+{
+    struct log_compressed_frame frame;
+    if (::read(fd, &frame, sizeof(frame)) != sizeof(frame)) {
+        return false;
+    }
+    const uint32_t size = MAX(frame.raw_len, frame.data_len);
+    if (size > frame_buf_size) {
+        free(frame_data);
+        free(frame_raw);
+        frame_data = (uint8_t *)malloc(size);
+        frame_raw = (uint8_t *)malloc(size);
+        if (frame_data == nullptr || frame_raw == nullptr) {
+            frame_buf_size = 0;
+            return false;
+        }
+        frame_buf_size = size;
+    }
+    if (::read(fd, frame_data, frame.data_len) != (ssize_t)frame.data_len) {
+        return false;
+    }
+    const int32_t raw_len = AP_Logger_Compress::decode_frame(frame, frame_data, frame_raw, frame_buf_size);
+    if (raw_len < 0) {
+        printf("bad compressed log frame\n");
+        return false;
+    }
+    frame_raw_start += frame_raw_len;
+    frame_raw_len = raw_len;
+    frame_raw_ofs = 0;
     return true;
 }
 
 ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
-    uint64_t ret = ::read(fd, buffer, count);
+    if (map_data != nullptr) {
+        const size_t n = MIN(count, map_len - raw_offset);
+        memcpy(buffer, &map_data[raw_offset], n);
+        bytes_read += n;
+        raw_offset += n;
+        return n;
+    }
+    if (!compressed) {
+        const ssize_t ret = ::read(fd, buffer, count);
+        if (ret > 0) {
+            bytes_read += ret;
+            raw_offset += ret;
+        }
+        return ret;
+    }
+    size_t ret = 0;
+    while (ret < count) {
+        if (frame_raw_ofs == frame_raw_len && !read_frame()) {
+            break;
+        }
+        const size_t n = MIN(count - ret, size_t(frame_raw_len - frame_raw_ofs));
+        memcpy((uint8_t *)buffer + ret, &frame_raw[frame_raw_ofs], n);
+        frame_raw_ofs += n;
+        ret += n;
+    }
     bytes_read += ret;
+    raw_offset += ret;
     return ret;
 }
 
@@ -64,12 +379,29 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
 bool AP_LoggerFileReader::update(char type[5])
 {
     uint8_t hdr[3];
-    if (read_input(hdr, 3) != 3) {
-        return false;
-    }
-    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
-        printf("bad log header\n");
-        return false;
+    while (true) {
+        if (!next_block()) {
+            return false;
+        }
+        if (read_input(hdr, 3) != 3) {
+            return false;
+        }
+        if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+            printf("bad log header\n");
+            return false;
+        }
+        if (hdr[2] == LOG_FORMAT_MSG || type_wanted(hdr[2])) {
+            break;
+        }
+        // skip a message which has been filtered out
+        const struct log_Format &f = formats[hdr[2]];
+        if (f.length == 0) {
+            ::printf("No format defined for type (%d)\n", hdr[2]);
+            exit(1);
+        }
+        if (!seek_raw(raw_offset + f.length - 3)) {
+            return false;
+        }
     }
 
     packet_counts[hdr[2]]++;
@@ -81,6 +413,13 @@ bool AP_LoggerFileReader::update(char type[5])
             return false;
         }
         memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        if (filter_names != nullptr) {
+            char name[5];
+            format_type(f.type, name);
+            if (in_list(name, filter_names)) {
+                filter_types[f.type/8] |= (1U<<(f.type%8));
+            }
+        }
         strncpy(type, "FMT", 3);
         type[3] = 0;
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/AP_Logger_Compress.h>
+#include <AP_Logger/AP_Logger_Index.h>
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
@@ -14,6 +16,28 @@ public:
     bool open_log(const char *logfile);
     bool update(char type[5]);
 
+    // the log contents if it could be memory mapped, else nullptr.
+    // Compressed logs are never mapped
+    const uint8_t *mapped_log(size_t &len) const {
+        len = map_len;
+        return map_data;
+    }
+
+    // true if an index (.IDX file) was found for the log
+    bool have_index() const { return index_count != 0; }
+
+    // only return messages whose names are in the nullptr terminated
+    // list, or all messages if types is nullptr. FMT messages are
+    // always processed. With an index, blocks of the log which
+    // contain none of the types are skipped without reading them
+    void set_type_filter(const char **types);
+
+    // using the index, move to the last index block starting at or
+    // before time_us. FMT messages, and messages in the nullptr
+    // terminated keep_types list, from before that point are passed
+    // to the handlers first
+    bool seek_time(uint64_t time_us, const char **keep_types);
+
     virtual bool handle_log_format_msg(const struct log_Format &f) = 0;
     virtual bool handle_msg(const struct log_Format &f, uint8_t *msg) = 0;
 
@@ -28,6 +52,42 @@ protected:
 private:
     ssize_t read_input(void *buf, size_t count);
 
+    // uncompressed logs are memory mapped and read_input() copies
+    // from the mapping
+    const uint8_t *map_data = nullptr;
+    size_t map_len = 0;
+
+    // support for logs written with LOG_FILE_COMPR
+    bool compressed = false;
+    uint8_t *frame_data = nullptr;
+    uint8_t *frame_raw = nullptr;
+    uint32_t frame_buf_size = 0;
+    uint32_t frame_raw_len = 0;
+    uint32_t frame_raw_ofs = 0;
+    uint32_t frame_raw_start = 0;   // raw log offset of frame_raw
+    bool read_frame();
+
+    // raw log offset of the next byte read_input() will return
+    uint32_t raw_offset = 0;
+    bool seek_raw(uint32_t ofs);
+
+    // support for logs indexed with LOG_FILE_INDEX
+    struct log_index_entry *index = nullptr;
+    uint32_t index_count = 0;
+    uint32_t index_stop = 0;        // don't read blocks from here on
+    int32_t index_block = -1;       // block being read
+    uint32_t block_end = 0;         // raw offset of the end of index_block
+    bool load_index(const char *logfile);
+    void start_block(uint32_t block);
+    bool next_block();
+    bool block_wanted(const struct log_index_entry &entry) const;
+
+    // message type filtering
+    const char **filter_names = nullptr;
+    uint8_t filter_types[32] {};
+    bool type_wanted(uint8_t type) const;
+    static bool in_list(const char *name, const char **list);
+
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
     uint64_t start_micros;
@@ -99,6 +99,12 @@ void LR_MsgHandler_CHEK::process_message(uint8_t *msg)
     require_field(msg, "VD", check_state.velocity.z);
 }
 
+void LR_MsgHandler_CHK3::process_message(uint8_t *msg)
+{
+    LR_MsgHandler_CHEK::process_message(msg);
+    require_field(msg, "FusT", check_state.fusion_time_us);
+}
+
 
 void LR_MsgHandler_BARO::process_message(uint8_t *msg)
 {
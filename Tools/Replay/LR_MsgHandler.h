@@ -13,12 +13,13 @@ public:
                   uint64_t &last_timestamp_usec);
     virtual void process_message(uint8_t *msg) = 0;
 
-    // state for CHEK message
+    // state for CHEK and CHK3 messages
     struct CheckState {
         uint64_t time_us;
         Vector3f euler;
         Location pos;
         Vector3f velocity;
+        uint64_t fusion_time_us; // cumulative EKF3 velocity and position fusion time, CHK3 only
     };
 
 protected:
@@ -107,10 +108,17 @@ public:
         { };
     void process_message(uint8_t *msg) override;
 
-private:
+protected:
     CheckState &check_state;
 };
 
+class LR_MsgHandler_CHK3 : public LR_MsgHandler_CHEK
+{
+public:
+    using LR_MsgHandler_CHEK::LR_MsgHandler_CHEK;
+    void process_message(uint8_t *msg) override;
+};
+
 class LR_MsgHandler_BARO : public LR_MsgHandler
 {
 public:
@@ -0,0 +1,449 @@
+#include "LogColumns.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// number of valid messages which must follow a message to sync on it
+#define LOGCOLUMNS_SYNC_MESSAGES 8
+
+/*
+  run fn on each of args[0..n-1], each in its own thread. Jobs which
+  can't get a thread run in the calling thread
+ */
+template <typename T>
+struct ThreadJob {
+    T *arg;
+    void (*fn)(T &);
+    pthread_t thread;
+    bool started;
+
+    static void *run(void *p) {
+        ThreadJob *job = (ThreadJob *)p;
+        job->fn(*job->arg);
+        return nullptr;
+    }
+};
+
+template <typename T>
+static void run_parallel(T *args, uint8_t n, void (*fn)(T &))
+{
+    ThreadJob<T> *jobs = (ThreadJob<T> *)calloc(n, sizeof(ThreadJob<T>));
+    if (jobs == nullptr) {
+        for (uint8_t i=0; i<n; i++) {
+            fn(args[i]);
+        }
+        return;
+    }
+    for (uint8_t i=0; i<n; i++) {
+        jobs[i].arg = &args[i];
+        jobs[i].fn = fn;
+        jobs[i].started = (i != 0 &&
+                           pthread_create(&jobs[i].thread, nullptr, ThreadJob<T>::run, &jobs[i]) == 0);
+    }
+    for (uint8_t i=0; i<n; i++) {
+        if (!jobs[i].started) {
+            fn(args[i]);
+        }
+    }
+    for (uint8_t i=0; i<n; i++) {
+        if (jobs[i].started) {
+            pthread_join(jobs[i].thread, nullptr);
+        }
+    }
+    free(jobs);
+}
+
+/*
+  size of a field of each format type, zero for unknown types
+ */
+static uint8_t field_size(char type)
+{
+    switch (type) {
+    case 'b': case 'B': case 'M':
+        return 1;
+    case 'c': case 'C': case 'h': case 'H':
+        return 2;
+    case 'e': case 'E': case 'f': case 'i': case 'I': case 'L': case 'n':
+        return 4;
+    case 'd': case 'q': case 'Q':
+        return 8;
+    case 'N':
+        return 16;
+    case 'a': case 'Z':
+        return 64;
+    }
+    return 0;
+}
+
+LogColumns::LogColumns(const uint8_t *_data, size_t _len) :
+    data(_data),
+    len(_len)
+{
+    // the FMT message describes itself, but the log may not start
+    // with it
+    formats[LOG_FORMAT_MSG].type = LOG_FORMAT_MSG;
+    formats[LOG_FORMAT_MSG].length = sizeof(struct log_Format);
+}
+
+LogColumns::~LogColumns()
+{
+    for (uint16_t i=0; i<ARRAY_SIZE(columns); i++) {
+        free(columns[i].offset);
+    }
+}
+
+/*
+  check an FMT message found by searching the log is plausible
+ */
+bool LogColumns::valid_format(const struct log_Format &f) const
+{
+    if (f.head1 != HEAD_BYTE1 || f.head2 != HEAD_BYTE2 || f.msgid != LOG_FORMAT_MSG) {
+        return false;
+    }
+    if (f.name[0] == 0) {
+        return false;
+    }
+    for (uint8_t i=0; i<sizeof(f.name) && f.name[i] != 0; i++) {
+        if (f.name[i] < ' ' || f.name[i] > '~') {
+            return false;
+        }
+    }
+    uint16_t length = 3;
+    uint8_t i;
+    for (i=0; i<sizeof(f.format) && f.format[i] != 0; i++) {
+        const uint8_t size = field_size(f.format[i]);
+        if (size == 0) {
+            return false;
+        }
+        length += size;
+    }
+    if (f.type == LOG_FORMAT_MSG) {
+        return f.length == sizeof(struct log_Format);
+    }
+    return i > 0 && f.length == length;
+}
+
+/*
+  length of the message at ofs, or zero if there isn't a valid
+  message there
+ */
+uint8_t LogColumns::msg_length(size_t ofs) const
+{
+    if (ofs + 3 > len || data[ofs] != HEAD_BYTE1 || data[ofs+1] != HEAD_BYTE2) {
+        return 0;
+    }
+    const uint8_t length = formats[data[ofs+2]].length;
+    if (length < 3 || ofs + length > len) {
+        return 0;
+    }
+    return length;
+}
+
+/*
+  find the first message starting in [ofs,end) which is followed by
+  LOGCOLUMNS_SYNC_MESSAGES valid messages or the end of the log,
+  returning end if there isn't one
+ */
+size_t LogColumns::find_sync(size_t ofs, size_t end) const
+{
+    for (; ofs < end; ofs++) {
+        if (data[ofs] != HEAD_BYTE1) {
+            continue;
+        }
+        size_t p = ofs;
+        uint8_t n;
+        for (n=0; n<LOGCOLUMNS_SYNC_MESSAGES && p < len; n++) {
+            const uint8_t length = msg_length(p);
+            if (length == 0) {
+                break;
+            }
+            p += length;
+        }
+        if (n == LOGCOLUMNS_SYNC_MESSAGES || p == len) {
+            return ofs;
+        }
+    }
+    return end;
+}
+
+void LogColumns::find_formats(struct Segment &seg)
+{
+    const LogColumns &log = *seg.log;
+    const uint8_t pattern[3] = { HEAD_BYTE1, HEAD_BYTE2, LOG_FORMAT_MSG };
+    size_t ofs = seg.start;
+    while (ofs < seg.end) {
+        const size_t search_end = MIN(log.len, seg.end + sizeof(pattern) - 1);
+        const uint8_t *p = (const uint8_t *)memmem(&log.data[ofs], search_end - ofs, pattern, sizeof(pattern));
+        if (p == nullptr) {
+            break;
+        }
+        ofs = p - log.data;
+        if (ofs + sizeof(struct log_Format) > log.len) {
+            break;
+        }
+        struct log_Format f;
+        memcpy(&f, p, sizeof(f));
+        if (log.valid_format(f) && seg.formats[f.type].length == 0) {
+            seg.formats[f.type] = f;
+        }
+        ofs++;
+    }
+}
+
+bool LogColumns::push(struct Column &col, uint32_t ofs)
+{
+    if (col.count == col.size) {
+        const uint32_t new_size = col.size ? col.size * 2 : 256;
+        uint32_t *p = (uint32_t *)realloc(col.offset, new_size * sizeof(uint32_t));
+        if (p == nullptr) {
+            return false;
+        }
+        col.offset = p;
+        col.size = new_size;
+    }
+    col.offset[col.count++] = ofs;
+    return true;
+}
+
+void LogColumns::walk_messages(struct Segment &seg)
+{
+    const LogColumns &log = *seg.log;
+    size_t ofs = log.find_sync(seg.start, seg.end);
+    seg.start = ofs;
+    while (ofs < seg.end) {
+        const uint8_t length = log.msg_length(ofs);
+        if (length == 0) {
+            const size_t next = log.find_sync(ofs+1, seg.end);
+            seg.bad_bytes += next - ofs;
+            ofs = next;
+            continue;
+        }
+        if (!push(seg.columns[log.data[ofs+2]], ofs)) {
+            break;
+        }
+        ofs += length;
+    }
+    seg.last = ofs;
+}
+
+void LogColumns::set_timestamp(uint8_t type)
+{
+    const struct log_Format &f = formats[type];
+    if (f.length == 0) {
+        return;
+    }
+    if (f.format[0] == 'Q' && strncmp(f.labels, "TimeUS,", 7) == 0) {
+        time_type[type] = 'Q';
+    } else if (f.format[0] == 'I' && strncmp(f.labels, "TimeMS,", 7) == 0) {
+        time_type[type] = 'I';
+    }
+}
+
+bool LogColumns::scan(uint8_t num_threads)
+{
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    // don't bother with tiny segments
+    const size_t min_segment = 1024*1024;
+    if (len / num_threads < min_segment) {
+        num_threads = len / min_segment + 1;
+    }
+
+    struct Segment *segs = (struct Segment *)calloc(num_threads, sizeof(struct Segment));
+    if (segs == nullptr) {
+        return false;
+    }
+    bool ret = true;
+    for (uint8_t i=0; i<num_threads; i++) {
+        segs[i].log = this;
+        segs[i].start = len * i / num_threads;
+        segs[i].end = len * (i+1) / num_threads;
+        segs[i].formats = (struct log_Format *)calloc(256, sizeof(struct log_Format));
+        if (segs[i].formats == nullptr) {
+            ret = false;
+        }
+    }
+    if (!ret) {
+        goto failed;
+    }
+
+    // formats from earlier in the log take precedence
+    run_parallel(segs, num_threads, find_formats);
+    for (uint8_t i=0; i<num_threads; i++) {
+        for (uint16_t t=0; t<256; t++) {
+            if (formats[t].length == 0 && segs[i].formats[t].length != 0) {
+                formats[t] = segs[i].formats[t];
+                set_timestamp(t);
+            }
+        }
+    }
+
+    run_parallel(segs, num_threads, walk_messages);
+
+    /*
+      join the segments. If a segment synced on what was really the
+      middle of the last message of the segment before, drop its
+      messages up to the end of that message
+     */
+    for (uint8_t i=0; i<num_threads; i++) {
+        const size_t prev_last = i > 0 ? segs[i-1].last : 0;
+        num_bad_bytes += segs[i].bad_bytes;
+        if (segs[i].start > prev_last) {
+            num_bad_bytes += segs[i].start - prev_last;
+        }
+        for (uint16_t t=0; t<256; t++) {
+            const struct Column &c = segs[i].columns[t];
+            uint32_t skip = 0;
+            while (skip < c.count && c.offset[skip] < prev_last) {
+                skip++;
+            }
+            for (uint32_t n=skip; n<c.count; n++) {
+                if (!push(columns[t], c.offset[n])) {
+                    ret = false;
+                    goto failed;
+                }
+            }
+        }
+    }
+
+failed:
+    for (uint8_t i=0; i<num_threads; i++) {
+        free(segs[i].formats);
+        for (uint16_t t=0; t<256; t++) {
+            free(segs[i].columns[t].offset);
+        }
+    }
+    free(segs);
+    return ret;
+}
+
+const struct log_Format *LogColumns::format(uint8_t type) const
+{
+    if (formats[type].length == 0) {
+        return nullptr;
+    }
+    return &formats[type];
+}
+
+int16_t LogColumns::find_type(const char *name) const
+{
+    for (uint16_t t=0; t<256; t++) {
+        if (formats[t].length != 0 && strncmp(formats[t].name, name, sizeof(formats[t].name)) == 0) {
+            return t;
+        }
+    }
+    return -1;
+}
+
+uint64_t LogColumns::time_us(uint8_t type, uint32_t idx) const
+{
+    const uint8_t *msg = &data[columns[type].offset[idx]];
+    switch (time_type[type]) {
+    case 'Q': {
+        uint64_t t;
+        memcpy(&t, &msg[3], sizeof(t));
+        return t;
+    }
+    case 'I': {
+        uint32_t t;
+        memcpy(&t, &msg[3], sizeof(t));
+        return t * 1000ULL;
+    }
+    }
+    return 0;
+}
+
+struct DecodeJob {
+    const uint8_t *data;
+    const uint32_t *offsets;
+    uint32_t count;
+    uint8_t field_ofs;
+    char field_type;
+    double *values;
+};
+
+template <typename T>
+static double field_at(const uint8_t *msg)
+{
+    T v;
+    memcpy(&v, msg, sizeof(v));
+    return v;
+}
+
+static void decode_values(DecodeJob &job)
+{
+    for (uint32_t i=0; i<job.count; i++) {
+        const uint8_t *p = &job.data[job.offsets[i] + job.field_ofs];
+        double v;
+        switch (job.field_type) {
+        case 'b': v = field_at<int8_t>(p); break;
+        case 'B': case 'M': v = field_at<uint8_t>(p); break;
+        case 'c': case 'h': v = field_at<int16_t>(p); break;
+        case 'C': case 'H': v = field_at<uint16_t>(p); break;
+        case 'e': case 'i': case 'L': v = field_at<int32_t>(p); break;
+        case 'E': case 'I': v = field_at<uint32_t>(p); break;
+        case 'f': v = field_at<float>(p); break;
+        case 'd': v = field_at<double>(p); break;
+        case 'q': v = field_at<int64_t>(p); break;
+        case 'Q': v = field_at<uint64_t>(p); break;
+        default: v = 0; break;
+        }
+        job.values[i] = v;
+    }
+}
+
+bool LogColumns::decode_field(uint8_t type, const char *label, double *values, uint8_t num_threads) const
+{
+    const struct log_Format &f = formats[type];
+    if (f.length == 0) {
+        return false;
+    }
+
+    // find the field offset from the labels
+    char labels[sizeof(f.labels)+1] {};
+    memcpy(labels, f.labels, sizeof(f.labels));
+    uint8_t field_ofs = 3;
+    char field_type = 0;
+    uint8_t i = 0;
+    char *saveptr = nullptr;
+    for (const char *l=strtok_r(labels, ",", &saveptr); l != nullptr && i < sizeof(f.format) && f.format[i];
+         l=strtok_r(nullptr, ",", &saveptr), i++) {
+        if (strcmp(l, label) == 0) {
+            field_type = f.format[i];
+            break;
+        }
+        field_ofs += field_size(f.format[i]);
+    }
+    if (field_type == 0 || strchr("nNZa", field_type) != nullptr) {
+        // not found, or not numeric
+        return false;
+    }
+
+    const struct Column &c = columns[type];
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (c.count / num_threads < 100000) {
+        num_threads = c.count / 100000 + 1;
+    }
+    DecodeJob *jobs = (DecodeJob *)calloc(num_threads, sizeof(DecodeJob));
+    if (jobs == nullptr) {
+        return false;
+    }
+    for (uint8_t n=0; n<num_threads; n++) {
+        const uint32_t start = uint64_t(c.count) * n / num_threads;
+        const uint32_t end = uint64_t(c.count) * (n+1) / num_threads;
+        jobs[n].data = data;
+        jobs[n].offsets = &c.offset[start];
+        jobs[n].count = end - start;
+        jobs[n].field_ofs = field_ofs;
+        jobs[n].field_type = field_type;
+        jobs[n].values = &values[start];
+    }
+    run_parallel(jobs, num_threads, decode_values);
+    free(jobs);
+    return true;
+}
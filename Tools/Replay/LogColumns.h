@@ -0,0 +1,89 @@
+#pragma once
+
+#include <AP_Logger/AP_Logger.h>
+
+/*
+  parallel pre-pass over a memory mapped log.
+
+  The log is split into one segment per thread. The threads first
+  search their segments for FMT messages, so that every thread knows
+  the length of every message type. Each thread then finds the first
+  message in its segment which is followed by a run of valid
+  messages and walks the messages from there to the start of the
+  next segment, building per-type columns of message offsets.
+
+  Fields are decoded from the columns on demand, also split across
+  threads. Replay uses this to gather statistics of the EKF outputs
+  recorded in the log for its --summary. Only the pre-pass is
+  parallel; Replay still feeds the messages to the EKF in log order
+ */
+class LogColumns {
+public:
+    LogColumns(const uint8_t *data, size_t len);
+    ~LogColumns();
+
+    /* Do not allow copies */
+    LogColumns(const LogColumns &other) = delete;
+    LogColumns &operator=(const LogColumns&) = delete;
+
+    // run the pre-pass with up to num_threads threads
+    bool scan(uint8_t num_threads);
+
+    // format for a message type, or nullptr if there isn't one
+    const struct log_Format *format(uint8_t type) const;
+
+    // type for a message name, or -1 if it is not in the log
+    int16_t find_type(const char *name) const;
+
+    // number of messages of a type
+    uint32_t count(uint8_t type) const { return columns[type].count; }
+
+    // offsets in the log of the messages of a type
+    const uint32_t *offsets(uint8_t type) const { return columns[type].offset; }
+
+    // TimeUS (or TimeMS * 1000) of a message, zero if it has neither
+    uint64_t time_us(uint8_t type, uint32_t idx) const;
+
+    // decode one field of every message of a type into values, which
+    // must have room for count(type) entries
+    bool decode_field(uint8_t type, const char *label, double *values, uint8_t num_threads) const;
+
+    // bytes which were not part of any valid message
+    uint32_t bad_bytes() const { return num_bad_bytes; }
+
+private:
+    const uint8_t *data;
+    const size_t len;
+
+    struct log_Format formats[256] {};
+
+    struct Column {
+        uint32_t count;
+        uint32_t size;
+        uint32_t *offset;
+    } columns[256] {};
+
+    // field type of the timestamp which starts each message type, if any
+    char time_type[256] {};
+
+    uint32_t num_bad_bytes = 0;
+
+    struct Segment {
+        LogColumns *log;
+        size_t start;               // scan from here
+        size_t end;                 // messages from here on belong to the next segment
+        size_t last;                // end of the last message walked
+        uint32_t bad_bytes;
+        struct log_Format *formats; // FMT messages found in the segment
+        struct Column columns[256];
+    };
+
+    static void find_formats(struct Segment &seg);
+    static void walk_messages(struct Segment &seg);
+
+    bool valid_format(const struct log_Format &f) const;
+    uint8_t msg_length(size_t ofs) const;
+    size_t find_sync(size_t ofs, size_t end) const;
+    static bool push(struct Column &col, uint32_t ofs);
+    void set_timestamp(uint8_t type);
+};
@@ -122,7 +122,7 @@ static const char *generated_names[] = {
     "AHR2",
     "ORGN",
     "POS",
-    "CHEK",
+    "CHEK", "CHK3",
     "IMT", "IMT2", "IMT3",
     "MAG", "MAG2",
     "BARO", "BAR2",
@@ -176,7 +176,7 @@ void LogReader::initialise_fmt_map()
             }
         }
         if (!found) {
-            if (streq(*name, "CHEK")) {
+            if (streq(*name, "CHEK") || streq(*name, "CHK3")) {
                 // HACK: CHEK is emitted using Log_Write, so doesn't
                 // have a fixed address to pre-populate the fmt-map
                 // with....
@@ -237,7 +237,7 @@ bool LogReader::save_message_type(const char *name)
 {
     bool save_message = !in_list(name, generated_names);
     save_message = save_message && !in_list(name, log_write_names);
-    if (save_chek_messages && strcmp(name, "CHEK") == 0) {
+    if (save_chek_messages && (strcmp(name, "CHEK") == 0 || strcmp(name, "CHK3") == 0)) {
         save_message = true;
     }
     return save_message;
@@ -399,6 +399,10 @@ bool LogReader::handle_log_format_msg(const struct log_Format &f)
 	  msgparser[f.type] = new LR_MsgHandler_CHEK(formats[f.type], logger,
                                                      last_timestamp_usec,
                                                      check_state);
+	} else if (streq(name, "CHK3")) {
+	  msgparser[f.type] = new LR_MsgHandler_CHK3(formats[f.type], logger,
+                                                     last_timestamp_usec,
+                                                     check3_state);
 	} else if (streq(name, "PM")) {
 	  msgparser[f.type] = new LR_MsgHandler_PM(formats[f.type], logger,
                                                    last_timestamp_usec);
@@ -23,6 +23,7 @@ public:
     const Vector3f &get_sim_attitude(void) const { return sim_attitude; }
     const float &get_relalt(void) const { return rel_altitude; }
     const LR_MsgHandler::CheckState &get_check_state(void) const { return check_state; }
+    const LR_MsgHandler::CheckState &get_check3_state(void) const { return check3_state; }
 
     VehicleType::vehicle_type vehicle;
 
@@ -73,6 +74,7 @@ private:
     uint8_t next_msgid = 1;
 
     LR_MsgHandler::CheckState check_state;
+    LR_MsgHandler::CheckState check3_state;
 
     bool installed_vehicle_specific_parsers;
     const char **&nottypes;
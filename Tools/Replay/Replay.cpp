@@ -26,6 +26,7 @@
 
 #include "LogReader.h"
 #include "DataFlashFileReader.h"
+#include "LogColumns.h"
 #include "Replay.h"
 
 #include <AP_Camera/AP_Camera.h>
@@ -34,6 +35,11 @@
 #include <SITL/SITL.h>
 #endif
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+// Util.h must come first as it and Perf.h include each other
+#include <AP_HAL_Linux/Util.h>
+#endif
+
 #define streq(x, y) (!strcmp(x, y))
 
 const AP_HAL::HAL& hal = AP_HAL::get_HAL();
@@ -151,6 +157,10 @@ void Replay::usage(void)
     ::printf("\t--no-params        don't use parameters from the log\n");
     ::printf("\t--no-fpe           do not generate floating point exceptions\n");
     ::printf("\t--packet-counts    print packet counts at end of processing\n");
+    ::printf("\t--start-time       start replay at time (seconds), needs a log index\n");
+    ::printf("\t--threads N        number of threads for the log pre-pass (default all CPUs)\n");
+    ::printf("\t--summary FILE     append a JSON summary of the replay to FILE\n");
+    ::printf("\t--logged-only      only summarise the EKF3 outputs recorded in the log\n");
 }
 
 
@@ -167,6 +177,10 @@ enum {
     OPT_PARAM_FILE,
     OPT_NO_FPE,
     OPT_PACKET_COUNTS,
+    OPT_START_TIME,
+    OPT_THREADS,
+    OPT_SUMMARY,
+    OPT_LOGGED_ONLY,
 };
 
 void Replay::flush_logger(void) {
@@ -224,6 +238,10 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"no-params",       false,  0, OPT_NOPARAMS},
         {"no-fpe",          false,  0, OPT_NO_FPE},
         {"packet-counts",   false,  0, OPT_PACKET_COUNTS},
+        {"start-time",      true,   0, OPT_START_TIME},
+        {"threads",         true,   0, OPT_THREADS},
+        {"summary",         true,   0, OPT_SUMMARY},
+        {"logged-only",     false,  0, OPT_LOGGED_ONLY},
         {0, false, 0, 0}
     };
 
@@ -311,6 +329,22 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             packet_counts = true;
             break;
 
+        case OPT_START_TIME:
+            start_time_us = atof(gopt.optarg) * 1.0e6;
+            break;
+
+        case OPT_THREADS:
+            num_threads = constrain_int16(atoi(gopt.optarg), 1, 64);
+            break;
+
+        case OPT_SUMMARY:
+            summary_filename = gopt.optarg;
+            break;
+
+        case OPT_LOGGED_ONLY:
+            logged_only = true;
+            break;
+
         case 'h':
         default:
             usage();
@@ -386,6 +420,9 @@ bool Replay::find_log_info(struct log_information &info)
         perror(filename);
         exit(1);
     }
+    // with an index, blocks without these are skipped
+    static const char *info_types[] = { "PARM", "IMU", "IMU2", "IMT", "IMT2", nullptr };
+    reader.set_type_filter(info_types);
     char clock_source[5] = { };
     int samplecount = 0;
     uint64_t prev = 0;
@@ -483,6 +520,7 @@ static void _replay_sig_fpe(int signum)
                 replay.log_filename);
         fclose(f);
     }
+    replay.write_summary("fpe");
     abort();
 }
 
@@ -496,15 +534,28 @@ FILE *Replay::xfopen(const char *f, const char *mode)
     return ret;
 }
 
+/*
+  wall clock time, as the HAL clock follows the log
+ */
+static uint64_t wall_micros64()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000ULL + ts.tv_nsec/1000U;
+}
+
 void Replay::setup()
 {
     ::printf("Starting\n");
+    start_wall_us = wall_micros64();
 
     uint8_t argc;
     char * const *argv;
 
     hal.util->commandline_arguments(argc, argv);
 
+    // use all CPUs for the log pre-pass unless told otherwise
+    num_threads = constrain_int32(sysconf(_SC_NPROCESSORS_ONLN), 1, 64);
     _parse_command_line(argc, argv);
 
     if (!check_generate) {
@@ -518,18 +569,26 @@ void Replay::setup()
     // remember filename for reporting
     log_filename = filename;
 
-    if (!find_log_info(log_info)) {
-        printf("Update to get log information\n");
+    if (!logreader.open_log(filename)) {
+        perror(filename);
         exit(1);
     }
 
-    hal.console->printf("Using an update rate of %u Hz\n", log_info.update_rate);
+    if (summary_filename != nullptr) {
+        find_logged_stats();
+    }
+    if (logged_only) {
+        write_summary(logged_stats.valid ? "ok" : "no-logged-stats");
+        exit(logged_stats.valid ? 0 : 1);
+    }
 
-    if (!logreader.open_log(filename)) {
-        perror(filename);
+    if (!find_log_info(log_info)) {
+        printf("Update to get log information\n");
         exit(1);
     }
 
+    hal.console->printf("Using an update rate of %u Hz\n", log_info.update_rate);
+
     _vehicle.setup();
 
     inhibit_gyro_cal();
@@ -546,6 +605,16 @@ void Replay::setup()
     }
     
     set_ins_update_rate(log_info.update_rate);
+
+    if (start_time_us != 0) {
+        // keep parameters from before the start time
+        static const char *keep_types[] = { "PARM", nullptr };
+        if (!logreader.seek_time(start_time_us, keep_types)) {
+            ::printf("Unable to seek to start time - no log index?\n");
+            exit(1);
+        }
+        ::printf("Starting at %.1f seconds\n", start_time_us*1.0e-6);
+    }
 }
 
 void Replay::set_ins_update_rate(uint16_t _update_rate) {
@@ -697,8 +766,14 @@ void Replay::read_sensors(const char *type)
         if ((downsample == 0 || ++output_counter % downsample == 0) && !logmatch) {
             write_ekf_logs();
         }
+        if (summary_filename != nullptr) {
+            update_ekf3_stats();
+        }
         if (_vehicle.ahrs.healthy() != ahrs_healthy) {
             ahrs_healthy = _vehicle.ahrs.healthy();
+            if (!ahrs_healthy) {
+                ekf3_stats.unhealthy_events++;
+            }
             printf("AHRS health: %u at %lu\n", 
                    (unsigned)ahrs_healthy,
                    (unsigned long)AP_HAL::millis());
@@ -709,6 +784,15 @@ void Replay::read_sensors(const char *type)
             log_check_solution();
         }
     }
+
+    /*
+      CHK3 immediately follows the CHEK message it was generated with,
+      so the EKF3 solution is the one from the update run on CHEK
+     */
+    if (check_solution && streq(type, "CHK3")) {
+        seen_chk3 = true;
+        log_check_solution_ekf3();
+    }
     
     if (logmatch && (streq(type, "NKF1") || streq(type, "XKF1"))) {
         write_ekf_logs();
@@ -746,6 +830,45 @@ void Replay::log_check_generate(void)
         velocity.y,
         velocity.z
         );
+
+    _vehicle.ahrs.EKF3.getEulerAngles(-1,euler);
+    _vehicle.ahrs.EKF3.getVelNED(-1,velocity);
+    _vehicle.ahrs.EKF3.getLLH(loc);
+
+    _vehicle.logger.Write(
+        "CHK3",
+        "TimeUS,Roll,Pitch,Yaw,Lat,Lng,Alt,VN,VE,VD,FusT",
+        "sdddDUmnnns",
+        "FBBBGGB000F",
+        "QccCLLffffQ",
+        AP_HAL::micros64(),
+        (int16_t)(100*degrees(euler.x)), // roll angle (centi-deg, displayed as deg due to format string)
+        (int16_t)(100*degrees(euler.y)), // pitch angle (centi-deg, displayed as deg due to format string)
+        (uint16_t)wrap_360_cd(100*degrees(euler.z)), // yaw angle (centi-deg, displayed as deg due to format string)
+        loc.lat,
+        loc.lng,
+        loc.alt*0.01f,
+        velocity.x,
+        velocity.y,
+        velocity.z,
+        ekf3_fusion_time_us()
+        );
+}
+
+/*
+  return the total CPU time spent fusing EKF3 velocity and position
+  measurements so far, over all cores
+ */
+uint64_t Replay::ekf3_fusion_time_us()
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    uint64_t count;
+    uint64_t total_nsec;
+    if (Linux::Perf::get_singleton()->get_elapsed_total("EK3_FuseVelPosNED", count, total_nsec)) {
+        return total_nsec / 1000;
+    }
+#endif
+    return 0;
 }
 
 
@@ -763,32 +886,269 @@ void Replay::log_check_solution(void)
     _vehicle.ahrs.EKF2.getVelNED(-1,velocity);
     _vehicle.ahrs.EKF2.getLLH(loc);
 
+    update_check_result(check_result, check_state, euler, velocity, loc);
+}
+
+/*
+  check current EKF3 solution against CHK3 message
+ */
+void Replay::log_check_solution_ekf3(void)
+{
+    const LR_MsgHandler::CheckState &check_state = logreader.get_check3_state();
+    Vector3f euler;
+    Vector3f velocity;
+    Location loc {};
+
+    _vehicle.ahrs.EKF3.getEulerAngles(-1,euler);
+    _vehicle.ahrs.EKF3.getVelNED(-1,velocity);
+    _vehicle.ahrs.EKF3.getLLH(loc);
+
+    update_check_result(check3_result, check_state, euler, velocity, loc);
+}
+
+void Replay::update_check_result(CheckResult &result, const LR_MsgHandler::CheckState &check_state,
+                                 const Vector3f &euler, const Vector3f &velocity, const Location &loc)
+{
     float roll_error  = degrees(fabsf(euler.x - check_state.euler.x));
     float pitch_error = degrees(fabsf(euler.y - check_state.euler.y));
     float yaw_error = wrap_180_cd(100*degrees(fabsf(euler.z - check_state.euler.z)))*0.01f;
     float vel_error = (velocity - check_state.velocity).length();
     float pos_error = check_state.pos.get_distance(loc);
 
-    check_result.max_roll_error  = MAX(check_result.max_roll_error,  roll_error);
-    check_result.max_pitch_error = MAX(check_result.max_pitch_error, pitch_error);
-    check_result.max_yaw_error   = MAX(check_result.max_yaw_error,   yaw_error);
-    check_result.max_vel_error   = MAX(check_result.max_vel_error,   vel_error);
-    check_result.max_pos_error   = MAX(check_result.max_pos_error,   pos_error);
+    result.max_roll_error  = MAX(result.max_roll_error,  roll_error);
+    result.max_pitch_error = MAX(result.max_pitch_error, pitch_error);
+    result.max_yaw_error   = MAX(result.max_yaw_error,   yaw_error);
+    result.max_vel_error   = MAX(result.max_vel_error,   vel_error);
+    result.max_pos_error   = MAX(result.max_pos_error,   pos_error);
 }
 
 void Replay::flush_and_exit()
 {
     flush_logger();
 
+    bool failed = false;
     if (check_solution) {
-        report_checks();
+        failed = report_checks();
     }
 
     if (packet_counts) {
         show_packet_counts();
     }
 
-    exit(0);
+    write_summary(failed ? "checks-failed" : "ok");
+
+    exit(failed ? 1 : 0);
+}
+
+void Replay::Stat::update(float v)
+{
+    if (isnan(v)) {
+        return;
+    }
+    max = MAX(max, fabsf(v));
+    sum_sq += double(v) * v;
+    count++;
+}
+
+/*
+  gather EKF3 innovation statistics and count fault, timeout and
+  health events for the primary core after each AHRS update
+ */
+void Replay::update_ekf3_stats()
+{
+    const NavEKF3 &ekf3 = _vehicle.ahrs.EKF3;
+    if (ekf3.activeCores() == 0) {
+        return;
+    }
+
+    Vector3f vel_innov, pos_innov, mag_innov;
+    float tas_innov, yaw_innov;
+    ekf3.getInnovations(-1, vel_innov, pos_innov, mag_innov, tas_innov, yaw_innov);
+    ekf3_stats.vel_innov.update(vel_innov.length());
+    ekf3_stats.pos_innov.update(Vector2f(pos_innov.x, pos_innov.y).length());
+
+    float vel_var, pos_var, hgt_var, tas_var;
+    Vector3f mag_var;
+    Vector2f offset;
+    ekf3.getVariances(-1, vel_var, pos_var, hgt_var, mag_var, tas_var, offset);
+    ekf3_stats.vel_ratio.update(vel_var);
+    ekf3_stats.pos_ratio.update(pos_var);
+    ekf3_stats.hgt_ratio.update(hgt_var);
+    ekf3_stats.mag_ratio.update(mag_var.length());
+    ekf3_stats.tas_ratio.update(tas_var);
+
+    uint16_t faults;
+    ekf3.getFilterFaults(-1, faults);
+    // bit 7 is set until the filter is initialised
+    faults &= ~(1U<<7);
+    if (faults & ~ekf3_stats.last_faults) {
+        ekf3_stats.fault_events++;
+    }
+    ekf3_stats.last_faults = faults;
+
+    uint8_t timeouts;
+    ekf3.getFilterTimeouts(-1, timeouts);
+    if (timeouts & ~ekf3_stats.last_timeouts) {
+        ekf3_stats.timeout_events++;
+    }
+    ekf3_stats.last_timeouts = timeouts;
+}
+
+/*
+  decode fields of every message of a type into newly allocated
+  arrays, returning the number of messages, or zero if the type is
+  not in the log or a field could not be decoded. The caller frees
+  the arrays
+ */
+static uint32_t decode_fields(const LogColumns &columns, const char *name,
+                              const char *const labels[], uint8_t num_labels,
+                              double *values[], uint8_t num_threads)
+{
+    const int16_t type = columns.find_type(name);
+    if (type == -1 || columns.count(type) == 0) {
+        return 0;
+    }
+    const uint32_t count = columns.count(type);
+    for (uint8_t i=0; i<num_labels; i++) {
+        values[i] = new double[count];
+        if (values[i] == nullptr ||
+            !columns.decode_field(type, labels[i], values[i], num_threads)) {
+            return 0;
+        }
+    }
+    return count;
+}
+
+/*
+  gather statistics of the EKF3 innovations and test ratios recorded
+  in the log, for comparison with the replayed ones. The messages are
+  found and decoded by the parallel pre-pass over the mapped log, so
+  this doesn't need a sequential pass. Only the first core is used,
+  which is the primary unless the log has a lane switch
+ */
+void Replay::find_logged_stats()
+{
+    size_t len;
+    const uint8_t *data = logreader.mapped_log(len);
+    if (data == nullptr) {
+        ::printf("Log is not mapped, no logged EKF3 statistics\n");
+        return;
+    }
+    LogColumns columns(data, len);
+    const uint64_t start_us = wall_micros64();
+    if (!columns.scan(num_threads)) {
+        ::printf("Log pre-pass failed\n");
+        return;
+    }
+
+    static const char *xkf3_labels[] = { "C", "IVN", "IVE", "IVD", "IPN", "IPE" };
+    static const char *xkf4_labels[] = { "C", "SV", "SP", "SH", "SM", "SVT" };
+    double *xkf3[ARRAY_SIZE(xkf3_labels)] {};
+    double *xkf4[ARRAY_SIZE(xkf4_labels)] {};
+    const uint32_t xkf3_count = decode_fields(columns, "XKF3", xkf3_labels, ARRAY_SIZE(xkf3_labels), xkf3, num_threads);
+    const uint32_t xkf4_count = decode_fields(columns, "XKF4", xkf4_labels, ARRAY_SIZE(xkf4_labels), xkf4, num_threads);
+
+    // innovations and test ratios are logged in hundredths
+    for (uint32_t i=0; i<xkf3_count; i++) {
+        if (xkf3[0][i] != 0) {
+            continue;
+        }
+        logged_stats.vel_innov.update(0.01f * Vector3f(xkf3[1][i], xkf3[2][i], xkf3[3][i]).length());
+        logged_stats.pos_innov.update(0.01f * Vector2f(xkf3[4][i], xkf3[5][i]).length());
+    }
+    for (uint32_t i=0; i<xkf4_count; i++) {
+        if (xkf4[0][i] != 0) {
+            continue;
+        }
+        logged_stats.vel_ratio.update(0.01f * xkf4[1][i]);
+        logged_stats.pos_ratio.update(0.01f * xkf4[2][i]);
+        logged_stats.hgt_ratio.update(0.01f * xkf4[3][i]);
+        logged_stats.mag_ratio.update(0.01f * xkf4[4][i]);
+        logged_stats.tas_ratio.update(0.01f * xkf4[5][i]);
+    }
+    logged_stats.valid = xkf3_count != 0 && xkf4_count != 0;
+
+    for (uint8_t i=0; i<ARRAY_SIZE(xkf3); i++) {
+        delete[] xkf3[i];
+    }
+    for (uint8_t i=0; i<ARRAY_SIZE(xkf4); i++) {
+        delete[] xkf4[i];
+    }
+
+    ::printf("Log pre-pass took %.1fms with %u threads, %u bad bytes\n",
+             (wall_micros64() - start_us)*1.0e-3, (unsigned)num_threads, (unsigned)columns.bad_bytes());
+}
+
+void Replay::write_summary_stats(FILE *f, const InnovStats &stats)
+{
+    const struct {
+        const char *name;
+        const Stat &stat;
+    } fields[] = {
+        { "vel_innov", stats.vel_innov },
+        { "pos_innov", stats.pos_innov },
+        { "vel_test_ratio", stats.vel_ratio },
+        { "pos_test_ratio", stats.pos_ratio },
+        { "hgt_test_ratio", stats.hgt_ratio },
+        { "mag_test_ratio", stats.mag_ratio },
+        { "tas_test_ratio", stats.tas_ratio },
+    };
+    for (uint8_t i=0; i<ARRAY_SIZE(fields); i++) {
+        fprintf(f, "%s\"%s\": {\"max\": %.4f, \"rms\": %.4f}",
+                i == 0 ? "" : ", ", fields[i].name, fields[i].stat.max, fields[i].stat.rms());
+    }
+}
+
+void Replay::write_summary(const char *result)
+{
+    if (summary_filename == nullptr) {
+        return;
+    }
+    FILE *f = fopen(summary_filename, "a");
+    if (f == nullptr) {
+        ::fprintf(stderr, "Failed to open (%s): %m\n", summary_filename);
+        return;
+    }
+    fprintf(f, "{\"log\": \"");
+    for (const char *p = log_filename; p && *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', f);
+        }
+        fputc(*p, f);
+    }
+    fprintf(f, "\", \"result\": \"%s\", \"runtime_s\": %.3f, \"log_time_s\": %.3f",
+            result,
+            (wall_micros64() - start_wall_us)*1.0e-6,
+            AP_HAL::millis()*0.001);
+
+    if (logged_stats.valid) {
+        fprintf(f, ", \"logged_ekf3\": {");
+        write_summary_stats(f, logged_stats);
+        fprintf(f, "}");
+    }
+    if (logged_only) {
+        fprintf(f, "}\n");
+        fclose(f);
+        return;
+    }
+
+    fprintf(f, ", \"ekf3\": {");
+    write_summary_stats(f, ekf3_stats);
+    fprintf(f, ", \"fault_events\": %u, \"timeout_events\": %u, \"unhealthy_events\": %u}",
+            (unsigned)ekf3_stats.fault_events,
+            (unsigned)ekf3_stats.timeout_events,
+            (unsigned)ekf3_stats.unhealthy_events);
+
+    if (check_solution) {
+        fprintf(f, ", \"check\": {\"roll\": %.3f, \"pitch\": %.3f, \"yaw\": %.3f, \"pos\": %.3f, \"vel\": %.3f}",
+                check_result.max_roll_error,
+                check_result.max_pitch_error,
+                check_result.max_yaw_error,
+                check_result.max_pos_error,
+                check_result.max_vel_error);
+    }
+    fprintf(f, "}\n");
+    fclose(f);
 }
 
 void Replay::show_packet_counts()
@@ -856,10 +1216,27 @@ bool Replay::show_error(const char *text, float max_error, float tolerance)
     return failed;
 }
 
+bool Replay::show_errors(const char *name, const CheckResult &result)
+{
+    char text[40];
+    bool failed = false;
+    snprintf(text, sizeof(text), "%sRoll error", name);
+    failed |= show_error(text, result.max_roll_error, tolerance_euler);
+    snprintf(text, sizeof(text), "%sPitch error", name);
+    failed |= show_error(text, result.max_pitch_error, tolerance_euler);
+    snprintf(text, sizeof(text), "%sYaw error", name);
+    failed |= show_error(text, result.max_yaw_error, tolerance_euler);
+    snprintf(text, sizeof(text), "%sPosition error", name);
+    failed |= show_error(text, result.max_pos_error, tolerance_pos);
+    snprintf(text, sizeof(text), "%sVelocity error", name);
+    failed |= show_error(text, result.max_vel_error, tolerance_vel);
+    return failed;
+}
+
 /*
-  report results of --check
+  report results of --check, returning true if any check failed
  */
-void Replay::report_checks(void)
+bool Replay::report_checks(void)
 {
     bool failed = false;
     if (tolerance_euler < 0.01f) {
@@ -876,17 +1253,26 @@ void Replay::report_checks(void)
                 check_result.max_vel_error);
         fclose(f);
     }
-    failed |= show_error("Roll error", check_result.max_roll_error, tolerance_euler);
-    failed |= show_error("Pitch error", check_result.max_pitch_error, tolerance_euler);
-    failed |= show_error("Yaw error", check_result.max_yaw_error, tolerance_euler);
-    failed |= show_error("Position error", check_result.max_pos_error, tolerance_pos);
-    failed |= show_error("Velocity error", check_result.max_vel_error, tolerance_vel);
+    failed |= show_errors("", check_result);
+    if (seen_chk3) {
+        failed |= show_errors("EKF3 ", check3_result);
+
+        // compare the EKF3 fusion CPU time with the run which generated the log
+        const uint64_t baseline_us = logreader.get_check3_state().fusion_time_us;
+        const uint64_t fusion_us = ekf3_fusion_time_us();
+        if (baseline_us != 0 && fusion_us != 0) {
+            printf("EKF3 vel/pos fusion time:\t%.3f s (was %.3f s, %.1f%% saving)\n",
+                   fusion_us*1.0e-6,
+                   baseline_us*1.0e-6,
+                   100.0 * (1.0 - (double)fusion_us / baseline_us));
+        }
+    }
     if (failed) {
         printf("Checks failed\n");
-        exit(1);
     } else {
         printf("Checks passed\n");
     }
+    return failed;
 }
 
 /*
@@ -120,6 +120,9 @@ public:
 
     // return true if a user parameter of name is set
     bool check_user_param(const char *name);
+
+    // append a JSON summary of the replay to the --summary file
+    void write_summary(const char *result);
     
 private:
     const char *filename;
@@ -159,15 +162,60 @@ private:
     uint32_t output_counter = 0;
     uint64_t last_timestamp = 0;
     bool packet_counts = false;
+    uint64_t start_time_us = 0;
+    uint8_t num_threads = 1;
 
-    struct {
+    /*
+      statistics for the --summary file
+     */
+    const char *summary_filename = nullptr;
+    uint64_t start_wall_us;
+    struct Stat {
+        float max;
+        double sum_sq;
+        uint32_t count;
+        void update(float v);
+        float rms() const { return count ? sqrt(sum_sq / count) : 0; }
+    };
+    struct InnovStats {
+        Stat vel_innov;     // m/s
+        Stat pos_innov;     // m
+        Stat vel_ratio;     // innovation test ratios
+        Stat pos_ratio;
+        Stat hgt_ratio;
+        Stat mag_ratio;
+        Stat tas_ratio;
+    };
+    struct : InnovStats {
+        uint16_t last_faults;
+        uint8_t last_timeouts;
+        uint32_t fault_events;
+        uint32_t timeout_events;
+        uint32_t unhealthy_events;
+    } ekf3_stats {};
+    void update_ekf3_stats();
+
+    // the EKF3 outputs recorded in the log, from the pre-pass
+    struct : InnovStats {
+        bool valid;
+    } logged_stats {};
+    bool logged_only = false;
+    void find_logged_stats();
+    void write_summary_stats(FILE *f, const InnovStats &stats);
+
+    struct CheckResult {
         float max_roll_error;
         float max_pitch_error;
         float max_yaw_error;
         float max_pos_error;
         float max_alt_error;
         float max_vel_error;
-    } check_result {};
+    };
+    CheckResult check_result {};
+
+    // EKF3 solution checked against CHK3 messages
+    CheckResult check3_result {};
+    bool seen_chk3 = false;
 
     void _parse_command_line(uint8_t argc, char * const argv[]);
 
@@ -187,8 +235,13 @@ private:
     void write_ekf_logs(void);
     void log_check_generate();
     void log_check_solution();
+    void log_check_solution_ekf3();
+    void update_check_result(CheckResult &result, const LR_MsgHandler::CheckState &check_state,
+                             const Vector3f &euler, const Vector3f &velocity, const Location &loc);
     bool show_error(const char *text, float max_error, float tolerance);
-    void report_checks();
+    bool show_errors(const char *name, const CheckResult &result);
+    bool report_checks();
+    uint64_t ekf3_fusion_time_us();
     bool find_log_info(struct log_information &info);
     const char **parse_list_from_string(const char *str);
     bool parse_param_line(char *line, char **vname, float &value);
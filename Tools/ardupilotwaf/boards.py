@@ -412,6 +412,9 @@ class sitl(Board):
         if cfg.options.sitl_flash_storage:
             env.CXXFLAGS += ['-DSTORAGE_USE_FLASH=1']
 
+        if cfg.options.enable_ekf_threads:
+            env.CXXFLAGS += ['-DHAL_NAVEKF_CORE_THREADS=1']
+
         if cfg.env.DEST_OS == 'cygwin':
             env.LIB += [
                 'winmm',
@@ -607,6 +610,9 @@ class linux(Board):
         if cfg.options.apstatedir:
             cfg.define('AP_STATEDIR', cfg.options.apstatedir)
 
+        if cfg.options.enable_ekf_threads:
+            env.CXXFLAGS += ['-DHAL_NAVEKF_CORE_THREADS=1']
+
     def build(self, bld):
         super(linux, self).build(bld)
         if bld.options.upload:
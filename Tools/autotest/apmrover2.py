@@ -4685,6 +4685,64 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
             target_component=target_component,
         )
 
+    def test_oa_planner_latency(self, target_system=1, target_component=1):
+        '''drive around obstacles with a dense object database and check
+        path planning latency reported in OAPL log messages'''
+        if not self.mavproxy_can_do_mision_item_protocols():
+            return
+        self.load_fence("rover-path-bendyruler-fence.txt")
+        for oa_type in 1, 2:
+            self.context_push()
+            ex = None
+            try:
+                self.set_parameter("AVOID_ENABLE", 3)
+                self.set_parameter("OA_TYPE", oa_type)
+                self.set_parameter("OA_LOOKAHEAD", 50)
+                # fill the object database from the simulated proximity sensor
+                self.set_parameter("PRX_TYPE", 10)
+                self.set_parameter("OA_DB_SIZE", 1000)
+                self.set_parameter("OA_DB_QUEUE_SIZE", 200)
+                self.set_parameter("OA_DB_EXPIRE", 60)
+                self.reboot_sitl()
+                self.change_mode('GUIDED')
+                self.wait_ready_to_arm()
+                self.arm_vehicle()
+                self.set_parameter("FENCE_ENABLE", 1)
+                self.set_parameter("WP_RADIUS", 5)
+                target_loc = mavutil.location(40.071260, -105.227000, 0, 0)
+                self.send_guided_mission_item(target_loc,
+                                              target_system=target_system,
+                                              target_component=target_component)
+                self.wait_location(target_loc, timeout=300, accuracy=15)
+                self.disarm_vehicle()
+
+                dfreader = self.dfreader_for_current_onboard_log()
+                count = 0
+                last = None
+                while True:
+                    m = dfreader.recv_match(type="OAPL")
+                    if m is None:
+                        break
+                    count += 1
+                    last = m
+                if last is None:
+                    raise NotAchievedException("No OAPL messages")
+                self.progress("OA_TYPE=%u: %u planner runs, max latency %ums, cancelled %u, late %u" %
+                              (oa_type, count, last.LcyMax, last.Canc, last.Late))
+                if last.Late > 0:
+                    raise NotAchievedException("Path planner results missed their deadline")
+                if last.LcyMax > 1000:
+                    raise NotAchievedException("Path planner latency too high (%ums)" % last.LcyMax)
+            except Exception as e:
+                self.progress("Caught exception: %s" %
+                              self.get_exception_stacktrace(e))
+                ex = e
+            self.context_pop()
+            self.disarm_vehicle()
+            self.reboot_sitl()
+            if ex is not None:
+                raise ex
+
     def script_source_path(self, scriptname):
         return os.path.join(self.rootdir(), "libraries", "AP_Scripting", "examples", scriptname)
 
@@ -5064,6 +5122,10 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
              "PolyFence object avoidance tests - easier bendy ruler test",
              self.test_poly_fence_object_avoidance_bendy_ruler_easier),
 
+            ("OAPlannerLatency",
+             "Path planning latency with a dense object database",
+             self.test_oa_planner_latency),
+
             ("Scripting",
              "Scripting test",
              self.test_scripting),
@@ -4185,6 +4185,7 @@ switch value'''
                     self.progress("Download failed; retrying")
                 self.drain_mav()
                 self.mav.mav.param_request_list_send(target_system, target_component)
+                request_time = self.get_sim_time_cached()
                 attempt_count += 1
                 count = 0
                 expected_count = None
@@ -4215,8 +4216,8 @@ switch value'''
                 if count == expected_count:
                     break
 
-        self.progress("Downloaded %u parameters OK (attempt=%u)" %
-                      (count, attempt_count))
+        self.progress("Downloaded %u parameters OK in %.1fs (attempt=%u)" %
+                      (count, self.get_sim_time_cached() - request_time, attempt_count))
         return (seen_ids, id_seq)
 
     def test_parameters_download(self):
@@ -19,11 +19,14 @@
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_Logger/AP_Logger.h>
 
-const int16_t OA_BENDYRULER_BEARING_INC = 5;            // check every 5 degrees around vehicle
-const float OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO = 1.0f; // step2's lookahead length as a ratio of step1's lookahead length
-const float OA_BENDYRULER_LOOKAHEAD_STEP2_MIN = 2.0f;   // step2 checks at least this many meters past step1's location
-const float OA_BENDYRULER_LOOKAHEAD_PAST_DEST = 2.0f;   // lookahead length will be at least this many meters past the destination
 const float OA_BENDYRULER_LOW_SPEED_SQUARED = (0.2f * 0.2f);    // when ground course is below this speed squared, vehicle's heading will be used
+const uint8_t OA_BENDYRULER_POINTS_BATCH = 32;          // obstacles are copied to the stack in batches of this many points
+
+constexpr int16_t AP_OABendyRuler::OA_BENDYRULER_BEARING_INC;
+constexpr uint8_t AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX;
+constexpr float AP_OABendyRuler::OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO;
+constexpr float AP_OABendyRuler::OA_BENDYRULER_LOOKAHEAD_STEP2_MIN;
+constexpr float AP_OABendyRuler::OA_BENDYRULER_LOOKAHEAD_PAST_DEST;
 
 // run background task to find best path and update avoidance_results
 // returns true and updates origin_new and destination_new if a best path has been found
@@ -32,6 +35,26 @@ bool AP_OABendyRuler::update(const Location& current_loc, const Location& destin
     // bendy ruler always sets origin to current_loc
     origin_new = current_loc;
 
+    // get ground course
+    float ground_course_deg;
+    if (ground_speed_vec.length_squared() < OA_BENDYRULER_LOW_SPEED_SQUARED) {
+        // with zero ground speed use vehicle's heading
+        ground_course_deg = AP::ahrs().yaw_sensor * 0.01f;
+    } else {
+        ground_course_deg = degrees(ground_speed_vec.angle());
+    }
+
+    float log_bearing, log_margin;
+    const bool active = search_bearings(FUNCTOR_BIND_MEMBER(&AP_OABendyRuler::calc_avoidance_margins, void, const Location &, Fan &),
+                                        current_loc, destination, ground_course_deg, destination_new, log_bearing, log_margin);
+    AP::logger().Write_OABendyRuler(active, log_bearing, log_margin, destination, destination_new);
+    return active;
+}
+
+// search the bearings around the vehicle for the one closest to the destination with a clear
+// path, and set destination_new in that direction.  Returns true if avoidance is required
+bool AP_OABendyRuler::search_bearings(margins_fn_t calc_margins, const Location& current_loc, const Location& destination, float ground_course_deg, Location &destination_new, float &log_bearing, float &log_margin)
+{
     // calculate bearing and distance to final destination
     const float bearing_to_dest = current_loc.get_bearing_to(destination) * 0.01f;
     const float distance_to_dest = current_loc.get_distance(destination);
@@ -46,81 +69,87 @@ bool AP_OABendyRuler::update(const Location& current_loc, const Location& destin
     // calculate lookahead dist for step2
     const float lookahead_step2_dist = _current_lookahead * OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO;
 
-    // get ground course
-    float ground_course_deg;
-    if (ground_speed_vec.length_squared() < OA_BENDYRULER_LOW_SPEED_SQUARED) {
-        // with zero ground speed use vehicle's heading
-        ground_course_deg = AP::ahrs().yaw_sensor * 0.01f;
-    } else {
-        ground_course_deg = degrees(ground_speed_vec.angle());
-    }
-
     // check OA_BEARING_INC definition allows checking in all directions
     static_assert(360 % OA_BENDYRULER_BEARING_INC == 0, "check 360 is a multiple of OA_BEARING_INC");
 
     // search in OA_BENDYRULER_BEARING_INC degree increments around the vehicle alternating left
     // and right. For each direction check if vehicle would avoid all obstacles
-    float best_bearing = bearing_to_dest;
-    bool have_best_bearing = false;
-    float best_margin = -FLT_MAX;
-    float best_margin_bearing = best_bearing;
-
+    float bearings[OA_BENDYRULER_BEARINGS_MAX];
+    uint8_t num_bearings = 0;
     for (uint8_t i = 0; i <= (170 / OA_BENDYRULER_BEARING_INC); i++) {
         for (uint8_t bdir = 0; bdir <= 1; bdir++) {
             // skip duplicate check of bearing straight towards destination
             if ((i==0) && (bdir > 0)) {
                 continue;
             }
-            // bearing that we are probing
             const float bearing_delta = i * OA_BENDYRULER_BEARING_INC * (bdir == 0 ? -1.0f : 1.0f);
-            const float bearing_test = wrap_180(bearing_to_dest + bearing_delta);
+            bearings[num_bearings++] = wrap_180(bearing_to_dest + bearing_delta);
+        }
+    }
+
+    float best_bearing = bearing_to_dest;
+    bool have_best_bearing = false;
+    float best_margin = -FLT_MAX;
+    float best_margin_bearing = best_bearing;
+
+    // the bearing straight towards the destination is usually clear so its margin is calculated
+    // on its own.  The margins of all other bearings are calculated together when first needed
+    fan_init(_fan_step1, bearings, 1, lookahead_step1_dist);
+    calc_margins(current_loc, _fan_step1);
+    const float margin_to_dest = _fan_step1.margin[0];
+
+    for (uint8_t i = 0; i < num_bearings; i++) {
+        if (i == 1) {
+            fan_init(_fan_step1, &bearings[1], num_bearings - 1, lookahead_step1_dist);
+            calc_margins(current_loc, _fan_step1);
+        }
+
+        // bearing that we are probing
+        const float bearing_test = bearings[i];
+
+        // ToDo: add effective groundspeed calculations using airspeed
+        // ToDo: add prediction of vehicle's position change as part of turn to desired heading
 
-            // ToDo: add effective groundspeed calculations using airspeed
-            // ToDo: add prediction of vehicle's position change as part of turn to desired heading
+        // margin from fence for this scenario
+        const float margin = (i == 0) ? margin_to_dest : _fan_step1.margin[i-1];
+        if (margin > best_margin) {
+            best_margin_bearing = bearing_test;
+            best_margin = margin;
+        }
+        if (margin > _margin_max) {
+            // this bearing avoids obstacles out to the lookahead_step1_dist
+            // now check in there is a clear path in three directions towards the destination
+            if (!have_best_bearing) {
+                best_bearing = bearing_test;
+                have_best_bearing = true;
+            } else if (fabsf(wrap_180(ground_course_deg - bearing_test)) <
+                       fabsf(wrap_180(ground_course_deg - best_bearing))) {
+                // replace bearing with one that is closer to our current ground course
+                best_bearing = bearing_test;
+            }
 
             // test location is projected from current location at test bearing
             Location test_loc = current_loc;
             test_loc.offset_bearing(bearing_test, lookahead_step1_dist);
 
-            // calculate margin from fence for this scenario
-            float margin = calc_avoidance_margin(current_loc, test_loc);
-            if (margin > best_margin) {
-                best_margin_bearing = bearing_test;
-                best_margin = margin;
-            }
-            if (margin > _margin_max) {
-                // this bearing avoids obstacles out to the lookahead_step1_dist
-                // now check in there is a clear path in three directions towards the destination
-                if (!have_best_bearing) {
-                    best_bearing = bearing_test;
-                    have_best_bearing = true;
-                } else if (fabsf(wrap_180(ground_course_deg - bearing_test)) <
-                           fabsf(wrap_180(ground_course_deg - best_bearing))) {
-                    // replace bearing with one that is closer to our current ground course
-                    best_bearing = bearing_test;
-                }
-
-                // perform second stage test in three directions looking for obstacles
-                const float test_bearings[] { 0.0f, 45.0f, -45.0f };
-                const float bearing_to_dest2 = test_loc.get_bearing_to(destination) * 0.01f;
-                float distance2 = constrain_float(lookahead_step2_dist, OA_BENDYRULER_LOOKAHEAD_STEP2_MIN, test_loc.get_distance(destination));
-                for (uint8_t j = 0; j < ARRAY_SIZE(test_bearings); j++) {
-                    float bearing_test2 = wrap_180(bearing_to_dest2 + test_bearings[j]);
-                    Location test_loc2 = test_loc;
-                    test_loc2.offset_bearing(bearing_test2, distance2);
-
-                    // calculate minimum margin to fence and obstacles for this scenario
-                    float margin2 = calc_avoidance_margin(test_loc, test_loc2);
-                    if (margin2 > _margin_max) {
-                        // all good, now project in the chosen direction by the full distance
-                        destination_new = current_loc;
-                        destination_new.offset_bearing(bearing_test, distance_to_dest);
-                        _current_lookahead = MIN(_lookahead, _current_lookahead * 1.1f);
-                        // if the chosen direction is directly towards the destination turn off avoidance
-                        const bool active = (i != 0 || j != 0);
-                        AP::logger().Write_OABendyRuler(active, bearing_to_dest, margin, destination, destination_new);
-                        return active;
-                    }
+            // perform second stage test in three directions looking for obstacles
+            const float bearing_to_dest2 = test_loc.get_bearing_to(destination) * 0.01f;
+            const float test_bearings[] { wrap_180(bearing_to_dest2), wrap_180(bearing_to_dest2 + 45.0f), wrap_180(bearing_to_dest2 - 45.0f) };
+            const float distance2 = constrain_float(lookahead_step2_dist, OA_BENDYRULER_LOOKAHEAD_STEP2_MIN, test_loc.get_distance(destination));
+            fan_init(_fan_step2, test_bearings, ARRAY_SIZE(test_bearings), distance2);
+
+            // calculate minimum margin to fence and obstacles for these scenarios
+            calc_margins(test_loc, _fan_step2);
+            for (uint8_t j = 0; j < ARRAY_SIZE(test_bearings); j++) {
+                if (_fan_step2.margin[j] > _margin_max) {
+                    // all good, now project in the chosen direction by the full distance
+                    destination_new = current_loc;
+                    destination_new.offset_bearing(bearing_test, distance_to_dest);
+                    _current_lookahead = MIN(_lookahead, _current_lookahead * 1.1f);
+                    // if the chosen direction is directly towards the destination turn off avoidance
+                    log_bearing = bearing_to_dest;
+                    log_margin = margin;
+                    return (i != 0 || j != 0);
                 }
             }
         }
@@ -144,246 +173,224 @@ bool AP_OABendyRuler::update(const Location& current_loc, const Location& destin
     destination_new.offset_bearing(chosen_bearing, distance_to_dest);
 
     // log results
-    AP::logger().Write_OABendyRuler(true, chosen_bearing, best_margin, destination, destination_new);
+    log_bearing = chosen_bearing;
+    log_margin = best_margin;
 
     return true;
 }
 
-// calculate minimum distance between a segment and any obstacle
-float AP_OABendyRuler::calc_avoidance_margin(const Location &start, const Location &end)
+// initialise fan with count segments of length meters at bearings (in degrees) and no obstacles
+void AP_OABendyRuler::fan_init(Fan &fan, const float *bearings, uint8_t count, float length)
 {
-    float margin_min = FLT_MAX;
-
-    float latest_margin;
-    if (calc_margin_from_circular_fence(start, end, latest_margin)) {
-        margin_min = MIN(margin_min, latest_margin);
+    fan.count = MIN(count, (uint8_t)OA_BENDYRULER_BEARINGS_MAX);
+    fan.length = length;
+    for (uint8_t i = 0; i < fan.count; i++) {
+        const float bearing_rad = radians(bearings[i]);
+        fan.dir_x[i] = cosf(bearing_rad);
+        fan.dir_y[i] = sinf(bearing_rad);
+        fan.margin[i] = FLT_MAX;
     }
+}
 
-    if (calc_margin_from_object_database(start, end, latest_margin)) {
-        margin_min = MIN(margin_min, latest_margin);
+// update fan's margins with the distance to points (in meters from the fan's start) less their radius
+void AP_OABendyRuler::fan_update_margins_from_points(Fan &fan, const float *x, const float *y, const float *radius, uint16_t num_points)
+{
+    float dist_sq[OA_BENDYRULER_BEARINGS_MAX];
+    for (uint16_t i = 0; i < num_points; i++) {
+        const float point_x = x[i];
+        const float point_y = y[i];
+        const float point_radius = radius[i];
+
+        // squared distance between each segment and the obstacle.  Segments have no
+        // dependencies between them, so the compiler may vectorise this loop
+        for (uint8_t j = 0; j < fan.count; j++) {
+            // obstacle's distance along and across the segment's line, and along from the closest point of the segment
+            const float along = point_x * fan.dir_x[j] + point_y * fan.dir_y[j];
+            const float across = point_x * fan.dir_y[j] - point_y * fan.dir_x[j];
+            const float beyond = along - MIN(MAX(along, 0.0f), fan.length);
+            dist_sq[j] = sq(across) + sq(beyond);
+        }
+
+        // margin is distance between segment and obstacle minus obstacle's radius.  The square
+        // root is only taken if the margin is smaller, which is rare once the closest obstacles are found
+        for (uint8_t j = 0; j < fan.count; j++) {
+            const float dist_max = fan.margin[j] + point_radius;
+            if ((dist_max > 0.0f) && (dist_sq[j] < sq(dist_max))) {
+                fan.margin[j] = sqrtf(dist_sq[j]) - point_radius;
+            }
+        }
     }
+}
 
-    if (calc_margin_from_inclusion_and_exclusion_polygons(start, end, latest_margin)) {
-        margin_min = MIN(margin_min, latest_margin);
+// update fan's margins with the distance inside a circle (center in meters from the fan's start)
+void AP_OABendyRuler::fan_update_margins_from_inclusion_circle(Fan &fan, const Vector2f &center, float radius)
+{
+    const float start_dist_sq = center.length_squared();
+    for (uint8_t j = 0; j < fan.count; j++) {
+        const float end_dist_sq = sq(fan.dir_x[j] * fan.length - center.x) + sq(fan.dir_y[j] * fan.length - center.y);
+        // margin is circle's radius minus the longer of start or end distance
+        fan.margin[j] = MIN(fan.margin[j], radius - sqrtf(MAX(start_dist_sq, end_dist_sq)));
     }
+}
 
-    if (calc_margin_from_inclusion_and_exclusion_circles(start, end, latest_margin)) {
-        margin_min = MIN(margin_min, latest_margin);
+// calculate minimum distance between each of fan's segments from start and any obstacle
+void AP_OABendyRuler::calc_avoidance_margins(const Location &start, Fan &fan)
+{
+    calc_margins_from_circular_fence(start, fan);
+
+    // all other obstacles are held relative to the EKF origin
+    Vector2f start_NE;
+    if (!start.get_vector_xy_from_origin_NE(start_NE)) {
+        return;
     }
 
-    // return smallest margin from any obstacle
-    return margin_min;
+    calc_margins_from_object_database(start_NE, fan);
+    calc_margins_from_inclusion_and_exclusion_polygons(start_NE, fan);
+    calc_margins_from_inclusion_and_exclusion_circles(start_NE, fan);
 }
 
-// calculate minimum distance between a path and the circular fence (centered on home)
-// on success returns true and updates margin
-bool AP_OABendyRuler::calc_margin_from_circular_fence(const Location &start, const Location &end, float &margin)
+// update fan's margins with the distance inside the circular fence (centered on home)
+void AP_OABendyRuler::calc_margins_from_circular_fence(const Location &start, Fan &fan) const
 {
     // exit immediately if polygon fence is not enabled
     const AC_Fence *fence = AC_Fence::get_singleton();
     if (fence == nullptr) {
-        return false;
+        return;
     }
     if ((fence->get_enabled_fences() & AC_FENCE_TYPE_CIRCLE) == 0) {
-        return false;
+        return;
     }
 
-    // calculate start and end point's distance from home
-    const Location &ahrs_home = AP::ahrs().get_home();
-    const float start_dist_sq = ahrs_home.get_distance_NE(start).length_squared();
-    const float end_dist_sq = ahrs_home.get_distance_NE(end).length_squared();
+    // get home's position from start
+    const Vector2f home_NE = start.get_distance_NE(AP::ahrs().get_home());
 
     // get circular fence radius + margin
     const float fence_radius_plus_margin = fence->get_radius() - fence->get_margin();
 
-    // margin is fence radius minus the longer of start or end distance
-    margin = fence_radius_plus_margin - sqrtf(MAX(start_dist_sq, end_dist_sq));
-    return true;
+    fan_update_margins_from_inclusion_circle(fan, home_NE, fence_radius_plus_margin);
 }
 
-// calculate minimum distance between a path and all inclusion and exclusion polygons
-// on success returns true and updates margin
-bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_polygons(const Location &start, const Location &end, float &margin)
+// update fan's margins with the distance to all inclusion and exclusion polygons. start_NE is in cm from the EKF origin
+void AP_OABendyRuler::calc_margins_from_inclusion_and_exclusion_polygons(const Vector2f &start_NE, Fan &fan) const
 {
     const AC_Fence *fence = AC_Fence::get_singleton();
     if (fence == nullptr) {
-        return false;
+        return;
     }
 
     // exclusion polygons enabled along with polygon fences
     if ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0) {
-        return false;
+        return;
     }
 
     // return immediately if no inclusion nor exclusion polygons
     const uint8_t num_inclusion_polygons = fence->polyfence().get_inclusion_polygon_count();
     const uint8_t num_exclusion_polygons = fence->polyfence().get_exclusion_polygon_count();
     if ((num_inclusion_polygons == 0) && (num_exclusion_polygons == 0)) {
-        return false;
-    }
-
-    // convert start and end to offsets from EKF origin
-    Vector2f start_NE, end_NE;
-    if (!start.get_vector_xy_from_origin_NE(start_NE) || !end.get_vector_xy_from_origin_NE(end_NE)) {
-        return false;
+        return;
     }
 
     // get fence margin
     const float fence_margin = fence->get_margin();
 
-    // iterate through inclusion polygons and calculate minimum margin
-    bool margin_updated = false;
-    for (uint8_t i = 0; i < num_inclusion_polygons; i++) {
+    // iterate through inclusion polygons then exclusion polygons and calculate minimum margin
+    for (uint8_t i = 0; i < num_inclusion_polygons + num_exclusion_polygons; i++) {
+        const bool inclusion = (i < num_inclusion_polygons);
         uint16_t num_points;
-        const Vector2f* boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
+        const Vector2f* boundary = inclusion ? fence->polyfence().get_inclusion_polygon(i, num_points) :
+                                               fence->polyfence().get_exclusion_polygon(i - num_inclusion_polygons, num_points);
         if (num_points < 3) {
-            // ignore exclusion polygons with less than 3 points
+            // ignore polygons with less than 3 points
             continue;
         }
 
-        // if outside the fence margin is the closest distance but with negative sign
-        const float sign = Polygon_outside(start_NE, boundary, num_points) ? -1.0f : 1.0f;
-
-        // calculate min distance (in meters) from line to polygon
-        float margin_new = (sign * Polygon_closest_distance_line(boundary, num_points, start_NE, end_NE) * 0.01f) - fence_margin;
-        if (!margin_updated || (margin_new < margin)) {
-            margin_updated = true;
-            margin = margin_new;
-        }
+        fan_update_margins_from_polygon(fan, start_NE, boundary, num_points, inclusion, fence_margin);
     }
+}
 
-    // iterate through exclusion polygons and calculate minimum margin
-    for (uint8_t i = 0; i < num_exclusion_polygons; i++) {
-        uint16_t num_points;
-        const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
-        if (num_points < 3) {
-            // ignore exclusion polygons with less than 3 points
-            continue;
-        }
-
-        // if start is inside the polygon the margin's sign is reversed
-        const float sign = Polygon_outside(start_NE, boundary, num_points) ? 1.0f : -1.0f;
-
-        // calculate min distance (in meters) from line to polygon
-        float margin_new = (sign * Polygon_closest_distance_line(boundary, num_points, start_NE, end_NE) * 0.01f) - fence_margin;
-        if (!margin_updated || (margin_new < margin)) {
-            margin_updated = true;
-            margin = margin_new;
-        }
+// update fan's margins with the distance to an inclusion or exclusion polygon less fence_margin.
+// start_NE and boundary are in cm from the EKF origin
+void AP_OABendyRuler::fan_update_margins_from_polygon(Fan &fan, const Vector2f &start_NE, const Vector2f *boundary, uint16_t num_points, bool inclusion, float fence_margin)
+{
+    // if outside an inclusion polygon, or inside an exclusion polygon, the margin's sign is reversed
+    const float sign = (Polygon_outside(start_NE, boundary, num_points) != inclusion) ? 1.0f : -1.0f;
+
+    // calculate min distance (in meters) from each segment to polygon
+    for (uint8_t j = 0; j < fan.count; j++) {
+        const Vector2f end_NE = start_NE + Vector2f{fan.dir_x[j], fan.dir_y[j]} * (fan.length * 100.0f);
+        const float margin_new = (sign * Polygon_closest_distance_line(boundary, num_points, start_NE, end_NE) * 0.01f) - fence_margin;
+        fan.margin[j] = MIN(fan.margin[j], margin_new);
     }
-
-    return margin_updated;
 }
 
-// calculate minimum distance between a path and all inclusion and exclusion circles
-// on success returns true and updates margin
-bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_circles(const Location &start, const Location &end, float &margin)
+// update fan's margins with the distance to all inclusion and exclusion circles. start_NE is in cm from the EKF origin
+void AP_OABendyRuler::calc_margins_from_inclusion_and_exclusion_circles(const Vector2f &start_NE, Fan &fan) const
 {
     // exit immediately if fence is not enabled
     const AC_Fence *fence = AC_Fence::get_singleton();
     if (fence == nullptr) {
-        return false;
+        return;
     }
 
     // inclusion/exclusion circles enabled along with polygon fences
     if ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0) {
-        return false;
-    }
-
-    // return immediately if no inclusion nor exclusion circles
-    const uint8_t num_inclusion_circles = fence->polyfence().get_inclusion_circle_count();
-    const uint8_t num_exclusion_circles = fence->polyfence().get_exclusion_circle_count();
-    if ((num_inclusion_circles == 0) && (num_exclusion_circles == 0)) {
-        return false;
-    }
-
-    // convert start and end to offsets from EKF origin
-    Vector2f start_NE, end_NE;
-    if (!start.get_vector_xy_from_origin_NE(start_NE) || !end.get_vector_xy_from_origin_NE(end_NE)) {
-        return false;
+        return;
     }
 
     // get fence margin
     const float fence_margin = fence->get_margin();
 
     // iterate through inclusion circles and calculate minimum margin
-    bool margin_updated = false;
+    const uint8_t num_inclusion_circles = fence->polyfence().get_inclusion_circle_count();
     for (uint8_t i = 0; i < num_inclusion_circles; i++) {
         Vector2f center_pos_cm;
         float radius;
         if (fence->polyfence().get_inclusion_circle(i, center_pos_cm, radius)) {
-
-            // calculate start and ends distance from the center of the circle
-            const float start_dist_sq = (start_NE - center_pos_cm).length_squared();
-            const float end_dist_sq = (end_NE - center_pos_cm).length_squared();
-
-            // margin is fence radius minus the longer of start or end distance
-            const float margin_new = (radius + fence_margin) - (sqrtf(MAX(start_dist_sq, end_dist_sq)) * 0.01f);
-
-            // update margin with lowest value so far
-            if (!margin_updated || (margin_new < margin)) {
-                margin_updated = true;
-                margin = margin_new;
-            }
+            fan_update_margins_from_inclusion_circle(fan, (center_pos_cm - start_NE) * 0.01f, radius + fence_margin);
         }
     }
 
-    // iterate through exclusion circles and calculate minimum margin
+    // exclusion circles are obstacles with the fence margin added to their radius
+    const uint8_t num_exclusion_circles = fence->polyfence().get_exclusion_circle_count();
+    float x[OA_BENDYRULER_POINTS_BATCH], y[OA_BENDYRULER_POINTS_BATCH], radius[OA_BENDYRULER_POINTS_BATCH];
+    uint8_t num_points = 0;
     for (uint8_t i = 0; i < num_exclusion_circles; i++) {
         Vector2f center_pos_cm;
-        float radius;
-        if (fence->polyfence().get_exclusion_circle(i, center_pos_cm, radius)) {
-
-            // first calculate distance between circle's center and segment
-            const float dist_cm = Vector2f::closest_distance_between_line_and_point(start_NE, end_NE, center_pos_cm);
-
-            // margin is distance to the center minus the radius
-            const float margin_new = (dist_cm * 0.01f) - (radius + fence_margin);
-
-            // update margin with lowest value so far
-            if (!margin_updated || (margin_new < margin)) {
-                margin_updated = true;
-                margin = margin_new;
-            }
+        float circle_radius;
+        if (fence->polyfence().get_exclusion_circle(i, center_pos_cm, circle_radius)) {
+            x[num_points] = (center_pos_cm.x - start_NE.x) * 0.01f;
+            y[num_points] = (center_pos_cm.y - start_NE.y) * 0.01f;
+            radius[num_points] = circle_radius + fence_margin;
+            num_points++;
+        }
+        if ((num_points == OA_BENDYRULER_POINTS_BATCH) || ((i == num_exclusion_circles - 1) && (num_points > 0))) {
+            fan_update_margins_from_points(fan, x, y, radius, num_points);
+            num_points = 0;
         }
     }
-
-    return margin_updated;
 }
 
-// calculate minimum distance between a path and proximity sensor obstacles
-// on success returns true and updates margin
-bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, const Location &end, float &margin)
+// update fan's margins with the distance to proximity sensor obstacles. start_NE is in cm from the EKF origin
+void AP_OABendyRuler::calc_margins_from_object_database(const Vector2f &start_NE, Fan &fan) const
 {
     // exit immediately if db is empty
-    AP_OADatabase *oaDb = AP::oadatabase();
+    const AP_OADatabase *oaDb = AP::oadatabase();
     if (oaDb == nullptr || !oaDb->healthy()) {
-        return false;
+        return;
     }
 
-    // convert start and end to offsets (in cm) from EKF origin
-    Vector2f start_NE, end_NE;
-    if (!start.get_vector_xy_from_origin_NE(start_NE) || !end.get_vector_xy_from_origin_NE(end_NE)) {
-        return false;
-    }
-
-    // check each obstacle's distance from segment
-    float smallest_margin = FLT_MAX;
-    for (uint16_t i=0; i<oaDb->database_count(); i++) {
-        const AP_OADatabase::OA_DbItem& item = oaDb->get_item(i);
-        const Vector2f point_cm = item.pos * 100.0f;
-        // margin is distance between line segment and obstacle minus obstacle's radius
-        const float m = Vector2f::closest_distance_between_line_and_point(start_NE, end_NE, point_cm) * 0.01f - item.radius;
-        if (m < smallest_margin) {
-            smallest_margin = m;
+    // obstacles are copied in batches to be positions (in meters) from start
+    const Vector2f start_m = start_NE * 0.01f;
+    float x[OA_BENDYRULER_POINTS_BATCH], y[OA_BENDYRULER_POINTS_BATCH], radius[OA_BENDYRULER_POINTS_BATCH];
+    const uint16_t count = oaDb->database_count();
+    for (uint16_t i = 0; i < count; i += OA_BENDYRULER_POINTS_BATCH) {
+        const uint8_t num_points = MIN(count - i, OA_BENDYRULER_POINTS_BATCH);
+        for (uint8_t j = 0; j < num_points; j++) {
+            const AP_OADatabase::OA_DbItem& item = oaDb->get_item(i + j);
+            x[j] = item.pos.x - start_m.x;
+            y[j] = item.pos.y - start_m.y;
+            radius[j] = item.radius;
         }
+        fan_update_margins_from_points(fan, x, y, radius, num_points);
     }
-
-    // return smallest margin
-    if (smallest_margin < FLT_MAX) {
-        margin = smallest_margin;
-        return true;
-    }
-
-    return false;
 }
@@ -11,6 +11,12 @@
 class AP_OABendyRuler {
 public:
 
+    static constexpr int16_t OA_BENDYRULER_BEARING_INC = 5;    // check every 5 degrees around vehicle
+    static constexpr uint8_t OA_BENDYRULER_BEARINGS_MAX = 1 + 2 * (170 / OA_BENDYRULER_BEARING_INC);  // number of bearings checked around vehicle
+    static constexpr float OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO = 1.0f; // step2's lookahead length as a ratio of step1's lookahead length
+    static constexpr float OA_BENDYRULER_LOOKAHEAD_STEP2_MIN = 2.0f;   // step2 checks at least this many meters past step1's location
+    static constexpr float OA_BENDYRULER_LOOKAHEAD_PAST_DEST = 2.0f;   // lookahead length will be at least this many meters past the destination
+
     AP_OABendyRuler() {}
 
     /* Do not allow copies */
@@ -24,26 +30,58 @@ public:
     // returns true and populates origin_new and destination_new if OA is required.  returns false if OA is not required
     bool update(const Location& current_loc, const Location& destination, const Vector2f &ground_speed_vec, Location &origin_new, Location &destination_new);
 
+    // segments of the same length from a common start in the directions
+    // of unit vectors (north, east). Held as separate arrays so the
+    // margins of all segments are calculated together for each obstacle
+    struct Fan {
+        float dir_x[OA_BENDYRULER_BEARINGS_MAX];
+        float dir_y[OA_BENDYRULER_BEARINGS_MAX];
+        float margin[OA_BENDYRULER_BEARINGS_MAX];   // minimum distance (in meters) between each segment and any obstacle
+        float length;                               // length (in meters) of all segments
+        uint8_t count;                              // number of segments
+    };
+
+    // initialise fan with count segments of length meters at bearings (in degrees) and no obstacles
+    static void fan_init(Fan &fan, const float *bearings, uint8_t count, float length);
+
+    // update fan's margins with the distance to points (in meters from the fan's start) less their radius
+    static void fan_update_margins_from_points(Fan &fan, const float *x, const float *y, const float *radius, uint16_t num_points);
+
+    // update fan's margins with the distance inside a circle (center in meters from the fan's start)
+    static void fan_update_margins_from_inclusion_circle(Fan &fan, const Vector2f &center, float radius);
+
+    // update fan's margins with the distance to an inclusion or exclusion polygon less fence_margin.
+    // start_NE and boundary are in cm from the EKF origin
+    static void fan_update_margins_from_polygon(Fan &fan, const Vector2f &start_NE, const Vector2f *boundary, uint16_t num_points, bool inclusion, float fence_margin);
+
+    // calculates the minimum distance between each of a fan's segments from a start location and any obstacle
+    FUNCTOR_TYPEDEF(margins_fn_t, void, const Location &, Fan &);
+
+    // search the bearings around the vehicle for the one closest to the destination with a clear
+    // path, using calc_margins for the obstacles, and set destination_new in that direction.
+    // Returns true if avoidance is required.  log_bearing and log_margin are set to the bearing
+    // and margin to be logged
+    bool search_bearings(margins_fn_t calc_margins, const Location& current_loc, const Location& destination, float ground_course_deg, Location &destination_new, float &log_bearing, float &log_margin);
+
+    // distance (in meters) ahead of the vehicle the last search looked for obstacles
+    float current_lookahead() const { return _current_lookahead; }
+
 private:
 
-    // calculate minimum distance between a path and any obstacle
-    float calc_avoidance_margin(const Location &start, const Location &end);
+    // calculate minimum distance between each of fan's segments from start and any obstacle
+    void calc_avoidance_margins(const Location &start, Fan &fan);
 
-    // calculate minimum distance between a path and the circular fence (centered on home)
-    // on success returns true and updates margin
-    bool calc_margin_from_circular_fence(const Location &start, const Location &end, float &margin);
+    // update fan's margins with the distance inside the circular fence (centered on home)
+    void calc_margins_from_circular_fence(const Location &start, Fan &fan) const;
 
-    // calculate minimum distance between a path and all inclusion and exclusion polygons
-    // on success returns true and updates margin
-    bool calc_margin_from_inclusion_and_exclusion_polygons(const Location &start, const Location &end, float &margin);
+    // update fan's margins with the distance to all inclusion and exclusion polygons. start_NE is in cm from the EKF origin
+    void calc_margins_from_inclusion_and_exclusion_polygons(const Vector2f &start_NE, Fan &fan) const;
 
-    // calculate minimum distance between a path and all inclusion and exclusion circles
-    // on success returns true and updates margin
-    bool calc_margin_from_inclusion_and_exclusion_circles(const Location &start, const Location &end, float &margin);
+    // update fan's margins with the distance to all inclusion and exclusion circles. start_NE is in cm from the EKF origin
+    void calc_margins_from_inclusion_and_exclusion_circles(const Vector2f &start_NE, Fan &fan) const;
 
-    // calculate minimum distance between a path and proximity sensor obstacles
-    // on success returns true and updates margin
-    bool calc_margin_from_object_database(const Location &start, const Location &end, float &margin);
+    // update fan's margins with the distance to proximity sensor obstacles. start_NE is in cm from the EKF origin
+    void calc_margins_from_object_database(const Vector2f &start_NE, Fan &fan) const;
 
     // configuration parameters
     float _lookahead;               // object avoidance will look this many meters ahead of vehicle
@@ -51,4 +89,6 @@ private:
 
     // internal variables used by background thread
     float _current_lookahead;       // distance (in meters) ahead of the vehicle we are looking for obstacles
+    Fan _fan_step1;                 // segments from the vehicle at the bearings around it
+    Fan _fan_step2;                 // segments from the end of a clear first step towards the destination
 };
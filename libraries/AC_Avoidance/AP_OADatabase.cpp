@@ -31,6 +31,10 @@ extern const AP_HAL::HAL& hal;
     #define AP_OADATABASE_QUEUE_SIZE_DEFAULT 80
 #endif
 
+#ifndef AP_OADATABASE_INDEX_CELL_SIZE
+    #define AP_OADATABASE_INDEX_CELL_SIZE   2.0f    // size in meters of the cells used to index items by position
+#endif
+
 
 const AP_Param::GroupInfo AP_OADatabase::var_info[] = {
 
@@ -167,6 +171,9 @@ void AP_OADatabase::init_database()
     }
 
     _database.items = new OA_DbItem[_database.size];
+
+    // failure to allocate the index is reported by healthy()
+    IGNORE_RETURN(_database.index.init(_database.size, AP_OADATABASE_INDEX_CELL_SIZE));
 }
 
 // get bitmask of gcs channels item should be sent to based on its importance
@@ -226,17 +233,11 @@ bool AP_OADatabase::process_queue()
 
         item.send_to_gcs = get_send_to_gcs_flags(item.importance);
 
-        // compare item to all items in database. If found a similar item, update the existing, else add it as a new one
-        bool found = false;
-        for (uint16_t i=0; i<_database.count; i++) {
-            if (is_close_to_item_in_database(i, item)) {
-                database_item_refresh(i, item.timestamp_ms, item.radius);
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
+        // find first similar item in database. If found update the existing, else add it as a new one
+        const uint16_t index = find_close_item_in_database(item);
+        if (index != AP_OADatabase_hash::none) {
+            database_item_refresh(index, item.timestamp_ms, item.radius);
+        } else {
             database_item_add(item);
         }
     }
@@ -250,6 +251,7 @@ void AP_OADatabase::database_item_add(const OA_DbItem &item)
     }
     _database.items[_database.count] = item;
     _database.items[_database.count].send_to_gcs = get_send_to_gcs_flags(_database.items[_database.count].importance);
+    _database.index.add(_database.count, item.pos, item.timestamp_ms, item.radius);
     _database.count++;
 }
 
@@ -264,6 +266,7 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
     _database.items[index].radius = 0;
     _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
 
+    _database.index.remove(index);
     _database.count--;
     if (_database.count == 0) {
         return;
@@ -293,6 +296,7 @@ void AP_OADatabase::database_item_refresh(const uint16_t index, const uint32_t t
         _database.items[index].timestamp_ms = timestamp_ms;
         _database.items[index].radius = radius;
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
+        _database.index.refresh(index, _database.items[index].pos, timestamp_ms, radius);
     }
 }
 
@@ -306,14 +310,15 @@ void AP_OADatabase::database_items_remove_all_expired()
         return;
     }
 
+    // remove items from the oldest until one has not expired
     const uint32_t now_ms = AP_HAL::millis();
     const uint32_t expiry_ms = (uint32_t)_database_expiry_seconds * 1000;
-    uint16_t index = 0;
-    while (index < _database.count) {
+    while (_database.count > 0) {
+        const uint16_t index = _database.index.oldest();
         if (now_ms - _database.items[index].timestamp_ms > expiry_ms) {
             database_item_remove(index);
         } else {
-            index++;
+            break;
         }
     }
 }
@@ -330,6 +335,30 @@ bool AP_OADatabase::is_close_to_item_in_database(const uint16_t index, const OA_
     return ((distance_sq < sq(item.radius)) || (distance_sq < sq(_database.items[index].radius)));
 }
 
+// returns index of the first database item close to "item", or AP_OADatabase_hash::none
+uint16_t AP_OADatabase::find_close_item_in_database(const OA_DbItem &item) const
+{
+    // items are close if within either's radius, which the index searches for
+    AP_OADatabase_hash::Search search;
+    if (!_database.index.search_start(item.pos, item.radius, search)) {
+        // too many cells to search so compare item to all items in database
+        for (uint16_t i=0; i<_database.count; i++) {
+            if (is_close_to_item_in_database(i, item)) {
+                return i;
+            }
+        }
+        return AP_OADatabase_hash::none;
+    }
+
+    uint16_t lowest = AP_OADatabase_hash::none;
+    for (uint16_t i = _database.index.search_next(search); i != AP_OADatabase_hash::none; i = _database.index.search_next(search)) {
+        if ((i < lowest) && is_close_to_item_in_database(i, item)) {
+            lowest = i;
+        }
+    }
+    return lowest;
+}
+
 // send ADSB_VEHICLE mavlink messages
 void AP_OADatabase::send_adsb_vehicle(mavlink_channel_t chan, uint16_t interval_ms)
 {
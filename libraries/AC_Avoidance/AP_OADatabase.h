@@ -4,6 +4,7 @@
 #include <AP_Math/AP_Math.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_Param/AP_Param.h>
+#include "AP_OADatabase_hash.h"
 
 class AP_OADatabase {
 public:
@@ -38,7 +39,7 @@ public:
     void queue_push(const Vector2f &pos, uint32_t timestamp_ms, float distance);
 
     // returns true if database is healthy
-    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr); }
+    bool healthy() const { return (_queue.items != nullptr) && (_database.items != nullptr) && _database.index.initialised(); }
 
     // fetch an item in database. Undefined result when i >= _database.count.
     const OA_DbItem& get_item(uint32_t i) const { return _database.items[i]; }
@@ -73,6 +74,9 @@ private:
     // returns true if database item "index" is close to "item"
     bool is_close_to_item_in_database(const uint16_t index, const OA_DbItem &item) const;
 
+    // returns index of the first database item close to "item", or AP_OADatabase_hash::none
+    uint16_t find_close_item_in_database(const OA_DbItem &item) const;
+
     // enum for use with _OUTPUT parameter
     enum class OA_DbOutputLevel {
         OUTPUT_LEVEL_DISABLED = 0,
@@ -101,6 +105,7 @@ private:
         OA_DbItem       *items;                             // array of objects in the database
         uint16_t        count;                              // number of objects in the items array
         uint16_t        size;                               // cached value of _database_size_param that sticks after initialized
+        AP_OADatabase_hash index;                           // spatial and time ordered index of the items
     } _database;
 
     uint16_t _next_index_to_send[MAVLINK_COMM_NUM_BUFFERS]; // index of next object in _database to send to GCS
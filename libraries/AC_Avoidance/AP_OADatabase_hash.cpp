@@ -0,0 +1,280 @@
+#include "AP_OADatabase_hash.h"
+
+const uint16_t AP_OADatabase_hash::none;
+
+bool AP_OADatabase_hash::init(uint16_t max_items, float cell_size)
+{
+    clear();
+    if (max_items == 0 || max_items > 0x8000 || !is_positive(cell_size)) {
+        return false;
+    }
+
+    // at least one bucket per item, and the overflow list
+    uint32_t num_buckets = 16;
+    while (num_buckets < max_items) {
+        num_buckets *= 2;
+    }
+
+    _bucket_head = new uint16_t[num_buckets + 1];
+    _bucket_next = new uint16_t[max_items];
+    _item_bucket = new uint16_t[max_items];
+    _time_prev = new uint16_t[max_items];
+    _time_next = new uint16_t[max_items];
+    _timestamp_ms = new uint32_t[max_items];
+    if (_bucket_head == nullptr || _bucket_next == nullptr || _item_bucket == nullptr ||
+        _time_prev == nullptr || _time_next == nullptr || _timestamp_ms == nullptr) {
+        clear();
+        return false;
+    }
+    _bucket_mask = num_buckets - 1;
+    _max_items = max_items;
+    _cell_size = cell_size;
+    remove_all();
+    return true;
+}
+
+void AP_OADatabase_hash::clear()
+{
+    delete[] _bucket_head;
+    _bucket_head = nullptr;
+    delete[] _bucket_next;
+    _bucket_next = nullptr;
+    delete[] _item_bucket;
+    _item_bucket = nullptr;
+    delete[] _time_prev;
+    _time_prev = nullptr;
+    delete[] _time_next;
+    _time_next = nullptr;
+    delete[] _timestamp_ms;
+    _timestamp_ms = nullptr;
+    _bucket_mask = 0;
+    _max_items = 0;
+    _num_items = 0;
+    for (uint8_t level = 0; level < num_levels; level++) {
+        _radius_max[level] = 0.0f;
+    }
+    _time_head = none;
+    _time_tail = none;
+}
+
+void AP_OADatabase_hash::remove_all()
+{
+    if (!initialised()) {
+        return;
+    }
+    for (uint32_t i = 0; i <= overflow_bucket(); i++) {
+        _bucket_head[i] = none;
+    }
+    _num_items = 0;
+    for (uint8_t level = 0; level < num_levels; level++) {
+        _radius_max[level] = 0.0f;
+    }
+    _time_head = none;
+    _time_tail = none;
+}
+
+// search the cells of each grid covering the square of half width
+// radius (or the largest radius of an item in the grid) around pos,
+// then the overflow list
+bool AP_OADatabase_hash::search_start(const Vector2f &pos, float radius, Search &search) const
+{
+    if (!initialised() || !position_ok(pos)) {
+        return false;
+    }
+    for (uint8_t level = 0; level < num_levels; level++) {
+        if (!search_ok(level, MAX(radius, _radius_max[level]))) {
+            return false;
+        }
+    }
+    search.pos = pos;
+    search.radius = radius;
+    search_level(search, 0);
+    return true;
+}
+
+void AP_OADatabase_hash::search_level(Search &search, uint8_t level) const
+{
+    search.level = level;
+    if (level >= num_levels) {
+        search.item = _bucket_head[overflow_bucket()];
+        return;
+    }
+    const float radius = MAX(search.radius, _radius_max[level]);
+    search.x_min = cell(level, search.pos.x - radius);
+    search.x_max = cell(level, search.pos.x + radius);
+    search.y_min = cell(level, search.pos.y - radius);
+    search.y_max = cell(level, search.pos.y + radius);
+    search.x = search.x_min;
+    search.y = search.y_min;
+    search.item = _bucket_head[bucket(level, search.x, search.y)];
+}
+
+uint16_t AP_OADatabase_hash::search_next(Search &search) const
+{
+    while (search.item == none) {
+        if (search.level >= num_levels) {
+            // the overflow list is finished too
+            return none;
+        }
+        // move to next cell
+        search.y++;
+        if (search.y > search.y_max) {
+            search.y = search.y_min;
+            search.x++;
+            if (search.x > search.x_max) {
+                search_level(search, search.level + 1);
+                continue;
+            }
+        }
+        search.item = _bucket_head[bucket(search.level, search.x, search.y)];
+    }
+    const uint16_t item = search.item;
+    search.item = _bucket_next[item];
+    return item;
+}
+
+void AP_OADatabase_hash::add(uint16_t index, const Vector2f &pos, uint32_t timestamp_ms, float radius)
+{
+    if (!initialised() || (index != _num_items) || (_num_items >= _max_items)) {
+        return;
+    }
+    _num_items++;
+
+    bucket_insert(index, place(pos, radius));
+
+    _timestamp_ms[index] = timestamp_ms;
+    time_insert(index);
+}
+
+void AP_OADatabase_hash::refresh(uint16_t index, const Vector2f &pos, uint32_t timestamp_ms, float radius)
+{
+    if (index >= _num_items) {
+        return;
+    }
+    // a change of radius may move the item to another grid
+    const uint16_t b = place(pos, radius);
+    if (b != _item_bucket[index]) {
+        bucket_unlink(index);
+        bucket_insert(index, b);
+    }
+    time_unlink(index);
+    _timestamp_ms[index] = timestamp_ms;
+    time_insert(index);
+}
+
+void AP_OADatabase_hash::remove(uint16_t index)
+{
+    if (index >= _num_items) {
+        return;
+    }
+    bucket_unlink(index);
+    time_unlink(index);
+    _num_items--;
+    if (_num_items == 0) {
+        for (uint8_t level = 0; level < num_levels; level++) {
+            _radius_max[level] = 0.0f;
+        }
+    }
+    if (index != _num_items) {
+        move(_num_items, index);
+    }
+}
+
+// items go in the finest grid with cells at least as large as their
+// radius, so the cells searched for them are at most three across
+uint16_t AP_OADatabase_hash::place(const Vector2f &pos, float radius)
+{
+    if (position_ok(pos)) {
+        for (uint8_t level = 0; level < num_levels; level++) {
+            if (radius <= cell_size(level)) {
+                _radius_max[level] = MAX(_radius_max[level], radius);
+                return bucket(level, cell(level, pos.x), cell(level, pos.y));
+            }
+        }
+    }
+    return overflow_bucket();
+}
+
+// insert item into the timestamp ordered list.  Items are almost
+// always newer than all others, so the search starts from the newest
+void AP_OADatabase_hash::time_insert(uint16_t index)
+{
+    const uint32_t timestamp_ms = _timestamp_ms[index];
+    uint16_t prev = _time_tail;
+    while ((prev != none) && ((int32_t)(timestamp_ms - _timestamp_ms[prev]) < 0)) {
+        prev = _time_prev[prev];
+    }
+    const uint16_t next = (prev == none) ? _time_head : _time_next[prev];
+    _time_prev[index] = prev;
+    _time_next[index] = next;
+    if (prev == none) {
+        _time_head = index;
+    } else {
+        _time_next[prev] = index;
+    }
+    if (next == none) {
+        _time_tail = index;
+    } else {
+        _time_prev[next] = index;
+    }
+}
+
+void AP_OADatabase_hash::time_unlink(uint16_t index)
+{
+    const uint16_t prev = _time_prev[index];
+    const uint16_t next = _time_next[index];
+    if (prev == none) {
+        _time_head = next;
+    } else {
+        _time_next[prev] = next;
+    }
+    if (next == none) {
+        _time_tail = prev;
+    } else {
+        _time_prev[next] = prev;
+    }
+}
+
+void AP_OADatabase_hash::bucket_insert(uint16_t index, uint16_t b)
+{
+    _item_bucket[index] = b;
+    _bucket_next[index] = _bucket_head[b];
+    _bucket_head[b] = index;
+}
+
+void AP_OADatabase_hash::bucket_unlink(uint16_t index)
+{
+    uint16_t *link = &_bucket_head[_item_bucket[index]];
+    while (*link != index) {
+        link = &_bucket_next[*link];
+    }
+    *link = _bucket_next[index];
+}
+
+// change the index of an item, updating the links to it
+void AP_OADatabase_hash::move(uint16_t from, uint16_t to)
+{
+    uint16_t *link = &_bucket_head[_item_bucket[from]];
+    while (*link != from) {
+        link = &_bucket_next[*link];
+    }
+    *link = to;
+    _bucket_next[to] = _bucket_next[from];
+    _item_bucket[to] = _item_bucket[from];
+
+    const uint16_t prev = _time_prev[from];
+    const uint16_t next = _time_next[from];
+    if (prev == none) {
+        _time_head = to;
+    } else {
+        _time_next[prev] = to;
+    }
+    if (next == none) {
+        _time_tail = to;
+    } else {
+        _time_prev[next] = to;
+    }
+    _time_prev[to] = prev;
+    _time_next[to] = next;
+    _timestamp_ms[to] = _timestamp_ms[from];
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+  AP_OADatabase_hash - an index over the object database's items.
+
+  Items are hashed by the square cell of the grid containing their
+  position, so the items near a position are found by looking only at
+  the buckets of the cells around it.  There is a fine grid and a
+  coarse grid, and each item goes in the finer one whose cells are
+  at least as large as its radius, so the large radius of distant
+  lidar returns doesn't widen every search of the fine grid.  Items
+  too large for either grid, or whose position is out of range, are
+  kept in an overflow list which every search also returns.  Items are
+  also kept in a list ordered by timestamp, so the oldest item is
+  always at the front for expiry.
+
+  Items are identified by their index in the database, and when an
+  item is removed the last item is moved into its place, as the
+  database does.
+ */
+class AP_OADatabase_hash {
+public:
+    AP_OADatabase_hash() {}
+    ~AP_OADatabase_hash() { clear(); }
+
+    /* Do not allow copies */
+    AP_OADatabase_hash(const AP_OADatabase_hash &other) = delete;
+    AP_OADatabase_hash &operator=(const AP_OADatabase_hash&) = delete;
+
+    static const uint16_t none = UINT16_MAX;
+
+    // init - make space for max_items items in cells of cell_size
+    // meters.  returns false on allocation failure
+    bool init(uint16_t max_items, float cell_size) WARN_IF_UNUSED;
+
+    // clear - free all resources
+    void clear();
+
+    // initialised - returns true if the index can be used
+    bool initialised() const { return _bucket_head != nullptr; }
+
+    // remove_all - remove all items, keeping the allocated space
+    void remove_all();
+
+    // add - index a new item, which must be given the next index
+    void add(uint16_t index, const Vector2f &pos, uint32_t timestamp_ms, float radius);
+
+    // refresh - item's timestamp and radius have changed
+    void refresh(uint16_t index, const Vector2f &pos, uint32_t timestamp_ms, float radius);
+
+    // remove - remove item, moving the last item into its index
+    void remove(uint16_t index);
+
+    // oldest - returns index of the item with the oldest timestamp, or none
+    uint16_t oldest() const { return _time_head; }
+
+    // a search of the cells around a position
+    struct Search {
+        Vector2f pos;
+        float radius;
+        uint8_t level;          // grid being searched, or num_levels for the overflow list
+        int32_t x_min, x_max, y_min, y_max;
+        int32_t x, y;           // current cell
+        uint16_t item;          // next item in current cell's bucket
+    };
+
+    // search_start - start a search for the items within radius of
+    // pos, or within their own radius of it.  Returns false if radius
+    // covers too many cells of either grid, and the caller should
+    // check every item instead
+    bool search_start(const Vector2f &pos, float radius, Search &search) const WARN_IF_UNUSED;
+
+    // search_next - returns the index of the next item found by a
+    // search, or none when there are no more.  Some items further
+    // than radius from pos may also be returned, and an item may be
+    // returned more than once
+    uint16_t search_next(Search &search) const;
+
+private:
+    // most cells along each side of a search of each grid
+    static const int32_t max_cells_per_side = 9;
+
+    // the fine grid, then the coarse grid with cells this many times larger
+    static const uint8_t num_levels = 2;
+    static const uint8_t coarse_scale = 4;
+
+    float _cell_size = 1.0f;    // size of the fine grid's cells
+    uint16_t _max_items = 0;
+    uint16_t _num_items = 0;
+
+    // largest radius of an item in each grid, so searches cover them.
+    // Never more than the grid's cell size
+    float _radius_max[num_levels] {};
+
+    // buckets hold singly linked lists of the items in the cells which
+    // hash to them.  The bucket after the last is the overflow list
+    uint16_t *_bucket_head = nullptr;
+    uint16_t _bucket_mask = 0;
+    uint16_t *_bucket_next = nullptr;
+    uint16_t *_item_bucket = nullptr;
+
+    // doubly linked list of items in timestamp order, oldest first
+    uint16_t *_time_prev = nullptr;
+    uint16_t *_time_next = nullptr;
+    uint32_t *_timestamp_ms = nullptr;
+    uint16_t _time_head = none;
+    uint16_t _time_tail = none;
+
+    // returns true if pos is finite and within the range the cells can cover
+    static bool position_ok(const Vector2f &pos) {
+        return (fabsf(pos.x) < 1.0e6f) && (fabsf(pos.y) < 1.0e6f);
+    }
+
+    float cell_size(uint8_t level) const { return (level == 0) ? _cell_size : (_cell_size * coarse_scale); }
+
+    // returns true if a search of radius is within max_cells_per_side of a grid
+    bool search_ok(uint8_t level, float radius) const {
+        return (radius * 2) <= (cell_size(level) * (max_cells_per_side - 1));
+    }
+
+    // cell of a grid containing coordinate
+    int32_t cell(uint8_t level, float coord) const { return (int32_t)floorf(coord / cell_size(level)); }
+
+    // bucket holding the items not in any cell
+    uint16_t overflow_bucket() const { return _bucket_mask + 1; }
+
+    // bucket holding a cell's items
+    uint16_t bucket(uint8_t level, int32_t x, int32_t y) const {
+        return (((uint32_t)x * 73856093U) ^ ((uint32_t)y * 19349663U) ^ (level * 83492791U)) & _bucket_mask;
+    }
+
+    // bucket for an item of radius at pos, updating the grid's largest radius
+    uint16_t place(const Vector2f &pos, float radius);
+
+    // move a search to the cells of a grid, or to the overflow list
+    void search_level(Search &search, uint8_t level) const;
+
+    // add item to, or remove it from, the timestamp ordered list
+    void time_insert(uint16_t index);
+    void time_unlink(uint16_t index);
+
+    // add item to, or remove it from, a bucket
+    void bucket_insert(uint16_t index, uint16_t b);
+    void bucket_unlink(uint16_t index);
+
+    // change the index of an item
+    void move(uint16_t from, uint16_t to);
+};
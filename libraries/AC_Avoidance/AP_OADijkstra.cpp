@@ -20,7 +20,7 @@
 #include <AP_Logger/AP_Logger.h>
 
 #define OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK  32      // expanding arrays for fence points and paths to destination will grow in increments of 20 elements
-#define OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX        255     // index use to indicate we do not have a tentative short path for a node
+#define OA_DIJKSTRA_EXCLUSION_CIRCLE_NUMPOINTS          6       // number of points around each exclusion circle
 #define OA_DIJKSTRA_ERROR_REPORTING_INTERVAL_MS         5000    // failure messages sent to GCS every 5 seconds
 
 /// Constructor
@@ -28,7 +28,6 @@ AP_OADijkstra::AP_OADijkstra() :
         _inclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
-        _short_path_data(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _path(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
 {
 }
@@ -453,7 +452,7 @@ bool AP_OADijkstra::create_exclusion_circle_with_margin(float margin_cm, AP_OADi
     _exclusion_circle_numpoints = 0;
 
     // unit length offsets for polygon points around circles
-    const Vector2f unit_offsets[] = {
+    const Vector2f unit_offsets[OA_DIJKSTRA_EXCLUSION_CIRCLE_NUMPOINTS] = {
             {cosf(radians(30)), cosf(radians(30-90))},  // north-east
             {cosf(radians(90)), cosf(radians(90-90))},  // east
             {cosf(radians(150)), cosf(radians(150-90))},// south-east
@@ -530,76 +529,10 @@ bool AP_OADijkstra::get_point(uint16_t index, Vector2f &point) const
     return false;
 }
 
-// returns true if line segment intersects polygon or circular fence
-bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const
-{
-    // return immediately if fence is not enabled
-    const AC_Fence *fence = AC_Fence::get_singleton();
-    if (fence == nullptr) {
-        return false;
-    }
-
-    // determine if segment crosses any of the inclusion polygons
-    uint16_t num_points = 0;
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_polygon_count(); i++) {
-        const Vector2f* boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
-        if ((boundary != nullptr) && (num_points >= 3)) {
-            Vector2f intersection;
-            if (Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection)) {
-                return true;
-            }
-        }
-    }
-
-    // determine if segment crosses any of the exclusion polygons
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_polygon_count(); i++) {
-        const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
-        if ((boundary != nullptr) && (num_points >= 3)) {
-            Vector2f intersection;
-            if (Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection)) {
-                return true;
-            }
-        }
-    }
-
-    // determine if segment crosses any of the inclusion circles
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_circle_count(); i++) {
-        Vector2f center_pos_cm;
-        float radius;
-        if (fence->polyfence().get_inclusion_circle(i, center_pos_cm, radius)) {
-            // intersects circle if either start or end is further from the center than the radius
-            const float radius_cm_sq = sq(radius * 100.0f) ;
-            if ((seg_start - center_pos_cm).length_squared() > radius_cm_sq) {
-                return true;
-            }
-            if ((seg_end - center_pos_cm).length_squared() > radius_cm_sq) {
-                return true;
-            }
-        }
-    }
-
-    // determine if segment crosses any of the exclusion circles
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_circle_count(); i++) {
-        Vector2f center_pos_cm;
-        float radius;
-        if (fence->polyfence().get_exclusion_circle(i, center_pos_cm, radius)) {
-            // calculate distance between circle's center and segment
-            const float dist_cm = Vector2f::closest_distance_between_line_and_point(seg_start, seg_end, center_pos_cm);
-
-            // intersects if distance is less than radius
-            if (dist_cm <= (radius * 100.0f)) {
-                return true;
-            }
-        }
-    }
-
-    // if we got this far then no intersection
-    return false;
-}
-
 // create visibility graph for all fence (with margin) points
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin
+// nodes are added in the same order as get_point so node indexes match point indexes
 bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
 {
     // exit immediately if fence is not enabled
@@ -610,175 +543,78 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
     }
 
     // fail if more fence points than algorithm can handle
-    if (total_numpoints() >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+    if (total_numpoints() > AP_OAVisGraph::max_nodes) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_TOO_MANY_FENCE_POINTS;
         return false;
     }
 
-    // clear fence points visibility graph
-    _fence_visgraph.clear();
-
-    // calculate distance from each point to all other points
-    for (uint8_t i = 0; i < total_numpoints() - 1; i++) {
-        Vector2f start_seg;
-        if (get_point(i, start_seg)) {
-            for (uint8_t j = i + 1; j < total_numpoints(); j++) {
-                Vector2f end_seg;
-                if (get_point(j, end_seg)) {
-                    // if line segment does not intersect with any inclusion or exclusion zones add to visgraph
-                    if (!intersects_fence(start_seg, end_seg)) {
-                        if (!_fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
-                                                      {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
-                                                      (start_seg - end_seg).length())) {
-                            // failure to add a point can only be caused by out-of-memory
-                            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-                            return false;
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    return true;
-}
-
-// updates visibility graph for a given position which is an offset (in cm) from the ekf origin
-// to add an additional position (i.e. the destination) set add_extra_position = true and provide the position in the extra_position argument
-// requires create_inclusion_polygon_with_margin to have been run
-// returns true on success
-bool AP_OADijkstra::update_visgraph(AP_OAVisGraph& visgraph, const AP_OAVisGraph::OAItemID& oaid, const Vector2f &position, bool add_extra_position, Vector2f extra_position)
-{
-    // exit immediately if no fence (with margin) points
-    if (total_numpoints() == 0) {
+    // fail if more fence objects than algorithm can handle
+    const AC_PolyFence_loader &polyfence = fence->polyfence();
+    const uint16_t num_objects = polyfence.get_inclusion_polygon_count() + polyfence.get_exclusion_polygon_count() +
+                                 polyfence.get_inclusion_circle_count() + polyfence.get_exclusion_circle_count();
+    if (num_objects > AP_OAVisGraph::max_objects) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_TOO_MANY_FENCE_POINTS;
         return false;
     }
 
-    // clear visibility graph
-    visgraph.clear();
+    // describe the fence to the visibility graph, which only tests pairs of points affected by changes
+    _fence_visgraph.begin_update();
+    bool success = true;
 
-    // calculate distance from position to all inclusion/exclusion fence points
-    for (uint8_t i = 0; i < total_numpoints(); i++) {
-        Vector2f seg_end;
-        if (get_point(i, seg_end)) {
-            if (!intersects_fence(position, seg_end)) {
-                // line segment does not intersect with fences so add to visgraph
-                if (!visgraph.add_item(oaid, {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, (position - seg_end).length())) {
-                    return false;
-                }
+    // inclusion polygons and the points inside them
+    uint16_t num_points = 0;
+    uint16_t point_idx = 0;
+    for (uint8_t i = 0; i < polyfence.get_inclusion_polygon_count(); i++) {
+        const Vector2f* boundary = polyfence.get_inclusion_polygon(i, num_points);
+        if ((boundary != nullptr) && (num_points >= 3)) {
+            success &= _fence_visgraph.add_polygon(AP_OAVisGraph::ObjectType::INCLUSION_POLYGON, boundary, num_points);
+            for (uint16_t j = 0; j < num_points; j++) {
+                success &= _fence_visgraph.add_node(_inclusion_polygon_pts[point_idx++]);
             }
         }
     }
 
-    // add extra point to visibility graph if it doesn't intersect with polygon fence or exclusion polygons
-    if (add_extra_position) {
-        if (!intersects_fence(position, extra_position)) {
-            if (!visgraph.add_item(oaid, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, (position - extra_position).length())) {
-                return false;
+    // exclusion polygons and the points around them
+    point_idx = 0;
+    for (uint8_t i = 0; i < polyfence.get_exclusion_polygon_count(); i++) {
+        const Vector2f* boundary = polyfence.get_exclusion_polygon(i, num_points);
+        if ((boundary != nullptr) && (num_points >= 3)) {
+            success &= _fence_visgraph.add_polygon(AP_OAVisGraph::ObjectType::EXCLUSION_POLYGON, boundary, num_points);
+            for (uint16_t j = 0; j < num_points; j++) {
+                success &= _fence_visgraph.add_node(_exclusion_polygon_pts[point_idx++]);
             }
         }
     }
 
-    return true;
-}
-
-// update total distance for all nodes visible from current node
-// curr_node_idx is an index into the _short_path_data array
-void AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
-{
-    // sanity check
-    if (curr_node_idx >= _short_path_data_numpoints) {
-        return;
-    }
-
-    // get current node for convenience
-    const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
-
-    // for each visibility graph
-    const AP_OAVisGraph* visgraphs[] = {&_fence_visgraph, &_destination_visgraph};
-    for (uint8_t v=0; v<ARRAY_SIZE(visgraphs); v++) {
-
-        // skip if empty
-        const AP_OAVisGraph &curr_visgraph = *visgraphs[v];
-        if (curr_visgraph.num_items() == 0) {
-            continue;
-        }
-
-        // search visibility graph for items visible from current_node
-        for (uint16_t i = 0; i < curr_visgraph.num_items(); i++) {
-            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph[i];
-            // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
-            if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
-                AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
-                // find item's id in node array
-                node_index item_node_idx;
-                if (find_node_from_id(matching_id, item_node_idx)) {
-                    // if current node's distance + distance to item is less than item's current distance, update item's distance
-                    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
-                    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
-                        // update item's distance and set "distance_from_idx" to current node's index
-                        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
-                        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
-                    }
-                }
+    // exclusion circles and the points around them
+    point_idx = 0;
+    for (uint8_t i = 0; i < polyfence.get_exclusion_circle_count(); i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (polyfence.get_exclusion_circle(i, center_pos_cm, radius)) {
+            success &= _fence_visgraph.add_circle(AP_OAVisGraph::ObjectType::EXCLUSION_CIRCLE, center_pos_cm, radius * 100.0f);
+            for (uint8_t j = 0; j < OA_DIJKSTRA_EXCLUSION_CIRCLE_NUMPOINTS; j++) {
+                success &= _fence_visgraph.add_node(_exclusion_circle_pts[point_idx++]);
             }
         }
     }
-}
 
-// find a node's index into _short_path_data array from it's id (i.e. id type and id number)
-// returns true if successful and node_idx is updated
-bool AP_OADijkstra::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const
-{
-    switch (id.id_type) {
-    case AP_OAVisGraph::OATYPE_SOURCE:
-        // source node is always the first node
-        if (_short_path_data_numpoints > 0) {
-            node_idx = 0;
-            return true;
-        }
-        break;
-    case AP_OAVisGraph::OATYPE_DESTINATION:
-        // destination is always the 2nd node
-        if (_short_path_data_numpoints > 1) {
-            node_idx = 1;
-            return true;
-        }
-        break;
-    case AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT:
-        // intermediate nodes start from 3rd node
-        if (_short_path_data_numpoints > id.id_num + 2) {
-            node_idx = id.id_num + 2;
-            return true;
+    // inclusion circles, which have no points
+    for (uint8_t i = 0; i < polyfence.get_inclusion_circle_count(); i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (polyfence.get_inclusion_circle(i, center_pos_cm, radius)) {
+            success &= _fence_visgraph.add_circle(AP_OAVisGraph::ObjectType::INCLUSION_CIRCLE, center_pos_cm, radius * 100.0f);
         }
-        break;
     }
 
-    // could not find node
-    return false;
-}
-
-// find index of node with lowest tentative distance (ignore visited nodes)
-// returns true if successful and node_idx argument is updated
-bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
-{
-    node_index lowest_idx = 0;
-    float lowest_dist = FLT_MAX;
-
-    // scan through all nodes looking for closest
-    for (node_index i=0; i<_short_path_data_numpoints; i++) {
-        const ShortPathNode &node = _short_path_data[i];
-        if (!node.visited && (node.distance_cm < lowest_dist)) {
-            lowest_idx = i;
-            lowest_dist = node.distance_cm;
-        }
+    // failure to add an object or update the graph can only be caused by out-of-memory
+    if (!success || !_fence_visgraph.update()) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
     }
 
-    if (lowest_dist < FLT_MAX) {
-        node_idx = lowest_idx;
-        return true;
-    }
-    return false;
+    return true;
 }
 
 // calculate shortest path from origin to destination
@@ -794,99 +630,24 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         return false;
     }
 
-    // create visgraphs of origin and destination to fence points
-    if (!update_visgraph(_source_visgraph, {AP_OAVisGraph::OATYPE_SOURCE, 0}, origin_NE, true, destination_NE)) {
+    // expand path array to hold the longest possible path
+    if (!_path.expand_to_hold(2 + total_numpoints())) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
-    if (!update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, destination_NE)) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-        return false;
-    }
-
-    // expand _short_path_data if necessary
-    if (!_short_path_data.expand_to_hold(2 + total_numpoints())) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-        return false;
-    }
-
-    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm) to short_path_data array
-    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0};
-    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
-    _short_path_data_numpoints = 2;
-
-    // add all inclusion and exclusion fence points to short_path_data array (node_type, id, visited, distance_from_idx, distance_cm)
-    for (uint8_t i=0; i<total_numpoints(); i++) {
-        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
-    }
-
-    // start algorithm from source point
-    node_index current_node_idx = 0;
-
-    // update nodes visible from source point
-    for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
-        node_index node_idx;
-        if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
-            _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
-            _short_path_data[node_idx].distance_from_idx = current_node_idx;
-        } else {
-            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
-            return false;
-        }
-    }
-    // mark source node as visited
-    _short_path_data[current_node_idx].visited = true;
-
-    // move current_node_idx to node with lowest distance
-    while (find_closest_node_idx(current_node_idx)) {
-        // update distances to all neighbours of current node
-        update_visible_node_distances(current_node_idx);
-
-        // mark current node as visited
-        _short_path_data[current_node_idx].visited = true;
-    }
 
-    // extract path starting from destination
-    bool success = false;
-    node_index nidx;
-    if (!find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, nidx)) {
+    // search visibility graph for shortest path
+    if (!_fence_visgraph.find_path(origin_NE, destination_NE, _path, _path_numpoints)) {
+        _path_numpoints = 0;
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
         return false;
     }
-    _path_numpoints = 0;
-    while (true) {
-        if (!_path.expand_to_hold(_path_numpoints + 1)) {
-            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-            return false;
-        }
-        // fail if newest node has invalid distance_from_index
-        if ((_short_path_data[nidx].distance_from_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) ||
-            (_short_path_data[nidx].distance_cm >= FLT_MAX)) {
-            break;
-        } else {
-            // add node's id to path array
-            _path[_path_numpoints] = _short_path_data[nidx].id;
-            _path_numpoints++;
-
-            // we are done if node is the source
-            if (_short_path_data[nidx].id.id_type == AP_OAVisGraph::OATYPE_SOURCE) {
-                success = true;
-                break;
-            } else {
-                // follow node's "distance_from_idx" to previous node on path
-                nidx = _short_path_data[nidx].distance_from_idx;
-            }
-        }
-    }
+
     // update source and destination for by get_shortest_path_point
-    if (success) {
-        _path_source = origin_NE;
-        _path_destination = destination_NE;
-    } else {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
-    }
+    _path_source = origin_NE;
+    _path_destination = destination_NE;
 
-    return success;
+    return true;
 }
 
 // return point from final path as an offset (in cm) from the ekf origin
@@ -7,7 +7,7 @@
 #include "AP_OAVisGraph.h"
 
 /*
- * Dijkstra's algorithm for path planning around polygon fence
+ * A* search of a visibility graph for path planning around polygon fence
  */
 
 class AP_OADijkstra {
@@ -103,9 +103,6 @@ private:
     // also returns the type of point
     bool get_point(uint16_t index, Vector2f& point) const;
 
-    // returns true if line segment intersects polygon or circular fence
-    bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const;
-
     // create visibility graph for all fence (with margin) points
     // returns true on success.  returns false on failure and err_id is updated
     bool create_fence_visgraph(AP_OADijkstra_Error &err_id);
@@ -142,38 +139,8 @@ private:
     uint8_t _exclusion_circle_numpoints;    // number of points held in above array
     uint32_t _exclusion_circle_update_ms;   // system time exclusion circles were updated (used to detect changes)
 
-    // visibility graphs
-    AP_OAVisGraph _fence_visgraph;          // holds distances between all inclusion/exclusion fence points (with margin)
-    AP_OAVisGraph _source_visgraph;         // holds distances from source point to all other nodes
-    AP_OAVisGraph _destination_visgraph;    // holds distances from the destination to all other nodes
-
-    // updates visibility graph for a given position which is an offset (in cm) from the ekf origin
-    // to add an additional position (i.e. the destination) set add_extra_position = true and provide the position in the extra_position argument
-    // requires create_polygon_fence_with_margin to have been run
-    // returns true on success
-    bool update_visgraph(AP_OAVisGraph& visgraph, const AP_OAVisGraph::OAItemID& oaid, const Vector2f &position, bool add_extra_position = false, Vector2f extra_position = Vector2f(0,0));
-
-    typedef uint8_t node_index;         // indices into short path data
-    struct ShortPathNode {
-        AP_OAVisGraph::OAItemID id;     // unique id for node (combination of type and id number)
-        bool visited;                   // true if all this node's neighbour's distances have been updated
-        node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
-        float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
-    };
-    AP_ExpandingArray<ShortPathNode> _short_path_data;
-    node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
-
-    // update total distance for all nodes visible from current node
-    // curr_node_idx is an index into the _short_path_data array
-    void update_visible_node_distances(node_index curr_node_idx);
-
-    // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
-    // returns true if successful and node_idx is updated
-    bool find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const;
-
-    // find index of node with lowest tentative distance (ignore visited nodes)
-    // returns true if successful and node_idx argument is updated
-    bool find_closest_node_idx(node_index &node_idx) const;
+    // visibility graph
+    AP_OAVisGraph _fence_visgraph;          // holds visibility between all inclusion/exclusion fence points (with margin)
 
     // final path variables and functions
     AP_ExpandingArray<AP_OAVisGraph::OAItemID> _path;   // ids of points on return path in reverse order (i.e. destination is first element)
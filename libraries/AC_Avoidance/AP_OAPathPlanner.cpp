@@ -29,6 +29,8 @@ const float OA_MARGIN_MAX_DEFAULT = 5;
 
 const int16_t OA_UPDATE_MS = 1000;      // path planning updates run at 1hz
 const int16_t OA_TIMEOUT_MS = 3000;     // results over 3 seconds old are ignored
+const float OA_CANCEL_DIST_M = 10;      // results are discarded if the vehicle moves this many meters (or half the lookahead if more) while planning
+const uint8_t OA_CANCEL_MAX = 2;        // but a result is used after this many consecutive cancels, so a fast vehicle still gets one
 
 const AP_Param::GroupInfo AP_OAPathPlanner::var_info[] = {
 
@@ -131,6 +133,18 @@ bool AP_OAPathPlanner::start_thread()
         return false;
     }
 
+    // Dijkstra's path calculations run on their own thread so that
+    // building the visibility graph for a large fence does not delay
+    // processing of the object database
+    if ((_type == OA_PATHPLAN_DIJKSTRA) && !_dijkstra_thread_created) {
+        if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_OAPathPlanner::dijkstra_thread, void),
+                                          "dijkstra",
+                                          8192, AP_HAL::Scheduler::PRIORITY_IO, -1)) {
+            return false;
+        }
+        _dijkstra_thread_created = true;
+    }
+
     // create the avoidance thread as low priority. It should soak
     // up spare CPU cycles to fill in the avoidance_result structure based
     // on requests in avoidance_request
@@ -165,6 +179,7 @@ AP_OAPathPlanner::OA_RetState AP_OAPathPlanner::mission_avoidance(const Location
     avoidance_request.destination = destination;
     avoidance_request.ground_speed_vec = AP::ahrs().groundspeed_vector();
     avoidance_request.request_time_ms = now;
+    avoidance_request.deadline_ms = now + OA_TIMEOUT_MS;
 
     // check result's destination matches our request
     const bool destination_matches = (destination.lat == avoidance_result.destination.lat) && (destination.lng == avoidance_result.destination.lng);
@@ -175,6 +190,7 @@ AP_OAPathPlanner::OA_RetState AP_OAPathPlanner::mission_avoidance(const Location
     // return results from background thread's latest checks
     if (destination_matches && !timed_out) {
         // we have a result from the thread
+        _planner_stats.age_max_ms = MAX(_planner_stats.age_max_ms, now - avoidance_result.result_time_ms);
         result_origin = avoidance_result.origin_new;
         result_destination = avoidance_result.destination_new;
         return avoidance_result.ret_state;
@@ -189,7 +205,7 @@ AP_OAPathPlanner::OA_RetState AP_OAPathPlanner::mission_avoidance(const Location
     return OA_PROCESSING;
 }
 
-// avoidance thread that continually updates the avoidance_result structure based on avoidance_request
+// avoidance thread that services the object database and, for BendyRuler, runs the path planner
 void AP_OAPathPlanner::avoidance_thread()
 {
     while (true) {
@@ -202,75 +218,122 @@ void AP_OAPathPlanner::avoidance_thread()
         }
 
         const uint32_t now = AP_HAL::millis();
-        if (now - avoidance_latest_ms < OA_UPDATE_MS) {
-            continue;
+        if (now - database_update_ms >= OA_UPDATE_MS) {
+            database_update_ms = now;
+            _oadatabase.update();
         }
-        avoidance_latest_ms = now;
 
-        _oadatabase.update();
+        // BendyRuler reads the database so runs on this thread
+        if (_type == OA_PATHPLAN_BENDYRULER) {
+            run_planner();
+        }
+    }
+}
 
-        Location origin_new;
-        Location destination_new;
-        {
-            WITH_SEMAPHORE(_rsem);
-            if (now - avoidance_request.request_time_ms > OA_TIMEOUT_MS) {
-                // this is a very old request, don't process it
-                continue;
-            }
+// Dijkstra thread that continually updates the avoidance_result structure based on avoidance_request
+void AP_OAPathPlanner::dijkstra_thread()
+{
+    while (true) {
+        hal.scheduler->delay(20);
+        if (_type == OA_PATHPLAN_DIJKSTRA) {
+            run_planner();
+        }
+    }
+}
 
-            // copy request to avoid conflict with main thread
-            avoidance_request2 = avoidance_request;
+// run the path planner if an update is due and give the result to the main thread
+void AP_OAPathPlanner::run_planner()
+{
+    const uint32_t now = AP_HAL::millis();
+    if (!_replan && (now - avoidance_latest_ms < OA_UPDATE_MS)) {
+        return;
+    }
+    avoidance_latest_ms = now;
+    _replan = false;
+
+    Location origin_new;
+    Location destination_new;
+    {
+        WITH_SEMAPHORE(_rsem);
+        if (now - avoidance_request.request_time_ms > OA_TIMEOUT_MS) {
+            // this is a very old request, don't process it
+            return;
+        }
 
-            // store passed in origin and destination so we can return it if object avoidance is not required
-            origin_new = avoidance_request.origin;
-            destination_new = avoidance_request.destination;
+        // copy request to avoid conflict with main thread
+        avoidance_request2 = avoidance_request;
+
+        // store passed in origin and destination so we can return it if object avoidance is not required
+        origin_new = avoidance_request.origin;
+        destination_new = avoidance_request.destination;
+    }
+
+    // run background task looking for best alternative destination
+    OA_RetState res = OA_NOT_REQUIRED;
+    switch (_type) {
+    case OA_PATHPLAN_DISABLED:
+        return;
+    case OA_PATHPLAN_BENDYRULER:
+        if (_oabendyruler == nullptr) {
+            return;
         }
+        _oabendyruler->set_config(_lookahead, _margin_max);
+        if (_oabendyruler->update(avoidance_request2.current_loc, avoidance_request2.destination, avoidance_request2.ground_speed_vec, origin_new, destination_new)) {
+            res = OA_SUCCESS;
+        }
+        break;
 
-        // run background task looking for best alternative destination
-        OA_RetState res = OA_NOT_REQUIRED;
-        switch (_type) {
-        case OA_PATHPLAN_DISABLED:
-            continue;
-        case OA_PATHPLAN_BENDYRULER:
-            if (_oabendyruler == nullptr) {
-                continue;
-            }
-            _oabendyruler->set_config(_lookahead, _margin_max);
-            if (_oabendyruler->update(avoidance_request2.current_loc, avoidance_request2.destination, avoidance_request2.ground_speed_vec, origin_new, destination_new)) {
-                res = OA_SUCCESS;
-            }
+    case OA_PATHPLAN_DIJKSTRA:
+        if (_oadijkstra == nullptr) {
+            return;
+        }
+        _oadijkstra->set_fence_margin(_margin_max);
+        const AP_OADijkstra::AP_OADijkstra_State dijkstra_state = _oadijkstra->update(avoidance_request2.current_loc, avoidance_request2.destination, origin_new, destination_new);
+        switch (dijkstra_state) {
+        case AP_OADijkstra::DIJKSTRA_STATE_NOT_REQUIRED:
+            res = OA_NOT_REQUIRED;
             break;
-
-        case OA_PATHPLAN_DIJKSTRA:
-            if (_oadijkstra == nullptr) {
-                continue;
-            }
-            _oadijkstra->set_fence_margin(_margin_max);
-            const AP_OADijkstra::AP_OADijkstra_State dijkstra_state = _oadijkstra->update(avoidance_request2.current_loc, avoidance_request2.destination, origin_new, destination_new);
-            switch (dijkstra_state) {
-            case AP_OADijkstra::DIJKSTRA_STATE_NOT_REQUIRED:
-                res = OA_NOT_REQUIRED;
-                break;
-            case AP_OADijkstra::DIJKSTRA_STATE_ERROR:
-                res = OA_ERROR;
-                break;
-            case AP_OADijkstra::DIJKSTRA_STATE_SUCCESS:
-                res = OA_SUCCESS;
-                break;
-            }
+        case AP_OADijkstra::DIJKSTRA_STATE_ERROR:
+            res = OA_ERROR;
+            break;
+        case AP_OADijkstra::DIJKSTRA_STATE_SUCCESS:
+            res = OA_SUCCESS;
             break;
         }
+        break;
+    }
 
-        {
+    uint32_t latency_ms, latency_max_ms, age_max_ms;
+    {
+        WITH_SEMAPHORE(_rsem);
+        const uint32_t done_ms = AP_HAL::millis();
+        latency_ms = done_ms - avoidance_request2.request_time_ms;
+        const float cancel_dist_m = MAX(OA_CANCEL_DIST_M, _lookahead * 0.5f);
+        if ((_cancel_count < OA_CANCEL_MAX) &&
+            (avoidance_request.current_loc.get_distance(avoidance_request2.current_loc) > cancel_dist_m)) {
+            // vehicle has moved too far for the result to be useful, plan again from its new position
+            _planner_stats.cancelled++;
+            _cancel_count++;
+            _replan = true;
+        } else if ((int32_t)(done_ms - avoidance_request2.deadline_ms) > 0) {
+            // result is too late to use
+            _planner_stats.late++;
+        } else {
             // give the main thread the avoidance result
-            WITH_SEMAPHORE(_rsem);
+            _cancel_count = 0;
             avoidance_result.destination = avoidance_request2.destination;
             avoidance_result.origin_new = (res == OA_SUCCESS) ? origin_new : avoidance_result.origin_new;
             avoidance_result.destination_new = (res == OA_SUCCESS) ? destination_new : avoidance_result.destination;
-            avoidance_result.result_time_ms = AP_HAL::millis();
+            avoidance_result.result_time_ms = done_ms;
             avoidance_result.ret_state = res;
         }
+        _planner_stats.latency_max_ms = MAX(_planner_stats.latency_max_ms, latency_ms);
+        latency_max_ms = _planner_stats.latency_max_ms;
+        age_max_ms = _planner_stats.age_max_ms;
+        _planner_stats.age_max_ms = 0;
     }
+
+    AP::logger().Write_OAPathPlanner(_type, res, latency_ms, latency_max_ms, age_max_ms, _planner_stats.cancelled, _planner_stats.late);
 }
 
 // singleton instance
@@ -58,10 +58,18 @@ public:
 
 private:
 
-    // avoidance thread that continually updates the avoidance_result structure based on avoidance_request
+    // avoidance thread that services the object database and, for BendyRuler (which reads the database), runs the path planner
     void avoidance_thread();
+
+    // Dijkstra thread that runs the path planner, so long path calculations do not hold up the object database
+    void dijkstra_thread();
+
     bool start_thread();
 
+    // run the path planner if an update is due and give the result to the main thread
+    // results are discarded if the vehicle has moved too far or they are later than the request's deadline
+    void run_planner();
+
     // an avoidance request from the navigation code
     struct avoidance_info {
         Location current_loc;
@@ -69,6 +77,7 @@ private:
         Location destination;
         Vector2f ground_speed_vec;
         uint32_t request_time_ms;
+        uint32_t deadline_ms;       // system time after which a result for this request is too late to use
     } avoidance_request, avoidance_request2;
 
     // an avoidance result from the avoidance thread
@@ -80,6 +89,14 @@ private:
         OA_RetState ret_state;      // OA_SUCCESS if the vehicle should move along the path from origin_new to destination_new
     } avoidance_result;
 
+    // path planner latency statistics, logged after each planner run
+    struct {
+        uint32_t latency_max_ms;    // highest time from request to result since boot
+        uint32_t age_max_ms;        // age of the oldest result returned to the navigation code since the last log
+        uint16_t cancelled;         // number of results discarded because the vehicle moved too far while planning
+        uint16_t late;              // number of results discarded because they missed their request's deadline
+    } _planner_stats;
+
     // parameters
     AP_Int8 _type;                  // avoidance algorith to be used
     AP_Float _lookahead;            // object avoidance will look this many meters ahead of vehicle
@@ -87,11 +104,15 @@ private:
 
     // internal variables used by front end
     HAL_Semaphore _rsem;            // semaphore for multi-thread use of avoidance_request and avoidance_result
-    bool _thread_created;           // true once background thread has been created
+    bool _thread_created;           // true once background threads have been created
+    bool _dijkstra_thread_created;  // true once Dijkstra thread has been created
     AP_OABendyRuler *_oabendyruler; // Bendy Ruler algorithm
     AP_OADijkstra *_oadijkstra;     // Dijkstra's algorithm
     AP_OADatabase _oadatabase;      // Database of dynamic objects to avoid
     uint32_t avoidance_latest_ms;   // last time Dijkstra's or BendyRuler algorithms ran
+    uint32_t database_update_ms;    // last time the object database was updated
+    bool _replan;                   // true if the last result was cancelled and the planner should run again immediately
+    uint8_t _cancel_count;          // number of consecutive results cancelled
 
     static AP_OAPathPlanner *_singleton;
 };
@@ -15,27 +15,475 @@
 
 #include "AP_OAVisGraph.h"
 
-// constructor initialises expanding array to use 20 elements per chunk
+#define OA_VISGRAPH_ARRAY_ELEMENTS_PER_CHUNK    32      // arrays grow in multiples of this many elements
+
+// grow array to hold at least num_required elements, keeping the first num_keep
+// returns false on allocation failure, leaving the array unchanged
+template <typename T>
+static bool expand_array(T *&array, uint16_t &size, uint32_t num_required, uint16_t num_keep)
+{
+    if (num_required <= size) {
+        return true;
+    }
+    const uint32_t new_size = ((num_required / OA_VISGRAPH_ARRAY_ELEMENTS_PER_CHUNK) + 1) * OA_VISGRAPH_ARRAY_ELEMENTS_PER_CHUNK;
+    if (new_size > UINT16_MAX) {
+        return false;
+    }
+    T *new_array = new T[new_size];
+    if (new_array == nullptr) {
+        return false;
+    }
+    if (num_keep > 0) {
+        memcpy(new_array, array, num_keep * sizeof(T));
+    }
+    delete[] array;
+    array = new_array;
+    size = new_size;
+    return true;
+}
+
 AP_OAVisGraph::AP_OAVisGraph() :
-    _items(20)
+    _curr(0),
+    _update_ok(false),
+    _pair_tests(0),
+    _cost_cm(nullptr),
+    _estimate_cm(nullptr),
+    _came_from(nullptr),
+    _heap(nullptr),
+    _heap_pos(nullptr),
+    _closed(nullptr),
+    _heap_len(0),
+    _search_size(0)
+{
+}
+
+AP_OAVisGraph::~AP_OAVisGraph()
+{
+    for (Fence &fence : _fence) {
+        free_fence(fence);
+    }
+    expand_search(0);
+}
+
+// free a fence's arrays
+void AP_OAVisGraph::free_fence(Fence &fence)
+{
+    delete[] fence.objects;
+    delete[] fence.points;
+    delete[] fence.nodes;
+    delete[] fence.blockers;
+    fence = Fence();
+}
+
+// start describing a new fence
+void AP_OAVisGraph::begin_update()
 {
+    Fence &fence = next_fence();
+    fence.num_objects = 0;
+    fence.num_points = 0;
+    fence.num_nodes = 0;
+    _update_ok = true;
 }
 
-// add item to visiblity graph, returns true on success, false if graph is full
-bool AP_OAVisGraph::add_item(const OAItemID &id1, const OAItemID &id2, float distance_cm)
+// add an object with num_points points to the fence being built
+AP_OAVisGraph::FenceObject *AP_OAVisGraph::add_object(ObjectType type, uint16_t num_points)
 {
-    // no more than 65k items
-    if (_num_items == UINT16_MAX) {
+    Fence &fence = next_fence();
+    if (!_update_ok ||
+        (fence.num_objects >= max_objects) ||
+        !expand_array(fence.objects, fence.objects_size, fence.num_objects + 1, fence.num_objects) ||
+        !expand_array(fence.points, fence.points_size, fence.num_points + num_points, fence.num_points)) {
+        _update_ok = false;
+        return nullptr;
+    }
+    FenceObject &object = fence.objects[fence.num_objects++];
+    object.type = type;
+    object.first_node = fence.num_nodes;
+    object.num_nodes = 0;
+    object.first_point = fence.num_points;
+    object.num_points = num_points;
+    object.radius_cm = 0.0f;
+    fence.num_points += num_points;
+    return &object;
+}
+
+// add a polygon.  points are offsets in cm from the EKF origin
+bool AP_OAVisGraph::add_polygon(ObjectType type, const Vector2f *points, uint16_t num_points)
+{
+    FenceObject *object = add_object(type, num_points);
+    if (object == nullptr) {
         return false;
     }
+    Fence &fence = next_fence();
+    memcpy(&fence.points[object->first_point], points, num_points * sizeof(Vector2f));
+    object->min_cm = object->max_cm = points[0];
+    for (uint16_t i = 1; i < num_points; i++) {
+        object->min_cm.x = MIN(object->min_cm.x, points[i].x);
+        object->min_cm.y = MIN(object->min_cm.y, points[i].y);
+        object->max_cm.x = MAX(object->max_cm.x, points[i].x);
+        object->max_cm.y = MAX(object->max_cm.y, points[i].y);
+    }
+    return true;
+}
+
+// add a circle.  center is an offset in cm from the EKF origin, radius is in cm
+bool AP_OAVisGraph::add_circle(ObjectType type, const Vector2f &center_cm, float radius_cm)
+{
+    FenceObject *object = add_object(type, 1);
+    if (object == nullptr) {
+        return false;
+    }
+    next_fence().points[object->first_point] = center_cm;
+    object->radius_cm = radius_cm;
+    object->min_cm = center_cm - Vector2f(radius_cm, radius_cm);
+    object->max_cm = center_cm + Vector2f(radius_cm, radius_cm);
+    return true;
+}
+
+// add a node around the last object added
+bool AP_OAVisGraph::add_node(const Vector2f &node_cm)
+{
+    Fence &fence = next_fence();
+    if (!_update_ok ||
+        (fence.num_objects == 0) ||
+        (fence.num_nodes >= max_nodes) ||
+        !expand_array(fence.nodes, fence.nodes_size, fence.num_nodes + 1, fence.num_nodes)) {
+        _update_ok = false;
+        return false;
+    }
+    fence.nodes[fence.num_nodes++] = node_cm;
+    fence.objects[fence.num_objects-1].num_nodes++;
+    return true;
+}
+
+// returns true if objects a and b, in fences fa and fb, have the same geometry and nodes
+bool AP_OAVisGraph::same_object(const Fence &fa, const FenceObject &a, const Fence &fb, const FenceObject &b)
+{
+    return (a.type == b.type) &&
+           (a.num_points == b.num_points) &&
+           (a.num_nodes == b.num_nodes) &&
+           is_equal(a.radius_cm, b.radius_cm) &&
+           (memcmp(&fa.points[a.first_point], &fb.points[b.first_point], a.num_points * sizeof(Vector2f)) == 0) &&
+           (memcmp(&fa.nodes[a.first_node], &fb.nodes[b.first_node], a.num_nodes * sizeof(Vector2f)) == 0);
+}
+
+// replace the graph with the fence described since begin_update
+bool AP_OAVisGraph::update()
+{
+    Fence &fence = next_fence();
+    const Fence &prev = _fence[_curr];
+    if (!_update_ok) {
+        return false;
+    }
+    const uint16_t num_pairs = (fence.num_nodes > 0) ? (fence.num_nodes * (fence.num_nodes - 1) / 2) : 0;
+    if (!expand_array(fence.blockers, fence.blockers_size, num_pairs, 0) ||
+        !expand_search(fence.num_nodes + 2)) {
+        return false;
+    }
+
+    // match objects to identical objects in the previous fence, and their nodes
+    memset(_new_object, OA_VISGRAPH_NONE, sizeof(_new_object));
+    memset(_prev_node, OA_VISGRAPH_NONE, sizeof(_prev_node));
+    for (uint8_t i = 0; i < fence.num_objects; i++) {
+        const FenceObject &object = fence.objects[i];
+        _prev_object[i] = OA_VISGRAPH_NONE;
+        for (uint8_t j = 0; j < prev.num_objects; j++) {
+            if ((_new_object[j] == OA_VISGRAPH_NONE) && same_object(fence, object, prev, prev.objects[j])) {
+                _prev_object[i] = j;
+                _new_object[j] = i;
+                for (uint8_t n = 0; n < object.num_nodes; n++) {
+                    _prev_node[object.first_node + n] = prev.objects[j].first_node + n;
+                }
+                break;
+            }
+        }
+    }
+
+    // find the object blocking each pair of nodes
+    _pair_tests = 0;
+    uint16_t pair = 0;
+    for (uint8_t j = 1; j < fence.num_nodes; j++) {
+        for (uint8_t i = 0; i < j; i++) {
+            uint8_t blocker = OA_VISGRAPH_VISIBLE;
+            const uint8_t prev_i = _prev_node[i];
+            const uint8_t prev_j = _prev_node[j];
+            if ((prev_i != OA_VISGRAPH_NONE) && (prev_j != OA_VISGRAPH_NONE)) {
+                const uint8_t prev_blocker = prev.blockers[pair_index(prev_i, prev_j)];
+                if (prev_blocker == OA_VISGRAPH_VISIBLE) {
+                    // only a new object can block this pair
+                    blocker = first_blocker(fence, fence.nodes[i], fence.nodes[j], true);
+                } else if (_new_object[prev_blocker] != OA_VISGRAPH_NONE) {
+                    // still blocked by the same object
+                    blocker = _new_object[prev_blocker];
+                } else {
+                    blocker = first_blocker(fence, fence.nodes[i], fence.nodes[j], false);
+                }
+            } else {
+                blocker = first_blocker(fence, fence.nodes[i], fence.nodes[j], false);
+            }
+            fence.blockers[pair++] = blocker;
+        }
+    }
+
+    _curr = 1 - _curr;
+
+    // the previous fence isn't needed until the next update, so
+    // don't hold the memory for two fences in the meantime
+    free_fence(next_fence());
+    return true;
+}
+
+// forget all nodes and objects
+void AP_OAVisGraph::clear()
+{
+    for (Fence &fence : _fence) {
+        fence.num_objects = 0;
+        fence.num_points = 0;
+        fence.num_nodes = 0;
+    }
+}
+
+// returns true if line segment intersects object
+bool AP_OAVisGraph::intersects_object(const Fence &fence, const FenceObject &object, const Vector2f &seg_start, const Vector2f &seg_end) const
+{
+    const Vector2f &first_point = fence.points[object.first_point];
+
+    if (object.type == ObjectType::INCLUSION_CIRCLE) {
+        // intersects circle if either start or end is further from the center than the radius
+        const float radius_cm_sq = sq(object.radius_cm);
+        return ((seg_start - first_point).length_squared() > radius_cm_sq) ||
+               ((seg_end - first_point).length_squared() > radius_cm_sq);
+    }
 
-    // ensure there is space in the array
-    if (!_items.expand_to_hold(_num_items+1)) {
+    // line segments entirely outside the object's bounding box cannot intersect it
+    if ((MAX(seg_start.x, seg_end.x) < object.min_cm.x) || (MIN(seg_start.x, seg_end.x) > object.max_cm.x) ||
+        (MAX(seg_start.y, seg_end.y) < object.min_cm.y) || (MIN(seg_start.y, seg_end.y) > object.max_cm.y)) {
         return false;
     }
 
-    // add item
-    _items[_num_items] = {id1, id2, distance_cm};
-    _num_items++;
+    if (object.type == ObjectType::EXCLUSION_CIRCLE) {
+        // intersects if distance between circle's center and segment is less than radius
+        return Vector2f::closest_distance_between_line_and_point(seg_start, seg_end, first_point) <= object.radius_cm;
+    }
+
+    Vector2f intersection;
+    return Polygon_intersects(&first_point, object.num_points, seg_start, seg_end, intersection);
+}
+
+// returns the first object in fence which blocks the line segment, or OA_VISGRAPH_VISIBLE
+uint8_t AP_OAVisGraph::first_blocker(const Fence &fence, const Vector2f &seg_start, const Vector2f &seg_end, bool changed_only)
+{
+    for (uint8_t i = 0; i < fence.num_objects; i++) {
+        if (changed_only && (_prev_object[i] != OA_VISGRAPH_NONE)) {
+            continue;
+        }
+        _pair_tests++;
+        if (intersects_object(fence, fence.objects[i], seg_start, seg_end)) {
+            return i;
+        }
+    }
+    return OA_VISGRAPH_VISIBLE;
+}
+
+// returns true if line segment intersects any fence object
+bool AP_OAVisGraph::intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const
+{
+    const Fence &fence = _fence[_curr];
+    for (uint8_t i = 0; i < fence.num_objects; i++) {
+        if (intersects_object(fence, fence.objects[i], seg_start, seg_end)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// make space for a search over num_nodes nodes.  Zero frees the search state
+bool AP_OAVisGraph::expand_search(uint16_t num_nodes)
+{
+    if ((num_nodes > 0) && (num_nodes <= _search_size)) {
+        return true;
+    }
+    delete[] _cost_cm;
+    delete[] _estimate_cm;
+    delete[] _came_from;
+    delete[] _heap;
+    delete[] _heap_pos;
+    delete[] _closed;
+    _cost_cm = nullptr;
+    _estimate_cm = nullptr;
+    _came_from = nullptr;
+    _heap = nullptr;
+    _heap_pos = nullptr;
+    _closed = nullptr;
+    _search_size = 0;
+    if (num_nodes == 0) {
+        return true;
+    }
+    _cost_cm = new float[num_nodes];
+    _estimate_cm = new float[num_nodes];
+    _came_from = new uint16_t[num_nodes];
+    _heap = new uint16_t[num_nodes];
+    _heap_pos = new uint16_t[num_nodes];
+    _closed = new bool[num_nodes];
+    if ((_cost_cm == nullptr) || (_estimate_cm == nullptr) || (_came_from == nullptr) ||
+        (_heap == nullptr) || (_heap_pos == nullptr) || (_closed == nullptr)) {
+        expand_search(0);
+        return false;
+    }
+    _search_size = num_nodes;
     return true;
 }
+
+void AP_OAVisGraph::heap_swap(uint16_t pos1, uint16_t pos2)
+{
+    const uint16_t node1 = _heap[pos1];
+    _heap[pos1] = _heap[pos2];
+    _heap[pos2] = node1;
+    _heap_pos[_heap[pos1]] = pos1;
+    _heap_pos[_heap[pos2]] = pos2;
+}
+
+void AP_OAVisGraph::heap_sift_up(uint16_t pos)
+{
+    while (pos > 0) {
+        const uint16_t parent = (pos - 1) / 2;
+        if (_estimate_cm[_heap[parent]] <= _estimate_cm[_heap[pos]]) {
+            break;
+        }
+        heap_swap(parent, pos);
+        pos = parent;
+    }
+}
+
+void AP_OAVisGraph::heap_sift_down(uint16_t pos)
+{
+    while (true) {
+        const uint16_t left = pos * 2 + 1;
+        const uint16_t right = left + 1;
+        uint16_t smallest = pos;
+        if ((left < _heap_len) && (_estimate_cm[_heap[left]] < _estimate_cm[_heap[smallest]])) {
+            smallest = left;
+        }
+        if ((right < _heap_len) && (_estimate_cm[_heap[right]] < _estimate_cm[_heap[smallest]])) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        heap_swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+// remove and return the open node with the lowest estimated path length
+uint16_t AP_OAVisGraph::heap_pop()
+{
+    const uint16_t node = _heap[0];
+    _heap_len--;
+    if (_heap_len > 0) {
+        heap_swap(0, _heap_len);
+        heap_sift_down(0);
+    }
+    _heap_pos[node] = OA_VISGRAPH_SEARCH_NONE;
+    return node;
+}
+
+// update node's path if reaching it from node from is shorter
+void AP_OAVisGraph::relax(uint16_t from, uint16_t node, float distance_cm, float heuristic_cm)
+{
+    const float cost_cm = _cost_cm[from] + distance_cm;
+    if (cost_cm >= _cost_cm[node]) {
+        return;
+    }
+    _cost_cm[node] = cost_cm;
+    _estimate_cm[node] = cost_cm + heuristic_cm;
+    _came_from[node] = from;
+    if (_heap_pos[node] == OA_VISGRAPH_SEARCH_NONE) {
+        _heap[_heap_len] = node;
+        _heap_pos[node] = _heap_len;
+        _heap_len++;
+    }
+    heap_sift_up(_heap_pos[node]);
+}
+
+// find the shortest path from source to destination through the nodes with an A* search.
+// The straight line distance to the destination never overestimates the remaining path
+// length, so the first time the destination is taken from the open set its path is the shortest
+bool AP_OAVisGraph::find_path(const Vector2f &source, const Vector2f &destination, AP_ExpandingArray<OAItemID> &path, uint8_t &path_numpoints)
+{
+    const Fence &fence = _fence[_curr];
+    const uint16_t num_nodes = fence.num_nodes;
+    const uint16_t source_idx = num_nodes;
+    const uint16_t destination_idx = num_nodes + 1;
+    if (!expand_search(num_nodes + 2)) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < num_nodes + 2; i++) {
+        _cost_cm[i] = FLT_MAX;
+        _came_from[i] = OA_VISGRAPH_SEARCH_NONE;
+        _heap_pos[i] = OA_VISGRAPH_SEARCH_NONE;
+        _closed[i] = false;
+    }
+    _cost_cm[source_idx] = 0.0f;
+    _estimate_cm[source_idx] = (destination - source).length();
+    _heap[0] = source_idx;
+    _heap_pos[source_idx] = 0;
+    _heap_len = 1;
+
+    while (_heap_len > 0) {
+        const uint16_t curr_idx = heap_pop();
+        if (curr_idx == destination_idx) {
+            break;
+        }
+        _closed[curr_idx] = true;
+        const Vector2f &curr_pos = (curr_idx == source_idx) ? source : fence.nodes[curr_idx];
+
+        // update paths to nodes visible from the current node.  Visibility
+        // from the source is not in the graph so is checked here
+        for (uint16_t i = 0; i < num_nodes; i++) {
+            if (_closed[i] || (i == curr_idx)) {
+                continue;
+            }
+            if (curr_idx == source_idx) {
+                if (intersects_fence(source, fence.nodes[i])) {
+                    continue;
+                }
+            } else if (!visible(curr_idx, i)) {
+                continue;
+            }
+            relax(curr_idx, i, (curr_pos - fence.nodes[i]).length(), (destination - fence.nodes[i]).length());
+        }
+
+        // update path to destination if it is visible
+        const bool destination_visible = (curr_idx == source_idx) ? !intersects_fence(source, destination) : !intersects_fence(destination, curr_pos);
+        if (destination_visible) {
+            relax(curr_idx, destination_idx, (destination - curr_pos).length(), 0.0f);
+        }
+    }
+
+    if (_came_from[destination_idx] == OA_VISGRAPH_SEARCH_NONE) {
+        return false;
+    }
+
+    // extract path starting from destination
+    path_numpoints = 0;
+    uint16_t idx = destination_idx;
+    while (true) {
+        if (idx == destination_idx) {
+            path[path_numpoints] = {OATYPE_DESTINATION, 0};
+        } else if (idx == source_idx) {
+            path[path_numpoints] = {OATYPE_SOURCE, 0};
+        } else {
+            path[path_numpoints] = {OATYPE_INTERMEDIATE_POINT, (oaid_num)idx};
+        }
+        path_numpoints++;
+        if (idx == source_idx) {
+            return true;
+        }
+        if (path_numpoints == UINT8_MAX) {
+            return false;
+        }
+        idx = _came_from[idx];
+    }
+}
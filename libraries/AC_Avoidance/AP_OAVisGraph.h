@@ -3,13 +3,24 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_Common/AP_ExpandingArray.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 
 /*
- * Visibility graph used by Dijkstra's algorithm for path planning around fence, stay-out zones and moving obstacles
+ * Visibility graph used for path planning around fence and stay-out zones
+ *
+ * Nodes are the points (just outside the fences) a path may pass through,
+ * and fence objects (polygons and circles) block the line of sight between
+ * them.  For each pair of nodes the graph holds the object which blocks
+ * it, if any, so that when the fence is reloaded only pairs that a changed
+ * object may affect are tested again:
+ *   - a pair which was visible is tested against new objects only
+ *   - a pair blocked by an object which is still present stays blocked
+ *   - other pairs, including all pairs with a new node, are tested against all objects
  */
 class AP_OAVisGraph {
 public:
     AP_OAVisGraph();
+    ~AP_OAVisGraph();
 
     /* Do not allow copies */
     AP_OAVisGraph(const AP_OAVisGraph &other) = delete;
@@ -33,27 +44,157 @@ public:
         bool operator ==(const OAItemID &i) const { return ((id_type == i.id_type) && (id_num == i.id_num)); }
     };
 
-    struct VisGraphItem {
-        OAItemID id1;       // first item's id
-        OAItemID id2;       // second item's id
-        float distance_cm;  // distance between the items
+    // types of fence objects
+    enum class ObjectType : uint8_t {
+        INCLUSION_POLYGON,
+        EXCLUSION_POLYGON,
+        INCLUSION_CIRCLE,
+        EXCLUSION_CIRCLE,
     };
 
-    // clear all elements from graph
-    void clear() { _num_items = 0; }
+    // maximum number of nodes and objects
+    static const uint8_t max_nodes = 254;
+    static const uint8_t max_objects = 254;
 
-    // get number of items in visibility graph table
-    uint16_t num_items() const { return _num_items; }
+    // start describing a new fence with add_polygon and add_circle.
+    // The graph is unchanged until update is called
+    void begin_update();
 
-    // add item to visiblity graph, returns true on success, false if graph is full
-    bool add_item(const OAItemID &id1, const OAItemID &id2, float distance_cm);
+    // add a polygon.  points are offsets in cm from the EKF origin
+    // returns false if there are too many objects or on allocation failure
+    bool add_polygon(ObjectType type, const Vector2f *points, uint16_t num_points) WARN_IF_UNUSED;
 
-    // allow accessing graph as an array, 0 indexed
-    // Note: no protection against out-of-bounds accesses so use with num_items()
-    const VisGraphItem& operator[](uint16_t i) const { return _items[i]; }
+    // add a circle.  center is an offset in cm from the EKF origin, radius is in cm
+    // returns false if there are too many objects or on allocation failure
+    bool add_circle(ObjectType type, const Vector2f &center_cm, float radius_cm) WARN_IF_UNUSED;
+
+    // add a node around the last object added, as an offset in cm from the EKF origin
+    // returns false if there are too many nodes or on allocation failure
+    bool add_node(const Vector2f &node_cm) WARN_IF_UNUSED;
+
+    // replace the graph with the fence described since begin_update,
+    // reusing visibility from the previous graph where possible
+    // returns false on allocation failure, leaving the previous graph in place
+    bool update() WARN_IF_UNUSED;
+
+    // forget all nodes and objects, so the next update tests every pair
+    void clear();
+
+    // get number of nodes, and their positions
+    uint8_t num_nodes() const { return _fence[_curr].num_nodes; }
+    const Vector2f &node(uint8_t i) const { return _fence[_curr].nodes[i]; }
+
+    // returns true if nodes i and j (which must differ) can see each other
+    bool visible(uint8_t i, uint8_t j) const {
+        return _fence[_curr].blockers[pair_index(i, j)] == OA_VISGRAPH_VISIBLE;
+    }
+
+    // returns true if line segment intersects any fence object
+    bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const;
+
+    // find the shortest path from source to destination through the nodes with an A* search
+    // path holds the ids of points on the path in reverse order (i.e. destination is first element)
+    // and must be able to hold num_nodes()+2 elements
+    // returns false if there is no path
+    bool find_path(const Vector2f &source, const Vector2f &destination, AP_ExpandingArray<OAItemID> &path, uint8_t &path_numpoints) WARN_IF_UNUSED;
+
+    // number of node pairs tested against each object by the last update, for benchmarking
+    uint32_t get_pair_tests() const { return _pair_tests; }
 
 private:
 
-    AP_ExpandingArray<VisGraphItem> _items;
-    uint16_t _num_items;
+    static const uint8_t OA_VISGRAPH_VISIBLE = 0xFF;    // blocker value for pairs of nodes which can see each other
+    static const uint8_t OA_VISGRAPH_NONE = 0xFF;       // object or node has no match in the previous graph
+
+    struct FenceObject {
+        ObjectType type;
+        uint8_t first_node;     // index of first node around this object
+        uint8_t num_nodes;
+        uint16_t first_point;   // index into points of polygon points or circle center
+        uint16_t num_points;
+        float radius_cm;        // circle radius
+        Vector2f min_cm;        // bounding box
+        Vector2f max_cm;
+    };
+
+    // a fence and the visibility between its nodes
+    struct Fence {
+        FenceObject *objects = nullptr;
+        uint16_t num_objects = 0;
+        uint16_t objects_size = 0;
+        Vector2f *points = nullptr;
+        uint16_t num_points = 0;
+        uint16_t points_size = 0;
+        Vector2f *nodes = nullptr;
+        uint16_t num_nodes = 0;
+        uint16_t nodes_size = 0;
+        uint8_t *blockers = nullptr;    // blocking object for each pair of nodes, see pair_index
+        uint16_t blockers_size = 0;
+    };
+
+    // _fence[_curr] is the current graph, the other is filled in by
+    // begin_update and add_*, and freed once update has used it
+    Fence _fence[2];
+    uint8_t _curr;
+    bool _update_ok;            // false if an add_* call since begin_update failed
+
+    // the fence being built
+    Fence &next_fence() { return _fence[1 - _curr]; }
+
+    // free a fence's arrays
+    static void free_fence(Fence &fence);
+
+    // index of pair of nodes into blockers
+    static uint16_t pair_index(uint8_t i, uint8_t j) {
+        if (i > j) {
+            const uint8_t tmp = i;
+            i = j;
+            j = tmp;
+        }
+        return j * (j - 1) / 2 + i;
+    }
+
+    // add an object with num_points points to the fence being built
+    // returns nullptr if there are too many objects or on allocation failure
+    FenceObject *add_object(ObjectType type, uint16_t num_points);
+
+    // returns true if line segment intersects object
+    bool intersects_object(const Fence &fence, const FenceObject &object, const Vector2f &seg_start, const Vector2f &seg_end) const;
+
+    // returns the first object in fence which blocks the line segment, or OA_VISGRAPH_VISIBLE
+    // if changed_only is true only objects which are not in the previous fence are checked
+    uint8_t first_blocker(const Fence &fence, const Vector2f &seg_start, const Vector2f &seg_end, bool changed_only);
+
+    // returns true if objects a and b, in fences fa and fb, have the same geometry and nodes
+    static bool same_object(const Fence &fa, const FenceObject &a, const Fence &fb, const FenceObject &b);
+
+    // matches between the fence being built and the previous fence
+    uint8_t _prev_object[max_objects];  // previous index of each new object
+    uint8_t _new_object[max_objects];   // new index of each previous object
+    uint8_t _prev_node[max_nodes];      // previous index of each new node
+    uint32_t _pair_tests;
+
+    // A* search state, indexed by node with the source and destination as the last two
+    static const uint16_t OA_VISGRAPH_SEARCH_NONE = 0xFFFF;
+    float *_cost_cm;            // length of best path found from source
+    float *_estimate_cm;        // length of best path found plus straight line distance to destination
+    uint16_t *_came_from;       // previous node on best path found
+    uint16_t *_heap;            // open set as a binary heap ordered by _estimate_cm
+    uint16_t *_heap_pos;        // position of each node in _heap, or OA_VISGRAPH_SEARCH_NONE if not in it
+    bool *_closed;              // true once the best path to the node is known
+    uint16_t _heap_len;
+    uint16_t _search_size;
+
+    // make space for a search over num_nodes nodes, returns false on allocation failure
+    bool expand_search(uint16_t num_nodes);
+
+    // update node's path if reaching it from node from is shorter
+    // heuristic_cm is the straight line distance from node to the destination
+    void relax(uint16_t from, uint16_t node, float distance_cm, float heuristic_cm);
+
+    // open set operations
+    uint16_t heap_pop();
+    void heap_sift_up(uint16_t pos);
+    void heap_sift_down(uint16_t pos);
+    void heap_swap(uint16_t pos1, uint16_t pos2);
 };
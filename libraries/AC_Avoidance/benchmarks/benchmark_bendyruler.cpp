@@ -0,0 +1,82 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_Avoidance/AP_OABendyRuler.h>
+#include <AP_Math/tests/random_test.h>
+
+/*
+  BendyRuler's margin calculation for all bearings around the vehicle
+  with 1 to 100 obstacles. Margins are calculated for all bearings
+  together with AP_OABendyRuler's fan of segments, and for one bearing
+  at a time, as AP_OABendyRuler did, by the distance from each
+  obstacle to the segment
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t max_obstacles = 100;
+
+struct Obstacles {
+    float x[max_obstacles];
+    float y[max_obstacles];
+    float radius[max_obstacles];
+    uint16_t count;
+};
+
+static Obstacles obstacles;
+static AP_OABendyRuler::Fan fan;
+static float bearings[AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX];
+static const float lookahead = 15.0f;
+
+// obstacles scattered within 30m of the vehicle, and bearings around the vehicle
+static void setup(uint16_t count)
+{
+    rand_seed(1);
+    obstacles.count = count;
+    for (uint16_t i=0; i<count; i++) {
+        obstacles.x[i] = rand_float(-30, 30);
+        obstacles.y[i] = rand_float(-30, 30);
+        obstacles.radius[i] = rand_float(0.1f, 1.0f);
+    }
+    for (uint8_t i=0; i<AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX; i++) {
+        bearings[i] = wrap_180(i * AP_OABendyRuler::OA_BENDYRULER_BEARING_INC);
+    }
+}
+
+static void BM_MarginsFan(benchmark::State& state)
+{
+    setup(state.range_x());
+    float total = 0;
+    while (state.KeepRunning()) {
+        AP_OABendyRuler::fan_init(fan, bearings, AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX, lookahead);
+        AP_OABendyRuler::fan_update_margins_from_points(fan, obstacles.x, obstacles.y, obstacles.radius, obstacles.count);
+        total += fan.margin[0];
+    }
+    gbenchmark_escape(&total);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MarginsScalar(benchmark::State& state)
+{
+    setup(state.range_x());
+    float total = 0;
+    while (state.KeepRunning()) {
+        for (uint8_t i=0; i<AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX; i++) {
+            const float bearing_rad = radians(bearings[i]);
+            const Vector2f end_cm = Vector2f{cosf(bearing_rad), sinf(bearing_rad)} * (lookahead * 100.0f);
+            float margin = FLT_MAX;
+            for (uint16_t j=0; j<obstacles.count; j++) {
+                const Vector2f point_cm = Vector2f{obstacles.x[j], obstacles.y[j]} * 100.0f;
+                const float m = Vector2f::closest_distance_between_line_and_point(Vector2f{}, end_cm, point_cm) * 0.01f - obstacles.radius[j];
+                margin = MIN(margin, m);
+            }
+            total += margin;
+        }
+    }
+    gbenchmark_escape(&total);
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MarginsFan)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK(BM_MarginsScalar)->Arg(1)->Arg(10)->Arg(100);
+
+BENCHMARK_MAIN()
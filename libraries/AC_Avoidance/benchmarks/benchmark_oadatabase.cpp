@@ -0,0 +1,189 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_Avoidance/AP_OADatabase_hash.h>
+#include <AP_Math/tests/random_test.h>
+
+/*
+  object database processing times for a 360 degree lidar scanning a
+  cluttered area at a rate which keeps 250 to 4000 items in the
+  database. Each iteration processes one revolution of 360 samples and
+  then removes expired items, as AP_OADatabase does, either comparing
+  against every item or using AP_OADatabase_hash. Returns are out to
+  40m with 1 degree beams, or out to 80m with the default 5 degree
+  beam width, where the radius of far returns is too large for the
+  index's fine grid.
+
+  AP_OADatabase's size and expiry are parameters, and it expires items
+  by the system time, so the parts of it used in processing are
+  repeated here
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t samples_per_rev = 360;
+static const uint16_t max_items = 8000;
+static const uint16_t num_samples = 16384;
+
+// the parts of AP_OADatabase's items and database used in processing
+struct Database {
+    Vector2f pos[max_items];
+    float radius[max_items];
+    uint32_t timestamp_ms[max_items];
+    uint16_t count;
+    uint16_t size;
+    AP_OADatabase_hash index;
+};
+
+struct Sample {
+    Vector2f pos;
+    float radius;
+};
+
+// static, as the database is too large for the stack
+static Database db;
+static Sample samples[num_samples];
+
+// lidar returns around a vehicle moving through the area, with radius growing with distance
+static void make_samples(float beam_width, float distance_max)
+{
+    rand_seed(1);
+    const float dist_to_radius_scalar = tanf(radians(beam_width));
+    Vector2f vehicle;
+    for (uint16_t i=0; i<num_samples; i++) {
+        vehicle.x += 0.002f;
+        const float angle = radians(i % samples_per_rev);
+        const float distance = rand_float(1, distance_max);
+        samples[i].pos = vehicle + Vector2f{cosf(angle), sinf(angle)} * distance;
+        samples[i].radius = MAX(0.01f, distance * dist_to_radius_scalar);
+    }
+}
+
+static bool is_close(uint16_t i, const Sample &sample)
+{
+    const float distance_sq = (db.pos[i] - sample.pos).length_squared();
+    return (distance_sq < sq(sample.radius)) || (distance_sq < sq(db.radius[i]));
+}
+
+static uint16_t find_linear(const Sample &sample)
+{
+    for (uint16_t i=0; i<db.count; i++) {
+        if (is_close(i, sample)) {
+            return i;
+        }
+    }
+    return AP_OADatabase_hash::none;
+}
+
+static uint16_t find_index(const Sample &sample)
+{
+    AP_OADatabase_hash::Search search;
+    if (!db.index.search_start(sample.pos, sample.radius, search)) {
+        return find_linear(sample);
+    }
+    uint16_t lowest = AP_OADatabase_hash::none;
+    for (uint16_t i = db.index.search_next(search); i != AP_OADatabase_hash::none; i = db.index.search_next(search)) {
+        if ((i < lowest) && is_close(i, sample)) {
+            lowest = i;
+        }
+    }
+    return lowest;
+}
+
+static void process(const Sample &sample, uint32_t timestamp_ms, bool use_index)
+{
+    const uint16_t i = use_index ? find_index(sample) : find_linear(sample);
+    if (i != AP_OADatabase_hash::none) {
+        db.timestamp_ms[i] = timestamp_ms;
+        db.radius[i] = sample.radius;
+        db.index.refresh(i, db.pos[i], timestamp_ms, sample.radius);
+        return;
+    }
+    if (db.count >= db.size) {
+        return;
+    }
+    db.pos[db.count] = sample.pos;
+    db.radius[db.count] = sample.radius;
+    db.timestamp_ms[db.count] = timestamp_ms;
+    db.index.add(db.count, sample.pos, timestamp_ms, sample.radius);
+    db.count++;
+}
+
+static void remove(uint16_t i)
+{
+    db.index.remove(i);
+    db.count--;
+    db.pos[i] = db.pos[db.count];
+    db.radius[i] = db.radius[db.count];
+    db.timestamp_ms[i] = db.timestamp_ms[db.count];
+}
+
+static void remove_expired(uint32_t now_ms, uint32_t expiry_ms, bool use_index)
+{
+    if (use_index) {
+        while ((db.count > 0) && (now_ms - db.timestamp_ms[db.index.oldest()] > expiry_ms)) {
+            remove(db.index.oldest());
+        }
+        return;
+    }
+    uint16_t i = 0;
+    while (i < db.count) {
+        if (now_ms - db.timestamp_ms[i] > expiry_ms) {
+            remove(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+// one revolution every 100ms, with the expiry chosen to hold about the requested number of items
+static void run(benchmark::State& state, bool use_index, float beam_width, float distance_max)
+{
+    make_samples(beam_width, distance_max);
+    db.size = max_items;
+    db.count = 0;
+    if (!db.index.init(db.size, 2.0f)) {
+        abort();
+    }
+    const uint32_t expiry_ms = 100 * state.range_x() / samples_per_rev;
+    uint32_t now_ms = 0;
+    uint16_t n = 0;
+    uint32_t total = 0;
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<samples_per_rev; i++) {
+            process(samples[n], now_ms, use_index);
+            n = (n + 1) % num_samples;
+        }
+        now_ms += 100;
+        remove_expired(now_ms, expiry_ms, use_index);
+        total += db.count;
+    }
+    gbenchmark_escape(&total);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_DatabaseLinear(benchmark::State& state)
+{
+    run(state, false, 1, 40);
+}
+
+static void BM_DatabaseIndex(benchmark::State& state)
+{
+    run(state, true, 1, 40);
+}
+
+static void BM_DatabaseLinearDefaultBeam(benchmark::State& state)
+{
+    run(state, false, 5, 80);
+}
+
+static void BM_DatabaseIndexDefaultBeam(benchmark::State& state)
+{
+    run(state, true, 5, 80);
+}
+
+BENCHMARK(BM_DatabaseLinear)->Arg(250)->Arg(1000)->Arg(4000);
+BENCHMARK(BM_DatabaseIndex)->Arg(250)->Arg(1000)->Arg(4000);
+BENCHMARK(BM_DatabaseLinearDefaultBeam)->Arg(250)->Arg(1000)->Arg(4000);
+BENCHMARK(BM_DatabaseIndexDefaultBeam)->Arg(250)->Arg(1000)->Arg(4000);
+
+BENCHMARK_MAIN()
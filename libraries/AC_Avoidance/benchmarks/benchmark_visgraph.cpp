@@ -0,0 +1,199 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_Avoidance/AP_OAVisGraph.h>
+#include <AP_Math/tests/random_test.h>
+
+/*
+  visibility graph build and path query times for synthetic fences of
+  20 to 250 points: an inclusion fence with an exclusion zone of 10
+  points for every 20 points in the fence. The graph is built from
+  scratch, and updated after one exclusion zone moves. Path queries
+  are made with the graph's A* search and with Dijkstra's algorithm
+  scanning every node for the closest, as AP_OADijkstra did
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t exclusion_points = 10;
+static const uint16_t max_polygons = 1 + AP_OAVisGraph::max_nodes / (2 * exclusion_points);
+static const uint16_t num_queries = 64;
+
+struct Fence {
+    Vector2f *points[max_polygons];
+    uint16_t counts[max_polygons];
+    uint16_t num_polygons;
+    Vector2f sources[num_queries];
+    Vector2f destinations[num_queries];
+    AP_OAVisGraph graph;
+};
+
+// static, as expanding arrays rely on zeroed memory
+static AP_ExpandingArray<AP_OAVisGraph::OAItemID> path(32);
+
+// describe the fence to the graph, with nodes inside the inclusion fence and outside the exclusion zones
+static void load_fence(Fence &fence)
+{
+    fence.graph.begin_update();
+    for (uint16_t i=0; i<fence.num_polygons; i++) {
+        const bool inclusion = (i == 0);
+        const Vector2f *points = fence.points[i];
+        if (!fence.graph.add_polygon(inclusion ? AP_OAVisGraph::ObjectType::INCLUSION_POLYGON : AP_OAVisGraph::ObjectType::EXCLUSION_POLYGON,
+                                     points, fence.counts[i])) {
+            abort();
+        }
+        Vector2f centre;
+        for (uint16_t j=0; j<fence.counts[i]; j++) {
+            centre += points[j];
+        }
+        centre /= fence.counts[i];
+        for (uint16_t j=0; j<fence.counts[i]; j++) {
+            if (!fence.graph.add_node(centre + (points[j] - centre) * (inclusion ? 0.95f : 1.3f))) {
+                abort();
+            }
+        }
+    }
+    if (!fence.graph.update()) {
+        abort();
+    }
+}
+
+static void make_fence(Fence &fence, uint16_t total_points)
+{
+    rand_seed(1);
+    const uint16_t num_exclusions = total_points / (2 * exclusion_points);
+    fence.num_polygons = 1 + num_exclusions;
+    fence.counts[0] = total_points - num_exclusions * exclusion_points;
+    fence.points[0] = new Vector2f[fence.counts[0]];
+    make_polygon(fence.points[0], fence.counts[0], Vector2f{0, 0}, 120000, 200000);
+    for (uint16_t i=1; i<fence.num_polygons; i++) {
+        fence.counts[i] = exclusion_points;
+        fence.points[i] = new Vector2f[exclusion_points];
+        make_polygon(fence.points[i], exclusion_points,
+                     Vector2f{rand_float(-80000, 80000), rand_float(-80000, 80000)}, 3000, 5000);
+    }
+    for (uint16_t i=0; i<num_queries; i++) {
+        fence.sources[i] = Vector2f{rand_float(-100000, 100000), rand_float(-100000, 100000)};
+        fence.destinations[i] = Vector2f{rand_float(-100000, 100000), rand_float(-100000, 100000)};
+    }
+    load_fence(fence);
+    if (!path.expand_to_hold(fence.graph.num_nodes() + 2)) {
+        abort();
+    }
+}
+
+static void free_fence(Fence &fence)
+{
+    for (uint16_t i=0; i<fence.num_polygons; i++) {
+        delete[] fence.points[i];
+    }
+}
+
+// shortest path length by Dijkstra's algorithm, finding the closest unvisited node by scanning all nodes
+static float path_length_linear(const AP_OAVisGraph &graph, const Vector2f &source, const Vector2f &destination)
+{
+    const uint16_t n = graph.num_nodes();
+    const uint16_t source_idx = n;
+    const uint16_t destination_idx = n + 1;
+    float distance[AP_OAVisGraph::max_nodes + 2];
+    bool visited[AP_OAVisGraph::max_nodes + 2];
+    for (uint16_t i=0; i<n+2; i++) {
+        distance[i] = FLT_MAX;
+        visited[i] = false;
+    }
+    distance[source_idx] = 0;
+    while (true) {
+        uint16_t curr = destination_idx + 1;
+        float lowest = FLT_MAX;
+        for (uint16_t i=0; i<n+2; i++) {
+            if (!visited[i] && (distance[i] < lowest)) {
+                curr = i;
+                lowest = distance[i];
+            }
+        }
+        if (curr >= destination_idx) {
+            return lowest;
+        }
+        visited[curr] = true;
+        const Vector2f &curr_pos = (curr == source_idx) ? source : graph.node(curr);
+        for (uint16_t i=0; i<n; i++) {
+            if (visited[i] || (i == curr)) {
+                continue;
+            }
+            const bool visible = (curr == source_idx) ? !graph.intersects_fence(source, graph.node(i)) : graph.visible(curr, i);
+            if (visible) {
+                distance[i] = MIN(distance[i], lowest + (graph.node(i) - curr_pos).length());
+            }
+        }
+        if (!graph.intersects_fence(curr_pos, destination)) {
+            distance[destination_idx] = MIN(distance[destination_idx], lowest + (destination - curr_pos).length());
+        }
+    }
+}
+
+static void BM_VisGraphBuild(benchmark::State& state)
+{
+    Fence fence;
+    make_fence(fence, state.range_x());
+    while (state.KeepRunning()) {
+        fence.graph.clear();
+        load_fence(fence);
+    }
+    state.SetItemsProcessed(state.iterations());
+    free_fence(fence);
+}
+
+static void BM_VisGraphUpdate(benchmark::State& state)
+{
+    Fence fence;
+    make_fence(fence, state.range_x());
+    float offset = 2000;
+    while (state.KeepRunning()) {
+        // move one exclusion zone back and forth
+        Vector2f *points = fence.points[fence.num_polygons - 1];
+        for (uint16_t i=0; i<exclusion_points; i++) {
+            points[i].x += offset;
+        }
+        offset = -offset;
+        load_fence(fence);
+    }
+    state.SetItemsProcessed(state.iterations());
+    free_fence(fence);
+}
+
+static void BM_PathAStar(benchmark::State& state)
+{
+    Fence fence;
+    make_fence(fence, state.range_x());
+    uint16_t n = 0;
+    uint32_t found = 0;
+    while (state.KeepRunning()) {
+        uint8_t numpoints;
+        found += fence.graph.find_path(fence.sources[n], fence.destinations[n], path, numpoints);
+        n = (n + 1) % num_queries;
+    }
+    gbenchmark_escape(&found);
+    state.SetItemsProcessed(state.iterations());
+    free_fence(fence);
+}
+
+static void BM_PathLinear(benchmark::State& state)
+{
+    Fence fence;
+    make_fence(fence, state.range_x());
+    uint16_t n = 0;
+    float length = 0;
+    while (state.KeepRunning()) {
+        length += path_length_linear(fence.graph, fence.sources[n], fence.destinations[n]);
+        n = (n + 1) % num_queries;
+    }
+    gbenchmark_escape(&length);
+    state.SetItemsProcessed(state.iterations());
+    free_fence(fence);
+}
+
+BENCHMARK(BM_VisGraphBuild)->Arg(20)->Arg(50)->Arg(100)->Arg(250);
+BENCHMARK(BM_VisGraphUpdate)->Arg(20)->Arg(50)->Arg(100)->Arg(250);
+BENCHMARK(BM_PathAStar)->Arg(20)->Arg(50)->Arg(100)->Arg(250);
+BENCHMARK(BM_PathLinear)->Arg(20)->Arg(50)->Arg(100)->Arg(250);
+
+BENCHMARK_MAIN()
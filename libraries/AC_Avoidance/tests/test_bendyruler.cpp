@@ -0,0 +1,262 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AC_Avoidance/AP_OABendyRuler.h>
+#include <AP_Math/tests/random_test.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t num_points = 100;
+
+// static, as the fan is large
+static AP_OABendyRuler::Fan fan;
+
+static void make_fan(float length)
+{
+    float bearings[AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX];
+    for (uint8_t i=0; i<AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX; i++) {
+        bearings[i] = wrap_180(rand_float(-180, 180));
+    }
+    AP_OABendyRuler::fan_init(fan, bearings, AP_OABendyRuler::OA_BENDYRULER_BEARINGS_MAX, length);
+    for (uint8_t i=0; i<fan.count; i++) {
+        EXPECT_FLOAT_EQ(1.0f, sq(fan.dir_x[i]) + sq(fan.dir_y[i]));
+        EXPECT_FLOAT_EQ(FLT_MAX, fan.margin[i]);
+    }
+}
+
+// margins must match the distance from each segment to each point, as calculated one at a time
+TEST(BendyRuler, points)
+{
+    float x[num_points], y[num_points], radius[num_points];
+    for (uint16_t i=0; i<num_points; i++) {
+        x[i] = rand_float(-40, 40);
+        y[i] = rand_float(-40, 40);
+        radius[i] = rand_float(0.01f, 3.0f);
+    }
+    make_fan(15.0f);
+    AP_OABendyRuler::fan_update_margins_from_points(fan, x, y, radius, num_points);
+
+    for (uint8_t i=0; i<fan.count; i++) {
+        const Vector2f end{fan.dir_x[i] * fan.length, fan.dir_y[i] * fan.length};
+        float expected = FLT_MAX;
+        for (uint16_t j=0; j<num_points; j++) {
+            const float m = Vector2f::closest_distance_between_line_and_point(Vector2f{}, end, Vector2f{x[j], y[j]}) - radius[j];
+            expected = MIN(expected, m);
+        }
+        EXPECT_NEAR(expected, fan.margin[i], 1e-3f);
+    }
+
+    // no points leaves the margins unchanged
+    make_fan(15.0f);
+    AP_OABendyRuler::fan_update_margins_from_points(fan, x, y, radius, 0);
+    EXPECT_FLOAT_EQ(FLT_MAX, fan.margin[0]);
+}
+
+// margins must match the distance of the furthest end of each segment inside the circle
+TEST(BendyRuler, inclusion_circle)
+{
+    make_fan(20.0f);
+    const Vector2f center{rand_float(-10, 10), rand_float(-10, 10)};
+    const float radius = 25.0f;
+    AP_OABendyRuler::fan_update_margins_from_inclusion_circle(fan, center, radius);
+
+    for (uint8_t i=0; i<fan.count; i++) {
+        const Vector2f end{fan.dir_x[i] * fan.length, fan.dir_y[i] * fan.length};
+        const float expected = radius - MAX(center.length(), (end - center).length());
+        EXPECT_NEAR(expected, fan.margin[i], 1e-4f);
+    }
+}
+
+// bearings are clockwise from north, with north the first axis
+TEST(BendyRuler, bearings)
+{
+    const float bearings[] { 0.0f, 90.0f, 180.0f, -90.0f };
+    AP_OABendyRuler::fan_init(fan, bearings, ARRAY_SIZE(bearings), 10.0f);
+    EXPECT_EQ(ARRAY_SIZE(bearings), fan.count);
+    EXPECT_NEAR(1.0f, fan.dir_x[0], 1e-6f);
+    EXPECT_NEAR(1.0f, fan.dir_y[1], 1e-6f);
+    EXPECT_NEAR(-1.0f, fan.dir_x[2], 1e-6f);
+    EXPECT_NEAR(-1.0f, fan.dir_y[3], 1e-6f);
+
+    // point 5m east with 1m radius is on the segment heading east, and 4m from the segments heading north, south and west
+    const float x[] { 0.0f }, y[] { 5.0f }, radius[] { 1.0f };
+    AP_OABendyRuler::fan_update_margins_from_points(fan, x, y, radius, 1);
+    EXPECT_NEAR(4.0f, fan.margin[0], 1e-5f);
+    EXPECT_NEAR(-1.0f, fan.margin[1], 1e-5f);
+    EXPECT_NEAR(4.0f, fan.margin[2], 1e-5f);
+    EXPECT_NEAR(4.0f, fan.margin[3], 1e-5f);
+}
+
+// margins must match the distance to each polygon, as calculated for one segment at a time
+TEST(BendyRuler, polygon)
+{
+    Vector2f boundary[20];
+    const Vector2f center_cm{rand_float(-500, 500), rand_float(-500, 500)};
+    make_polygon(boundary, ARRAY_SIZE(boundary), center_cm, 1000, 3000);
+    const float fence_margin = 2.0f;
+
+    // from inside and outside the polygon, treated as an inclusion and an exclusion polygon
+    const Vector2f starts_cm[] { Vector2f{0, 0}, Vector2f{5000, 0} };
+    for (const Vector2f &start_cm : starts_cm) {
+        for (uint8_t inclusion = 0; inclusion <= 1; inclusion++) {
+            make_fan(15.0f);
+            AP_OABendyRuler::fan_update_margins_from_polygon(fan, start_cm, boundary, ARRAY_SIZE(boundary), inclusion, fence_margin);
+
+            const bool outside = Polygon_outside(start_cm, boundary, ARRAY_SIZE(boundary));
+            const float sign = inclusion ? (outside ? -1.0f : 1.0f) : (outside ? 1.0f : -1.0f);
+            for (uint8_t i=0; i<fan.count; i++) {
+                const Vector2f end_cm = start_cm + Vector2f{fan.dir_x[i], fan.dir_y[i]} * (fan.length * 100.0f);
+                const float expected = (sign * Polygon_closest_distance_line(boundary, ARRAY_SIZE(boundary), start_cm, end_cm) * 0.01f) - fence_margin;
+                EXPECT_NEAR(expected, fan.margin[i], 1e-4f);
+            }
+        }
+    }
+}
+
+static const Location origin{-353632620, 1491652300, 58400, Location::AltFrame::ABSOLUTE};
+
+// obstacles (in meters from origin), used as BendyRuler's margin source instead of the fence and object database
+class Obstacles {
+public:
+    float x[num_points];
+    float y[num_points];
+    float radius[num_points];
+    uint16_t count;
+
+    void calc_margins(const Location &start, AP_OABendyRuler::Fan &fan_out) {
+        const Vector2f start_m = origin.get_distance_NE(start);
+        float x_start[num_points], y_start[num_points];
+        for (uint16_t i=0; i<count; i++) {
+            x_start[i] = x[i] - start_m.x;
+            y_start[i] = y[i] - start_m.y;
+        }
+        AP_OABendyRuler::fan_update_margins_from_points(fan_out, x_start, y_start, radius, count);
+    }
+};
+
+static Obstacles obstacles;
+
+// minimum distance between one segment and any obstacle, calculated on its own.  Many
+// bearings can share the closest obstacle, so this uses the same calculation as the fan
+// rather than the distance to the segment between rounded Locations, else the rounding
+// would decide between bearings with equal margins
+static float scalar_margin(const Location &start, float bearing, float length)
+{
+    static AP_OABendyRuler::Fan segment;
+    AP_OABendyRuler::fan_init(segment, &bearing, 1, length);
+    const Vector2f start_m = origin.get_distance_NE(start);
+    for (uint16_t i=0; i<obstacles.count; i++) {
+        const float x[] { obstacles.x[i] - start_m.x };
+        const float y[] { obstacles.y[i] - start_m.y };
+        AP_OABendyRuler::fan_update_margins_from_points(segment, x, y, &obstacles.radius[i], 1);
+    }
+    return segment.margin[0];
+}
+
+// bearing search as AP_OABendyRuler::update did, calculating the margin of each bearing when it is tested
+static bool scalar_search(float &current_lookahead, float lookahead, float margin_max, const Location &current_loc, const Location &destination, float ground_course_deg, Location &destination_new)
+{
+    const float bearing_to_dest = current_loc.get_bearing_to(destination) * 0.01f;
+    const float distance_to_dest = current_loc.get_distance(destination);
+    current_lookahead = constrain_float(current_lookahead, lookahead * 0.5f, lookahead);
+    const float lookahead_step1_dist = MIN(current_lookahead, distance_to_dest + AP_OABendyRuler::OA_BENDYRULER_LOOKAHEAD_PAST_DEST);
+    const float lookahead_step2_dist = current_lookahead * AP_OABendyRuler::OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO;
+
+    float best_bearing = bearing_to_dest;
+    bool have_best_bearing = false;
+    float best_margin = -FLT_MAX;
+    float best_margin_bearing = best_bearing;
+
+    for (uint8_t i = 0; i <= (170 / AP_OABendyRuler::OA_BENDYRULER_BEARING_INC); i++) {
+        for (uint8_t bdir = 0; bdir <= 1; bdir++) {
+            if ((i==0) && (bdir > 0)) {
+                continue;
+            }
+            const float bearing_delta = i * AP_OABendyRuler::OA_BENDYRULER_BEARING_INC * (bdir == 0 ? -1.0f : 1.0f);
+            const float bearing_test = wrap_180(bearing_to_dest + bearing_delta);
+            const float margin = scalar_margin(current_loc, bearing_test, lookahead_step1_dist);
+            if (margin > best_margin) {
+                best_margin_bearing = bearing_test;
+                best_margin = margin;
+            }
+            if (margin > margin_max) {
+                if (!have_best_bearing) {
+                    best_bearing = bearing_test;
+                    have_best_bearing = true;
+                } else if (fabsf(wrap_180(ground_course_deg - bearing_test)) <
+                           fabsf(wrap_180(ground_course_deg - best_bearing))) {
+                    best_bearing = bearing_test;
+                }
+
+                Location test_loc = current_loc;
+                test_loc.offset_bearing(bearing_test, lookahead_step1_dist);
+
+                const float test_bearings[] { 0.0f, 45.0f, -45.0f };
+                const float bearing_to_dest2 = test_loc.get_bearing_to(destination) * 0.01f;
+                const float distance2 = constrain_float(lookahead_step2_dist, AP_OABendyRuler::OA_BENDYRULER_LOOKAHEAD_STEP2_MIN, test_loc.get_distance(destination));
+                for (uint8_t j = 0; j < ARRAY_SIZE(test_bearings); j++) {
+                    if (scalar_margin(test_loc, wrap_180(bearing_to_dest2 + test_bearings[j]), distance2) > margin_max) {
+                        destination_new = current_loc;
+                        destination_new.offset_bearing(bearing_test, distance_to_dest);
+                        current_lookahead = MIN(lookahead, current_lookahead * 1.1f);
+                        return (i != 0 || j != 0);
+                    }
+                }
+            }
+        }
+    }
+
+    float chosen_bearing;
+    if (have_best_bearing) {
+        chosen_bearing = best_bearing;
+        current_lookahead = MIN(lookahead, current_lookahead * 1.05f);
+    } else {
+        chosen_bearing = best_margin_bearing;
+        current_lookahead = MAX(lookahead * 0.5f, current_lookahead * 0.9f);
+    }
+    destination_new = current_loc;
+    destination_new.offset_bearing(chosen_bearing, distance_to_dest);
+    return true;
+}
+
+// the bearing chosen from margins calculated together must match the bearing chosen by calculating margins one bearing at a time
+TEST(BendyRuler, search_bearings)
+{
+    static AP_OABendyRuler bendy;
+    const AP_OABendyRuler::margins_fn_t calc_margins = FUNCTOR_BIND(&obstacles, &Obstacles::calc_margins, void, const Location &, AP_OABendyRuler::Fan &);
+    const float lookahead = 15.0f;
+    const float margin_max = 2.0f;
+    bendy.set_config(lookahead, margin_max);
+    float current_lookahead = bendy.current_lookahead();
+    uint16_t num_active = 0;
+
+    Location current_loc = origin;
+    for (uint16_t n=0; n<200; n++) {
+        // more obstacles each time around so that all of the ways of choosing a bearing are used
+        obstacles.count = n % num_points;
+        for (uint16_t i=0; i<obstacles.count; i++) {
+            obstacles.x[i] = rand_float(-30, 30);
+            obstacles.y[i] = rand_float(-30, 30);
+            obstacles.radius[i] = rand_float(0.1f, 3.0f);
+        }
+        Location destination = current_loc;
+        destination.offset_bearing(rand_float(-180, 180), rand_float(5, 50));
+        const float ground_course_deg = rand_float(-180, 180);
+
+        Location destination_new, expected_destination;
+        float log_bearing, log_margin;
+        const bool active = bendy.search_bearings(calc_margins, current_loc, destination, ground_course_deg, destination_new, log_bearing, log_margin);
+        const bool expected_active = scalar_search(current_lookahead, lookahead, margin_max, current_loc, destination, ground_course_deg, expected_destination);
+        EXPECT_EQ(expected_active, active);
+        EXPECT_EQ(expected_destination.lat, destination_new.lat);
+        EXPECT_EQ(expected_destination.lng, destination_new.lng);
+        EXPECT_FLOAT_EQ(current_lookahead, bendy.current_lookahead());
+        num_active += active ? 1 : 0;
+    }
+
+    // some searches had to avoid obstacles and some didn't
+    EXPECT_LT(0, num_active);
+    EXPECT_GT(200, num_active);
+}
+
+AP_GTEST_MAIN()
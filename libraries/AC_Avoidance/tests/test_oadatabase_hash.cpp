@@ -0,0 +1,224 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AC_Avoidance/AP_OADatabase_hash.h>
+#include <AP_Math/tests/random_test.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t max_items = 500;
+
+// items stored as the object database does, removing by moving the last item into the gap
+struct Items {
+    Vector2f pos[max_items];
+    float radius[max_items];
+    uint32_t timestamp_ms[max_items];
+    uint16_t count;
+};
+
+static void add(Items &items, AP_OADatabase_hash &index, const Vector2f &pos, uint32_t timestamp_ms, float radius)
+{
+    items.pos[items.count] = pos;
+    items.radius[items.count] = radius;
+    items.timestamp_ms[items.count] = timestamp_ms;
+    index.add(items.count, pos, timestamp_ms, radius);
+    items.count++;
+}
+
+static void remove(Items &items, AP_OADatabase_hash &index, uint16_t i)
+{
+    index.remove(i);
+    items.count--;
+    items.pos[i] = items.pos[items.count];
+    items.radius[i] = items.radius[items.count];
+    items.timestamp_ms[i] = items.timestamp_ms[items.count];
+}
+
+// every item within radius, or within its own radius, is found, and the oldest item is oldest
+static void check(const Items &items, const AP_OADatabase_hash &index, float radius)
+{
+    for (uint16_t n=0; n<20; n++) {
+        const Vector2f pos{rand_float(-60, 60), rand_float(-60, 60)};
+        bool found[max_items] {};
+        AP_OADatabase_hash::Search search;
+        ASSERT_TRUE(index.search_start(pos, radius, search));
+        for (uint16_t i = index.search_next(search); i != AP_OADatabase_hash::none; i = index.search_next(search)) {
+            ASSERT_LT(i, items.count);
+            found[i] = true;
+        }
+        for (uint16_t i=0; i<items.count; i++) {
+            const float distance = (items.pos[i] - pos).length();
+            if ((distance < radius) || (distance < items.radius[i])) {
+                EXPECT_TRUE(found[i]);
+            }
+        }
+    }
+
+    if (items.count == 0) {
+        EXPECT_EQ(AP_OADatabase_hash::none, index.oldest());
+        return;
+    }
+    const uint16_t oldest = index.oldest();
+    ASSERT_LT(oldest, items.count);
+    for (uint16_t i=0; i<items.count; i++) {
+        EXPECT_LE(items.timestamp_ms[oldest], items.timestamp_ms[i]);
+    }
+}
+
+TEST(OADatabaseHash, random)
+{
+    static Items items;
+    AP_OADatabase_hash index;
+    ASSERT_TRUE(index.init(max_items, 2.0f));
+    uint32_t now_ms = 1000;
+
+    for (uint16_t step=0; step<3000; step++) {
+        now_ms += 10;
+        const float action = rand_float(0, 1);
+        if ((items.count < max_items) && (action < 0.5f)) {
+            // timestamps are mostly in order, and a few items are too large for the fine grid or either grid
+            const uint32_t timestamp_ms = now_ms - ((action < 0.1f) ? (uint32_t)rand_float(0, 500) : 0);
+            const float radius = (action < 0.02f) ? rand_float(5, 20) : rand_float(0.1f, 1);
+            add(items, index, Vector2f{rand_float(-50, 50), rand_float(-50, 50)}, timestamp_ms, radius);
+        } else if ((items.count > 0) && (action < 0.7f)) {
+            const uint16_t i = (uint16_t)rand_float(0, items.count - 1);
+            items.timestamp_ms[i] = now_ms;
+            if (action < 0.54f) {
+                // growing or shrinking moves items between grids
+                items.radius[i] = rand_float(0.1f, 20);
+            }
+            index.refresh(i, items.pos[i], now_ms, items.radius[i]);
+        } else if (items.count > 0) {
+            remove(items, index, (action < 0.85f) ? index.oldest() : (uint16_t)rand_float(0, items.count - 1));
+        }
+        if ((step % 100) == 0) {
+            check(items, index, 3.0f);
+            check(items, index, 8.0f);
+        }
+    }
+    check(items, index, 3.0f);
+
+    // remove oldest until empty
+    while (items.count > 0) {
+        const uint32_t oldest_ms = items.timestamp_ms[index.oldest()];
+        remove(items, index, index.oldest());
+        for (uint16_t i=0; i<items.count; i++) {
+            EXPECT_LE(oldest_ms, items.timestamp_ms[i]);
+        }
+    }
+    check(items, index, 3.0f);
+}
+
+TEST(OADatabaseHash, wrap)
+{
+    // timestamps are ordered across the wrap of the system time
+    AP_OADatabase_hash index;
+    ASSERT_TRUE(index.init(10, 2.0f));
+    index.add(0, Vector2f{0, 0}, UINT32_MAX - 10, 1);
+    index.add(1, Vector2f{1, 0}, 5, 1);
+    index.add(2, Vector2f{2, 0}, UINT32_MAX - 20, 1);
+    EXPECT_EQ(2, index.oldest());
+    index.remove(2);
+    EXPECT_EQ(0, index.oldest());
+    index.refresh(0, Vector2f{0, 0}, 10, 1);
+    EXPECT_EQ(1, index.oldest());
+}
+
+TEST(OADatabaseHash, limits)
+{
+    AP_OADatabase_hash index;
+    AP_OADatabase_hash::Search search;
+    EXPECT_FALSE(index.initialised());
+    EXPECT_FALSE(index.search_start(Vector2f{0, 0}, 1.0f, search));
+    EXPECT_FALSE(index.init(0, 2.0f));
+    EXPECT_FALSE(index.init(10, 0.0f));
+    ASSERT_TRUE(index.init(10, 2.0f));
+
+    // large radius and positions out of range need every item checked
+    EXPECT_TRUE(index.search_start(Vector2f{0, 0}, 8.0f, search));
+    EXPECT_FALSE(index.search_start(Vector2f{0, 0}, 8.5f, search));
+    EXPECT_FALSE(index.search_start(Vector2f{0, 0}, 100.0f, search));
+    EXPECT_FALSE(index.search_start(Vector2f{NAN, 0}, 1.0f, search));
+    EXPECT_FALSE(index.search_start(Vector2f{0, 1e7f}, 1.0f, search));
+
+    // items out of range are still in the timestamp ordered list
+    index.add(0, Vector2f{NAN, 0}, 100, 1);
+    index.add(1, Vector2f{0, 0}, 200, 1);
+    EXPECT_EQ(0, index.oldest());
+    ASSERT_TRUE(index.search_start(Vector2f{0, 0}, 1.0f, search));
+    uint16_t count = 0;
+    for (uint16_t i = index.search_next(search); i != AP_OADatabase_hash::none; i = index.search_next(search)) {
+        count += (i == 1) ? 1 : 0;
+    }
+    EXPECT_EQ(1, count);
+    index.remove(0);
+    EXPECT_EQ(0, index.oldest());
+}
+
+TEST(OADatabaseHash, overflow)
+{
+    AP_OADatabase_hash index;
+    AP_OADatabase_hash::Search search;
+    ASSERT_TRUE(index.init(10, 2.0f));
+
+    // an item too large for either grid doesn't stop searches using
+    // them, and is found from positions within its radius
+    index.add(0, Vector2f{0, 0}, 100, 50);
+    index.add(1, Vector2f{100, 0}, 200, 1);
+    ASSERT_TRUE(index.search_start(Vector2f{40, 0}, 1.0f, search));
+    bool found = false;
+    for (uint16_t i = index.search_next(search); i != AP_OADatabase_hash::none; i = index.search_next(search)) {
+        EXPECT_NE(1, i);
+        found |= (i == 0);
+    }
+    EXPECT_TRUE(found);
+
+    // an item which grows too large moves to the overflow list
+    index.refresh(1, Vector2f{100, 0}, 300, 50);
+    ASSERT_TRUE(index.search_start(Vector2f{60, 0}, 1.0f, search));
+    found = false;
+    for (uint16_t i = index.search_next(search); i != AP_OADatabase_hash::none; i = index.search_next(search)) {
+        found |= (i == 1);
+    }
+    EXPECT_TRUE(found);
+
+    // and moves with its index
+    index.remove(0);
+    ASSERT_TRUE(index.search_start(Vector2f{60, 0}, 1.0f, search));
+    EXPECT_EQ(0, index.search_next(search));
+    EXPECT_EQ(AP_OADatabase_hash::none, index.search_next(search));
+}
+
+TEST(OADatabaseHash, grids)
+{
+    AP_OADatabase_hash index;
+    AP_OADatabase_hash::Search search;
+    // enough buckets that the cells searched don't share the items' buckets
+    ASSERT_TRUE(index.init(1000, 2.0f));
+
+    // an item too large for the fine grid is found from the coarse grid
+    index.add(0, Vector2f{0, 0}, 100, 5);
+    index.add(1, Vector2f{20, 0}, 200, 1);
+    ASSERT_TRUE(index.search_start(Vector2f{4, 0}, 1.0f, search));
+    bool found = false;
+    for (uint16_t i = index.search_next(search); i != AP_OADatabase_hash::none; i = index.search_next(search)) {
+        EXPECT_NE(1, i);
+        found |= (i == 0);
+    }
+    EXPECT_TRUE(found);
+
+    // and doesn't widen searches of the fine grid
+    ASSERT_TRUE(index.search_start(Vector2f{16.5f, 0}, 1.0f, search));
+    for (uint16_t i = index.search_next(search); i != AP_OADatabase_hash::none; i = index.search_next(search)) {
+        EXPECT_NE(1, i);
+    }
+
+    // an item which shrinks moves to the fine grid
+    index.refresh(0, Vector2f{0, 0}, 300, 0.5f);
+    ASSERT_TRUE(index.search_start(Vector2f{12, 0}, 1.0f, search));
+    for (uint16_t i = index.search_next(search); i != AP_OADatabase_hash::none; i = index.search_next(search)) {
+        EXPECT_NE(0, i);
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,232 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AC_Avoidance/AP_OAVisGraph.h>
+#include <AP_Math/tests/random_test.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint8_t max_exclusions = 20;
+static const uint8_t exclusion_points = 8;
+
+// an inclusion polygon with exclusion polygons and a circle inside it
+struct TestFence {
+    Vector2f inclusion[100];
+    uint8_t inclusion_count;
+    Vector2f exclusions[max_exclusions][exclusion_points];
+    uint8_t num_exclusions;
+    Vector2f circle_center;
+    float circle_radius;
+};
+
+static void make_fence(TestFence &fence, uint8_t inclusion_count, uint8_t num_exclusions)
+{
+    fence.inclusion_count = inclusion_count;
+    make_polygon(fence.inclusion, inclusion_count, Vector2f{0, 0}, 50000, 100000);
+    fence.num_exclusions = num_exclusions;
+    for (uint8_t i=0; i<num_exclusions; i++) {
+        make_polygon(fence.exclusions[i], exclusion_points,
+                     Vector2f{rand_float(-40000, 40000), rand_float(-40000, 40000)}, 2500, 5000);
+    }
+    fence.circle_center = Vector2f{rand_float(-20000, 20000), rand_float(-20000, 20000)};
+    fence.circle_radius = 4000;
+}
+
+// nodes are the object's points moved away from (or towards) its centre
+static bool add_nodes(AP_OAVisGraph &graph, const Vector2f *points, uint8_t count, float scale)
+{
+    Vector2f centre;
+    for (uint8_t i=0; i<count; i++) {
+        centre += points[i];
+    }
+    centre /= count;
+    for (uint8_t i=0; i<count; i++) {
+        if (!graph.add_node(centre + (points[i] - centre) * scale)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void load_fence(AP_OAVisGraph &graph, const TestFence &fence)
+{
+    graph.begin_update();
+    EXPECT_TRUE(graph.add_polygon(AP_OAVisGraph::ObjectType::INCLUSION_POLYGON, fence.inclusion, fence.inclusion_count));
+    EXPECT_TRUE(add_nodes(graph, fence.inclusion, fence.inclusion_count, 0.9f));
+    for (uint8_t i=0; i<fence.num_exclusions; i++) {
+        EXPECT_TRUE(graph.add_polygon(AP_OAVisGraph::ObjectType::EXCLUSION_POLYGON, fence.exclusions[i], exclusion_points));
+        EXPECT_TRUE(add_nodes(graph, fence.exclusions[i], exclusion_points, 1.3f));
+    }
+    EXPECT_TRUE(graph.add_circle(AP_OAVisGraph::ObjectType::EXCLUSION_CIRCLE, fence.circle_center, fence.circle_radius));
+    for (uint8_t i=0; i<6; i++) {
+        const float angle = M_2PI * i / 6;
+        EXPECT_TRUE(graph.add_node(fence.circle_center + Vector2f{cosf(angle), sinf(angle)} * fence.circle_radius * 1.3f));
+    }
+    EXPECT_TRUE(graph.add_circle(AP_OAVisGraph::ObjectType::INCLUSION_CIRCLE, Vector2f{0, 0}, 95000));
+    EXPECT_TRUE(graph.update());
+}
+
+// every pair must match a direct check of the fence
+static void check_visibility(const AP_OAVisGraph &graph)
+{
+    for (uint8_t i=0; i<graph.num_nodes(); i++) {
+        for (uint8_t j=0; j<graph.num_nodes(); j++) {
+            if (i != j) {
+                EXPECT_EQ(!graph.intersects_fence(graph.node(i), graph.node(j)), graph.visible(i, j));
+            }
+        }
+    }
+}
+
+// length of the shortest path by Dijkstra's algorithm over every pair of points, or -1 if there is none
+static float brute_path_length(const AP_OAVisGraph &graph, const Vector2f &source, const Vector2f &destination)
+{
+    const uint16_t n = graph.num_nodes() + 2;
+    Vector2f pos[AP_OAVisGraph::max_nodes + 2];
+    float dist[AP_OAVisGraph::max_nodes + 2];
+    bool done[AP_OAVisGraph::max_nodes + 2] {};
+    for (uint16_t i=0; i<graph.num_nodes(); i++) {
+        pos[i] = graph.node(i);
+        dist[i] = FLT_MAX;
+    }
+    pos[n-2] = source;
+    dist[n-2] = 0;
+    pos[n-1] = destination;
+    dist[n-1] = FLT_MAX;
+    while (true) {
+        uint16_t best = n;
+        for (uint16_t i=0; i<n; i++) {
+            if (!done[i] && (dist[i] < FLT_MAX) && ((best == n) || (dist[i] < dist[best]))) {
+                best = i;
+            }
+        }
+        if (best == n) {
+            return -1;
+        }
+        if (best == n-1) {
+            return dist[best];
+        }
+        done[best] = true;
+        for (uint16_t i=0; i<n; i++) {
+            if (!done[i] && !graph.intersects_fence(pos[best], pos[i])) {
+                dist[i] = MIN(dist[i], dist[best] + (pos[i] - pos[best]).length());
+            }
+        }
+    }
+}
+
+// static, as expanding arrays rely on zeroed memory
+static AP_ExpandingArray<AP_OAVisGraph::OAItemID> path(32);
+
+static void check_paths(AP_OAVisGraph &graph)
+{
+    ASSERT_TRUE(path.expand_to_hold(graph.num_nodes() + 2));
+    for (uint8_t i=0; i<20; i++) {
+        const Vector2f source{rand_float(-60000, 60000), rand_float(-60000, 60000)};
+        const Vector2f destination{rand_float(-60000, 60000), rand_float(-60000, 60000)};
+        const float expected = brute_path_length(graph, source, destination);
+        uint8_t numpoints = 0;
+        if (!graph.find_path(source, destination, path, numpoints)) {
+            EXPECT_FLOAT_EQ(-1, expected);
+            continue;
+        }
+
+        // path is in reverse order, and each leg must be clear of the fence
+        ASSERT_GE(numpoints, 2);
+        EXPECT_EQ(AP_OAVisGraph::OATYPE_DESTINATION, path[0].id_type);
+        EXPECT_EQ(AP_OAVisGraph::OATYPE_SOURCE, path[numpoints-1].id_type);
+        float length = 0;
+        Vector2f prev = destination;
+        for (uint8_t j=1; j<numpoints; j++) {
+            const Vector2f pos = (j == numpoints-1) ? source : graph.node(path[j].id_num);
+            EXPECT_FALSE(graph.intersects_fence(prev, pos));
+            length += (pos - prev).length();
+            prev = pos;
+        }
+        EXPECT_NEAR(expected, length, expected * 1e-5f);
+    }
+}
+
+TEST(VisGraph, build)
+{
+    TestFence fence;
+    make_fence(fence, 20, 4);
+    AP_OAVisGraph graph;
+    load_fence(graph, fence);
+    EXPECT_EQ(20 + 4 * exclusion_points + 6, graph.num_nodes());
+    check_visibility(graph);
+    check_paths(graph);
+}
+
+TEST(VisGraph, incremental)
+{
+    TestFence fence;
+    make_fence(fence, 60, max_exclusions);
+    AP_OAVisGraph graph;
+    load_fence(graph, fence);
+    const uint32_t full_tests = graph.get_pair_tests();
+
+    // reloading an unchanged fence tests nothing
+    load_fence(graph, fence);
+    EXPECT_EQ(0U, graph.get_pair_tests());
+    check_visibility(graph);
+
+    // moving one exclusion zone tests fewer pairs than a full build
+    for (uint8_t i=0; i<exclusion_points; i++) {
+        fence.exclusions[3][i] += Vector2f{3000, -2000};
+    }
+    load_fence(graph, fence);
+    EXPECT_LT(graph.get_pair_tests(), full_tests);
+    check_visibility(graph);
+    check_paths(graph);
+
+    // removing zones and moving the circle
+    fence.num_exclusions -= 2;
+    load_fence(graph, fence);
+    check_visibility(graph);
+    fence.circle_center += Vector2f{5000, 0};
+    load_fence(graph, fence);
+    check_visibility(graph);
+    check_paths(graph);
+
+    // and the graph matches one built from scratch
+    AP_OAVisGraph fresh;
+    load_fence(fresh, fence);
+    ASSERT_EQ(fresh.num_nodes(), graph.num_nodes());
+    for (uint8_t i=1; i<graph.num_nodes(); i++) {
+        for (uint8_t j=0; j<i; j++) {
+            EXPECT_EQ(fresh.visible(i, j), graph.visible(i, j));
+        }
+    }
+}
+
+TEST(VisGraph, limits)
+{
+    AP_OAVisGraph graph;
+    const Vector2f square[] = {{0, 0}, {0, 10}, {10, 10}, {10, 0}};
+
+    // nodes need an object
+    graph.begin_update();
+    EXPECT_FALSE(graph.add_node(Vector2f{1, 1}));
+    EXPECT_FALSE(graph.update());
+    EXPECT_EQ(0, graph.num_nodes());
+
+    // too many nodes leaves the previous graph in place
+    graph.begin_update();
+    EXPECT_TRUE(graph.add_polygon(AP_OAVisGraph::ObjectType::EXCLUSION_POLYGON, square, ARRAY_SIZE(square)));
+    EXPECT_TRUE(graph.add_node(Vector2f{20, 20}));
+    EXPECT_TRUE(graph.add_node(Vector2f{-10, -10}));
+    EXPECT_TRUE(graph.update());
+    EXPECT_EQ(2, graph.num_nodes());
+    EXPECT_FALSE(graph.visible(0, 1));
+    graph.begin_update();
+    EXPECT_TRUE(graph.add_polygon(AP_OAVisGraph::ObjectType::EXCLUSION_POLYGON, square, ARRAY_SIZE(square)));
+    for (uint16_t i=0; i<AP_OAVisGraph::max_nodes; i++) {
+        EXPECT_TRUE(graph.add_node(Vector2f{20, 20 + (float)i}));
+    }
+    EXPECT_FALSE(graph.add_node(Vector2f{20, 0}));
+    EXPECT_FALSE(graph.update());
+    EXPECT_EQ(2, graph.num_nodes());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,302 @@
+#include "AC_PolyFence_grid.h"
+
+#if AC_POLYFENCE_GRID_ENABLED
+
+#pragma GCC optimize("O2")
+
+bool AC_PolyFence_grid::init(uint16_t max_polygons)
+{
+    clear();
+    if (max_polygons == 0 || max_polygons > max_polygons_limit) {
+        return false;
+    }
+    _polygons = new Polygon[max_polygons];
+    if (_polygons == nullptr) {
+        return false;
+    }
+    _max_polygons = max_polygons;
+    return true;
+}
+
+bool AC_PolyFence_grid::add_polygon(const Vector2f *points, uint16_t count, bool inclusion)
+{
+    if (_num_polygons >= _max_polygons || built()) {
+        return false;
+    }
+    if (Polygon_complete(points, count)) {
+        count--;
+    }
+    if (count < 3) {
+        return false;
+    }
+    Polygon &polygon = _polygons[_num_polygons++];
+    polygon.points = points;
+    polygon.count = count;
+    polygon.inclusion = inclusion;
+    return true;
+}
+
+void AC_PolyFence_grid::clear_cells()
+{
+    delete[] _cell_start;
+    _cell_start = nullptr;
+    delete[] _cell_edges;
+    _cell_edges = nullptr;
+    delete[] _cell_breached;
+    _cell_breached = nullptr;
+    _nx = 0;
+    _ny = 0;
+}
+
+void AC_PolyFence_grid::clear()
+{
+    clear_cells();
+    delete[] _edges;
+    _edges = nullptr;
+    _num_edges = 0;
+    delete[] _polygons;
+    _polygons = nullptr;
+    _num_polygons = 0;
+    _max_polygons = 0;
+}
+
+uint16_t AC_PolyFence_grid::col(float x) const
+{
+    const float c = (x - _min.x) / _cell_size;
+    if (c <= 0) {
+        return 0;
+    }
+    if (c >= _nx - 1) {
+        return _nx - 1;
+    }
+    return uint16_t(c);
+}
+
+uint16_t AC_PolyFence_grid::row(float y) const
+{
+    const float r = (y - _min.y) / _cell_size;
+    if (r <= 0) {
+        return 0;
+    }
+    if (r >= _ny - 1) {
+        return _ny - 1;
+    }
+    return uint16_t(r);
+}
+
+/*
+  build the grid. Cells are square, with about one cell per edge so
+  that a typical cell lists only a few edges
+ */
+bool AC_PolyFence_grid::build()
+{
+    clear_cells();
+    delete[] _edges;
+    _edges = nullptr;
+    _num_edges = 0;
+
+    uint32_t total_edges = 0;
+    for (uint16_t i=0; i<_num_polygons; i++) {
+        total_edges += _polygons[i].count;
+    }
+    if (total_edges == 0 || total_edges > UINT16_MAX) {
+        return false;
+    }
+    _edges = new Edge[total_edges];
+    if (_edges == nullptr) {
+        return false;
+    }
+
+    _min = _polygons[0].points[0];
+    _max = _min;
+    for (uint16_t i=0; i<_num_polygons; i++) {
+        const Polygon &polygon = _polygons[i];
+        for (uint16_t j=0; j<polygon.count; j++) {
+            const Vector2f &p = polygon.points[j];
+            _min.x = MIN(_min.x, p.x);
+            _min.y = MIN(_min.y, p.y);
+            _max.x = MAX(_max.x, p.x);
+            _max.y = MAX(_max.y, p.y);
+            Edge &edge = _edges[_num_edges++];
+            edge.polygon = i;
+            edge.start = j;
+        }
+    }
+
+    const float width = MAX(_max.x - _min.x, 1.0f);
+    const float height = MAX(_max.y - _min.y, 1.0f);
+    const float target_cells = constrain_float(total_edges, 1, sq(max_cells_per_side));
+    _cell_size = MAX(sqrtf(width * height / target_cells),
+                     MAX(width, height) / max_cells_per_side);
+
+    // long diagonal edges cover many cells; if there are too many
+    // references to index, use larger cells
+    while (true) {
+        _nx = constrain_int16(ceilf(width / _cell_size), 1, max_cells_per_side);
+        _ny = constrain_int16(ceilf(height / _cell_size), 1, max_cells_per_side);
+        const bool single_cell = (_nx == 1 && _ny == 1);
+        if (fill_cells()) {
+            return true;
+        }
+        if (single_cell) {
+            // allocation failure
+            clear_cells();
+            return false;
+        }
+        _cell_size *= 2;
+    }
+}
+
+/*
+  fill the cells in two passes: count the edges in each cell, then
+  place the edge indexes using the running totals as cursors
+ */
+bool AC_PolyFence_grid::fill_cells()
+{
+    const uint16_t num_cells = _nx * _ny;
+    uint16_t *cell_start = new uint16_t[num_cells + 1];
+    if (cell_start == nullptr) {
+        return false;
+    }
+    memset(cell_start, 0, (num_cells + 1) * sizeof(uint16_t));
+
+    uint32_t total_refs = 0;
+    for (uint16_t i=0; i<_num_edges; i++) {
+        const Vector2f &a = edge_start(_edges[i]);
+        const Vector2f &b = edge_end(_edges[i]);
+        const uint16_t c0 = col(MIN(a.x, b.x));
+        const uint16_t c1 = col(MAX(a.x, b.x));
+        const uint16_t r0 = row(MIN(a.y, b.y));
+        const uint16_t r1 = row(MAX(a.y, b.y));
+        total_refs += (c1 - c0 + 1) * (r1 - r0 + 1);
+        if (total_refs > max_cell_refs) {
+            delete[] cell_start;
+            return false;
+        }
+        for (uint16_t r=r0; r<=r1; r++) {
+            for (uint16_t c=c0; c<=c1; c++) {
+                cell_start[r * _nx + c + 1]++;
+            }
+        }
+    }
+    for (uint16_t i=0; i<num_cells; i++) {
+        cell_start[i+1] += cell_start[i];
+    }
+
+    uint16_t *cell_edges = new uint16_t[MAX(total_refs, 1U)];
+    if (cell_edges == nullptr) {
+        delete[] cell_start;
+        return false;
+    }
+    for (uint16_t i=0; i<_num_edges; i++) {
+        const Vector2f &a = edge_start(_edges[i]);
+        const Vector2f &b = edge_end(_edges[i]);
+        const uint16_t c0 = col(MIN(a.x, b.x));
+        const uint16_t c1 = col(MAX(a.x, b.x));
+        const uint16_t r0 = row(MIN(a.y, b.y));
+        const uint16_t r1 = row(MAX(a.y, b.y));
+        for (uint16_t r=r0; r<=r1; r++) {
+            for (uint16_t c=c0; c<=c1; c++) {
+                cell_edges[cell_start[r * _nx + c]++] = i;
+            }
+        }
+    }
+    // each start was advanced to the next cell's start; move them back
+    for (uint16_t i=num_cells; i>0; i--) {
+        cell_start[i] = cell_start[i-1];
+    }
+    cell_start[0] = 0;
+
+    _cell_start = cell_start;
+    _cell_edges = cell_edges;
+
+    // positions in a cell with no edges are all breached or all not,
+    // so check once at the cell's centre
+    _cell_breached = new uint8_t[(num_cells + 7) / 8];
+    if (_cell_breached == nullptr) {
+        clear_cells();
+        return false;
+    }
+    memset(_cell_breached, 0, (num_cells + 7) / 8);
+    for (uint16_t i=0; i<num_cells; i++) {
+        if (cell_start[i] != cell_start[i+1]) {
+            continue;
+        }
+        const Vector2f centre{_min.x + ((i % _nx) + 0.5f) * _cell_size,
+                              _min.y + ((i / _nx) + 0.5f) * _cell_size};
+        if (breached_scan(centre)) {
+            _cell_breached[i / 8] |= 1U << (i % 8);
+        }
+    }
+    return true;
+}
+
+/*
+  count the crossings of a ray from pos with each polygon, as
+  Polygon_outside does.  Only edges in the cells of pos's row between
+  pos and the side of the grid can cross the ray, so the ray is cast
+  towards the nearer side.  Every edge straddling pos.y crosses the
+  line through pos either left or right of pos, and a closed polygon
+  has an even number of them, so counting the crossings to the left
+  gives the same parity as Polygon_outside's count to the right.  An
+  edge listed in several of the cells is tested only in the first of
+  them
+ */
+bool AC_PolyFence_grid::breached_scan(const Vector2f &pos) const
+{
+    uint32_t inside[(max_polygons_limit + 31) / 32] {};
+
+    if (pos.y >= _min.y && pos.y <= _max.y && pos.x >= _min.x && pos.x <= _max.x) {
+        const uint16_t r = row(pos.y);
+        const uint16_t c0 = col(pos.x);
+        const bool right = c0 >= _nx / 2;
+        const uint16_t c_begin = right ? c0 : 0;
+        const uint16_t c_end = right ? _nx - 1 : c0;
+        for (uint16_t c=c_begin; c<=c_end; c++) {
+            const uint16_t cell = r * _nx + c;
+            for (uint16_t i=_cell_start[cell]; i<_cell_start[cell+1]; i++) {
+                const Edge &edge = _edges[_cell_edges[i]];
+                const Vector2f &a = edge_start(edge);
+                const Vector2f &b = edge_end(edge);
+                if ((a.y > pos.y) == (b.y > pos.y)) {
+                    continue;
+                }
+                if (MAX(col(MIN(a.x, b.x)), c_begin) != c) {
+                    continue;
+                }
+                const float dx1 = pos.x - a.x;
+                const float dx2 = b.x - a.x;
+                const float dy1 = pos.y - a.y;
+                const float dy2 = b.y - a.y;
+                const bool crosses_right = (dy2 < 0) ? (dx1 * dy2 > dx2 * dy1) : (dx1 * dy2 < dx2 * dy1);
+                if (crosses_right == right) {
+                    inside[edge.polygon / 32] ^= 1U << (edge.polygon % 32);
+                }
+            }
+        }
+    }
+
+    for (uint16_t i=0; i<_num_polygons; i++) {
+        const bool is_inside = inside[i / 32] & (1U << (i % 32));
+        if (is_inside != _polygons[i].inclusion) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AC_PolyFence_grid::breached(const Vector2f &pos) const
+{
+    if (!built()) {
+        return false;
+    }
+    if (pos.y >= _min.y && pos.y <= _max.y && pos.x >= _min.x && pos.x <= _max.x) {
+        const uint16_t cell = row(pos.y) * _nx + col(pos.x);
+        if (_cell_start[cell] == _cell_start[cell+1]) {
+            return _cell_breached[cell / 8] & (1U << (cell % 8));
+        }
+    }
+    return breached_scan(pos);
+}
+
+#endif // AC_POLYFENCE_GRID_ENABLED
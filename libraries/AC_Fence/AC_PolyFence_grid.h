@@ -0,0 +1,111 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+#ifndef AC_POLYFENCE_GRID_ENABLED
+#define AC_POLYFENCE_GRID_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
+/*
+  AC_PolyFence_grid - a uniform grid over the loaded polygon fences,
+  where each cell lists the fence edges whose bounding box overlaps
+  it.  A breach check in a cell with no edges is a lookup, and
+  otherwise looks only at the edges in the vehicle's row of cells.  So
+  the cost of a check grows with the number of nearby edges rather
+  than the number of vertices in all fences.
+
+  The grid holds pointers to the polygon points, so it must be cleared
+  before they are freed.
+ */
+class AC_PolyFence_grid {
+public:
+    AC_PolyFence_grid() {}
+    ~AC_PolyFence_grid() { clear(); }
+
+    /* Do not allow copies */
+    AC_PolyFence_grid(const AC_PolyFence_grid &other) = delete;
+    AC_PolyFence_grid &operator=(const AC_PolyFence_grid&) = delete;
+
+    // init - make space for max_polygons polygons, removing any
+    // existing index.  returns false on allocation failure
+    bool init(uint16_t max_polygons) WARN_IF_UNUSED;
+
+    // add_polygon - add a polygon to be indexed.  If the last point
+    // is the same as the first it is ignored, as with Polygon_outside
+    bool add_polygon(const Vector2f *points, uint16_t count, bool inclusion) WARN_IF_UNUSED;
+
+    // build - index the polygons added.  returns false if there is
+    // nothing to index or on allocation failure
+    bool build() WARN_IF_UNUSED;
+
+    // clear - free all resources
+    void clear();
+
+    // built - returns true if the index can be used
+    bool built() const { return _cell_start != nullptr; }
+
+    // breached - returns true if pos is outside any inclusion polygon
+    // or inside any exclusion polygon
+    bool breached(const Vector2f &pos) const WARN_IF_UNUSED;
+
+private:
+    // most polygons the breach check can track
+    static const uint16_t max_polygons_limit = 512;
+    // most cells along each side of the grid
+    static const uint16_t max_cells_per_side = 64;
+    // most edge references in all cells, bounding _cell_edges to 16kB
+    static const uint16_t max_cell_refs = 8192;
+
+    struct Polygon {
+        const Vector2f *points;
+        uint16_t count;         // number of edges
+        bool inclusion;
+    };
+    Polygon *_polygons = nullptr;
+    uint16_t _num_polygons = 0;
+    uint16_t _max_polygons = 0;
+
+    struct Edge {
+        uint16_t polygon;
+        uint16_t start;         // index of first point in the polygon
+    };
+    Edge *_edges = nullptr;
+    uint16_t _num_edges = 0;
+
+    // the grid: cell (col,row) is at row*_nx+col, and lists the edges
+    // in _cell_edges[_cell_start[cell]] to _cell_edges[_cell_start[cell+1]-1]
+    Vector2f _min;
+    Vector2f _max;
+    float _cell_size = 1.0f;
+    uint16_t _nx = 0;
+    uint16_t _ny = 0;
+    uint16_t *_cell_start = nullptr;
+    uint16_t *_cell_edges = nullptr;
+    // one bit per cell: if the cell has no edges, it is wholly inside
+    // or outside each polygon, and this is whether it is breached
+    uint8_t *_cell_breached = nullptr;
+
+    const Vector2f &edge_start(const Edge &edge) const {
+        return _polygons[edge.polygon].points[edge.start];
+    }
+    const Vector2f &edge_end(const Edge &edge) const {
+        const Polygon &polygon = _polygons[edge.polygon];
+        const uint16_t end = edge.start + 1;
+        return polygon.points[end < polygon.count ? end : 0];
+    }
+
+    // column and row containing a position, clamped to the grid
+    uint16_t col(float x) const;
+    uint16_t row(float y) const;
+
+    // breach check by counting edge crossings along pos's row
+    bool breached_scan(const Vector2f &pos) const;
+
+    // fill in the cells, returning false if there are too many edge
+    // references for the index or on allocation failure
+    bool fill_cells();
+
+    // free the grid but keep the polygons
+    void clear_cells();
+};
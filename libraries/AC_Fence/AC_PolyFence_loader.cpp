@@ -202,13 +202,15 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
     return breached(posNE);
 }
 
-// check if a position (expressed as offsets in cm from the EKF origin) is within the boundary
-//   returns true if location is outside the boundary
-bool AC_PolyFence_loader::breached(const Vector2f& pos_cm) const
+// returns true if pos_cm is outside any inclusion polygon or inside
+// any exclusion polygon
+bool AC_PolyFence_loader::polygon_breached(const Vector2f& pos_cm) const
 {
-    if (!loaded()) {
-        return false;
+#if AC_POLYFENCE_GRID_ENABLED
+    if (_grid.built()) {
+        return _grid.breached(pos_cm);
     }
+#endif
 
     // check we are inside each inclusion zone:
     for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
@@ -226,6 +228,22 @@ bool AC_PolyFence_loader::breached(const Vector2f& pos_cm) const
         }
     }
 
+    return false;
+}
+
+// check if a position (expressed as offsets in cm from the EKF origin) is within the boundary
+//   returns true if location is outside the boundary
+bool AC_PolyFence_loader::breached(const Vector2f& pos_cm) const
+{
+    if (!loaded()) {
+        return false;
+    }
+
+    // check inclusion and exclusion zones:
+    if (polygon_breached(pos_cm)) {
+        return true;
+    }
+
     // check circular excludes
     for (uint8_t i=0; i<_num_loaded_circle_exclusion_boundaries; i++) {
         const ExclusionCircle &circle = _loaded_circle_exclusion_boundary[i];
@@ -542,6 +560,11 @@ bool AC_PolyFence_loader::check_indexed()
 
 void AC_PolyFence_loader::unload()
 {
+#if AC_POLYFENCE_GRID_ENABLED
+    // the index points into _loaded_offsets_from_origin
+    _grid.clear();
+#endif
+
     delete[] _loaded_offsets_from_origin;
     _loaded_offsets_from_origin = nullptr;
 
@@ -565,6 +588,36 @@ void AC_PolyFence_loader::unload()
     _load_time_ms = 0;
 }
 
+// build the index of the loaded polygon fences.  If it can't be built
+// breach checks fall back to checking every edge
+void AC_PolyFence_loader::index_loaded_polygons()
+{
+#if AC_POLYFENCE_GRID_ENABLED
+    const uint16_t num_polygons = _num_loaded_inclusion_boundaries + _num_loaded_exclusion_boundaries;
+    if (num_polygons == 0 || !_grid.init(num_polygons)) {
+        return;
+    }
+    for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
+        const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
+        if (!_grid.add_polygon(boundary.points, boundary.count, true)) {
+            _grid.clear();
+            return;
+        }
+    }
+    for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
+        const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
+        if (!_grid.add_polygon(boundary.points, boundary.count, false)) {
+            _grid.clear();
+            return;
+        }
+    }
+    if (!_grid.build()) {
+        Debug("Fence: unable to index polygons");
+        _grid.clear();
+    }
+#endif
+}
+
 // return the number of fences of type type in the index:
 uint16_t AC_PolyFence_loader::index_fence_count(const AC_PolyFenceType type)
 {
@@ -807,6 +860,8 @@ bool AC_PolyFence_loader::load_from_eeprom()
         return false;
     }
 
+    index_loaded_polygons();
+
     _load_time_ms = AP_HAL::millis();
 
     get_loaded_fence_semaphore().give();
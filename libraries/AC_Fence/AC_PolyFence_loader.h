@@ -5,6 +5,8 @@
 #include <AP_Math/AP_Math.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
+#include "AC_PolyFence_grid.h"
+
 #define AC_POLYFENCE_FENCE_POINT_PROTOCOL_SUPPORT 1
 
 enum class AC_PolyFenceType {
@@ -244,6 +246,14 @@ private:
     // example, in _loaded_offsets_from_origin
     void unload();
 
+    // index_loaded_polygons - build _grid from the loaded inclusion
+    // and exclusion polygons
+    void index_loaded_polygons();
+
+    // polygon_breached - returns true if pos_cm is outside any
+    // inclusion polygon or inside any exclusion polygon
+    bool polygon_breached(const Vector2f& pos_cm) const WARN_IF_UNUSED;
+
     // pointer into _loaded_offsets_from_origin where the return point
     // can be found:
     Vector2f *_loaded_return_point;
@@ -286,6 +296,13 @@ private:
     InclusionCircle *_loaded_circle_inclusion_boundary;
     uint8_t _num_loaded_circle_inclusion_boundaries;
 
+#if AC_POLYFENCE_GRID_ENABLED
+    // _grid - index of the loaded polygon edges for breach checks.
+    // Not built if it could not be allocated, in which case every
+    // edge is checked
+    AC_PolyFence_grid _grid;
+#endif
+
     // _load_attempted - true if we have attempted to load the fences
     // from storage into _loaded_circle_exclusion_boundary,
     // _loaded_offsets_from_origin etc etc
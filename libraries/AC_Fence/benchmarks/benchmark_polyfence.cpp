@@ -0,0 +1,111 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_Fence/AC_PolyFence_grid.h>
+#include <AP_Math/tests/random_test.h>
+
+/*
+  polygon fence breach checks for synthetic survey sites of 10 to 2000
+  vertices: an inclusion fence with an exclusion zone of 10 vertices
+  for every 20 vertices in the site. Each check is made by testing
+  every edge of every polygon, as the fence loader did, and with the
+  grid index
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t exclusion_points = 10;
+static const uint16_t num_positions = 1024;
+
+struct Fence {
+    Vector2f *points[1 + 2000 / (2 * exclusion_points)];
+    uint16_t counts[1 + 2000 / (2 * exclusion_points)];
+    uint16_t num_polygons;
+    Vector2f positions[num_positions];
+    AC_PolyFence_grid grid;
+};
+
+static void make_fence(Fence &fence, uint16_t total_points)
+{
+    rand_seed(1);
+    const uint16_t num_exclusions = total_points / (2 * exclusion_points);
+    fence.num_polygons = 1 + num_exclusions;
+    fence.counts[0] = total_points - num_exclusions * exclusion_points;
+    fence.points[0] = new Vector2f[fence.counts[0]];
+    make_polygon(fence.points[0], fence.counts[0], Vector2f{0, 0}, 120000, 200000);
+    for (uint16_t i=1; i<fence.num_polygons; i++) {
+        fence.counts[i] = exclusion_points;
+        fence.points[i] = new Vector2f[exclusion_points];
+        make_polygon(fence.points[i], exclusion_points,
+                     Vector2f{rand_float(-80000, 80000), rand_float(-80000, 80000)}, 1800, 3000);
+    }
+    if (!fence.grid.init(fence.num_polygons)) {
+        abort();
+    }
+    for (uint16_t i=0; i<fence.num_polygons; i++) {
+        if (!fence.grid.add_polygon(fence.points[i], fence.counts[i], i == 0)) {
+            abort();
+        }
+    }
+    if (!fence.grid.build()) {
+        abort();
+    }
+    for (uint16_t i=0; i<num_positions; i++) {
+        fence.positions[i] = Vector2f{rand_float(-150000, 150000), rand_float(-150000, 150000)};
+    }
+}
+
+static void free_fence(Fence &fence)
+{
+    fence.grid.clear();
+    for (uint16_t i=0; i<fence.num_polygons; i++) {
+        delete[] fence.points[i];
+    }
+}
+
+static bool breached_linear(const Fence &fence, const Vector2f &pos)
+{
+    if (Polygon_outside(pos, fence.points[0], fence.counts[0])) {
+        return true;
+    }
+    for (uint16_t i=1; i<fence.num_polygons; i++) {
+        if (!Polygon_outside(pos, fence.points[i], fence.counts[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void BM_BreachedLinear(benchmark::State& state)
+{
+    Fence fence;
+    make_fence(fence, state.range_x());
+    uint16_t n = 0;
+    bool breached = false;
+    while (state.KeepRunning()) {
+        breached ^= breached_linear(fence, fence.positions[n]);
+        n = (n + 1) % num_positions;
+    }
+    gbenchmark_escape(&breached);
+    state.SetItemsProcessed(state.iterations());
+    free_fence(fence);
+}
+
+static void BM_BreachedGrid(benchmark::State& state)
+{
+    Fence fence;
+    make_fence(fence, state.range_x());
+    uint16_t n = 0;
+    bool breached = false;
+    while (state.KeepRunning()) {
+        breached ^= fence.grid.breached(fence.positions[n]);
+        n = (n + 1) % num_positions;
+    }
+    gbenchmark_escape(&breached);
+    state.SetItemsProcessed(state.iterations());
+    free_fence(fence);
+}
+
+BENCHMARK(BM_BreachedLinear)->Arg(10)->Arg(100)->Arg(500)->Arg(2000);
+BENCHMARK(BM_BreachedGrid)->Arg(10)->Arg(100)->Arg(500)->Arg(2000);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,100 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AC_Fence/AC_PolyFence_grid.h>
+#include <AP_Math/tests/random_test.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// reference result from checking every polygon
+static bool brute_breached(const Vector2f &pos,
+                           const Vector2f *const *polygons, const uint16_t *counts,
+                           const bool *inclusion, uint16_t num_polygons)
+{
+    for (uint16_t i=0; i<num_polygons; i++) {
+        if (Polygon_outside(pos, polygons[i], counts[i]) == inclusion[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// an inclusion fence with exclusion zones inside it
+static void check_fence(uint16_t inclusion_points, uint16_t num_exclusions, uint16_t exclusion_points)
+{
+    const uint16_t num_polygons = 1 + num_exclusions;
+    Vector2f *polygons[64];
+    uint16_t counts[64];
+    bool inclusion[64];
+    ASSERT_LE(num_polygons, ARRAY_SIZE(polygons));
+
+    polygons[0] = new Vector2f[inclusion_points];
+    counts[0] = inclusion_points;
+    inclusion[0] = true;
+    make_polygon(polygons[0], inclusion_points, Vector2f{0, 0}, 30000, 100000);
+    for (uint16_t i=1; i<num_polygons; i++) {
+        polygons[i] = new Vector2f[exclusion_points];
+        counts[i] = exclusion_points;
+        inclusion[i] = false;
+        make_polygon(polygons[i], exclusion_points,
+                     Vector2f{rand_float(-20000, 20000), rand_float(-20000, 20000)}, 1500, 5000);
+    }
+
+    AC_PolyFence_grid grid;
+    EXPECT_TRUE(grid.init(num_polygons));
+    for (uint16_t i=0; i<num_polygons; i++) {
+        EXPECT_TRUE(grid.add_polygon(polygons[i], counts[i], inclusion[i]));
+    }
+    EXPECT_TRUE(grid.build());
+    EXPECT_TRUE(grid.built());
+
+    for (uint16_t i=0; i<2000; i++) {
+        const Vector2f pos{rand_float(-120000, 120000), rand_float(-120000, 120000)};
+        EXPECT_EQ(brute_breached(pos, polygons, counts, inclusion, num_polygons),
+                  grid.breached(pos));
+    }
+
+    grid.clear();
+    for (uint16_t i=0; i<num_polygons; i++) {
+        delete[] polygons[i];
+    }
+}
+
+TEST(PolyFenceGrid, single_polygon)
+{
+    check_fence(10, 0, 0);
+    check_fence(500, 0, 0);
+}
+
+TEST(PolyFenceGrid, exclusions)
+{
+    check_fence(20, 5, 10);
+    check_fence(1000, 50, 20);
+}
+
+TEST(PolyFenceGrid, closed_polygon)
+{
+    // a closing point is ignored, as by Polygon_outside
+    const Vector2f square[] = {{0, 0}, {0, 10}, {10, 10}, {10, 0}, {0, 0}};
+    AC_PolyFence_grid grid;
+    EXPECT_TRUE(grid.init(1));
+    EXPECT_TRUE(grid.add_polygon(square, ARRAY_SIZE(square), true));
+    EXPECT_TRUE(grid.build());
+    EXPECT_FALSE(grid.breached(Vector2f{5, 5}));
+    EXPECT_TRUE(grid.breached(Vector2f{15, 5}));
+    EXPECT_TRUE(grid.breached(Vector2f{-5, 5}));
+}
+
+TEST(PolyFenceGrid, invalid)
+{
+    const Vector2f line[] = {{0, 0}, {0, 10}};
+    AC_PolyFence_grid grid;
+    EXPECT_FALSE(grid.built());
+    EXPECT_FALSE(grid.init(0));
+    EXPECT_TRUE(grid.init(1));
+    EXPECT_FALSE(grid.add_polygon(line, ARRAY_SIZE(line), true));
+    EXPECT_FALSE(grid.build());
+    EXPECT_FALSE(grid.built());
+}
+
+AP_GTEST_MAIN()
@@ -34,13 +34,17 @@ AP_FlashStorage::AP_FlashStorage(uint8_t *_mem_buffer,
                                  FlashWrite _flash_write,
                                  FlashRead _flash_read,
                                  FlashErase _flash_erase,
-                                 FlashEraseOK _flash_erase_ok) :
+                                 FlashEraseOK _flash_erase_ok,
+                                 uint8_t _num_sectors) :
     mem_buffer(_mem_buffer),
     flash_sector_size(_flash_sector_size),
     flash_write(_flash_write),
     flash_read(_flash_read),
     flash_erase(_flash_erase),
-    flash_erase_ok(_flash_erase_ok) {}
+    flash_erase_ok(_flash_erase_ok),
+    // without multiple writes we can't mark a sector obsolete, so
+    // only two sectors can be used
+    num_sectors(AP_FLASHSTORAGE_MULTI_WRITE?constrain_int16(_num_sectors, 2, max_sectors):2) {}
 
 // initialise storage
 bool AP_FlashStorage::init(void)
@@ -50,20 +54,46 @@ bool AP_FlashStorage::init(void)
     // start with empty memory buffer
     memset(mem_buffer, 0, storage_size);
 
+    // clear any write error and compaction state
+    write_error = false;
+    reserved_space = 0;
+    compacting = false;
+    obsolete_mask = 0;
+
     // find state of sectors
-    struct sector_header header[2];
+    int8_t in_use_sector = -1;
+    int8_t full_sector = -1;
 
     // read headers and possibly initialise if bad signature
-    for (uint8_t i=0; i<2; i++) {
-        if (!flash_read(i, 0, (uint8_t *)&header[i], sizeof(header[i]))) {
+    for (uint8_t i=0; i<num_sectors; i++) {
+        struct sector_header header;
+        if (!flash_read(i, 0, (uint8_t *)&header, sizeof(header))) {
             return false;
         }
-        bool bad_header = (header[i].signature != signature);
-        enum SectorState state = (enum SectorState)header[i].state;
-        if (state != SECTOR_STATE_AVAILABLE &&
-            state != SECTOR_STATE_IN_USE &&
-            state != SECTOR_STATE_FULL) {
+        bool bad_header = (header.signature != signature);
+        switch ((enum SectorState)header.state) {
+        case SECTOR_STATE_AVAILABLE:
+            break;
+        case SECTOR_STATE_IN_USE:
+            if (in_use_sector != -1) {
+                bad_header = true;
+            }
+            in_use_sector = i;
+            break;
+        case SECTOR_STATE_FULL:
+            if (full_sector != -1) {
+                bad_header = true;
+            }
+            full_sector = i;
+            break;
+#if AP_FLASHSTORAGE_MULTI_WRITE
+        case SECTOR_STATE_OBSOLETE:
+            obsolete_mask |= 1U<<i;
+            break;
+#endif
+        default:
             bad_header = true;
+            break;
         }
 
         // initialise if bad header
@@ -72,68 +102,54 @@ bool AP_FlashStorage::init(void)
         }
     }
 
-    // work out the first sector to read from using sector states
-    enum SectorState states[2] {(enum SectorState)header[0].state, (enum SectorState)header[1].state};
-    uint8_t first_sector;
+    if (in_use_sector == -1 && full_sector == -1) {
+        return erase_all();
+    }
+
+    // sectors we had finished with can be erased now
+    if (!erase_obsolete()) {
+        return false;
+    }
 
-    if (states[0] == states[1]) {
-        if (states[0] != SECTOR_STATE_AVAILABLE) {
+    // load the full sector first, as the sector in use has newer data
+    if (full_sector != -1 && !load_sector(full_sector)) {
+        return erase_all();
+    }
+    if (in_use_sector != -1) {
+        if (!load_sector(in_use_sector)) {
             return erase_all();
         }
-        first_sector = 0;
-    } else if (states[0] == SECTOR_STATE_FULL) {
-        first_sector = 0;
-    } else if (states[1] == SECTOR_STATE_FULL) {
-        first_sector = 1;
-    } else if (states[0] == SECTOR_STATE_IN_USE) {
-        first_sector = 0;
-    } else if (states[1] == SECTOR_STATE_IN_USE) {
-        first_sector = 1;
+        current_sector = in_use_sector;
     } else {
-        // doesn't matter which is first
-        first_sector = 0;
-    }
-
-    // load data from any current sectors
-    for (uint8_t i=0; i<2; i++) {
-        uint8_t sector = (first_sector + i) & 1;
-        if (states[sector] == SECTOR_STATE_IN_USE ||
-            states[sector] == SECTOR_STATE_FULL) {
-            if (!load_sector(sector)) {
-                return erase_all();
-            }
+        // we lost power while switching sectors
+        int8_t new_sector = find_available_sector(full_sector);
+        if (new_sector == -1) {
+            return re_write_all();
+        }
+        if (!write_sector_state(new_sector, SECTOR_STATE_IN_USE)) {
+            return false;
         }
+        current_sector = new_sector;
+        write_offset = sizeof(struct sector_header);
     }
 
-    // clear any write error
-    write_error = false;
-    reserved_space = 0;
-    
-    // if the first sector is full then write out all data so we can erase it
-    if (states[first_sector] == SECTOR_STATE_FULL) {
-        current_sector = first_sector ^ 1;
+    // if a sector is full then write out all data so we can erase it
+    if (full_sector != -1) {
         if (!write_all()) {
-            return erase_all();
+            // the sector in use doesn't have room, which can happen
+            // if we lost power while a full sector was being
+            // erased. Start again from what we have loaded
+            return re_write_all();
         }
-    }
-
-    // erase any sectors marked full
-    for (uint8_t i=0; i<2; i++) {
-        if (states[i] == SECTOR_STATE_FULL) {
-            if (!erase_sector(i, true)) {
-                return false;
-            }
+        if (!erase_sector(full_sector, true)) {
+            return false;
         }
     }
 
-    reserved_space = 0;
-    
     // ready to use
     return true;
 }
 
-
-
 // switch full sector - should only be called when safe to have CPU
 // offline for considerable periods as an erase will be needed
 bool AP_FlashStorage::switch_full_sector(void)
@@ -142,13 +158,27 @@ bool AP_FlashStorage::switch_full_sector(void)
     
     // clear any write error
     write_error = false;
-    reserved_space = 0;
-    
-    if (!write_all()) {
-        return false;
+
+    if (compacting) {
+        // we can use the space reserved for init() to finish copying
+        // the full sector, as we are about to erase it
+        reserved_space = 0;
+        if (!finish_compaction()) {
+            return false;
+        }
+    } else if (num_sectors == 2 && reserved_space != 0) {
+        // with two sectors the full sector isn't compacted, so write
+        // out everything before erasing it
+        reserved_space = 0;
+        if (!write_all()) {
+            return false;
+        }
+        if (!erase_sector(current_sector ^ 1, true)) {
+            return false;
+        }
     }
 
-    if (!erase_sector(current_sector ^ 1, true)) {
+    if (!erase_obsolete()) {
         return false;
     }
 
@@ -161,6 +191,18 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
     if (write_error) {
         return false;
     }
+    const uint32_t start_us = AP_HAL::micros();
+    const bool ret = write_blocks(offset, length, true);
+    update_max_stall(start_us);
+    return ret;
+}
+
+/*
+  write blocks covering offset and length from mem_buffer to the
+  current sector
+ */
+bool AP_FlashStorage::write_blocks(uint16_t offset, uint16_t length, bool allow_switch)
+{
     //debug("write at %u for %u write_offset=%u\n", offset, length, write_offset);
     
     while (length > 0) {
@@ -170,6 +212,9 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
         }
 
         if (write_offset > flash_sector_size - (sizeof(struct block_header) + max_write + reserved_space)) {
+            if (!allow_switch) {
+                return false;
+            }
             if (!switch_sectors()) {
                 if (!flash_erase_ok()) {
                     return false;
@@ -216,6 +261,111 @@ bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
     return true;
 }
 
+/*
+  copy a full sector into the current sector a piece at a time,
+  within the time budget. Erase a sector we have finished with if we
+  are allowed to
+ */
+void AP_FlashStorage::background(void)
+{
+    if (write_error) {
+        return;
+    }
+    const uint32_t start_us = AP_HAL::micros();
+    // always make some progress, however small the budget
+    while (compacting && compact_step()) {
+        if (AP_HAL::micros() - start_us >= compaction_budget_us) {
+            break;
+        }
+    }
+    update_max_stall(start_us);
+
+    // an erase is only done when the caller allows the CPU to stall,
+    // so doesn't count towards max_stall_us
+    if (!compacting && obsolete_mask != 0 && flash_erase_ok()) {
+        erase_obsolete();
+    }
+}
+
+/*
+  write the next non-zero part of mem_buffer to the current
+  sector. Zero parts don't need writing as a sector loads into a
+  zeroed mem_buffer. Newer writes to the same part follow in the log,
+  so copying mem_buffer as it is now is always safe
+ */
+bool AP_FlashStorage::compact_step(void)
+{
+    while (compact_offset < storage_size) {
+        // local variable needed to overcome problem with MIN() macro and -O0
+        const uint8_t max_write_local = max_write;
+        uint8_t n = MIN(max_write_local, storage_size-compact_offset);
+        if (!all_zero(compact_offset, n)) {
+            // keep within reserved_space so a power loss leaves room
+            // for init() to copy everything again
+            if (!write_blocks(compact_offset, n, false)) {
+                return false;
+            }
+            compact_offset += n;
+            break;
+        }
+        compact_offset += n;
+    }
+    if (compact_offset < storage_size) {
+        return true;
+    }
+
+    debug("compacted sector %u\n", compact_sector);
+    compacting = false;
+    obsolete_mask |= 1U<<compact_sector;
+#if AP_FLASHSTORAGE_MULTI_WRITE
+    // record that we no longer need the full sector, so init()
+    // doesn't copy it again and we don't need to keep space for that
+    if (!write_sector_state(compact_sector, SECTOR_STATE_OBSOLETE)) {
+        return false;
+    }
+    reserved_space = 0;
+#endif
+    return true;
+}
+
+/*
+  finish copying the full sector
+ */
+bool AP_FlashStorage::finish_compaction(void)
+{
+    while (compacting) {
+        if (!compact_step()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  erase sectors we have finished with, making them available
+ */
+bool AP_FlashStorage::erase_obsolete(void)
+{
+    for (uint8_t i=0; i<num_sectors; i++) {
+        if (obsolete_mask & (1U<<i)) {
+            if (!erase_sector(i, true)) {
+                return false;
+            }
+            obsolete_mask &= ~(1U<<i);
+        }
+    }
+    if (!compacting) {
+        // no full sector is left for init() to copy
+        reserved_space = 0;
+    }
+    return true;
+}
+
+void AP_FlashStorage::update_max_stall(uint32_t start_us)
+{
+    max_stall_us = MAX(max_stall_us, AP_HAL::micros() - start_us);
+}
+
 /*
   load all data from a flash sector into mem_buffer
  */
@@ -284,34 +434,41 @@ bool AP_FlashStorage::erase_sector(uint8_t sector, bool mark_available)
     if (!mark_available) {
         return true;
     }
+    return write_sector_state(sector, SECTOR_STATE_AVAILABLE);
+}
+
+/*
+  write the header of a sector
+ */
+bool AP_FlashStorage::write_sector_state(uint8_t sector, enum SectorState state)
+{
     struct sector_header header;
     header.signature = signature;
-    header.state = SECTOR_STATE_AVAILABLE;
+    header.state = state;
     return flash_write(sector, 0, (const uint8_t *)&header, sizeof(header));
 }
 
 /*
-  erase both sectors
+  erase all sectors
  */
 bool AP_FlashStorage::erase_all(void)
 {
     write_error = false;
+    reserved_space = 0;
+    compacting = false;
+    obsolete_mask = 0;
 
     current_sector = 0;
     write_offset = sizeof(struct sector_header);
-    
-    if (!erase_sector(0, current_sector!=0)) {
-        return false;
-    }
-    if (!erase_sector(1, current_sector!=1)) {
-        return false;
+
+    for (uint8_t i=0; i<num_sectors; i++) {
+        if (!erase_sector(i, current_sector!=i)) {
+            return false;
+        }
     }
     
     // mark current sector as in-use
-    struct sector_header header;
-    header.signature = signature;
-    header.state = SECTOR_STATE_IN_USE;
-    return flash_write(current_sector, 0, (const uint8_t *)&header, sizeof(header));    
+    return write_sector_state(current_sector, SECTOR_STATE_IN_USE);
 }
 
 /*
@@ -326,7 +483,7 @@ bool AP_FlashStorage::write_all()
         const uint8_t max_write_local = max_write;
         uint8_t n = MIN(max_write_local, storage_size-ofs);
         if (!all_zero(ofs, n)) {
-            if (!write(ofs, n)) {
+            if (!write_blocks(ofs, n, false)) {
                 return false;
             }
         }
@@ -345,50 +502,73 @@ bool AP_FlashStorage::all_zero(uint16_t ofs, uint16_t size)
     return true;
 }
 
+/*
+  find an available sector, trying those after the given sector
+  first so that wear is spread over all sectors
+ */
+int8_t AP_FlashStorage::find_available_sector(uint8_t after)
+{
+    for (uint8_t i=1; i<num_sectors; i++) {
+        const uint8_t sector = (after + i) % num_sectors;
+        if (obsolete_mask & (1U<<sector)) {
+            continue;
+        }
+        struct sector_header header;
+        if (!flash_read(sector, 0, (uint8_t *)&header, sizeof(header))) {
+            continue;
+        }
+        if (header.signature == signature &&
+            SECTOR_STATE_AVAILABLE == (enum SectorState)header.state) {
+            return sector;
+        }
+    }
+    return -1;
+}
+
 // switch to next sector for writing
 bool AP_FlashStorage::switch_sectors(void)
 {
-    if (reserved_space != 0) {
-        // other sector is already full
-        debug("both sectors are full\n");
+    // the last full sector has to be copied before another fills
+    if (compacting && !finish_compaction()) {
         return false;
     }
 
-    struct sector_header header;
-    header.signature = signature;
-
-    uint8_t new_sector = current_sector ^ 1;
-    debug("switching to sector %u\n", new_sector);
-    
-    // check sector is available
-    if (!flash_read(new_sector, 0, (uint8_t *)&header, sizeof(header))) {
-        return false;
-    }
-    if (header.signature != signature) {
-        write_error = true;
+    if (reserved_space != 0) {
+        // the last full sector hasn't been erased
+        debug("full sector not erased\n");
         return false;
     }
-    if (SECTOR_STATE_AVAILABLE != (enum SectorState)header.state) {
-        write_error = true;
-        debug("both sectors full\n");
+
+    int8_t new_sector = find_available_sector(current_sector);
+    if (new_sector == -1) {
+        debug("no sector available\n");
         return false;
     }
+    debug("switching to sector %u\n", new_sector);
 
     // mark current sector as full. This needs to be done before we
     // mark the new sector as in-use so that a power failure between
     // the two steps doesn't leave us with an erase on the
     // reboot. Thanks to night-ghost for spotting this.
-    header.state = SECTOR_STATE_FULL;
-    if (!flash_write(current_sector, 0, (const uint8_t *)&header, sizeof(header))) {
+    if (!write_sector_state(current_sector, SECTOR_STATE_FULL)) {
         return false;
     }
 
     // mark new sector as in-use
-    header.state = SECTOR_STATE_IN_USE;
-    if (!flash_write(new_sector, 0, (const uint8_t *)&header, sizeof(header))) {
+    if (!write_sector_state(new_sector, SECTOR_STATE_IN_USE)) {
         return false;
     }
 
+    // with more than two sectors the full sector is copied to the
+    // new one from background(). With two we keep the layout older
+    // firmware knows, and the full sector is written out and erased
+    // by switch_full_sector() once the new one fills
+    if (num_sectors > 2) {
+        compacting = true;
+        compact_sector = current_sector;
+        compact_offset = 0;
+    }
+
     // switch sectors
     current_sector = new_sector;
         
@@ -396,7 +576,7 @@ bool AP_FlashStorage::switch_sectors(void)
     // full write out on init()
     reserved_space = reserve_size;
     
-    write_offset = sizeof(header);
+    write_offset = sizeof(struct sector_header);
     return true;    
 }
 
@@ -408,6 +588,14 @@ bool AP_FlashStorage::re_initialise(void)
     if (!flash_erase_ok()) {
         return false;
     }
+    return re_write_all();
+}
+
+/*
+  erase all sectors and write out mem_buffer
+ */
+bool AP_FlashStorage::re_write_all(void)
+{
     if (!erase_all()) {
         return false;        
     }
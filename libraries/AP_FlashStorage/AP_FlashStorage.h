@@ -17,10 +17,11 @@
 /*
   a class to allow for FLASH to be used as a memory backed storage
   backend for any HAL. The basic methodology is to use a log based
-  storage system over two flash sectors. Key design elements:
+  storage system over two or more flash sectors. Key design elements:
 
-  - erase of sectors only called on init, as erase will lock the flash
-    and prevent code execution
+  - erase of sectors only called on init, or when the caller says
+    erasing is OK, as erase will lock the flash and prevent code
+    execution
 
   - write using log based system
 
@@ -33,7 +34,14 @@
     aren't then caller can aggregate multiple sectors. Designed for
     128k flash sectors with 16k storage size.
 
-  - assumes two flash sectors are available
+  - when the sector being written fills we move on to the next
+    available sector. With more than two sectors the full sector is
+    compacted by copying mem_buffer into the new sector a little at a
+    time from background(). Once that is done the full sector holds
+    nothing we need and is erased when erasing is OK, so we can keep
+    switching sectors while erasing is not allowed, and sectors are
+    used in turn to spread wear. With two sectors the full sector is
+    written out and erased when the new one fills, as before
  */
 #pragma once
 
@@ -62,10 +70,12 @@ public:
     // caller provided function to write to a flash sector
     FUNCTOR_TYPEDEF(FlashWrite, bool, uint8_t , uint32_t , const uint8_t *, uint16_t );
 
-    // caller provided function to read from a flash sector. Only called on init()
+    // caller provided function to read from a flash sector. Called on
+    // init() and to check sector headers when switching sectors
     FUNCTOR_TYPEDEF(FlashRead, bool, uint8_t , uint32_t , uint8_t *, uint16_t );
     
-    // caller provided function to erase a flash sector. Only called from init()
+    // caller provided function to erase a flash sector. Only called
+    // from init() or when flash_erase_ok() returns true
     FUNCTOR_TYPEDEF(FlashErase, bool, uint8_t );
 
     // caller provided function to indicate if erasing is allowed
@@ -77,7 +87,8 @@ public:
                     FlashWrite flash_write,     // function to write to flash
                     FlashRead flash_read,       // function to read from flash
                     FlashErase flash_erase,     // function to erase flash
-                    FlashEraseOK flash_erase_ok); // function to check if erasing allowed
+                    FlashEraseOK flash_erase_ok, // function to check if erasing allowed
+                    uint8_t num_sectors=2);     // number of flash sectors to use
 
     // initialise storage, filling mem_buffer with current contents
     bool init(void);
@@ -97,6 +108,17 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length);
 
+    // compact a full sector for up to the compaction budget, and
+    // erase a sector we no longer need if erasing is OK. Should be
+    // called regularly, for example from the storage timer
+    void background(void);
+
+    // set the time background() may spend compacting in one call
+    void set_compaction_budget_us(uint16_t budget_us) { compaction_budget_us = budget_us; }
+
+    // longest time spent in a call to write() or background()
+    uint32_t get_max_stall_us(void) const { return max_stall_us; }
+
     // fixed storage size
     static const uint16_t storage_size = block_size * num_blocks;
     
@@ -107,12 +129,26 @@ private:
     FlashRead flash_read;
     FlashErase flash_erase;
     FlashEraseOK flash_erase_ok;
+    const uint8_t num_sectors;
+
+    static const uint8_t max_sectors = 16;
 
     uint8_t current_sector;
     uint32_t write_offset;
     uint32_t reserved_space;
     bool write_error;
 
+    // compaction of a full sector into current_sector
+    bool compacting;
+    uint8_t compact_sector;
+    uint16_t compact_offset;
+    uint16_t compaction_budget_us = 200;
+
+    // sectors which hold nothing we need, waiting to be erased
+    uint16_t obsolete_mask;
+
+    uint32_t max_stall_us = 0;
+
     // 24 bit signature
 #if AP_FLASHSTORAGE_MULTI_WRITE
     static const uint32_t signature = 0x51685B;
@@ -125,7 +161,10 @@ private:
 #if AP_FLASHSTORAGE_MULTI_WRITE
         SECTOR_STATE_AVAILABLE = 0xFF,
         SECTOR_STATE_IN_USE    = 0xFE,
-        SECTOR_STATE_FULL      = 0xFC
+        SECTOR_STATE_FULL      = 0xFC,
+        // only used with more than two sectors, where we need to
+        // tell a compacted full sector from one still in use
+        SECTOR_STATE_OBSOLETE  = 0xF8,
 #else
         SECTOR_STATE_AVAILABLE = 0xFFFFFFFF,
         SECTOR_STATE_IN_USE    = 0xFFFFFFF1,
@@ -173,6 +212,31 @@ private:
     // write all of mem_buffer to current sector
     bool write_all();
 
+    // erase all sectors and write all of mem_buffer
+    bool re_write_all();
+
+    // write blocks to the current sector, switching sectors when it
+    // is full if allow_switch is set
+    bool write_blocks(uint16_t offset, uint16_t length, bool allow_switch);
+
+    // find an available sector to switch to, starting after the
+    // given sector so sectors are used in turn. Returns -1 if none
+    int8_t find_available_sector(uint8_t after);
+
+    // write the state of a sector
+    bool write_sector_state(uint8_t sector, enum SectorState state);
+
+    // copy the next part of mem_buffer to the current sector
+    bool compact_step(void);
+
+    // complete compaction of the full sector
+    bool finish_compaction(void);
+
+    // erase sectors which hold nothing we need
+    bool erase_obsolete(void);
+
+    void update_max_stall(uint32_t start_us);
+
     // return true if all bytes are zero
     bool all_zero(uint16_t ofs, uint16_t size);
 
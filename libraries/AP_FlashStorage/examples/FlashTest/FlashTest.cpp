@@ -16,35 +16,36 @@ public:
     void loop() override;
 
 private:
-    static const uint32_t flash_sector_size = 32U * 1024U;
+    static const uint8_t max_sectors = 4;
+
+    uint32_t flash_sector_size;
+    uint8_t num_sectors;
 
     uint8_t mem_buffer[AP_FlashStorage::storage_size];
     uint8_t mem_mirror[AP_FlashStorage::storage_size];
 
     // flash buffer
-    uint8_t *flash[2];
+    uint8_t *flash[max_sectors];
 
     bool flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
     bool flash_erase(uint8_t sector);
     bool flash_erase_ok(void);
     
-    AP_FlashStorage storage{mem_buffer,
-            flash_sector_size,
-            FUNCTOR_BIND_MEMBER(&FlashTest::flash_write, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
-            FUNCTOR_BIND_MEMBER(&FlashTest::flash_read, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
-            FUNCTOR_BIND_MEMBER(&FlashTest::flash_erase, bool, uint8_t),
-            FUNCTOR_BIND_MEMBER(&FlashTest::flash_erase_ok, bool)};
+    AP_FlashStorage *storage;
 
     // write to storage and mem_mirror
     void write(uint16_t offset, const uint8_t *data, uint16_t length);
 
+    // run the test with the given sector layout
+    void run(uint32_t sector_size, uint8_t sectors);
+
     bool erase_ok;
 };
 
 bool FlashTest::flash_write(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length)
 {
-    if (sector > 1) {
+    if (sector >= num_sectors) {
         AP_HAL::panic("FATAL: write to sector %u\n", (unsigned)sector);
     }
     if (offset + length > flash_sector_size) {
@@ -87,7 +88,7 @@ bool FlashTest::flash_write(uint8_t sector, uint32_t offset, const uint8_t *data
 
 bool FlashTest::flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length)
 {
-    if (sector > 1) {
+    if (sector >= num_sectors) {
         AP_HAL::panic("FATAL: read from sector %u\n", (unsigned)sector);
     }
     if (offset + length > flash_sector_size) {
@@ -102,7 +103,7 @@ bool FlashTest::flash_read(uint8_t sector, uint32_t offset, uint8_t *data, uint1
 
 bool FlashTest::flash_erase(uint8_t sector)
 {
-    if (sector > 1) {
+    if (sector >= num_sectors) {
         AP_HAL::panic("FATAL: erase sector %u\n", (unsigned)sector);
     }
     memset(&flash[sector][0], 0xFF, flash_sector_size);
@@ -118,7 +119,7 @@ void FlashTest::write(uint16_t offset, const uint8_t *data, uint16_t length)
 {
     memcpy(&mem_mirror[offset], data, length);
     memcpy(&mem_buffer[offset], data, length);
-    if (!storage.write(offset, length)) {
+    if (!storage->write(offset, length)) {
         if (erase_ok) {
             printf("Failed to write at %u for %u\n", offset, length);
         }
@@ -133,14 +134,28 @@ void FlashTest::setup(void)
     hal.console->printf("AP_FlashStorage test\n");
 }
 
-void FlashTest::loop(void)
+void FlashTest::run(uint32_t sector_size, uint8_t sectors)
 {
-    flash[0] = (uint8_t *)malloc(flash_sector_size);
-    flash[1] = (uint8_t *)malloc(flash_sector_size);
-    flash_erase(0);
-    flash_erase(1);
+    hal.console->printf("testing %u sectors of %u bytes\n", (unsigned)sectors, (unsigned)sector_size);
+
+    flash_sector_size = sector_size;
+    num_sectors = sectors;
+    for (uint8_t i=0; i<num_sectors; i++) {
+        flash[i] = (uint8_t *)malloc(flash_sector_size);
+        flash_erase(i);
+    }
+    memset(mem_buffer, 0, sizeof(mem_buffer));
+    memset(mem_mirror, 0, sizeof(mem_mirror));
 
-    if (!storage.init()) {
+    storage = new AP_FlashStorage(mem_buffer,
+                                  flash_sector_size,
+                                  FUNCTOR_BIND_MEMBER(&FlashTest::flash_write, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
+                                  FUNCTOR_BIND_MEMBER(&FlashTest::flash_read, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
+                                  FUNCTOR_BIND_MEMBER(&FlashTest::flash_erase, bool, uint8_t),
+                                  FUNCTOR_BIND_MEMBER(&FlashTest::flash_erase_ok, bool),
+                                  num_sectors);
+
+    if (!storage->init()) {
         AP_HAL::panic("Failed first init()");
     }
 
@@ -156,6 +171,7 @@ void FlashTest::loop(void)
 
         erase_ok = (i % 1000 == 0);
         write(ofs, data, length);
+        storage->background();
 
         if (erase_ok) {
             if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
@@ -173,16 +189,33 @@ void FlashTest::loop(void)
         AP_HAL::panic("FATAL: data mis-match before re-init");
     }
     
+    printf("max stall %u us\n", (unsigned)storage->get_max_stall_us());
+
     // re-init
     printf("re-init\n");
     memset(mem_buffer, 0, sizeof(mem_buffer));
-    if (!storage.init()) {
+    if (!storage->init()) {
         AP_HAL::panic("Failed second init()");
     }
 
     if (memcmp(mem_buffer, mem_mirror, sizeof(mem_buffer)) != 0) {
         AP_HAL::panic("FATAL: data mis-match");
     }
+
+    delete storage;
+    for (uint8_t i=0; i<num_sectors; i++) {
+        free(flash[i]);
+    }
+}
+
+void FlashTest::loop(void)
+{
+    // the two sector layout used by most boards
+    run(32U * 1024U, 2);
+
+    // more sectors, compacted in the background
+    run(64U * 1024U, max_sectors);
+
     while (true) {
         hal.console->printf("TEST PASSED");
         hal.scheduler->delay(20000);
@@ -150,6 +150,12 @@
 #define HAL_OS_SOCKETS 0
 #endif
 
+// size in bytes of the data cache line, or 0 where padding data to
+// separate cache lines isn't worthwhile
+#ifndef HAL_CACHE_LINE_SIZE
+#define HAL_CACHE_LINE_SIZE 0
+#endif
+
 #ifndef HAL_PARAM_DEFAULTS_PATH
 #define HAL_PARAM_DEFAULTS_PATH nullptr
 #endif
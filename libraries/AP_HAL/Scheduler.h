@@ -115,6 +115,14 @@ public:
         return false;
     }
 
+    /*
+      pin the calling thread to a single CPU. Returns false if not
+      supported on this board
+     */
+    virtual bool set_thread_affinity(uint8_t cpu) {
+        return false;
+    }
+
 private:
 
     AP_HAL::Proc _delay_cb;
@@ -48,3 +48,26 @@ private:
 #define WITH_SEMAPHORE( sem ) JOIN( sem, __LINE__, __COUNTER__ )
 #define JOIN( sem, line, counter ) _DO_JOIN( sem, line, counter )
 #define _DO_JOIN( sem, line, counter ) WithSemaphore _getsem ## counter(sem, line)
+
+/*
+  a binary semaphore, used to signal an event from one thread to
+  another. Unlike AP_HAL::Semaphore this is not a mutex: one thread
+  waits, another thread signals. Only available on boards that define
+  HAL_BinarySemaphore
+ */
+class AP_HAL::BinarySemaphore {
+public:
+    BinarySemaphore(bool initial_state=false) {}
+    virtual ~BinarySemaphore(void) {}
+
+    // do not allow copying
+    BinarySemaphore(const BinarySemaphore &other) = delete;
+    BinarySemaphore &operator=(const BinarySemaphore&) = delete;
+
+    // wait for the semaphore to be signalled, consuming the signal.
+    // A timeout of zero means wait forever
+    virtual bool wait(uint32_t timeout_us) WARN_IF_UNUSED = 0;
+    virtual bool wait_blocking(void) = 0;
+
+    virtual void signal(void) = 0;
+};
@@ -0,0 +1,69 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+/*
+  compare the locked and lock-free object queues when one thread is
+  producing and another thread is consuming, as happens between the
+  main thread and the IO thread. Thread 0 pushes and thread 1 pops the
+  same number of objects, so the queue is empty again at the end of
+  each run
+ */
+
+struct sample {
+    uint32_t timestamp_us;
+    float value[6];
+};
+
+static const uint32_t queue_size = 32;
+
+template <class Queue>
+static void BM_QueueContended(benchmark::State& state)
+{
+    static Queue queue{queue_size};
+    sample s {};
+
+    if (state.thread_index == 0) {
+        while (state.KeepRunning()) {
+            while (!queue.push(s)) {
+            }
+            s.timestamp_us++;
+        }
+    } else {
+        while (state.KeepRunning()) {
+            while (!queue.pop(s)) {
+            }
+            gbenchmark_escape(&s);
+        }
+    }
+}
+
+// as above, moving a batch of range_x() objects per iteration
+static void BM_SPSCBulkContended(benchmark::State& state)
+{
+    static ObjectBuffer_SPSC<sample> queue{queue_size};
+    sample s[queue_size] {};
+    const uint32_t n = state.range_x();
+
+    if (state.thread_index == 0) {
+        while (state.KeepRunning()) {
+            while (!queue.push(s, n)) {
+            }
+        }
+    } else {
+        while (state.KeepRunning()) {
+            uint32_t count = 0;
+            while (count < n) {
+                count += queue.pop(&s[count], n - count);
+            }
+            gbenchmark_escape(&s);
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_QueueContended, ObjectBuffer_TS<sample>)->Threads(2);
+BENCHMARK_TEMPLATE(BM_QueueContended, ObjectBuffer_SPSC<sample>)->Threads(2);
+BENCHMARK(BM_SPSCBulkContended)->Arg(1)->Arg(8)->Arg(16)->Threads(2);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,82 @@
+#include <AP_gbenchmark.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/StorageJournal.h>
+#include <AP_Math/tests/random_test.h>
+
+/*
+  parameter save storms against file backed storage. Each iteration
+  saves range_x() parameters (an 8 byte header and value) at random
+  offsets in a 16k storage image, as when a GCS uploads a parameter
+  file, and writes them to the file either a line at a time, as the
+  SITL storage used to, or as one journalled batch
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t storage_size = 16384;
+static const uint16_t param_size = 8;
+static const uint16_t line_size = 8;
+
+static uint8_t image[storage_size];
+
+static int open_storage(void)
+{
+    const int fd = open("benchmark_storage.bin", O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if (fd != -1 && ftruncate(fd, storage_size) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static uint16_t param_offset(void)
+{
+    return ((rand_next() >> 8) % (storage_size / param_size)) * param_size;
+}
+
+static void BM_SaveStormLines(benchmark::State& state)
+{
+    const int fd = open_storage();
+    rand_seed(1);
+    int64_t bytes = 0;
+    while (state.KeepRunning()) {
+        for (int i=0; i<state.range_x(); i++) {
+            const uint16_t ofs = param_offset();
+            memset(&image[ofs], i, param_size);
+            for (uint16_t line=ofs; line<ofs+param_size; line+=line_size) {
+                bytes += pwrite(fd, &image[line], line_size, line);
+            }
+        }
+    }
+    close(fd);
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range_x());
+    state.SetBytesProcessed(bytes);
+}
+
+static void BM_SaveStormJournal(benchmark::State& state)
+{
+    const int fd = open_storage();
+    unlink("benchmark_storage.jnl");
+    StorageJournal journal(image, storage_size, "benchmark_storage.jnl");
+    rand_seed(1);
+    while (state.KeepRunning()) {
+        for (int i=0; i<state.range_x(); i++) {
+            const uint16_t ofs = param_offset();
+            memset(&image[ofs], i, param_size);
+            journal.mark_dirty(ofs, param_size);
+        }
+        journal.flush(fd);
+    }
+    close(fd);
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range_x());
+    state.SetBytesProcessed(int64_t(journal.page_count) * StorageJournal::page_size);
+}
+
+BENCHMARK(BM_SaveStormLines)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK(BM_SaveStormJournal)->Arg(1)->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN()
@@ -5,6 +5,7 @@
 #define HAL_MEM_CLASS HAL_MEM_CLASS_1000
 #define HAL_OS_POSIX_IO 1
 #define HAL_OS_SOCKETS 1
+#define HAL_CACHE_LINE_SIZE 64
 #define HAL_STORAGE_SIZE            16384
 #define HAL_STORAGE_SIZE_AVAILABLE  HAL_STORAGE_SIZE
 
@@ -347,4 +348,6 @@
 
 #include <AP_HAL_Linux/Semaphores.h>
 #define HAL_Semaphore Linux::Semaphore
+#include <AP_HAL/utility/BinarySemaphore_pthread.h>
+#define HAL_BinarySemaphore BinarySemaphore_pthread
 
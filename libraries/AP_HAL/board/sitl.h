@@ -5,6 +5,7 @@
 #define HAL_MEM_CLASS HAL_MEM_CLASS_1000
 #define HAL_OS_POSIX_IO 1
 #define HAL_OS_SOCKETS 1
+#define HAL_CACHE_LINE_SIZE 64
 #define HAL_STORAGE_SIZE            16384
 #define HAL_STORAGE_SIZE_AVAILABLE  HAL_STORAGE_SIZE
 #define HAL_BOARD_LOG_DIRECTORY "logs"
@@ -26,6 +27,8 @@
 // allow for static semaphores
 #include <AP_HAL_SITL/Semaphores.h>
 #define HAL_Semaphore HALSITL::Semaphore
+#include <AP_HAL/utility/BinarySemaphore_pthread.h>
+#define HAL_BinarySemaphore BinarySemaphore_pthread
 
 #ifndef HAL_BOARD_STORAGE_DIRECTORY
 #define HAL_BOARD_STORAGE_DIRECTORY "."
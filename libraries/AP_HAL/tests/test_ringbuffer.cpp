@@ -0,0 +1,104 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(ObjectBuffer_SPSC_Test, PushPop)
+{
+    ObjectBuffer_SPSC<uint16_t> buf(4);
+    EXPECT_TRUE(buf.empty());
+    EXPECT_EQ(buf.space(), 4U);
+
+    for (uint16_t i=0; i<4; i++) {
+        EXPECT_TRUE(buf.push(i));
+    }
+    EXPECT_FALSE(buf.push(99));
+    EXPECT_EQ(buf.available(), 4U);
+    EXPECT_EQ(buf.space(), 0U);
+
+    uint16_t v;
+    EXPECT_TRUE(buf.peek(v));
+    EXPECT_EQ(v, 0);
+    for (uint16_t i=0; i<4; i++) {
+        EXPECT_TRUE(buf.pop(v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(buf.pop(v));
+    EXPECT_FALSE(buf.pop());
+    EXPECT_TRUE(buf.empty());
+}
+
+TEST(ObjectBuffer_SPSC_Test, BulkWrap)
+{
+    ObjectBuffer_SPSC<uint16_t> buf(5);
+    uint16_t in[5] {};
+    uint16_t out[5] {};
+    uint16_t next_in = 0;
+    uint16_t next_out = 0;
+
+    // move the indexes all the way round the buffer several times
+    for (uint8_t loop=0; loop<20; loop++) {
+        const uint32_t n = 1 + loop % 5;
+        for (uint32_t i=0; i<n; i++) {
+            in[i] = next_in + i;
+        }
+        EXPECT_TRUE(buf.push(in, n));
+        next_in += n;
+        EXPECT_FALSE(buf.push(in, buf.space()+1));
+
+        EXPECT_EQ(buf.pop(out, 5), n);
+        for (uint32_t i=0; i<n; i++) {
+            EXPECT_EQ(out[i], next_out++);
+        }
+    }
+    EXPECT_TRUE(buf.empty());
+}
+
+TEST(ObjectBuffer_SPSC_Test, ZeroCopy)
+{
+    ObjectBuffer_SPSC<uint16_t> buf(4);
+    uint16_t v;
+
+    // leave the indexes part way through the buffer
+    EXPECT_TRUE(buf.push(100));
+    EXPECT_TRUE(buf.push(101));
+    EXPECT_TRUE(buf.pop(v));
+    EXPECT_TRUE(buf.pop(v));
+
+    uint32_t n;
+    uint16_t *wp = buf.reserve(n);
+    ASSERT_NE(wp, nullptr);
+    EXPECT_EQ(n, 3U);
+    for (uint32_t i=0; i<n; i++) {
+        wp[i] = i;
+    }
+    // nothing is visible until committed
+    EXPECT_TRUE(buf.empty());
+    EXPECT_TRUE(buf.commit(n));
+    wp = buf.reserve(n);
+    ASSERT_NE(wp, nullptr);
+    EXPECT_EQ(n, 1U);
+    wp[0] = 3;
+    EXPECT_TRUE(buf.commit(1));
+    EXPECT_EQ(buf.reserve(n), nullptr);
+    EXPECT_FALSE(buf.commit(1));
+
+    const uint16_t *rp = buf.readptr(n);
+    ASSERT_NE(rp, nullptr);
+    EXPECT_EQ(n, 3U);
+    EXPECT_EQ(rp[0], 0);
+    EXPECT_EQ(rp[2], 2);
+    EXPECT_TRUE(buf.advance(n));
+    rp = buf.readptr(n);
+    ASSERT_NE(rp, nullptr);
+    EXPECT_EQ(n, 1U);
+    EXPECT_EQ(rp[0], 3);
+    EXPECT_FALSE(buf.advance(2));
+
+    buf.clear();
+    EXPECT_TRUE(buf.empty());
+    EXPECT_EQ(buf.readptr(n), nullptr);
+}
+
+AP_GTEST_MAIN()
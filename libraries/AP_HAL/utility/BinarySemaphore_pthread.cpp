@@ -0,0 +1,87 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  binary semaphore, implemented with a pthread condition variable
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include "BinarySemaphore_pthread.h"
+
+#include <time.h>
+
+BinarySemaphore_pthread::BinarySemaphore_pthread(bool initial_state) :
+    AP_HAL::BinarySemaphore(initial_state)
+{
+    pthread_mutex_init(&mtx, nullptr);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#ifndef __APPLE__
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&cond, &attr);
+    pending = initial_state;
+}
+
+bool BinarySemaphore_pthread::wait(uint32_t timeout_us)
+{
+    if (timeout_us == 0) {
+        return wait_blocking();
+    }
+    struct timespec ts;
+#ifndef __APPLE__
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+    const uint64_t nsec = ts.tv_nsec + uint64_t(timeout_us) * 1000ULL;
+    ts.tv_sec += nsec / 1000000000ULL;
+    ts.tv_nsec = nsec % 1000000000ULL;
+
+    pthread_mutex_lock(&mtx);
+    while (!pending) {
+        if (pthread_cond_timedwait(&cond, &mtx, &ts) != 0) {
+            break;
+        }
+    }
+    const bool ret = pending;
+    pending = false;
+    pthread_mutex_unlock(&mtx);
+    return ret;
+}
+
+bool BinarySemaphore_pthread::wait_blocking(void)
+{
+    pthread_mutex_lock(&mtx);
+    while (!pending) {
+        pthread_cond_wait(&cond, &mtx);
+    }
+    pending = false;
+    pthread_mutex_unlock(&mtx);
+    return true;
+}
+
+void BinarySemaphore_pthread::signal(void)
+{
+    pthread_mutex_lock(&mtx);
+    if (!pending) {
+        pending = true;
+        pthread_cond_signal(&cond);
+    }
+    pthread_mutex_unlock(&mtx);
+}
+
+#endif  // CONFIG_HAL_BOARD
@@ -0,0 +1,38 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  binary semaphore for boards with pthreads, shared by Linux and SITL
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <stdint.h>
+#include <AP_HAL/AP_HAL_Macros.h>
+#include <AP_HAL/Semaphores.h>
+#include <pthread.h>
+
+class BinarySemaphore_pthread : public AP_HAL::BinarySemaphore {
+public:
+    BinarySemaphore_pthread(bool initial_state=false);
+
+    bool wait(uint32_t timeout_us) override;
+    bool wait_blocking(void) override;
+    void signal(void) override;
+
+protected:
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    bool pending;
+};
@@ -396,6 +396,195 @@ private:
     HAL_Semaphore sem;
 };
 
+/*
+  wait-free ring buffer class for objects of fixed size, for queues
+  with exactly one producer thread and one consumer thread.
+
+  Only the producer may call push(), reserve() and commit(). Only the
+  consumer may call pop(), peek(), readptr(), advance() and
+  clear(). available(), space() and empty() may be called from either
+  thread, and are exact for the caller's side of the queue.
+
+  Objects are stored directly, so readptr() and reserve() give
+  zero-copy access to a contiguous span of the buffer.
+ */
+template <class T>
+class ObjectBuffer_SPSC {
+public:
+    ObjectBuffer_SPSC(uint32_t _size) :
+        // one slot is always left empty to tell full from empty
+        size(_size+1)
+    {
+        buffer = new T[size];
+    }
+    ~ObjectBuffer_SPSC(void) {
+        delete[] buffer;
+    }
+
+    // return number of objects available to be read from the front of the queue
+    uint32_t available(void) const {
+        return count(head.load(std::memory_order_acquire), tail.load(std::memory_order_acquire));
+    }
+
+    // return number of objects that could be written to the back of the queue
+    uint32_t space(void) const {
+        return size - 1 - available();
+    }
+
+    // true is available() == 0
+    bool empty(void) const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    // push one object onto the back of the queue
+    bool push(const T &object) {
+        return push(&object, 1);
+    }
+
+    // push N objects onto the back of the queue. Either all or none are pushed
+    bool push(const T *objects, uint32_t n) {
+        const uint32_t _tail = tail.load(std::memory_order_relaxed);
+        const uint32_t _head = head.load(std::memory_order_acquire);
+        if (size - 1 - count(_head, _tail) < n) {
+            return false;
+        }
+        const uint32_t n1 = n < size - _tail ? n : size - _tail;
+        for (uint32_t i=0; i<n1; i++) {
+            buffer[_tail+i] = objects[i];
+        }
+        for (uint32_t i=n1; i<n; i++) {
+            buffer[i-n1] = objects[i];
+        }
+        tail.store((_tail + n) % size, std::memory_order_release);
+        return true;
+    }
+
+    /*
+      pop up to N objects off the front of the queue, returning the
+      number of objects popped
+     */
+    uint32_t pop(T *objects, uint32_t n) {
+        const uint32_t _head = head.load(std::memory_order_relaxed);
+        const uint32_t _tail = tail.load(std::memory_order_acquire);
+        const uint32_t avail = count(_head, _tail);
+        if (n > avail) {
+            n = avail;
+        }
+        const uint32_t n1 = n < size - _head ? n : size - _head;
+        for (uint32_t i=0; i<n1; i++) {
+            objects[i] = buffer[_head+i];
+        }
+        for (uint32_t i=n1; i<n; i++) {
+            objects[i] = buffer[i-n1];
+        }
+        head.store((_head + n) % size, std::memory_order_release);
+        return n;
+    }
+
+    /*
+      pop earliest object off the front of the queue
+     */
+    bool pop(T &object) {
+        return pop(&object, 1) == 1;
+    }
+
+    /*
+      throw away an object from the front of the queue
+     */
+    bool pop(void) {
+        return advance(1);
+    }
+
+    /*
+      peek copies an object out from the front of the queue without advancing the read pointer
+     */
+    bool peek(T &object) const {
+        const uint32_t _head = head.load(std::memory_order_relaxed);
+        if (_head == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        object = buffer[_head];
+        return true;
+    }
+
+    /*
+      return a pointer to first contiguous array of available
+      objects. Return nullptr if none available. The objects remain
+      valid until advance() is called
+     */
+    const T *readptr(uint32_t &n) const {
+        const uint32_t _head = head.load(std::memory_order_relaxed);
+        const uint32_t _tail = tail.load(std::memory_order_acquire);
+        if (_head == _tail) {
+            return nullptr;
+        }
+        n = _tail > _head ? _tail - _head : size - _head;
+        return &buffer[_head];
+    }
+
+    // advance the read pointer (discarding objects)
+    bool advance(uint32_t n) {
+        const uint32_t _head = head.load(std::memory_order_relaxed);
+        if (n > count(_head, tail.load(std::memory_order_acquire))) {
+            return false;
+        }
+        head.store((_head + n) % size, std::memory_order_release);
+        return true;
+    }
+
+    /*
+      return a pointer to the first contiguous array of free objects at
+      the back of the queue, setting n to its length. Return nullptr if
+      the queue is full. The objects are not visible to the consumer
+      until commit() is called
+     */
+    T *reserve(uint32_t &n) {
+        const uint32_t _tail = tail.load(std::memory_order_relaxed);
+        const uint32_t free = size - 1 - count(head.load(std::memory_order_acquire), _tail);
+        if (free == 0) {
+            return nullptr;
+        }
+        n = free < size - _tail ? free : size - _tail;
+        return &buffer[_tail];
+    }
+
+    // make n objects written after reserve() available to the consumer
+    bool commit(uint32_t n) {
+        const uint32_t _tail = tail.load(std::memory_order_relaxed);
+        if (n > size - 1 - count(head.load(std::memory_order_acquire), _tail)) {
+            return false;
+        }
+        tail.store((_tail + n) % size, std::memory_order_release);
+        return true;
+    }
+
+    // Discards the buffer content, emptying it
+    void clear(void) {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    uint32_t count(uint32_t _head, uint32_t _tail) const {
+        return _tail >= _head ? _tail - _head : size - _head + _tail;
+    }
+
+    T *buffer;
+    const uint32_t size;
+
+    // on boards with a data cache the consumer and producer indexes are
+    // padded onto separate cache lines, so the two threads don't contend
+    // for the same line. Padding rather than alignas() keeps the object
+    // normally aligned, so it can be created with plain new
+    std::atomic<uint32_t> head{0}; // where to read data, written by the consumer
+#if HAL_CACHE_LINE_SIZE > 0
+    uint8_t _pad_head[HAL_CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+#endif
+    std::atomic<uint32_t> tail{0}; // where to write data, written by the producer
+#if HAL_CACHE_LINE_SIZE > 0
+    uint8_t _pad_tail[HAL_CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+#endif
+};
+
 /*
   ring buffer class for objects of fixed size with pointer
   access. Note that this is not thread safe, buf offers efficient
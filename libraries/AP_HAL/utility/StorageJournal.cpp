@@ -0,0 +1,268 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_OS_POSIX_IO
+
+#include "StorageJournal.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <AP_Math/AP_Math.h>
+
+const uint16_t StorageJournal::page_size;
+const uint8_t StorageJournal::max_pages;
+
+StorageJournal::StorageJournal(uint8_t *buffer, uint16_t size, const char *journal_path) :
+    _buffer(buffer),
+    _size(size),
+    _journal_path(journal_path)
+{
+    if (num_pages() > max_pages) {
+        AP_HAL::panic("StorageJournal: %u bytes is too large", unsigned(size));
+    }
+}
+
+StorageJournal::~StorageJournal()
+{
+    if (_journal_fd != -1) {
+        close(_journal_fd);
+    }
+    delete[] _journal_buf;
+}
+
+bool StorageJournal::open_journal()
+{
+    if (_journal_buf == nullptr) {
+        _journal_buf = new uint8_t[sizeof(journal_header) + max_pages * (sizeof(uint16_t) + page_size)];
+        if (_journal_buf == nullptr) {
+            return false;
+        }
+    }
+    if (_journal_fd == -1) {
+        _journal_fd = open(_journal_path, O_RDWR|O_CREAT|O_CLOEXEC, 0644);
+    }
+    return _journal_fd != -1;
+}
+
+/*
+  replay a complete journal onto the storage file. An incomplete or
+  corrupt journal was never applied, so the storage file still holds
+  the previous contents of its pages
+ */
+bool StorageJournal::recover(int fd)
+{
+    if (!open_journal()) {
+        return false;
+    }
+    journal_header hdr;
+    if (pread(_journal_fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+        hdr.magic != journal_magic ||
+        hdr.page_size != page_size ||
+        hdr.num_pages == 0 ||
+        hdr.num_pages > num_pages()) {
+        // nothing to replay
+        return true;
+    }
+    const uint32_t len = hdr.num_pages * (sizeof(uint16_t) + page_size);
+    uint8_t *body = &_journal_buf[sizeof(hdr)];
+    if (pread(_journal_fd, body, len, sizeof(hdr)) != ssize_t(len) ||
+        crc_crc32(0, body, len) != hdr.crc) {
+        return true;
+    }
+    const uint16_t *page_nums = (const uint16_t *)body;
+    const uint8_t *data = &body[hdr.num_pages * sizeof(uint16_t)];
+    for (uint16_t i=0; i<hdr.num_pages; i++) {
+        const uint16_t page = page_nums[i];
+        if (page >= num_pages()) {
+            return false;
+        }
+        const uint32_t ofs = page * page_size;
+        const uint16_t n = MIN(page_size, _size - ofs);
+        if (pwrite(fd, &data[i * page_size], n, ofs) != n) {
+            return false;
+        }
+    }
+    if (fsync(fd) != 0) {
+        return false;
+    }
+    // replaying the journal again would do no harm, so this doesn't
+    // need to be synced
+    return ftruncate(_journal_fd, 0) == 0;
+}
+
+void StorageJournal::write(uint16_t loc, const void *src, uint16_t length)
+{
+    WITH_SEMAPHORE(_sem);
+    memcpy(&_buffer[loc], src, length);
+    mark_dirty(loc, length);
+}
+
+void StorageJournal::mark_dirty(uint16_t loc, uint16_t length)
+{
+    if (length == 0) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint16_t end = loc + length - 1;
+    WITH_SEMAPHORE(_sem);
+    if (_dirty == 0) {
+        _first_dirty_ms = now_ms;
+    }
+    for (uint16_t page=loc/page_size; page <= end/page_size; page++) {
+        _dirty |= 1ULL << page;
+    }
+    _last_write_ms = now_ms;
+}
+
+bool StorageJournal::flush_due(bool armed)
+{
+    const bool disarmed = _was_armed && !armed;
+    _was_armed = armed;
+    if (_dirty == 0) {
+        return false;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    return disarmed ||
+        now_ms - _last_write_ms >= flush_quiet_ms ||
+        now_ms - _first_dirty_ms >= flush_max_delay_ms;
+}
+
+uint64_t StorageJournal::take_dirty()
+{
+    WITH_SEMAPHORE(_sem);
+    const uint64_t pages = _dirty;
+    _dirty = 0;
+    return pages;
+}
+
+void StorageJournal::restore_dirty(uint64_t pages)
+{
+    WITH_SEMAPHORE(_sem);
+    if (_dirty == 0) {
+        _first_dirty_ms = AP_HAL::millis();
+    }
+    _dirty |= pages;
+}
+
+/*
+  take the dirty pages, and write a snapshot of them to the journal.
+  The semaphore is held while the snapshot is taken, so it holds
+  either all or none of each write(). Later writes mark their pages
+  dirty again, so they go out in the next batch
+ */
+bool StorageJournal::write_journal(uint64_t &pages)
+{
+    pages = 0;
+    if (!open_journal()) {
+        return false;
+    }
+    uint8_t *body = &_journal_buf[sizeof(journal_header)];
+    uint16_t count = 0;
+    {
+        WITH_SEMAPHORE(_sem);
+        pages = take_dirty();
+        if (pages == 0) {
+            return true;
+        }
+        for (uint8_t page=0; page<num_pages(); page++) {
+            if (pages & (1ULL << page)) {
+                count++;
+            }
+        }
+        uint16_t *page_nums = (uint16_t *)body;
+        uint8_t *data = &body[count * sizeof(uint16_t)];
+        uint16_t i = 0;
+        for (uint8_t page=0; page<num_pages(); page++) {
+            if (!(pages & (1ULL << page))) {
+                continue;
+            }
+            const uint32_t ofs = page * page_size;
+            const uint16_t n = MIN(page_size, _size - ofs);
+            page_nums[i] = page;
+            memcpy(&data[i * page_size], &_buffer[ofs], n);
+            memset(&data[i * page_size + n], 0, page_size - n);
+            i++;
+        }
+    }
+    const uint32_t len = count * (sizeof(uint16_t) + page_size);
+    journal_header hdr;
+    hdr.magic = journal_magic;
+    hdr.page_size = page_size;
+    hdr.num_pages = count;
+    hdr.crc = crc_crc32(0, body, len);
+    memcpy(_journal_buf, &hdr, sizeof(hdr));
+    const uint32_t total = sizeof(hdr) + len;
+    if (pwrite(_journal_fd, _journal_buf, total, 0) != ssize_t(total) ||
+        fsync(_journal_fd) != 0) {
+        restore_dirty(pages);
+        return false;
+    }
+    return true;
+}
+
+/*
+  write the dirty pages to the journal, then in place from the
+  journal's snapshot, coalescing runs of adjacent pages into one write
+ */
+bool StorageJournal::flush(int fd)
+{
+    uint64_t pages;
+    if (!write_journal(pages)) {
+        return false;
+    }
+    if (pages == 0) {
+        return true;
+    }
+    const uint8_t *data = &_journal_buf[sizeof(journal_header) + __builtin_popcountll(pages) * sizeof(uint16_t)];
+    uint16_t i = 0;
+    for (uint8_t page=0; page<num_pages(); ) {
+        if (!(pages & (1ULL << page))) {
+            page++;
+            continue;
+        }
+        uint8_t run = 1;
+        while (page + run < num_pages() && (pages & (1ULL << (page + run)))) {
+            run++;
+        }
+        const uint32_t ofs = page * page_size;
+        const uint32_t n = MIN(uint32_t(run * page_size), uint32_t(_size - ofs));
+        if (pwrite(fd, &data[i * page_size], n, ofs) != ssize_t(n)) {
+            // the journal holds these pages, so they are safe
+            // against a crash, but keep trying to write them
+            restore_dirty(pages);
+            return false;
+        }
+        i += run;
+        page += run;
+    }
+    if (fsync(fd) != 0) {
+        restore_dirty(pages);
+        return false;
+    }
+    // the pages are in place, so the journal is no longer needed.
+    // Replaying it would do no harm, so this doesn't need to be synced
+    if (ftruncate(_journal_fd, 0) != 0) {
+        return false;
+    }
+    flush_count++;
+    page_count += i;
+    return true;
+}
+
+#endif // HAL_OS_POSIX_IO
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_OS_POSIX_IO
+
+/*
+  write-back cache for storage backed by a file, as used by the Linux
+  and SITL HALs. The HAL keeps the storage image in RAM; this tracks
+  which pages of it are dirty, and writes them out in batches.
+
+  Each batch of pages is first written to a journal file and synced,
+  then written in place. A complete journal left by a crash is
+  replayed by recover() at startup, so a batch is either wholly in the
+  storage file or not at all, and a parameter or mission item can't be
+  torn by power loss.
+ */
+class StorageJournal {
+public:
+    static const uint16_t page_size = 512;
+    static const uint8_t max_pages = 64;
+
+    // buffer is the RAM image of the storage file, of size bytes
+    StorageJournal(uint8_t *buffer, uint16_t size, const char *journal_path);
+    ~StorageJournal();
+
+    /* Do not allow copies */
+    StorageJournal(const StorageJournal &other) = delete;
+    StorageJournal &operator=(const StorageJournal&) = delete;
+
+    // replay a complete journal onto the storage file fd. Call before
+    // loading the RAM image from fd
+    bool recover(int fd);
+
+    // copy length bytes from src into the RAM image at loc and mark
+    // them dirty, so write_journal() never snapshots half a write
+    void write(uint16_t loc, const void *src, uint16_t length);
+
+    // note a change to the RAM image
+    void mark_dirty(uint16_t loc, uint16_t length);
+
+    bool dirty() const { return _dirty != 0; }
+
+    // returns true if dirty pages should be written now: writes have
+    // stopped for a while, have been pending too long, or the vehicle
+    // has just disarmed
+    bool flush_due(bool armed);
+
+    // write all dirty pages through the journal. Returns false if
+    // they could not be written; they stay dirty
+    bool flush(int fd);
+
+    // write the dirty pages to the journal only. Exposed for testing
+    // recovery
+    bool write_journal(uint64_t &pages);
+
+    // number of flushes and pages written, for benchmarking
+    uint32_t flush_count = 0;
+    uint32_t page_count = 0;
+
+private:
+    // wait this long after the last write before flushing, so a burst
+    // of parameter saves goes out as one batch
+    static const uint16_t flush_quiet_ms = 50;
+    // but don't leave pages dirty for longer than this
+    static const uint16_t flush_max_delay_ms = 500;
+
+    struct PACKED journal_header {
+        uint32_t magic;
+        uint16_t page_size;
+        uint16_t num_pages;
+        uint32_t crc;
+    };
+    static const uint32_t journal_magic = 0x4a535041; // "APSJ"
+
+    uint8_t *_buffer;
+    uint16_t _size;
+    const char *_journal_path;
+    int _journal_fd = -1;
+
+    // the journal: a header, the page numbers, then the page contents
+    uint8_t *_journal_buf = nullptr;
+
+    HAL_Semaphore _sem;
+    uint64_t _dirty = 0;
+    uint32_t _first_dirty_ms = 0;
+    uint32_t _last_write_ms = 0;
+    bool _was_armed = false;
+
+    uint8_t num_pages() const { return (_size + page_size - 1) / page_size; }
+    bool open_journal();
+    uint64_t take_dirty();
+    void restore_dirty(uint64_t pages);
+};
+
+#endif // HAL_OS_POSIX_IO
@@ -0,0 +1,139 @@
+#include <AP_gtest.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/StorageJournal.h>
+
+#if HAL_OS_POSIX_IO
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t storage_size = 16384;
+
+// each test makes its files in a new temporary directory, removed
+// by remove_storage()
+static char temp_dir[64];
+static char storage_file[80];
+static char journal_file[80];
+
+static uint8_t image[storage_size];
+
+static int create_storage(void)
+{
+    strcpy(temp_dir, "/tmp/test_storage_journal.XXXXXX");
+    EXPECT_NE(nullptr, mkdtemp(temp_dir));
+    snprintf(storage_file, sizeof(storage_file), "%s/storage.bin", temp_dir);
+    snprintf(journal_file, sizeof(journal_file), "%s/storage.jnl", temp_dir);
+    memset(image, 0, sizeof(image));
+    const int fd = open(storage_file, O_RDWR|O_CREAT, 0644);
+    EXPECT_NE(-1, fd);
+    EXPECT_EQ(0, ftruncate(fd, storage_size));
+    return fd;
+}
+
+static void remove_storage(int fd)
+{
+    close(fd);
+    EXPECT_EQ(0, unlink(storage_file));
+    unlink(journal_file);
+    EXPECT_EQ(0, rmdir(temp_dir));
+}
+
+static void write_image(StorageJournal &journal, uint16_t loc, uint8_t value, uint16_t length)
+{
+    static uint8_t buf[storage_size];
+    memset(buf, value, length);
+    journal.write(loc, buf, length);
+}
+
+static bool file_matches_image(int fd)
+{
+    uint8_t contents[storage_size];
+    return pread(fd, contents, sizeof(contents), 0) == storage_size &&
+        memcmp(contents, image, sizeof(contents)) == 0;
+}
+
+TEST(StorageJournalTest, Flush)
+{
+    const int fd = create_storage();
+    StorageJournal journal(image, storage_size, journal_file);
+    EXPECT_TRUE(journal.recover(fd));
+
+    write_image(journal, 100, 0x11, 10);
+    // crosses a page boundary
+    write_image(journal, 1020, 0x22, 10);
+    write_image(journal, storage_size-4, 0x33, 4);
+    EXPECT_TRUE(journal.dirty());
+    EXPECT_TRUE(journal.flush(fd));
+    EXPECT_FALSE(journal.dirty());
+    EXPECT_EQ(1U, journal.flush_count);
+    EXPECT_EQ(4U, journal.page_count);
+    EXPECT_TRUE(file_matches_image(fd));
+    remove_storage(fd);
+}
+
+TEST(StorageJournalTest, RecoverAfterCrash)
+{
+    const int fd = create_storage();
+    {
+        StorageJournal journal(image, storage_size, journal_file);
+        EXPECT_TRUE(journal.recover(fd));
+        write_image(journal, 5000, 0x44, 8);
+        // crash after the journal is written, before the pages are
+        uint64_t pages;
+        EXPECT_TRUE(journal.write_journal(pages));
+        EXPECT_EQ(1ULL << (5000 / StorageJournal::page_size), pages);
+    }
+    EXPECT_FALSE(file_matches_image(fd));
+
+    StorageJournal journal(image, storage_size, journal_file);
+    EXPECT_TRUE(journal.recover(fd));
+    EXPECT_TRUE(file_matches_image(fd));
+    remove_storage(fd);
+}
+
+TEST(StorageJournalTest, IgnoreTornJournal)
+{
+    const int fd = create_storage();
+    {
+        StorageJournal journal(image, storage_size, journal_file);
+        EXPECT_TRUE(journal.recover(fd));
+        write_image(journal, 6000, 0x55, 8);
+        uint64_t pages;
+        EXPECT_TRUE(journal.write_journal(pages));
+    }
+    // corrupt the journal, as if the crash came while writing it
+    const int jfd = open(journal_file, O_RDWR);
+    const uint8_t junk = 0xEE;
+    EXPECT_EQ(1, pwrite(jfd, &junk, 1, 300));
+    close(jfd);
+
+    StorageJournal journal(image, storage_size, journal_file);
+    EXPECT_TRUE(journal.recover(fd));
+    uint8_t b;
+    EXPECT_EQ(1, pread(fd, &b, 1, 6000));
+    EXPECT_EQ(0, b);
+    remove_storage(fd);
+}
+
+TEST(StorageJournalTest, FlushOnDisarm)
+{
+    const int fd = create_storage();
+    StorageJournal journal(image, storage_size, journal_file);
+    EXPECT_FALSE(journal.flush_due(true));
+    write_image(journal, 0, 0x66, 1);
+    EXPECT_TRUE(journal.flush_due(false));
+    EXPECT_FALSE(file_matches_image(fd));
+    EXPECT_TRUE(journal.flush(fd));
+    EXPECT_FALSE(journal.dirty());
+    EXPECT_TRUE(file_matches_image(fd));
+    remove_storage(fd);
+}
+
+#endif // HAL_OS_POSIX_IO
+
+AP_GTEST_MAIN()
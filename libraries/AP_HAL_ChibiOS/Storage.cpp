@@ -42,6 +42,13 @@ extern const AP_HAL::HAL& hal;
 
 #define STORAGE_FLASH_RETRIES 5
 
+#ifdef STORAGE_FLASH_PAGE
+// from the linker script
+extern "C" {
+extern const uint8_t _textdata_start[], _data_start[], _data_end[];
+}
+#endif
+
 void Storage::_storage_open(void)
 {
     if (_initialised) {
@@ -168,6 +175,17 @@ void Storage::_timer_tick(void)
     if (!_initialised) {
         return;
     }
+
+#ifdef STORAGE_FLASH_PAGE
+#if HAL_WITH_RAMTRON
+    if (!using_fram)
+#endif
+    {
+        // copy a full flash sector a piece at a time
+        _flash.background();
+    }
+#endif
+
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
         return;
@@ -226,8 +244,11 @@ void Storage::_flash_load(void)
 #ifdef STORAGE_FLASH_PAGE
     _flash_page = STORAGE_FLASH_PAGE;
 
-    ::printf("Storage: Using flash pages %u and %u\n", _flash_page, _flash_page+1);
+    ::printf("Storage: Using flash pages %u to %u\n", _flash_page, _flash_page+STORAGE_FLASH_NUM_PAGES-1);
 
+    if (!_flash_pages_ok()) {
+        AP_HAL::panic("bad flash storage pages");
+    }
     if (!_flash.init()) {
         AP_HAL::panic("unable to init flash storage");
     }
@@ -236,6 +257,38 @@ void Storage::_flash_load(void)
 #endif
 }
 
+/*
+  check the flash pages used for storage exist, are all the same size
+  as the first, and don't overlap the firmware
+ */
+bool Storage::_flash_pages_ok(void)
+{
+#ifdef STORAGE_FLASH_PAGE
+    // the firmware image in flash finishes with the initial values of .data
+    const uint32_t fw_start = FLASH_LOAD_ADDRESS;
+    const uint32_t fw_end = uint32_t(_textdata_start) + (_data_end - _data_start);
+
+    if (uint32_t(_flash_page) + STORAGE_FLASH_NUM_PAGES > hal.flash->getnumpages()) {
+        return false;
+    }
+    const uint32_t page_size = hal.flash->getpagesize(_flash_page);
+    for (uint8_t i=0; i<STORAGE_FLASH_NUM_PAGES; i++) {
+        const uint32_t addr = hal.flash->getpageaddr(_flash_page+i);
+        if (hal.flash->getpagesize(_flash_page+i) != page_size) {
+            ::printf("Storage: flash page %u size differs\n", _flash_page+i);
+            return false;
+        }
+        if (addr < fw_end && addr + page_size > fw_start) {
+            ::printf("Storage: flash page %u overlaps firmware\n", _flash_page+i);
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
 /*
   write one storage line. This also updates _dirty_mask.
 */
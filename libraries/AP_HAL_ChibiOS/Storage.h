@@ -37,6 +37,16 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+#ifndef STORAGE_FLASH_NUM_PAGES
+// number of flash pages used for storage, starting at
+// STORAGE_FLASH_PAGE. More pages allow more sector switches while
+// armed, when the flash can't be erased
+#define STORAGE_FLASH_NUM_PAGES 2
+#endif
+
+static_assert(STORAGE_FLASH_NUM_PAGES >= 2 && STORAGE_FLASH_NUM_PAGES <= 16,
+              "STORAGE_FLASH_NUM_PAGES must be between 2 and 16");
+
 class ChibiOS::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -60,6 +70,7 @@ private:
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
     bool _flash_erase_sector(uint8_t sector);
     bool _flash_erase_ok(void);
+    bool _flash_pages_ok(void);
     uint8_t _flash_page;
     bool _flash_failed;
     uint32_t _last_re_init_ms;
@@ -71,7 +82,8 @@ private:
             FUNCTOR_BIND_MEMBER(&Storage::_flash_write_data, bool, uint8_t, uint32_t, const uint8_t *, uint16_t),
             FUNCTOR_BIND_MEMBER(&Storage::_flash_read_data, bool, uint8_t, uint32_t, uint8_t *, uint16_t),
             FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_sector, bool, uint8_t),
-            FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_ok, bool)};
+            FUNCTOR_BIND_MEMBER(&Storage::_flash_erase_ok, bool),
+            STORAGE_FLASH_NUM_PAGES};
 #endif
 
     void _flash_load(void);
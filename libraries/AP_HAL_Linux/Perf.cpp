@@ -16,6 +16,7 @@
  */
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <vector>
 
@@ -186,6 +187,26 @@ void Perf::end(Util::perf_counter_t pc)
     perf.lttng.end(perf.name);
 }
 
+bool Perf::get_elapsed_total(const char *name, uint64_t &count, uint64_t &total_nsec)
+{
+    bool found = false;
+
+    count = 0;
+    total_nsec = 0;
+
+    pthread_rwlock_rdlock(&_perf_counters_lock);
+    for (auto &c : _perf_counters) {
+        if (c.type == Util::PC_ELAPSED && strcmp(c.name, name) == 0) {
+            count += c.count;
+            total_nsec += c.total;
+            found = true;
+        }
+    }
+    pthread_rwlock_unlock(&_perf_counters_lock);
+
+    return found;
+}
+
 void Perf::count(Util::perf_counter_t pc)
 {
     uintptr_t idx = (uintptr_t)pc;
@@ -74,6 +74,9 @@ public:
 
     unsigned int get_update_count() { return _update_count; }
 
+    /* sum the event count and elapsed time of all counters with this name */
+    bool get_elapsed_total(const char *name, uint64_t &count, uint64_t &total_nsec);
+
 private:
     static Perf *_singleton;
 
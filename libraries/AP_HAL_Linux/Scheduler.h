@@ -51,6 +51,8 @@ public:
       create a new thread
      */
     bool thread_create(AP_HAL::MemberProc, const char *name, uint32_t stack_size, priority_base base, int8_t priority) override;
+
+    bool set_thread_affinity(uint8_t cpu) override;
     
 private:
     class SchedulerThread : public PeriodicThread {
@@ -1,19 +1,16 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/StorageJournal.h>
 
 #define LINUX_STORAGE_SIZE HAL_STORAGE_SIZE
-#define LINUX_STORAGE_MAX_WRITE 512
-#define LINUX_STORAGE_LINE_SHIFT 9
-#define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
-#define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
 
 namespace Linux {
 
 class Storage : public AP_HAL::Storage
 {
 public:
-    Storage() : _fd(-1),_dirty_mask(0) { }
+    Storage() : _fd(-1) { }
 
     static Storage *from(AP_HAL::Storage *storage) {
         return static_cast<Storage*>(storage);
@@ -35,13 +32,14 @@ public:
     virtual void _timer_tick(void) override;
 
 protected:
-    void _mark_dirty(uint16_t loc, uint16_t length);
     int _storage_create(const char *dpath);
 
     int _fd;
     volatile bool _initialised;
-    volatile uint32_t _dirty_mask;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+    char _journal_path[256];
+    // dirty pages of the file, written back in batches
+    StorageJournal _journal{_buffer, LINUX_STORAGE_SIZE, _journal_path};
 };
 
 }
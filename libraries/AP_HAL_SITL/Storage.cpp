@@ -40,6 +40,11 @@ void Storage::_storage_open(void)
 
     fcntl(log_fd, F_SETFD, FD_CLOEXEC);
 
+    // complete any batch of writes interrupted by a crash
+    if (!_journal.recover(log_fd)) {
+        hal.console->printf("journal recovery failed for " HAL_STORAGE_FILE "\n");
+    }
+
     int ret = read(log_fd, _buffer, HAL_STORAGE_SIZE);
     if (ret < 0) {
         hal.console->printf("read failed for " HAL_STORAGE_FILE "\n");
@@ -99,6 +104,12 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
     if (memcmp(src, &_buffer[loc], n) != 0) {
         _storage_open();
+#if STORAGE_USE_POSIX
+        if (using_filesystem) {
+            _journal.write(loc, src, n);
+            return;
+        }
+#endif
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
     }
@@ -109,6 +120,21 @@ void Storage::_timer_tick(void)
     if (!_initialised) {
         return;
     }
+#if STORAGE_USE_POSIX
+    if (using_filesystem) {
+        if (!_journal.dirty()) {
+            _last_empty_ms = AP_HAL::millis();
+        }
+        if (log_fd != -1 && _journal.flush_due(hal.util->get_soft_armed())) {
+            _journal.flush(log_fd);
+        }
+        return;
+    }
+#endif
+#if STORAGE_USE_FLASH
+    // copy a full flash sector a piece at a time
+    _flash.background();
+#endif
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
         return;
@@ -127,20 +153,6 @@ void Storage::_timer_tick(void)
         return;
     }
 
-#if STORAGE_USE_POSIX
-    if (using_filesystem && log_fd != -1) {
-        const off_t offset = STORAGE_LINE_SIZE*i;
-        if (lseek(log_fd, offset, SEEK_SET) != offset) {
-            return;
-        }
-        if (write(log_fd, &_buffer[offset], STORAGE_LINE_SIZE) != STORAGE_LINE_SIZE) {
-            return;
-        }
-        _dirty_mask.clear(i);
-        return;
-    } 
-#endif
-    
 #if STORAGE_USE_FLASH
     // save to storage backend
     _flash_write(i);
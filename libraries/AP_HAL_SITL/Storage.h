@@ -4,6 +4,7 @@
 #include <AP_Common/Bitmask.h>
 #include "AP_HAL_SITL_Namespace.h"
 #include <AP_FlashStorage/AP_FlashStorage.h>
+#include <AP_HAL/utility/StorageJournal.h>
 
 #ifndef HAL_STORAGE_FILE
 #define HAL_STORAGE_FILE "eeprom.bin"
@@ -66,5 +67,7 @@ private:
 #if STORAGE_USE_POSIX
     bool using_filesystem;
     int log_fd;
+    // dirty pages of the file, written back in batches
+    StorageJournal _journal{_buffer, HAL_STORAGE_SIZE, HAL_STORAGE_FILE ".jnl"};
 #endif
 };
@@ -35,6 +35,11 @@ extern const AP_HAL::HAL& hal;
 #define HAL_LOGGER_ARM_PERSIST 15
 #endif
 
+// log files are not indexed by default
+#ifndef HAL_LOGGER_FILE_INDEX_DEFAULT
+#define HAL_LOGGER_FILE_INDEX_DEFAULT 0
+#endif
+
 #ifndef HAL_LOGGING_BACKENDS_DEFAULT
 # ifdef HAL_LOGGING_DATAFLASH
 #  define HAL_LOGGING_BACKENDS_DEFAULT Backend_Type::BLOCK
@@ -92,7 +97,72 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
     // @User: Standard
     // @Units: s
     AP_GROUPINFO("_FILE_TIMEOUT",  6, AP_Logger, _params.file_timeout,     HAL_LOGGING_FILE_TIMEOUT),
-    
+
+    // @Param: _RATEMAX
+    // @DisplayName: Maximum logging rate for streaming messages
+    // @Description: If non-zero, each instance of each streaming message type is logged at no more than this rate. Messages such as parameters, mission items, batch sampler data and events are not limited. Messages dropped by this limit are counted in DRL log messages
+    // @User: Advanced
+    // @Units: Hz
+    // @Range: 0 100
+    AP_GROUPINFO("_RATEMAX",  7, AP_Logger, _params.rate_max,     0),
+
+    // @Param: _RATE1_ID
+    // @DisplayName: First rate limited message type
+    // @Description: Message type ID (as given in the FMT message) which is logged at the rate in LOG_RATE1_HZ instead of LOG_RATEMAX. -1 for none
+    // @User: Advanced
+    AP_GROUPINFO("_RATE1_ID",  8, AP_Logger, _params.rate_id[0],  -1),
+
+    // @Param: _RATE1_HZ
+    // @DisplayName: First rate limited message rate
+    // @Description: Maximum logging rate for messages of type LOG_RATE1_ID. Zero for no limit
+    // @User: Advanced
+    // @Units: Hz
+    // @Range: 0 100
+    AP_GROUPINFO("_RATE1_HZ",  9, AP_Logger, _params.rate_hz[0],  0),
+
+    // @Param: _RATE2_ID
+    // @DisplayName: Second rate limited message type
+    // @Description: Message type ID (as given in the FMT message) which is logged at the rate in LOG_RATE2_HZ instead of LOG_RATEMAX. -1 for none
+    // @User: Advanced
+    AP_GROUPINFO("_RATE2_ID", 10, AP_Logger, _params.rate_id[1],  -1),
+
+    // @Param: _RATE2_HZ
+    // @DisplayName: Second rate limited message rate
+    // @Description: Maximum logging rate for messages of type LOG_RATE2_ID. Zero for no limit
+    // @User: Advanced
+    // @Units: Hz
+    // @Range: 0 100
+    AP_GROUPINFO("_RATE2_HZ", 11, AP_Logger, _params.rate_hz[1],  0),
+
+    // @Param: _RATE3_ID
+    // @DisplayName: Third rate limited message type
+    // @Description: Message type ID (as given in the FMT message) which is logged at the rate in LOG_RATE3_HZ instead of LOG_RATEMAX. -1 for none
+    // @User: Advanced
+    AP_GROUPINFO("_RATE3_ID", 12, AP_Logger, _params.rate_id[2],  -1),
+
+    // @Param: _RATE3_HZ
+    // @DisplayName: Third rate limited message rate
+    // @Description: Maximum logging rate for messages of type LOG_RATE3_ID. Zero for no limit
+    // @User: Advanced
+    // @Units: Hz
+    // @Range: 0 100
+    AP_GROUPINFO("_RATE3_HZ", 13, AP_Logger, _params.rate_hz[2],  0),
+
+    // @Param: _FILE_COMPR
+    // @DisplayName: Compress log files
+    // @Description: If enabled, log files are written as frames of LZ4 block compressed data to reduce the bandwidth needed on the SD card. Logs are decompressed when downloaded over MAVLink, and can be read directly by Replay. Takes effect when the next log file is opened
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("_FILE_COMPR", 14, AP_Logger, _params.file_compress, 0),
+
+    // @Param: _FILE_INDEX
+    // @DisplayName: Log file index block size
+    // @Description: If non-zero, an index file (NNN.IDX) is written alongside each log file, with an entry recording the offset, first timestamp and message types for each block of this size. Replay and other tools use the index to seek to a time or message type without reading the whole log. Takes effect when the next log file is opened. 64 is a good value for most logs
+    // @Units: kB
+    // @Range: 0 1024
+    // @User: Advanced
+    AP_GROUPINFO("_FILE_INDEX", 15, AP_Logger, _params.file_index, HAL_LOGGER_FILE_INDEX_DEFAULT),
+
     AP_GROUPEND
 };
 
@@ -597,6 +667,40 @@ void AP_Logger::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool i
     FOR_EACH_BACKEND(WritePrioritisedBlock(pBuffer, size, is_critical));
 }
 
+bool AP_Logger::rate_limit_enabled(void) const
+{
+    if (is_positive(_params.rate_max)) {
+        return true;
+    }
+    for (uint8_t i=0; i<ARRAY_SIZE(_params.rate_id); i++) {
+        if (_params.rate_id[i] >= 0 && is_positive(_params.rate_hz[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void *AP_Logger::reserve_block(uint16_t size, void *fallback, bool is_critical)
+{
+    if (_next_backend == 0) {
+        return nullptr;
+    }
+    void *block = backends[0]->reserve_block(size, is_critical);
+    return (block != nullptr) ? block : fallback;
+}
+
+bool AP_Logger::commit_block(const void *block, const void *fallback, uint16_t size, bool is_critical)
+{
+    for (uint8_t i=1; i<_next_backend; i++) {
+        backends[i]->WritePrioritisedBlock(block, size, is_critical);
+    }
+    // only the first backend need succeed for us to be successful
+    if (block == fallback) {
+        return false;
+    }
+    return backends[0]->commit_block(block, size);
+}
+
 // change me to "DoTimeConsumingPreparations"?
 void AP_Logger::EraseAll() {
     FOR_EACH_BACKEND(EraseAll());
@@ -1084,27 +1188,23 @@ bool AP_Logger::Write_ISBH(const uint16_t seqno,
                                      const uint64_t sample_us,
                                      const float sample_rate_hz)
 {
-    if (_next_backend == 0) {
+    struct log_ISBH fallback;
+    struct log_ISBH *pkt = (struct log_ISBH *)reserve_block(sizeof(*pkt), &fallback);
+    if (pkt == nullptr) {
         return false;
     }
-    const struct log_ISBH pkt{
-        LOG_PACKET_HEADER_INIT(LOG_ISBH_MSG),
-        time_us        : AP_HAL::micros64(),
-        seqno          : seqno,
-        sensor_type    : (uint8_t)sensor_type,
-        instance       : sensor_instance,
-        multiplier     : mult,
-        sample_count   : sample_count,
-        sample_us      : sample_us,
-        sample_rate_hz : sample_rate_hz,
-    };
-
-    // only the first backend need succeed for us to be successful
-    for (uint8_t i=1; i<_next_backend; i++) {
-        backends[i]->WriteBlock(&pkt, sizeof(pkt));
-    }
-
-    return backends[0]->WriteBlock(&pkt, sizeof(pkt));
+    pkt->head1 = HEAD_BYTE1;
+    pkt->head2 = HEAD_BYTE2;
+    pkt->msgid = LOG_ISBH_MSG;
+    pkt->time_us = AP_HAL::micros64();
+    pkt->seqno = seqno;
+    pkt->sensor_type = (uint8_t)sensor_type;
+    pkt->instance = sensor_instance;
+    pkt->multiplier = mult;
+    pkt->sample_count = sample_count;
+    pkt->sample_us = sample_us;
+    pkt->sample_rate_hz = sample_rate_hz;
+    return commit_block(pkt, &fallback, sizeof(*pkt));
 }
 
 
@@ -1115,25 +1215,22 @@ bool AP_Logger::Write_ISBD(const uint16_t isb_seqno,
                                      const int16_t y[32],
                                      const int16_t z[32])
 {
-    if (_next_backend == 0) {
+    // serialise the samples straight into the write buffer
+    struct log_ISBD fallback;
+    struct log_ISBD *pkt = (struct log_ISBD *)reserve_block(sizeof(*pkt), &fallback);
+    if (pkt == nullptr) {
         return false;
     }
-    struct log_ISBD pkt = {
-        LOG_PACKET_HEADER_INIT(LOG_ISBD_MSG),
-        time_us    : AP_HAL::micros64(),
-        isb_seqno  : isb_seqno,
-        seqno      : seqno
-    };
-    memcpy(pkt.x, x, sizeof(pkt.x));
-    memcpy(pkt.y, y, sizeof(pkt.y));
-    memcpy(pkt.z, z, sizeof(pkt.z));
-
-    // only the first backend need succeed for us to be successful
-    for (uint8_t i=1; i<_next_backend; i++) {
-        backends[i]->WriteBlock(&pkt, sizeof(pkt));
-    }
-
-    return backends[0]->WriteBlock(&pkt, sizeof(pkt));
+    pkt->head1 = HEAD_BYTE1;
+    pkt->head2 = HEAD_BYTE2;
+    pkt->msgid = LOG_ISBD_MSG;
+    pkt->time_us = AP_HAL::micros64();
+    pkt->isb_seqno = isb_seqno;
+    pkt->seqno = seqno;
+    memcpy(pkt->x, x, sizeof(pkt->x));
+    memcpy(pkt->y, y, sizeof(pkt->y));
+    memcpy(pkt->z, z, sizeof(pkt->z));
+    return commit_block(pkt, &fallback, sizeof(*pkt));
 }
 
 // Wrote an event packet
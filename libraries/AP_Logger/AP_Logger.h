@@ -181,6 +181,7 @@ class AC_PosControl;
 class AP_Logger
 {
     friend class AP_Logger_Backend; // for _num_types
+    friend class AP_Logger_RateLimiter; // for message type lookups
 
 public:
     FUNCTOR_TYPEDEF(vehicle_startup_message_Writer, void);
@@ -210,6 +211,17 @@ public:
     /* Write an *important* block of data at current offset */
     void WriteCriticalBlock(const void *pBuffer, uint16_t size);
 
+    /*
+      zero-copy write of a single message, see
+      AP_Logger_Backend::reserve_block(). The message is built in
+      place in the first backend's write buffer, or in fallback if
+      the first backend can't take it, and is written to any other
+      backends on commit. Returns nullptr only if there are no
+      backends
+     */
+    void *reserve_block(uint16_t size, void *fallback, bool is_critical=false);
+    bool commit_block(const void *block, const void *fallback, uint16_t size, bool is_critical=false);
+
     // high level interface
     uint16_t find_last_log() const;
     void get_log_boundaries(uint16_t log_num, uint32_t & start_page, uint32_t & end_page);
@@ -287,6 +299,7 @@ public:
     void Write_SRTL(bool active, uint16_t num_points, uint16_t max_points, uint8_t action, const Vector3f& point);
     void Write_OABendyRuler(bool active, float target_yaw, float margin, const Location &final_dest, const Location &oa_dest);
     void Write_OADijkstra(uint8_t state, uint8_t error_id, uint8_t curr_point, uint8_t tot_points, const Location &final_dest, const Location &oa_dest);
+    void Write_OAPathPlanner(uint8_t type, uint8_t state, uint32_t latency_ms, uint32_t latency_max_ms, uint32_t age_max_ms, uint16_t cancelled, uint16_t late);
 
     void Write(const char *name, const char *labels, const char *fmt, ...);
     void Write(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, ...);
@@ -328,6 +341,9 @@ public:
     void set_force_log_disarmed(bool force_logging) { _force_log_disarmed = force_logging; }
     bool log_while_disarmed(void) const;
     uint8_t log_replay(void) const { return _params.log_replay; }
+
+    // true if any message types are rate limited
+    bool rate_limit_enabled(void) const;
     
     vehicle_startup_message_Writer _vehicle_messages;
 
@@ -341,6 +357,11 @@ public:
         AP_Int8 log_replay;
         AP_Int8 mav_bufsize; // in kilobytes
         AP_Int16 file_timeout; // in seconds
+        AP_Float rate_max;
+        AP_Int16 rate_id[3];
+        AP_Float rate_hz[3];
+        AP_Int8 file_compress;
+        AP_Int16 file_index;
     } _params;
 
     const struct LogStructure *structure(uint16_t num) const;
@@ -63,6 +63,10 @@ void AP_Logger_Backend::periodic_tasks()
     uint32_t now = AP_HAL::millis();
     if (now - _last_periodic_1Hz > 1000) {
         periodic_1Hz();
+        if (rate_limiter == nullptr && _front.rate_limit_enabled()) {
+            rate_limiter = new AP_Logger_RateLimiter(_front);
+        }
+        Write_RateLimit_Stats();
         _last_periodic_1Hz = now;
     }
     if (now - _last_periodic_10Hz > 100) {
@@ -364,6 +368,9 @@ bool AP_Logger_Backend::WritePrioritisedBlock(const void *pBuffer, uint16_t size
     if (!ShouldLog(is_critical)) {
         return false;
     }
+    if (!is_critical && rate_limited((const uint8_t *)pBuffer, size)) {
+        return false;
+    }
     if (StartNewLogOK()) {
         start_new_log();
     }
@@ -373,6 +380,134 @@ bool AP_Logger_Backend::WritePrioritisedBlock(const void *pBuffer, uint16_t size
     return _WritePrioritisedBlock(pBuffer, size, is_critical);
 }
 
+void *AP_Logger_Backend::reserve_block(uint16_t size, bool is_critical)
+{
+    if (!ShouldLog(is_critical)) {
+        return nullptr;
+    }
+    if (StartNewLogOK()) {
+        start_new_log();
+    }
+    if (!WritesOK()) {
+        return nullptr;
+    }
+    void *block = _reserve_block(size, is_critical);
+    if (block != nullptr) {
+        // the backend holds its semaphore until the block is
+        // committed, so no other reservation can change this
+        _reserved_critical = is_critical;
+    }
+    return block;
+}
+
+bool AP_Logger_Backend::commit_block(const void *block, uint16_t size)
+{
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    validate_WritePrioritisedBlock(block, size);
+#endif
+    // the message type and instance aren't known until the message
+    // has been built, but dropping it here still saves the copy
+    if (!_reserved_critical && rate_limited((const uint8_t *)block, size)) {
+        _cancel_block();
+        return false;
+    }
+    return _commit_block(block, size);
+}
+
+/*
+  return true if a non-critical message should be dropped by the rate
+  limits. Messages from the startup message writers are never dropped
+ */
+bool AP_Logger_Backend::rate_limited(const uint8_t *pkt, uint16_t size)
+{
+    if (rate_limiter == nullptr || _writing_startup_messages) {
+        return false;
+    }
+    return !rate_limiter->should_log(pkt, size);
+}
+
+bool AP_Logger_Backend::msg_type_has_time_us(uint8_t msg_type)
+{
+    const uint8_t bit = 1U<<(msg_type%8);
+    if (_time_us_checked[msg_type/8] & bit) {
+        return _time_us_types[msg_type/8] & bit;
+    }
+
+    const char *fmt = nullptr;
+    const char *labels = nullptr;
+    const struct LogStructure *s = _front.structure_for_msg_type(msg_type);
+    if (s != nullptr) {
+        fmt = s->format;
+        labels = s->labels;
+    } else {
+        const struct AP_Logger::log_write_fmt *f = _front.log_write_fmt_for_msg_type(msg_type);
+        if (f != nullptr) {
+            fmt = f->fmt;
+            labels = f->labels;
+        }
+    }
+    if (fmt == nullptr || labels == nullptr) {
+        // may be a format which hasn't been written yet, check again later
+        return false;
+    }
+    _time_us_checked[msg_type/8] |= bit;
+    if (fmt[0] == 'Q' && strncmp(labels, "TimeUS", 6) == 0 &&
+        (labels[6] == ',' || labels[6] == 0)) {
+        _time_us_types[msg_type/8] |= bit;
+        return true;
+    }
+    return false;
+}
+
+void AP_Logger_Backend::Write_RateLimit_Stats()
+{
+    if (rate_limiter == nullptr) {
+        return;
+    }
+    uint8_t idx = 0;
+    uint8_t msg_type, instance;
+    uint16_t dropped;
+    while (rate_limiter->next_dropped(idx, msg_type, instance, dropped)) {
+        const struct log_DRL pkt{
+            LOG_PACKET_HEADER_INIT(LOG_DF_RATE_LIMIT_MSG),
+            time_us  : AP_HAL::micros64(),
+            msg_type : msg_type,
+            instance : instance,
+            dropped  : dropped,
+        };
+        WriteCriticalBlock(&pkt, sizeof(pkt));
+    }
+}
+
+void *AP_Logger_Backend::_reserve_block(uint16_t size, bool is_critical)
+{
+    // messages are never longer than a uint8_t msg_len
+    if (size > UINT8_MAX) {
+        return nullptr;
+    }
+    _bounce_sem.take_blocking();
+    if (_bounce_buf == nullptr) {
+        _bounce_buf = new uint8_t[UINT8_MAX];
+        if (_bounce_buf == nullptr) {
+            _bounce_sem.give();
+            return nullptr;
+        }
+    }
+    return _bounce_buf;
+}
+
+bool AP_Logger_Backend::_commit_block(const void *block, uint16_t size)
+{
+    const bool ret = _WritePrioritisedBlock(block, size, _reserved_critical);
+    _bounce_sem.give();
+    return ret;
+}
+
+void AP_Logger_Backend::_cancel_block()
+{
+    _bounce_sem.give();
+}
+
 bool AP_Logger_Backend::ShouldLog(bool is_critical)
 {
     if (!_front.WritesEnabled()) {
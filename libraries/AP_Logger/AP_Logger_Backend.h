@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AP_Logger.h"
+#include "AP_Logger_RateLimiter.h"
 
 class LoggerMessageWriter_DFLogStart;
 
@@ -34,6 +35,17 @@ public:
 
     bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical);
 
+    /*
+      zero-copy writes. reserve_block() returns a pointer to size
+      contiguous bytes which the caller fills in with a single
+      complete message and then passes to commit_block(). Returns
+      nullptr if the message would be dropped, in which case
+      commit_block() must not be called. Nothing else may be written
+      to this backend between the two calls
+     */
+    void *reserve_block(uint16_t size, bool is_critical=false);
+    bool commit_block(const void *block, uint16_t size);
+
     // high level interface
     virtual uint16_t find_last_log() = 0;
     virtual void get_log_boundaries(uint16_t log_num, uint32_t & start_page, uint32_t & end_page) = 0;
@@ -103,6 +115,11 @@ public:
         return _dropped;
     }
 
+    // number of messages dropped by the LOG_RATEMAX/LOG_RATEn limits
+    uint32_t num_rate_limited(void) const {
+        return rate_limiter == nullptr ? 0 : rate_limiter->num_dropped();
+    }
+
     /*
      * Write support
      */
@@ -154,6 +171,19 @@ protected:
 
     virtual bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) = 0;
 
+    // backends which can serialise messages directly into their write
+    // buffer override these. By default the message is built in a
+    // bounce buffer and passed to _WritePrioritisedBlock()
+    virtual void *_reserve_block(uint16_t size, bool is_critical);
+    virtual bool _commit_block(const void *block, uint16_t size);
+    // release a reservation without writing it
+    virtual void _cancel_block();
+
+    bool rate_limited(const uint8_t *pkt, uint16_t size);
+
+    // true if messages of this type start with a uint64_t TimeUS field
+    bool msg_type_has_time_us(uint8_t msg_type);
+
     bool _initialised;
 
 private:
@@ -162,5 +192,21 @@ private:
     uint32_t _last_periodic_10Hz;
     bool have_logged_armed;
 
+    // per message type rate limiting, allocated when first enabled
+    AP_Logger_RateLimiter *rate_limiter;
+    void Write_RateLimit_Stats();
+
+    // is_critical of the block reserved by reserve_block(), set while
+    // the reservation's semaphore is held
+    bool _reserved_critical;
+
+    // bounce buffer for the default _reserve_block(), allocated on first use
+    uint8_t *_bounce_buf;
+    HAL_Semaphore _bounce_sem;
+
+    // cache for msg_type_has_time_us(), one bit per message type
+    uint8_t _time_us_checked[32];
+    uint8_t _time_us_types[32];
+
     void validate_WritePrioritisedBlock(const void *pBuffer, uint16_t size);
 };
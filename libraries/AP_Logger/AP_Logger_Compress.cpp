@@ -0,0 +1,202 @@
+#include "AP_Logger_Compress.h"
+
+#include <string.h>
+#include <AP_Math/AP_Math.h>
+
+// the LZ4 block format requires the last 5 bytes to be literals,
+// and the last match to start at least 12 bytes before the end
+static const uint8_t MINMATCH = 4;
+static const uint8_t LASTLITERALS = 5;
+static const uint8_t MFLIMIT = 12;
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash_sequence(uint32_t seq)
+{
+    return (seq * 2654435761U) >> (32 - HAL_LOGGER_COMPRESS_HASH_BITS);
+}
+
+// write an LZ4 length extension, returning false if out of space
+static bool write_length(uint8_t *dst, uint32_t &op, uint32_t dst_size, uint32_t len)
+{
+    while (len >= 255) {
+        if (op >= dst_size) {
+            return false;
+        }
+        dst[op++] = 255;
+        len -= 255;
+    }
+    if (op >= dst_size) {
+        return false;
+    }
+    dst[op++] = len;
+    return true;
+}
+
+// write a sequence of literals followed by an optional match
+static bool write_sequence(uint8_t *dst, uint32_t &op, uint32_t dst_size,
+                           const uint8_t *literals, uint32_t lit_len,
+                           uint16_t offset, uint32_t match_len)
+{
+    if (op >= dst_size) {
+        return false;
+    }
+    const uint32_t mlen = match_len ? match_len - MINMATCH : 0;
+    uint8_t &token = dst[op++];
+    token = (MIN(lit_len, 15U) << 4) | MIN(mlen, 15U);
+    if (lit_len >= 15 && !write_length(dst, op, dst_size, lit_len - 15)) {
+        return false;
+    }
+    if (op + lit_len > dst_size) {
+        return false;
+    }
+    memcpy(&dst[op], literals, lit_len);
+    op += lit_len;
+    if (match_len == 0) {
+        return true;
+    }
+    if (op + 2 > dst_size) {
+        return false;
+    }
+    dst[op++] = offset & 0xFF;
+    dst[op++] = offset >> 8;
+    if (mlen >= 15 && !write_length(dst, op, dst_size, mlen - 15)) {
+        return false;
+    }
+    return true;
+}
+
+uint32_t AP_Logger_Compress::compress(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dst_size)
+{
+    if (len > UINT16_MAX) {
+        return 0;
+    }
+    uint32_t op = 0;
+    uint32_t anchor = 0;
+
+    if (len > MFLIMIT) {
+        memset(hash_table, 0, sizeof(hash_table));
+        const uint32_t limit = len - MFLIMIT;
+        const uint32_t match_limit = len - LASTLITERALS;
+        uint32_t ip = 0;
+        while (ip < limit) {
+            const uint32_t seq = read32(&src[ip]);
+            uint16_t &slot = hash_table[hash_sequence(seq)];
+            uint32_t ref = slot;
+            slot = ip;
+            if (ref >= ip || read32(&src[ref]) != seq) {
+                ip++;
+                continue;
+            }
+            // extend the match backwards over pending literals, then forwards
+            while (ip > anchor && ref > 0 && src[ip-1] == src[ref-1]) {
+                ip--;
+                ref--;
+            }
+            uint32_t match_len = MINMATCH;
+            while (ip + match_len < match_limit && src[ref+match_len] == src[ip+match_len]) {
+                match_len++;
+            }
+            if (!write_sequence(dst, op, dst_size, &src[anchor], ip - anchor, ip - ref, match_len)) {
+                return 0;
+            }
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    if (!write_sequence(dst, op, dst_size, &src[anchor], len - anchor, 0, 0)) {
+        return 0;
+    }
+    return op;
+}
+
+// read an LZ4 length extension, returning false if truncated
+static bool read_length(const uint8_t *src, uint32_t &ip, uint32_t len, uint32_t &value)
+{
+    uint8_t b;
+    do {
+        if (ip >= len) {
+            return false;
+        }
+        b = src[ip++];
+        value += b;
+    } while (b == 255);
+    return true;
+}
+
+int32_t AP_Logger_Compress::decompress(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dst_size)
+{
+    uint32_t ip = 0;
+    uint32_t op = 0;
+    while (ip < len) {
+        const uint8_t token = src[ip++];
+        uint32_t lit_len = token >> 4;
+        if (lit_len == 15 && !read_length(src, ip, len, lit_len)) {
+            return -1;
+        }
+        if (lit_len > len - ip || lit_len > dst_size - op) {
+            return -1;
+        }
+        memcpy(&dst[op], &src[ip], lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == len) {
+            // the last sequence has no match
+            break;
+        }
+        if (len - ip < 2) {
+            return -1;
+        }
+        const uint16_t offset = src[ip] | (src[ip+1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return -1;
+        }
+        uint32_t match_len = token & 0x0F;
+        if (match_len == 15 && !read_length(src, ip, len, match_len)) {
+            return -1;
+        }
+        match_len += MINMATCH;
+        if (match_len > dst_size - op) {
+            return -1;
+        }
+        // matches may overlap the bytes they produce, so copy forwards
+        const uint8_t *ref = &dst[op - offset];
+        for (uint32_t i=0; i<match_len; i++) {
+            dst[op+i] = ref[i];
+        }
+        op += match_len;
+    }
+    return op;
+}
+
+int32_t AP_Logger_Compress::decode_frame(const struct log_compressed_frame &frame, const uint8_t *data,
+                                         uint8_t *dst, uint32_t dst_size)
+{
+    if (frame.magic1 != LOG_FRAME_MAGIC1 ||
+        frame.magic2 != LOG_FRAME_MAGIC2 ||
+        frame.raw_len > dst_size) {
+        return -1;
+    }
+    if (frame.flags & LOG_FRAME_FLAG_TRAILER) {
+        return frame.raw_len == 0 ? 0 : -1;
+    }
+    if (frame.flags & LOG_FRAME_FLAG_STORED) {
+        if (frame.data_len != frame.raw_len) {
+            return -1;
+        }
+        memcpy(dst, data, frame.raw_len);
+        return frame.raw_len;
+    }
+    const int32_t ret = decompress(data, frame.data_len, dst, frame.raw_len);
+    if (ret != (int32_t)frame.raw_len) {
+        return -1;
+    }
+    return ret;
+}
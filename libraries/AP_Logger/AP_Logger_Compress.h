@@ -0,0 +1,79 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+/*
+  fast block compression for log files, using the LZ4 block format
+  (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+
+  Compressed logs are a sequence of frames, each holding one
+  independently compressed chunk of the raw log, so a reader can
+  decode any frame without the ones before it. A raw log always
+  starts with HEAD_BYTE1, so readers tell the two apart by the first
+  frame's magic bytes
+ */
+
+#ifndef HAL_LOGGER_COMPRESS_HASH_BITS
+#define HAL_LOGGER_COMPRESS_HASH_BITS 10
+#endif
+
+#define LOG_FRAME_MAGIC1 'L'
+#define LOG_FRAME_MAGIC2 'Z'
+
+// frame data is stored uncompressed
+#define LOG_FRAME_FLAG_STORED (1U<<0)
+// last frame of a cleanly closed log, holding no raw data
+#define LOG_FRAME_FLAG_TRAILER (1U<<1)
+
+struct PACKED log_compressed_frame {
+    uint8_t magic1;
+    uint8_t magic2;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t raw_len;   // length of the raw log data in this frame
+    uint32_t data_len;  // length of the frame data following this header
+};
+
+/*
+  written at the end of a compressed log when it is closed, so the
+  raw size of the log can be found without reading every frame
+ */
+struct PACKED log_compressed_trailer {
+    struct log_compressed_frame frame;  // LOG_FRAME_FLAG_TRAILER, raw_len 0
+    uint32_t raw_size;                  // raw length of the whole log
+};
+
+class AP_Logger_Compress
+{
+public:
+    /*
+      compress len bytes of src into dst, returning the compressed
+      length or zero if it would not fit in dst_size bytes. len must
+      be less than 64k
+     */
+    uint32_t compress(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dst_size);
+
+    /*
+      decompress len bytes of src into dst, returning the
+      decompressed length or -1 if the data is corrupt or would
+      overflow dst_size
+     */
+    static int32_t decompress(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dst_size);
+
+    /*
+      decode a whole frame (header and data) into dst, returning the
+      raw length or -1 if the frame is corrupt. Trailer frames decode
+      to no data
+     */
+    static int32_t decode_frame(const struct log_compressed_frame &frame, const uint8_t *data,
+                                uint8_t *dst, uint32_t dst_size);
+
+    // true if the start of a file is a compressed frame
+    static bool is_frame_start(const uint8_t *buf, uint32_t len) {
+        return len >= 2 && buf[0] == LOG_FRAME_MAGIC1 && buf[1] == LOG_FRAME_MAGIC2;
+    }
+
+private:
+    // positions in the current block of recently seen 4 byte sequences
+    uint16_t hash_table[1U<<HAL_LOGGER_COMPRESS_HASH_BITS];
+};
@@ -49,7 +49,9 @@ AP_Logger_File::AP_Logger_File(AP_Logger &front,
     _perf_write(hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "DF_write")),
     _perf_fsync(hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "DF_fsync")),
     _perf_errors(hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "DF_errors")),
-    _perf_overruns(hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "DF_overruns"))
+    _perf_overruns(hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "DF_overruns")),
+    _perf_compress(hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "DF_compress")),
+    _index_fd(-1)
 {
     df_stats_clear();
 }
@@ -324,6 +326,7 @@ void AP_Logger_File::Prep_MinSpace()
                     break;
                 }
             } else {
+                unlink_index(filename_to_remove);
                 free(filename_to_remove);
             }
         }
@@ -441,6 +444,7 @@ void AP_Logger_File::EraseAll()
         }
         EXPECT_DELAY_MS(3000);
         AP::FS().unlink(fname);
+        unlink_index(fname);
         free(fname);
     }
     char *fname = _lastlog_file_name();
@@ -487,7 +491,71 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     if (!semaphore.take(1)) {
         return false;
     }
-        
+
+    if (!write_space_ok(size, is_critical)) {
+        semaphore.give();
+        return false;
+    }
+
+    _writebuf.write((uint8_t*)pBuffer, size);
+    df_stats_gather(size);
+    index_gather((const uint8_t *)pBuffer, size);
+    semaphore.give();
+    return true;
+}
+
+/*
+  reserve space for a message in the write buffer. On success the
+  semaphore is held until _commit_block()
+ */
+void *AP_Logger_File::_reserve_block(uint16_t size, bool is_critical)
+{
+    if (size > sizeof(_reserve_wrap_buf)) {
+        return nullptr;
+    }
+    if (! WriteBlockCheckStartupMessages()) {
+        _dropped++;
+        return nullptr;
+    }
+
+    if (!semaphore.take(1)) {
+        return nullptr;
+    }
+
+    if (!write_space_ok(size, is_critical)) {
+        semaphore.give();
+        return nullptr;
+    }
+
+    ByteBuffer::IoVec vec[2];
+    if (_writebuf.reserve(vec, size) == 1) {
+        _reserve_wrapped = false;
+        return vec[0].data;
+    }
+    _reserve_wrapped = true;
+    return _reserve_wrap_buf;
+}
+
+bool AP_Logger_File::_commit_block(const void *block, uint16_t size)
+{
+    if (_reserve_wrapped) {
+        _writebuf.write((const uint8_t *)block, size);
+    } else {
+        _writebuf.commit(size);
+    }
+    df_stats_gather(size);
+    index_gather((const uint8_t *)block, size);
+    semaphore.give();
+    return true;
+}
+
+void AP_Logger_File::_cancel_block()
+{
+    semaphore.give();
+}
+
+bool AP_Logger_File::write_space_ok(uint16_t size, bool is_critical)
+{
     uint32_t space = _writebuf.space();
 
     if (_writing_startup_messages &&
@@ -501,7 +569,6 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
         if (!must_dribble &&
             space < non_messagewriter_message_reserved_space()) {
             // this message isn't dropped, it will be sent again...
-            semaphore.give();
             return false;
         }
         last_messagewrite_message_sent = now;
@@ -509,7 +576,6 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
         // we reserve some amount of space for critical messages:
         if (!is_critical && space < critical_message_reserved_space()) {
             _dropped++;
-            semaphore.give();
             return false;
         }
     }
@@ -518,13 +584,8 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     if (space < size) {
         hal.util->perf_count(_perf_overruns);
         _dropped++;
-        semaphore.give();
         return false;
     }
-
-    _writebuf.write((uint8_t*)pBuffer, size);
-    df_stats_gather(size);
-    semaphore.give();
     return true;
 }
 
@@ -643,7 +704,7 @@ void AP_Logger_File::get_log_boundaries(const uint16_t list_entry, uint32_t & st
     }
 
     start_page = 0;
-    end_page = _get_log_size(log_num) / LOGGER_PAGE_SIZE;
+    end_page = _get_log_raw_size(log_num) / LOGGER_PAGE_SIZE;
 }
 
 /*
@@ -686,9 +747,26 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
         free(fname);
         _read_offset = 0;
         _read_fd_log_num = log_num;
+
+        // compressed logs are decompressed as they are downloaded
+        uint8_t magic[2];
+        _read_compressed = AP::FS().read(_read_fd, magic, sizeof(magic)) == sizeof(magic) &&
+            AP_Logger_Compress::is_frame_start(magic, sizeof(magic));
+        if (AP::FS().lseek(_read_fd, 0, SEEK_SET) == (off_t)-1) {
+            AP::FS().close(_read_fd);
+            _read_fd = -1;
+            return -1;
+        }
+        _read_raw_start = 0;
+        _read_raw_len = 0;
+        _read_frame_ofs = 0;
     }
     uint32_t ofs = page * (uint32_t)LOGGER_PAGE_SIZE + offset;
 
+    if (_read_compressed) {
+        return get_compressed_log_data(ofs, len, data);
+    }
+
     if (ofs != _read_offset) {
         if (AP::FS().lseek(_read_fd, ofs, SEEK_SET) == (off_t)-1) {
             AP::FS().close(_read_fd);
@@ -717,7 +795,7 @@ void AP_Logger_File::get_log_info(const uint16_t list_entry, uint32_t &size, uin
         return;
     }
 
-    size = _get_log_size(log_num);
+    size = _get_log_raw_size(log_num);
     time_utc = _get_log_time(log_num);
 }
 
@@ -756,10 +834,14 @@ void AP_Logger_File::stop_logging(void)
     // best-case effort to avoid annoying the IO thread
     const bool have_sem = write_fd_semaphore.take(hal.util->get_soft_armed()?1:20);
     if (_write_fd != -1) {
+        if (have_sem) {
+            write_trailer();
+        }
         int fd = _write_fd;
         _write_fd = -1;
         AP::FS().close(fd);
     }
+    index_close();
     if (have_sem) {
         write_fd_semaphore.give();
     }
@@ -846,6 +928,11 @@ void AP_Logger_File::start_new_log(void)
     _last_write_ms = AP_HAL::millis();
     _write_offset = 0;
     _writebuf.clear();
+    _frame_len = 0;
+    _frame_written = 0;
+    _raw_written = 0;
+    _write_compressed = _front._params.file_compress && alloc_compression();
+    index_open(_write_filename);
     write_fd_semaphore.give();
 
     // now update lastlog.txt with the new log number
@@ -881,7 +968,8 @@ void AP_Logger_File::flush(void)
 #if APM_BUILD_TYPE(APM_BUILD_Replay) || APM_BUILD_TYPE(APM_BUILD_UNKNOWN)
 {
     uint32_t tnow = AP_HAL::millis();
-    while (_write_fd != -1 && _initialised && !_open_error && _writebuf.available()) {
+    while (_write_fd != -1 && _initialised && !_open_error &&
+           (_writebuf.available() || _frame_len != 0)) {
         // convince the IO timer that it really is OK to write out
         // less than _writebuf_chunk bytes:
         if (tnow > 2001) { // avoid resetting _last_write_time to 0
@@ -914,10 +1002,10 @@ void AP_Logger_File::_io_timer(void)
     }
 
     uint32_t nbytes = _writebuf.available();
-    if (nbytes == 0) {
+    if (nbytes == 0 && _frame_len == 0) {
         return;
     }
-    if (nbytes < _writebuf_chunk && 
+    if (nbytes < _writebuf_chunk && _frame_len == 0 &&
         tnow - _last_write_time < 2000UL) {
         // write in _writebuf_chunk-sized chunks, but always write at
         // least once per 2 seconds if data is available
@@ -944,15 +1032,25 @@ void AP_Logger_File::_io_timer(void)
         nbytes = _writebuf_chunk;
     }
 
-    uint32_t size;
-    const uint8_t *head = _writebuf.readptr(size);
-    nbytes = MIN(nbytes, size);
-
-    // try to align writes on a 512 byte boundary to avoid filesystem reads
-    if ((nbytes + _write_offset) % 512 != 0) {
-        uint32_t ofs = (nbytes + _write_offset) % 512;
-        if (ofs < nbytes) {
-            nbytes -= ofs;
+    const uint8_t *head;
+    if (_write_compressed) {
+        // finish writing the last frame before starting another
+        if (_frame_len == 0) {
+            compress_frame(nbytes);
+        }
+        head = &_frame_buf[_frame_written];
+        nbytes = _frame_len - _frame_written;
+    } else {
+        uint32_t size;
+        head = _writebuf.readptr(size);
+        nbytes = MIN(nbytes, size);
+
+        // try to align writes on a 512 byte boundary to avoid filesystem reads
+        if ((nbytes + _write_offset) % 512 != 0) {
+            uint32_t ofs = (nbytes + _write_offset) % 512;
+            if (ofs < nbytes) {
+                nbytes -= ofs;
+            }
         }
     }
 
@@ -984,7 +1082,17 @@ void AP_Logger_File::_io_timer(void)
         _last_write_failed = false;
         _last_write_ms = tnow;
         _write_offset += nwritten;
-        _writebuf.advance(nwritten);
+        if (_write_compressed) {
+            _frame_written += nwritten;
+            if (_frame_written >= _frame_len) {
+                _raw_written += ((const struct log_compressed_frame *)_frame_buf)->raw_len;
+                _frame_len = 0;
+                _frame_written = 0;
+            }
+        } else {
+            _writebuf.advance(nwritten);
+        }
+        index_write_pending();
         /*
           the best strategy for minimizing corruption on microSD cards
           seems to be to write in 4k chunks and fsync the file on each
@@ -1101,6 +1209,347 @@ void AP_Logger_File::df_stats_log() {
     df_stats_clear();
 }
 
+/*
+  allocate the buffers for writing compressed logs
+ */
+bool AP_Logger_File::alloc_compression()
+{
+    if (_compressor == nullptr) {
+        _compressor = new AP_Logger_Compress;
+    }
+    if (_frame_buf == nullptr) {
+        _frame_buf = new uint8_t[sizeof(struct log_compressed_frame) + _writebuf_chunk];
+    }
+    return _compressor != nullptr && _frame_buf != nullptr;
+}
+
+/*
+  move up to nbytes from the front of _writebuf into a frame in
+  _frame_buf. Data which doesn't compress is stored as is
+ */
+void AP_Logger_File::compress_frame(uint32_t nbytes)
+{
+    uint32_t size;
+    const uint8_t *raw = _writebuf.readptr(size);
+    nbytes = MIN(nbytes, size);
+
+    hal.util->perf_begin(_perf_compress);
+    struct log_compressed_frame &frame = *(struct log_compressed_frame *)_frame_buf;
+    uint8_t *data = &_frame_buf[sizeof(frame)];
+    frame.magic1 = LOG_FRAME_MAGIC1;
+    frame.magic2 = LOG_FRAME_MAGIC2;
+    frame.flags = 0;
+    frame.reserved = 0;
+    frame.raw_len = nbytes;
+    frame.data_len = _compressor->compress(raw, nbytes, data, nbytes - 1);
+    if (frame.data_len == 0) {
+        frame.flags |= LOG_FRAME_FLAG_STORED;
+        frame.data_len = nbytes;
+        memcpy(data, raw, nbytes);
+    }
+    hal.util->perf_end(_perf_compress);
+
+    _frame_len = sizeof(frame) + frame.data_len;
+    _frame_written = 0;
+    _writebuf.advance(nbytes);
+}
+
+/*
+  read and decode the frame at _read_frame_ofs into _read_raw_buf
+ */
+bool AP_Logger_File::read_next_frame(uint32_t ofs)
+{
+    if (_read_raw_buf == nullptr) {
+        _read_raw_buf = new uint8_t[sizeof(struct log_compressed_frame) + 2*_writebuf_chunk];
+        if (_read_raw_buf == nullptr) {
+            return false;
+        }
+    }
+    // the frame data is read into the end of the buffer and decoded
+    // into the start
+    uint8_t *data = &_read_raw_buf[_writebuf_chunk];
+    struct log_compressed_frame frame;
+    if (AP::FS().lseek(_read_fd, _read_frame_ofs, SEEK_SET) == (off_t)-1 ||
+        AP::FS().read(_read_fd, &frame, sizeof(frame)) != sizeof(frame) ||
+        frame.data_len > _writebuf_chunk) {
+        return false;
+    }
+    if (_read_raw_start + _read_raw_len + frame.raw_len <= ofs) {
+        // the frame ends before ofs, skip it without reading its data
+        _read_raw_start += _read_raw_len + frame.raw_len;
+        _read_raw_len = 0;
+        _read_frame_ofs += sizeof(frame) + frame.data_len;
+        return true;
+    }
+    if (
+        AP::FS().read(_read_fd, data, frame.data_len) != (ssize_t)frame.data_len) {
+        return false;
+    }
+    const int32_t raw_len = AP_Logger_Compress::decode_frame(frame, data, _read_raw_buf, _writebuf_chunk);
+    if (raw_len < 0) {
+        return false;
+    }
+    _read_raw_start += _read_raw_len;
+    _read_raw_len = raw_len;
+    _read_frame_ofs += sizeof(frame) + frame.data_len;
+    return true;
+}
+
+/*
+  get_log_data() for compressed logs, where ofs is an offset in the
+  raw log. Downloads are sequential, so frames are decoded in order.
+  Seeking backwards starts again from the first frame, and frames
+  before the offset are skipped using their headers
+ */
+int16_t AP_Logger_File::get_compressed_log_data(uint32_t ofs, uint16_t len, uint8_t *data)
+{
+    if (ofs < _read_raw_start) {
+        _read_raw_start = 0;
+        _read_raw_len = 0;
+        _read_frame_ofs = 0;
+    }
+    while (ofs >= _read_raw_start + _read_raw_len) {
+        if (!read_next_frame(ofs)) {
+            // end of the log
+            return 0;
+        }
+    }
+    const uint32_t n = MIN(uint32_t(len), _read_raw_start + _read_raw_len - ofs);
+    memcpy(data, &_read_raw_buf[ofs - _read_raw_start], n);
+    return n;
+}
+
+/*
+  append a trailer frame holding the raw size of the log, called with
+  write_fd_semaphore held just before the log is closed. Nothing is
+  written if a frame has only been partly written, as the trailer
+  would then be read as part of that frame
+ */
+void AP_Logger_File::write_trailer()
+{
+    if (!_write_compressed || _frame_written != 0) {
+        return;
+    }
+    struct log_compressed_trailer trailer {};
+    trailer.frame.magic1 = LOG_FRAME_MAGIC1;
+    trailer.frame.magic2 = LOG_FRAME_MAGIC2;
+    trailer.frame.flags = LOG_FRAME_FLAG_TRAILER;
+    trailer.frame.data_len = sizeof(trailer.raw_size);
+    trailer.raw_size = _raw_written;
+    if (AP::FS().write(_write_fd, &trailer, sizeof(trailer)) == sizeof(trailer)) {
+        _write_offset += sizeof(trailer);
+    }
+}
+
+/*
+  find the size of the raw log data in a log. Compressed logs which
+  were closed cleanly end with a trailer holding the size; for any
+  others the frame headers are walked
+ */
+uint32_t AP_Logger_File::_get_log_raw_size(const uint16_t log_num)
+{
+    char *fname = _log_file_name(log_num);
+    if (fname == nullptr) {
+        return 0;
+    }
+    if (_write_fd != -1 && write_fd_semaphore.take_nonblocking()) {
+        if (_write_filename != nullptr && strcmp(_write_filename, fname) == 0) {
+            // it is the file we are currently writing
+            free(fname);
+            const uint32_t ret = _write_compressed ? _raw_written : _write_offset;
+            write_fd_semaphore.give();
+            return ret;
+        }
+        write_fd_semaphore.give();
+    }
+    EXPECT_DELAY_MS(3000);
+    const int fd = AP::FS().open(fname, O_RDONLY);
+    free(fname);
+    if (fd == -1) {
+        return 0;
+    }
+    struct log_compressed_frame frame;
+    if (AP::FS().read(fd, &frame, sizeof(frame)) != sizeof(frame) ||
+        frame.magic1 != LOG_FRAME_MAGIC1 || frame.magic2 != LOG_FRAME_MAGIC2) {
+        AP::FS().close(fd);
+        return _get_log_size(log_num);
+    }
+    struct log_compressed_trailer trailer;
+    if (AP::FS().lseek(fd, -(off_t)sizeof(trailer), SEEK_END) != (off_t)-1 &&
+        AP::FS().read(fd, &trailer, sizeof(trailer)) == sizeof(trailer) &&
+        trailer.frame.magic1 == LOG_FRAME_MAGIC1 &&
+        trailer.frame.magic2 == LOG_FRAME_MAGIC2 &&
+        (trailer.frame.flags & LOG_FRAME_FLAG_TRAILER) &&
+        trailer.frame.raw_len == 0 &&
+        trailer.frame.data_len == sizeof(trailer.raw_size)) {
+        AP::FS().close(fd);
+        return trailer.raw_size;
+    }
+    // the log was not closed cleanly
+    uint32_t raw_size = 0;
+    uint32_t ofs = 0;
+    do {
+        if (frame.magic1 != LOG_FRAME_MAGIC1 || frame.magic2 != LOG_FRAME_MAGIC2) {
+            break;
+        }
+        raw_size += frame.raw_len;
+        ofs += sizeof(frame) + frame.data_len;
+    } while (AP::FS().lseek(fd, ofs, SEEK_SET) != (off_t)-1 &&
+             AP::FS().read(fd, &frame, sizeof(frame)) == sizeof(frame));
+    AP::FS().close(fd);
+    return raw_size;
+}
+
+/*
+  return the name of the index file for a log. Caller must free
+ */
+char *AP_Logger_File::_index_file_name(const char *log_filename) const
+{
+    const size_t len = strlen(log_filename);
+    if (len < 4 || strcmp(&log_filename[len-4], ".BIN") != 0) {
+        return nullptr;
+    }
+    char *buf = strdup(log_filename);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    memcpy(&buf[len-3], "IDX", 3);
+    return buf;
+}
+
+void AP_Logger_File::unlink_index(const char *log_filename) const
+{
+    char *fname = _index_file_name(log_filename);
+    if (fname == nullptr) {
+        return;
+    }
+    if (file_exists(fname)) {
+        AP::FS().unlink(fname);
+    }
+    free(fname);
+}
+
+/*
+  open the index file for a new log, called with write_fd_semaphore
+  held. Any stale index from an earlier log with the same number is
+  removed even if indexing is disabled
+ */
+void AP_Logger_File::index_open(const char *log_filename)
+{
+    _raw_offset = 0;
+    _index_entry_open = false;
+    _index_block_size = 0;
+
+    const int16_t block_kb = _front._params.file_index;
+    if (block_kb <= 0) {
+        unlink_index(log_filename);
+        return;
+    }
+    if (_index_queue == nullptr) {
+        _index_queue = new ObjectBuffer_SPSC<struct log_index_entry>(16);
+        if (_index_queue == nullptr) {
+            return;
+        }
+    }
+    _index_queue->clear();
+
+    char *fname = _index_file_name(log_filename);
+    if (fname == nullptr) {
+        return;
+    }
+    EXPECT_DELAY_MS(3000);
+    _index_fd = AP::FS().open(fname, O_WRONLY|O_CREAT|O_TRUNC);
+    free(fname);
+    if (_index_fd == -1) {
+        return;
+    }
+    struct log_index_header hdr {};
+    memcpy(hdr.magic, LOG_INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.version = LOG_INDEX_VERSION;
+    hdr.entry_size = sizeof(struct log_index_entry);
+    hdr.block_size = uint32_t(block_kb) * 1024U;
+    if (AP::FS().write(_index_fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        AP::FS().close(_index_fd);
+        _index_fd = -1;
+        return;
+    }
+    _index_block_size = hdr.block_size;
+}
+
+/*
+  add a message to the index, called with semaphore held after the
+  message has gone into _writebuf. An entry is only started once the
+  previous one has been queued for the IO thread, so if the queue is
+  full entries grow rather than being lost
+ */
+void AP_Logger_File::index_gather(const uint8_t *pkt, uint16_t size)
+{
+    const uint32_t offset = _raw_offset;
+    _raw_offset += size;
+    if (_index_block_size == 0 || size < 3 ||
+        pkt[0] != HEAD_BYTE1 || pkt[1] != HEAD_BYTE2) {
+        return;
+    }
+    if (!_index_entry_open || offset >= _index_next_offset) {
+        if (!_index_entry_open || _index_queue->push(_index_entry)) {
+            memset(&_index_entry, 0, sizeof(_index_entry));
+            _index_entry.offset = offset;
+            _index_entry_open = true;
+            _index_next_offset = (offset / _index_block_size + 1) * _index_block_size;
+        }
+    }
+    const uint8_t msg_type = pkt[2];
+    _index_entry.set_type(msg_type);
+    if (_index_entry.time_us == 0 &&
+        size >= 3 + sizeof(uint64_t) &&
+        msg_type_has_time_us(msg_type)) {
+        memcpy(&_index_entry.time_us, &pkt[3], sizeof(uint64_t));
+    }
+}
+
+/*
+  append queued index entries to the index file, called from the IO
+  thread with write_fd_semaphore held
+ */
+void AP_Logger_File::index_write_pending()
+{
+    if (_index_fd == -1 || _index_queue == nullptr) {
+        return;
+    }
+    struct log_index_entry entry;
+    while (_index_queue->peek(entry)) {
+        if (AP::FS().write(_index_fd, &entry, sizeof(entry)) != sizeof(entry)) {
+            // give up on the index rather than leave a gap in it
+            AP::FS().close(_index_fd);
+            _index_fd = -1;
+            _index_block_size = 0;
+            return;
+        }
+        _index_queue->pop();
+    }
+}
+
+/*
+  write out the last index entry and close the index file
+ */
+void AP_Logger_File::index_close()
+{
+    if (_index_fd == -1) {
+        return;
+    }
+    {
+        WITH_SEMAPHORE(semaphore);
+        if (_index_block_size != 0 && _index_entry_open) {
+            _index_queue->push(_index_entry);
+            _index_entry_open = false;
+        }
+        _index_block_size = 0;
+    }
+    index_write_pending();
+    const int fd = _index_fd;
+    _index_fd = -1;
+    AP::FS().close(fd);
+}
 
 #endif // HAVE_FILESYSTEM_SUPPORT
 
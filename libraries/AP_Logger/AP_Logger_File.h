@@ -12,6 +12,8 @@
 
 #include <AP_HAL/utility/RingBuffer.h>
 #include "AP_Logger_Backend.h"
+#include "AP_Logger_Compress.h"
+#include "AP_Logger_Index.h"
 
 class AP_Logger_File : public AP_Logger_Backend
 {
@@ -65,6 +67,11 @@ protected:
     bool WritesOK() const override;
     bool StartNewLogOK() const override;
 
+    // serialise messages directly into _writebuf
+    void *_reserve_block(uint16_t size, bool is_critical) override;
+    bool _commit_block(const void *block, uint16_t size) override;
+    void _cancel_block() override;
+
 private:
     int _write_fd;
     char *_write_filename;
@@ -147,6 +154,15 @@ private:
     };
     uint32_t last_messagewrite_message_sent;
 
+    // check there is room in _writebuf for a message, called with
+    // semaphore held
+    bool write_space_ok(uint16_t size, bool is_critical);
+
+    // a reservation which would wrap around the end of _writebuf is
+    // built here and copied in by _commit_block()
+    uint8_t _reserve_wrap_buf[UINT8_MAX];
+    bool _reserve_wrapped;
+
     // free-space checks; filling up SD cards under NuttX leads to
     // corrupt filesystems which cause loss of data, failure to gather
     // data and failures-to-boot.
@@ -166,6 +182,51 @@ private:
     AP_HAL::Util::perf_counter_t  _perf_fsync;
     AP_HAL::Util::perf_counter_t  _perf_errors;
     AP_HAL::Util::perf_counter_t  _perf_overruns;
+    AP_HAL::Util::perf_counter_t  _perf_compress;
+
+    /*
+      LOG_FILE_COMPR support. When a log is opened with compression
+      enabled the IO thread compresses each chunk of _writebuf into
+      a frame in _frame_buf and writes that instead
+     */
+    AP_Logger_Compress *_compressor;
+    uint8_t *_frame_buf;
+    uint32_t _frame_len;        // length of the frame in _frame_buf
+    uint32_t _frame_written;    // bytes of the frame already written
+    uint32_t _raw_written;      // raw bytes in the frames written so far
+    bool _write_compressed;
+    bool alloc_compression();
+    void compress_frame(uint32_t nbytes);
+    void write_trailer();
+
+    // decompression of compressed logs for get_log_data()
+    bool _read_compressed;
+    uint8_t *_read_raw_buf;
+    uint32_t _read_raw_start;   // raw log offset of _read_raw_buf
+    uint32_t _read_raw_len;     // raw bytes in _read_raw_buf
+    uint32_t _read_frame_ofs;   // file offset of the next frame
+    int16_t get_compressed_log_data(uint32_t ofs, uint16_t len, uint8_t *data);
+    bool read_next_frame(uint32_t ofs);
+    uint32_t _get_log_raw_size(uint16_t log_num);
+
+    /*
+      LOG_FILE_INDEX support. Message boundaries are gathered into
+      index entries as messages go into _writebuf, and the IO thread
+      appends completed entries to the .IDX file for the log
+     */
+    int _index_fd;
+    uint32_t _index_block_size;     // zero if not indexing this log
+    uint32_t _raw_offset;           // raw log bytes put in _writebuf
+    uint32_t _index_next_offset;    // raw offset at which the next entry starts
+    struct log_index_entry _index_entry;
+    bool _index_entry_open;
+    ObjectBuffer_SPSC<struct log_index_entry> *_index_queue;
+    char *_index_file_name(const char *log_filename) const;
+    void unlink_index(const char *log_filename) const;
+    void index_open(const char *log_filename);
+    void index_gather(const uint8_t *pkt, uint16_t size);
+    void index_write_pending();
+    void index_close();
 
     const char *last_io_operation = "";
 
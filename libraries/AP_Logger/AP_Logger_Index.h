@@ -0,0 +1,36 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+/*
+  sidecar index for log files, written alongside each log as
+  NNN.IDX when LOG_FILE_INDEX is non-zero. The file is a header
+  followed by one entry for each block of the raw log.
+
+  A new entry starts at the first message boundary at or after each
+  multiple of the block size, so readers can seek to entry offsets
+  and parse from there. Offsets are in the raw (uncompressed) log
+ */
+
+#define LOG_INDEX_MAGIC "LIDX"
+#define LOG_INDEX_VERSION 1
+
+struct PACKED log_index_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t entry_size;
+    uint32_t block_size;
+};
+
+struct PACKED log_index_entry {
+    uint32_t offset;    // raw log offset of the first message in the entry
+    uint64_t time_us;   // TimeUS of the first timestamped message, zero if none
+    uint8_t types[32];  // bitmask of the message types in the entry
+
+    bool has_type(uint8_t type) const {
+        return types[type/8] & (1U<<(type%8));
+    }
+    void set_type(uint8_t type) {
+        types[type/8] |= (1U<<(type%8));
+    }
+};
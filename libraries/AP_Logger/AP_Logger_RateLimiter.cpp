@@ -0,0 +1,177 @@
+#include "AP_Logger_RateLimiter.h"
+
+#include "AP_Logger.h"
+
+extern const AP_HAL::HAL& hal;
+
+// message types which are not streams, and are never limited by
+// LOG_RATEMAX. They can still be limited by an explicit LOG_RATEn_ID
+static const uint8_t unlimited_types[] = {
+    LOG_PARAMETER_MSG,
+    LOG_CMD_MSG,
+    LOG_RALLY_MSG,
+    LOG_ISBH_MSG,
+    LOG_ISBD_MSG,
+    LOG_FORMAT_MSG,
+    LOG_FORMAT_UNITS_MSG,
+    LOG_UNIT_MSG,
+    LOG_MULT_MSG,
+    LOG_MESSAGE_MSG,
+    LOG_MODE_MSG,
+    LOG_EVENT_MSG,
+    LOG_ERROR_MSG,
+    LOG_ARM_DISARM_MSG,
+    LOG_DF_FILE_STATS,
+    LOG_DF_RATE_LIMIT_MSG,
+};
+
+AP_Logger_RateLimiter::AP_Logger_RateLimiter(AP_Logger &front) :
+    _front(front)
+{
+}
+
+float AP_Logger_RateLimiter::rate_hz(uint8_t msg_type) const
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(_front._params.rate_id); i++) {
+        if (_front._params.rate_id[i] == msg_type) {
+            return _front._params.rate_hz[i];
+        }
+    }
+    for (uint8_t i=0; i<ARRAY_SIZE(unlimited_types); i++) {
+        if (unlimited_types[i] == msg_type) {
+            return 0;
+        }
+    }
+    return _front._params.rate_max;
+}
+
+/*
+  find the offset of the instance field in messages of msg_type,
+  returning 1 if there isn't one (a message header byte is never an
+  instance)
+ */
+uint8_t AP_Logger_RateLimiter::instance_offset(uint8_t msg_type)
+{
+    uint8_t &ofs = _instance_offset[msg_type];
+    if (ofs != 0) {
+        return ofs;
+    }
+    ofs = 1;
+
+    const char *fmt = nullptr;
+    const char *units = nullptr;
+    const struct LogStructure *s = _front.structure_for_msg_type(msg_type);
+    if (s != nullptr) {
+        fmt = s->format;
+        units = s->units;
+    } else {
+        const struct AP_Logger::log_write_fmt *f = _front.log_write_fmt_for_msg_type(msg_type);
+        if (f != nullptr) {
+            fmt = f->fmt;
+            units = f->units;
+        }
+    }
+    if (fmt == nullptr || units == nullptr) {
+        return ofs;
+    }
+    const char *p = strchr(units, '#');
+    if (p == nullptr) {
+        return ofs;
+    }
+    const uint8_t idx = p - units;
+    if (idx >= strlen(fmt) || fmt[idx] != 'B') {
+        return ofs;
+    }
+    // the instance comes after the fields before it in the format
+    char prefix[LS_FORMAT_SIZE] {};
+    if (idx >= sizeof(prefix)) {
+        return ofs;
+    }
+    memcpy(prefix, fmt, idx);
+    const int16_t len = _front.Write_calc_msg_len(prefix);
+    if (len > 1 && len < 256) {
+        ofs = len;
+    }
+    return ofs;
+}
+
+/*
+  find or allocate the entry for a message type and instance
+ */
+AP_Logger_RateLimiter::entry *AP_Logger_RateLimiter::find_entry(uint8_t msg_type, uint8_t instance)
+{
+    const uint8_t start = (msg_type * 7U + instance) % max_entries;
+    for (uint8_t i=0; i<max_entries; i++) {
+        struct entry &e = _entries[(start + i) % max_entries];
+        if (!e.used) {
+            e.msg_type = msg_type;
+            e.instance = instance;
+            // always allow the first message through
+            e.last_ms = AP_HAL::millis16() - UINT16_MAX;
+            e.dropped = 0;
+            e.used = true;
+            return &e;
+        }
+        if (e.msg_type == msg_type && e.instance == instance) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+/*
+  decide if a message should be logged. This may be called from
+  several threads; a race here can only miscount or let an extra
+  message through
+ */
+bool AP_Logger_RateLimiter::should_log(const uint8_t *pkt, uint16_t size)
+{
+    if (size < LOG_PACKET_HEADER_LEN) {
+        return true;
+    }
+    const uint8_t msg_type = pkt[2];
+    const float rate = rate_hz(msg_type);
+    if (!is_positive(rate)) {
+        return true;
+    }
+    const uint8_t ofs = instance_offset(msg_type);
+    const uint8_t instance = (ofs > 1 && ofs < size) ? pkt[ofs] : 0;
+    struct entry *e = find_entry(msg_type, instance);
+    if (e == nullptr) {
+        return true;
+    }
+
+    const uint16_t interval_ms = MIN(1000.0f / rate, 60000.0f);
+    const uint16_t now = AP_HAL::millis16();
+    const uint16_t elapsed = now - e->last_ms;
+    if (elapsed < interval_ms) {
+        e->dropped++;
+        _dropped++;
+        return false;
+    }
+    // keep to the requested rate rather than drifting later each
+    // time, unless we have fallen well behind
+    if (elapsed < 2 * interval_ms) {
+        e->last_ms += interval_ms;
+    } else {
+        e->last_ms = now;
+    }
+    return true;
+}
+
+bool AP_Logger_RateLimiter::next_dropped(uint8_t &idx, uint8_t &msg_type, uint8_t &instance, uint16_t &dropped)
+{
+    for (; idx<max_entries; idx++) {
+        struct entry &e = _entries[idx];
+        if (!e.used || e.dropped == 0) {
+            continue;
+        }
+        msg_type = e.msg_type;
+        instance = e.instance;
+        dropped = e.dropped;
+        e.dropped = 0;
+        idx++;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+class AP_Logger;
+
+/*
+  limit the rate at which streaming messages are logged, per message
+  type and instance. Instances are taken from the field with the '#'
+  (instance) unit, so e.g. each EKF core is limited separately.
+
+  Only non-critical messages are limited. The decision is made on the
+  message header and instance field before the message is copied into
+  the backend's buffer
+ */
+class AP_Logger_RateLimiter
+{
+public:
+    AP_Logger_RateLimiter(AP_Logger &front);
+
+    // return true if the message in pkt should be logged now
+    bool should_log(const uint8_t *pkt, uint16_t size);
+
+    // return the message rate limit for msg_type in Hz, zero for no limit
+    float rate_hz(uint8_t msg_type) const;
+
+    // total number of messages dropped by the rate limit
+    uint32_t num_dropped() const { return _dropped; }
+
+    /*
+      iterate over the types which have had messages dropped since
+      the last call for each. Returns false when there are no more
+    */
+    bool next_dropped(uint8_t &idx, uint8_t &msg_type, uint8_t &instance, uint16_t &dropped);
+
+private:
+    AP_Logger &_front;
+
+    // number of message type/instance pairs which can be tracked;
+    // messages beyond this are not limited
+    static const uint8_t max_entries = 64;
+
+    struct entry {
+        uint8_t msg_type;
+        uint8_t instance;
+        uint16_t last_ms;
+        uint16_t dropped;
+        bool used;
+    } _entries[max_entries];
+
+    // offset of the instance field for each message type: 0 if not
+    // yet looked up, 1 if the type has no instance field
+    uint8_t _instance_offset[256];
+
+    uint32_t _dropped;
+
+    uint8_t instance_offset(uint8_t msg_type);
+    struct entry *find_entry(uint8_t msg_type, uint8_t instance);
+};
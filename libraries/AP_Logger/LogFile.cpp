@@ -290,24 +290,29 @@ void AP_Logger::Write_IMU_instance(const uint64_t time_us, const uint8_t imu_ins
     const AP_InertialSensor &ins = AP::ins();
     const Vector3f &gyro = ins.get_gyro(imu_instance);
     const Vector3f &accel = ins.get_accel(imu_instance);
-    const struct log_IMU pkt{
-        LOG_PACKET_HEADER_INIT(type),
-        time_us : time_us,
-        gyro_x  : gyro.x,
-        gyro_y  : gyro.y,
-        gyro_z  : gyro.z,
-        accel_x : accel.x,
-        accel_y : accel.y,
-        accel_z : accel.z,
-        gyro_error  : ins.get_gyro_error_count(imu_instance),
-        accel_error : ins.get_accel_error_count(imu_instance),
-        temperature : ins.get_temperature(imu_instance),
-        gyro_health : (uint8_t)ins.get_gyro_health(imu_instance),
-        accel_health : (uint8_t)ins.get_accel_health(imu_instance),
-        gyro_rate : ins.get_gyro_rate_hz(imu_instance),
-        accel_rate : ins.get_accel_rate_hz(imu_instance),
-    };
-    WriteBlock(&pkt, sizeof(pkt));
+    struct log_IMU fallback;
+    struct log_IMU *pkt = (struct log_IMU *)reserve_block(sizeof(*pkt), &fallback);
+    if (pkt == nullptr) {
+        return;
+    }
+    pkt->head1 = HEAD_BYTE1;
+    pkt->head2 = HEAD_BYTE2;
+    pkt->msgid = type;
+    pkt->time_us = time_us;
+    pkt->gyro_x = gyro.x;
+    pkt->gyro_y = gyro.y;
+    pkt->gyro_z = gyro.z;
+    pkt->accel_x = accel.x;
+    pkt->accel_y = accel.y;
+    pkt->accel_z = accel.z;
+    pkt->gyro_error = ins.get_gyro_error_count(imu_instance);
+    pkt->accel_error = ins.get_accel_error_count(imu_instance);
+    pkt->temperature = ins.get_temperature(imu_instance);
+    pkt->gyro_health = (uint8_t)ins.get_gyro_health(imu_instance);
+    pkt->accel_health = (uint8_t)ins.get_accel_health(imu_instance);
+    pkt->gyro_rate = ins.get_gyro_rate_hz(imu_instance);
+    pkt->accel_rate = ins.get_accel_rate_hz(imu_instance);
+    commit_block(pkt, &fallback, sizeof(*pkt));
 }
 
 // Write an raw accel/gyro data packet
@@ -1036,3 +1041,19 @@ void AP_Logger::Write_OADijkstra(uint8_t state, uint8_t error_id, uint8_t curr_p
     };
     WriteBlock(&pkt, sizeof(pkt));
 }
+
+void AP_Logger::Write_OAPathPlanner(uint8_t type, uint8_t state, uint32_t latency_ms, uint32_t latency_max_ms, uint32_t age_max_ms, uint16_t cancelled, uint16_t late)
+{
+    const struct log_OAPathPlanner pkt{
+        LOG_PACKET_HEADER_INIT(LOG_OA_PLANNER_MSG),
+        time_us         : AP_HAL::micros64(),
+        type            : type,
+        state           : state,
+        latency_ms      : latency_ms,
+        latency_max_ms  : latency_max_ms,
+        age_max_ms      : age_max_ms,
+        cancelled       : cancelled,
+        late            : late
+    };
+    WriteBlock(&pkt, sizeof(pkt));
+}
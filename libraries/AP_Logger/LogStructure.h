@@ -185,6 +185,14 @@ struct PACKED log_DSF {
     uint32_t buf_space_avg;
 };
 
+struct PACKED log_DRL {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t msg_type;
+    uint8_t instance;
+    uint16_t dropped;
+};
+
 struct PACKED log_Event {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -1213,6 +1221,18 @@ struct PACKED log_OADijkstra {
     int32_t oa_lng;
 };
 
+struct PACKED log_OAPathPlanner {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t type;
+    uint8_t state;
+    uint32_t latency_ms;
+    uint32_t latency_max_ms;
+    uint32_t age_max_ms;
+    uint16_t cancelled;
+    uint16_t late;
+};
+
 struct PACKED log_DSTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -1392,6 +1412,8 @@ struct PACKED log_Arm_Disarm {
       "OABR","QBHHfLLLL","TimeUS,Active,DesYaw,Yaw,Mar,DLat,DLng,OALat,OALng", "sbddmDUDU", "F----GGGG" }, \
     { LOG_OA_DIJKSTRA_MSG, sizeof(log_OADijkstra), \
       "OADJ","QBBBBLLLL","TimeUS,State,Err,CurrPoint,TotPoints,DLat,DLng,OALat,OALng", "sbbbbDUDU", "F----GGGG" }, \
+    { LOG_OA_PLANNER_MSG, sizeof(log_OAPathPlanner), \
+      "OAPL","QBBIIIHH","TimeUS,Type,State,Lcy,LcyMax,AgeMax,Canc,Late", "s--sss--", "F--CCC--" }, \
     { LOG_IMU2_MSG, sizeof(log_IMU), \
       "IMU2",  IMU_FMT,     IMU_LABELS, IMU_UNITS, IMU_MULTS }, \
     { LOG_IMU3_MSG, sizeof(log_IMU), \
@@ -1520,6 +1542,8 @@ struct PACKED log_Arm_Disarm {
       "ORGN","QBLLe","TimeUS,Type,Lat,Lng,Alt", "s-DUm", "F-GGB" },   \
     { LOG_DF_FILE_STATS, sizeof(log_DSF), \
       "DSF", "QIHIIII", "TimeUS,Dp,Blk,Bytes,FMn,FMx,FAv", "s--b---", "F--0---" }, \
+    { LOG_DF_RATE_LIMIT_MSG, sizeof(log_DRL), \
+      "DRL", "QBBH", "TimeUS,Type,I,Dp", "s-#-", "F---" }, \
     { LOG_RPM_MSG, sizeof(log_RPM), \
       "RPM",  "Qff", "TimeUS,rpm1,rpm2", "sqq", "F00" }, \
     { LOG_GIMBAL1_MSG, sizeof(log_Gimbal1), \
@@ -1699,6 +1723,8 @@ enum LogMessages : uint8_t {
     LOG_ARM_DISARM_MSG,
     LOG_OA_BENDYRULER_MSG,
     LOG_OA_DIJKSTRA_MSG,
+    LOG_DF_RATE_LIMIT_MSG,
+    LOG_OA_PLANNER_MSG,
 
     _LOG_LAST_MSG_
 };
@@ -0,0 +1,128 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Logger/AP_Logger_Compress.h>
+#include <AP_Logger/LogStructure.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+  measure the IO thread cost and compression ratio of LOG_FILE_COMPR,
+  compressing a log in the same sized chunks as AP_Logger_File. Set
+  LOG_BENCHMARK_FILE to the path of a real dataflash log to use it,
+  otherwise a synthetic stream of IMU, attitude and GPS messages is
+  used. Time per iteration is the IO thread time per chunk
+ */
+
+static const uint32_t chunk_size = 4096;
+static const uint32_t max_log_size = 16*1024*1024;
+
+static uint8_t *log_data;
+static uint32_t log_size;
+
+static void load_log()
+{
+    if (log_data != nullptr) {
+        return;
+    }
+    log_data = new uint8_t[max_log_size];
+
+    const char *fname = getenv("LOG_BENCHMARK_FILE");
+    if (fname != nullptr) {
+        FILE *f = fopen(fname, "rb");
+        if (f != nullptr) {
+            log_size = fread(log_data, 1, max_log_size, f);
+            fclose(f);
+            return;
+        }
+    }
+
+    // synthetic log: slowly changing sensor data at typical rates
+    struct log_IMU imu {};
+    imu.head1 = HEAD_BYTE1;
+    imu.head2 = HEAD_BYTE2;
+    imu.msgid = LOG_IMU_MSG;
+    struct log_GPS gps {};
+    gps.head1 = HEAD_BYTE1;
+    gps.head2 = HEAD_BYTE2;
+    gps.msgid = LOG_GPS_MSG;
+    uint32_t state = 1;
+    for (uint32_t loop=0; log_size + sizeof(imu) + sizeof(gps) < max_log_size/4; loop++) {
+        state = state * 1103515245U + 12345U;
+        imu.time_us += 2500;
+        imu.gyro_x = sinf(loop * 0.01f) + (state >> 20) * 1.0e-6f;
+        imu.accel_z = -9.8f + (state >> 16) * 1.0e-6f;
+        memcpy(&log_data[log_size], &imu, sizeof(imu));
+        log_size += sizeof(imu);
+        if (loop % 80 == 0) {
+            gps.time_us = imu.time_us;
+            gps.latitude = -353632610 + loop / 10;
+            gps.longitude = 1491652300 + loop / 20;
+            memcpy(&log_data[log_size], &gps, sizeof(gps));
+            log_size += sizeof(gps);
+        }
+    }
+}
+
+static void BM_CompressChunk(benchmark::State& state)
+{
+    static AP_Logger_Compress compressor;
+    static uint8_t frame[chunk_size];
+    load_log();
+    uint32_t ofs = 0;
+    uint64_t raw_total = 0;
+    uint64_t compressed_total = 0;
+
+    while (state.KeepRunning()) {
+        const uint32_t n = MIN(chunk_size, log_size - ofs);
+        uint32_t len = compressor.compress(&log_data[ofs], n, frame, n - 1);
+        if (len == 0) {
+            // stored
+            len = n;
+        }
+        gbenchmark_escape(frame);
+        raw_total += n;
+        compressed_total += len + sizeof(struct log_compressed_frame);
+        ofs += n;
+        if (ofs >= log_size) {
+            ofs = 0;
+        }
+    }
+
+    state.SetBytesProcessed(raw_total);
+    char label[60];
+    snprintf(label, sizeof(label), "ratio %.2f", compressed_total ? double(raw_total) / compressed_total : 0);
+    state.SetLabel(label);
+}
+
+static void BM_DecompressChunk(benchmark::State& state)
+{
+    static AP_Logger_Compress compressor;
+    static uint8_t frames[max_log_size/chunk_size][chunk_size];
+    static uint32_t frame_len[max_log_size/chunk_size];
+    static uint8_t raw[chunk_size];
+    load_log();
+    const uint32_t nframes = (log_size + chunk_size - 1) / chunk_size;
+    for (uint32_t i=0; i<nframes; i++) {
+        const uint32_t n = MIN(chunk_size, log_size - i*chunk_size);
+        frame_len[i] = compressor.compress(&log_data[i*chunk_size], n, frames[i], chunk_size);
+    }
+    uint32_t i = 0;
+    uint64_t raw_total = 0;
+
+    while (state.KeepRunning()) {
+        const int32_t n = AP_Logger_Compress::decompress(frames[i], frame_len[i], raw, sizeof(raw));
+        gbenchmark_escape(raw);
+        raw_total += n;
+        i = (i + 1) % nframes;
+    }
+
+    state.SetBytesProcessed(raw_total);
+}
+
+BENCHMARK(BM_CompressChunk);
+BENCHMARK(BM_DecompressChunk);
+
+BENCHMARK_MAIN()
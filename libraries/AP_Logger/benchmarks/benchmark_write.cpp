@@ -0,0 +1,204 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/AP_Logger_File.h>
+#include <AP_Logger/LoggerMessageWriter.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  compare copying log messages into an AP_Logger_File write buffer
+  from a stack packet (WriteBlock) against serialising them in place
+  (reserve_block/commit_block). Each iteration is the logging done in
+  one 400Hz main loop: three IMU messages and one ISBD batch sample
+  message. The log is written to a tmpfs directory, and whenever the
+  buffer cannot take another loop the backend is flushed to the file
+  as the IO thread would. The flush runs outside the timed region, as
+  the IO thread does not run in the main loop
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const char *log_directory = "/dev/shm/ap_logger_bench";
+
+static const struct LogStructure log_structure[] = {
+    LOG_COMMON_STRUCTURES
+};
+
+static GCS_Dummy _gcs;
+static AP_Int32 logger_bitmask;
+static AP_Logger logger{logger_bitmask};
+static AP_Logger_File *backend;
+
+static int16_t samples[32];
+
+static const uint32_t loop_bytes = 3*sizeof(log_IMU) + sizeof(log_ISBD);
+
+static void write_copy(uint64_t time_us)
+{
+    const struct log_IMU pkt{
+        LOG_PACKET_HEADER_INIT(LOG_IMU_MSG),
+        time_us : time_us,
+        gyro_x  : 0.1f,
+        gyro_y  : 0.2f,
+        gyro_z  : 0.3f,
+        accel_x : 0.0f,
+        accel_y : 0.0f,
+        accel_z : -9.8f,
+        gyro_error  : 0,
+        accel_error : 0,
+        temperature : 25.0f,
+        gyro_health : 1,
+        accel_health : 1,
+        gyro_rate : 1000,
+        accel_rate : 1000,
+    };
+    backend->WriteBlock(&pkt, sizeof(pkt));
+}
+
+static void write_copy_isbd(uint64_t time_us)
+{
+    struct log_ISBD pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_ISBD_MSG),
+        time_us    : time_us,
+        isb_seqno  : 1,
+        seqno      : 2
+    };
+    memcpy(pkt.x, samples, sizeof(pkt.x));
+    memcpy(pkt.y, samples, sizeof(pkt.y));
+    memcpy(pkt.z, samples, sizeof(pkt.z));
+    backend->WriteBlock(&pkt, sizeof(pkt));
+}
+
+static void write_inplace(uint64_t time_us)
+{
+    struct log_IMU *pkt = (struct log_IMU *)backend->reserve_block(sizeof(*pkt));
+    if (pkt == nullptr) {
+        return;
+    }
+    pkt->head1 = HEAD_BYTE1;
+    pkt->head2 = HEAD_BYTE2;
+    pkt->msgid = LOG_IMU_MSG;
+    pkt->time_us = time_us;
+    pkt->gyro_x = 0.1f;
+    pkt->gyro_y = 0.2f;
+    pkt->gyro_z = 0.3f;
+    pkt->accel_x = 0.0f;
+    pkt->accel_y = 0.0f;
+    pkt->accel_z = -9.8f;
+    pkt->gyro_error = 0;
+    pkt->accel_error = 0;
+    pkt->temperature = 25.0f;
+    pkt->gyro_health = 1;
+    pkt->accel_health = 1;
+    pkt->gyro_rate = 1000;
+    pkt->accel_rate = 1000;
+    backend->commit_block(pkt, sizeof(*pkt));
+}
+
+static void write_inplace_isbd(uint64_t time_us)
+{
+    struct log_ISBD *pkt = (struct log_ISBD *)backend->reserve_block(sizeof(*pkt));
+    if (pkt == nullptr) {
+        return;
+    }
+    pkt->head1 = HEAD_BYTE1;
+    pkt->head2 = HEAD_BYTE2;
+    pkt->msgid = LOG_ISBD_MSG;
+    pkt->time_us = time_us;
+    pkt->isb_seqno = 1;
+    pkt->seqno = 2;
+    memcpy(pkt->x, samples, sizeof(pkt->x));
+    memcpy(pkt->y, samples, sizeof(pkt->y));
+    memcpy(pkt->z, samples, sizeof(pkt->z));
+    backend->commit_block(pkt, sizeof(*pkt));
+}
+
+/*
+  open a fresh log in the tmpfs directory, removing the logs of the
+  previous benchmark so they don't fill memory
+ */
+static void start_log(void)
+{
+    if (backend == nullptr) {
+        logger_bitmask.set(1);
+        logger._params.backend_types.set(0);
+        logger._params.log_disarmed.set(1);
+        logger._params.file_compress.set(0);
+        logger._params.file_index.set(0);
+        logger.Init(log_structure, ARRAY_SIZE(log_structure));
+
+        backend = new AP_Logger_File(logger, new LoggerMessageWriter_DFLogStart(), log_directory);
+        backend->Init();
+        if (!backend->CardInserted()) {
+            AP_HAL::panic("Unable to use %s", log_directory);
+        }
+    }
+
+    backend->EraseAll();
+    backend->start_new_log();
+    if (!backend->logging_started()) {
+        AP_HAL::panic("Unable to open a log in %s", log_directory);
+    }
+
+    // the backend takes nothing else until the format messages are
+    // out, so push those through before timing anything
+    const struct log_Message msg{
+        LOG_PACKET_HEADER_INIT(LOG_MESSAGE_MSG),
+        time_us : 0,
+        msg : "benchmark"
+    };
+    while (!backend->WriteBlock(&msg, sizeof(msg))) {
+        backend->periodic_fullrate();
+        backend->flush();
+    }
+    backend->flush();
+}
+
+// write the buffer out to the file if it can't take another loop
+static void drain(benchmark::State& state)
+{
+    if (backend->bufferspace_available() >= loop_bytes) {
+        return;
+    }
+    state.PauseTiming();
+    backend->flush();
+    state.ResumeTiming();
+}
+
+static void BM_LoopCopy(benchmark::State& state)
+{
+    start_log();
+    uint64_t time_us = 0;
+
+    while (state.KeepRunning()) {
+        for (uint8_t i=0; i<3; i++) {
+            write_copy(time_us);
+        }
+        write_copy_isbd(time_us);
+        drain(state);
+        time_us += 2500;
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * loop_bytes);
+}
+
+static void BM_LoopInPlace(benchmark::State& state)
+{
+    start_log();
+    uint64_t time_us = 0;
+
+    while (state.KeepRunning()) {
+        for (uint8_t i=0; i<3; i++) {
+            write_inplace(time_us);
+        }
+        write_inplace_isbd(time_us);
+        drain(state);
+        time_us += 2500;
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * loop_bytes);
+}
+
+BENCHMARK(BM_LoopCopy);
+BENCHMARK(BM_LoopInPlace);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,89 @@
+#include <AP_gtest.h>
+#include <AP_Logger/AP_Logger_Compress.h>
+#include <AP_Logger/LogStructure.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static AP_Logger_Compress compressor;
+
+static void check_roundtrip(const uint8_t *raw, uint32_t len, uint32_t &compressed_len)
+{
+    static uint8_t compressed[8192];
+    static uint8_t decompressed[4096];
+    compressed_len = compressor.compress(raw, len, compressed, sizeof(compressed));
+    ASSERT_GT(compressed_len, 0U);
+    EXPECT_EQ(AP_Logger_Compress::decompress(compressed, compressed_len, decompressed, sizeof(decompressed)), (int32_t)len);
+    EXPECT_EQ(memcmp(raw, decompressed, len), 0);
+}
+
+TEST(AP_Logger_Compress, Roundtrip)
+{
+    uint8_t raw[4096];
+    uint32_t compressed_len;
+
+    // all sizes up to and around the match limits, of repetitive data
+    for (uint32_t len=0; len<64; len++) {
+        for (uint32_t i=0; i<len; i++) {
+            raw[i] = i % 5;
+        }
+        check_roundtrip(raw, len, compressed_len);
+    }
+
+    // a stream of log packets compresses well
+    struct log_IMU pkt {};
+    pkt.head1 = HEAD_BYTE1;
+    pkt.head2 = HEAD_BYTE2;
+    pkt.msgid = LOG_IMU_MSG;
+    uint32_t len = 0;
+    while (len + sizeof(pkt) <= sizeof(raw)) {
+        pkt.time_us += 2500;
+        pkt.gyro_x += 0.001f;
+        memcpy(&raw[len], &pkt, sizeof(pkt));
+        len += sizeof(pkt);
+    }
+    check_roundtrip(raw, len, compressed_len);
+    EXPECT_LT(compressed_len, len / 2);
+
+    // noise doesn't compress, but must not be corrupted
+    uint32_t state = 1;
+    for (uint32_t i=0; i<sizeof(raw); i++) {
+        state = state * 1103515245U + 12345U;
+        raw[i] = state >> 24;
+    }
+    check_roundtrip(raw, sizeof(raw), compressed_len);
+    EXPECT_EQ(compressor.compress(raw, sizeof(raw), raw, sizeof(raw) - 1), 0U);
+}
+
+TEST(AP_Logger_Compress, Corrupt)
+{
+    uint8_t out[64];
+
+    // match offset before the start of the output
+    const uint8_t bad_offset[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    EXPECT_EQ(AP_Logger_Compress::decompress(bad_offset, sizeof(bad_offset), out, sizeof(out)), -1);
+
+    // literals overrunning the input
+    const uint8_t truncated[] = { 0x50, 'a', 'b' };
+    EXPECT_EQ(AP_Logger_Compress::decompress(truncated, sizeof(truncated), out, sizeof(out)), -1);
+
+    // output overrun
+    const uint8_t overrun[] = { 0x1F, 'a', 0x01, 0x00, 0xFF, 0x00 };
+    EXPECT_EQ(AP_Logger_Compress::decompress(overrun, sizeof(overrun), out, sizeof(out)), -1);
+
+    struct log_compressed_frame frame {};
+    frame.magic1 = 'X';
+    EXPECT_EQ(AP_Logger_Compress::decode_frame(frame, out, out, sizeof(out)), -1);
+
+    // trailers hold no raw data
+    struct log_compressed_trailer trailer {};
+    trailer.frame.magic1 = LOG_FRAME_MAGIC1;
+    trailer.frame.magic2 = LOG_FRAME_MAGIC2;
+    trailer.frame.flags = LOG_FRAME_FLAG_TRAILER;
+    trailer.frame.data_len = sizeof(trailer.raw_size);
+    trailer.raw_size = 12345;
+    EXPECT_EQ(AP_Logger_Compress::decode_frame(trailer.frame, (const uint8_t *)&trailer.raw_size, out, sizeof(out)), 0);
+    trailer.frame.raw_len = 1;
+    EXPECT_EQ(AP_Logger_Compress::decode_frame(trailer.frame, (const uint8_t *)&trailer.raw_size, out, sizeof(out)), -1);
+}
+
+AP_GTEST_MAIN()
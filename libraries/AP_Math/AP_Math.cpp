@@ -347,4 +347,11 @@ void fill_nanf(float *f, uint16_t count)
         *f++ = std::numeric_limits<float>::signaling_NaN();
     }
 }
+
+void fill_nanf(double *f, uint16_t count)
+{
+    while (count--) {
+        *f++ = std::numeric_limits<double>::signaling_NaN();
+    }
+}
 #endif
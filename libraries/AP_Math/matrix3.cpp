@@ -283,6 +283,8 @@ template void Matrix3<double>::zero(void);
 template void Matrix3<double>::rotate(const Vector3<double> &g);
 template void Matrix3<double>::from_euler(float roll, float pitch, float yaw);
 template void Matrix3<double>::to_euler(float *roll, float *pitch, float *yaw) const;
+template void Matrix3<double>::from_euler312(float roll, float pitch, float yaw);
+template Vector3<double> Matrix3<double>::to_euler312(void) const;
 template Vector3<double> Matrix3<double>::operator *(const Vector3<double> &v) const;
 template Vector3<double> Matrix3<double>::mul_transpose(const Vector3<double> &v) const;
 template Matrix3<double> Matrix3<double>::operator *(const Matrix3<double> &m) const;
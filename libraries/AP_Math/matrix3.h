@@ -58,6 +58,13 @@ public:
         , b(b0)
         , c(c0) {}
 
+    // conversion from another precision
+    template <typename U>
+    explicit constexpr Matrix3<T>(const Matrix3<U> &m)
+        : a(m.a)
+        , b(m.b)
+        , c(m.c) {}
+
     // setting ctor
     constexpr Matrix3<T>(const T ax, const T ay, const T az,
                          const T bx, const T by, const T bz,
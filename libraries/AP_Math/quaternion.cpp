@@ -21,17 +21,18 @@
 #include "AP_Math.h"
 
 // return the rotation matrix equivalent for this quaternion
-void Quaternion::rotation_matrix(Matrix3f &m) const
+template <typename T>
+void QuaternionT<T>::rotation_matrix(Matrix3<T> &m) const
 {
-    const float q3q3 = q3 * q3;
-    const float q3q4 = q3 * q4;
-    const float q2q2 = q2 * q2;
-    const float q2q3 = q2 * q3;
-    const float q2q4 = q2 * q4;
-    const float q1q2 = q1 * q2;
-    const float q1q3 = q1 * q3;
-    const float q1q4 = q1 * q4;
-    const float q4q4 = q4 * q4;
+    const T q3q3 = q3 * q3;
+    const T q3q4 = q3 * q4;
+    const T q2q2 = q2 * q2;
+    const T q2q3 = q2 * q3;
+    const T q2q4 = q2 * q4;
+    const T q1q2 = q1 * q2;
+    const T q1q3 = q1 * q3;
+    const T q1q4 = q1 * q4;
+    const T q4q4 = q4 * q4;
 
     m.a.x = 1.0f-2.0f*(q3q3 + q4q4);
     m.a.y = 2.0f*(q2q3 - q1q4);
@@ -45,19 +46,20 @@ void Quaternion::rotation_matrix(Matrix3f &m) const
 }
 
 // return the rotation matrix equivalent for this quaternion after normalization
-void Quaternion::rotation_matrix_norm(Matrix3f &m) const
+template <typename T>
+void QuaternionT<T>::rotation_matrix_norm(Matrix3<T> &m) const
 {
-    const float q1q1 = q1 * q1;
-    const float q1q2 = q1 * q2;
-    const float q1q3 = q1 * q3;
-    const float q1q4 = q1 * q4;
-    const float q2q2 = q2 * q2;
-    const float q2q3 = q2 * q3;
-    const float q2q4 = q2 * q4;
-    const float q3q3 = q3 * q3;
-    const float q3q4 = q3 * q4;
-    const float q4q4 = q4 * q4;
-    const float invs = 1.0f / (q1q1 + q2q2 + q3q3 + q4q4);
+    const T q1q1 = q1 * q1;
+    const T q1q2 = q1 * q2;
+    const T q1q3 = q1 * q3;
+    const T q1q4 = q1 * q4;
+    const T q2q2 = q2 * q2;
+    const T q2q3 = q2 * q3;
+    const T q2q4 = q2 * q4;
+    const T q3q3 = q3 * q3;
+    const T q3q4 = q3 * q4;
+    const T q4q4 = q4 * q4;
+    const T invs = 1.0f / (q1q1 + q2q2 + q3q3 + q4q4);
 
     m.a.x = ( q2q2 - q3q3 - q4q4 + q1q1)*invs;
     m.a.y = 2.0f*(q2q3 - q1q4)*invs;
@@ -73,44 +75,45 @@ void Quaternion::rotation_matrix_norm(Matrix3f &m) const
 // return the rotation matrix equivalent for this quaternion
 // Thanks to Martin John Baker
 // http://www.euclideanspace.com/maths/geometry/rotations/conversions/matrixToQuaternion/index.htm
-void Quaternion::from_rotation_matrix(const Matrix3f &m)
+template <typename T>
+void QuaternionT<T>::from_rotation_matrix(const Matrix3<T> &m)
 {
-    const float &m00 = m.a.x;
-    const float &m11 = m.b.y;
-    const float &m22 = m.c.z;
-    const float &m10 = m.b.x;
-    const float &m01 = m.a.y;
-    const float &m20 = m.c.x;
-    const float &m02 = m.a.z;
-    const float &m21 = m.c.y;
-    const float &m12 = m.b.z;
-    float &qw = q1;
-    float &qx = q2;
-    float &qy = q3;
-    float &qz = q4;
-
-    const float tr = m00 + m11 + m22;
+    const T &m00 = m.a.x;
+    const T &m11 = m.b.y;
+    const T &m22 = m.c.z;
+    const T &m10 = m.b.x;
+    const T &m01 = m.a.y;
+    const T &m20 = m.c.x;
+    const T &m02 = m.a.z;
+    const T &m21 = m.c.y;
+    const T &m12 = m.b.z;
+    T &qw = q1;
+    T &qx = q2;
+    T &qy = q3;
+    T &qz = q4;
+
+    const T tr = m00 + m11 + m22;
 
     if (tr > 0) {
-        const float S = sqrtf(tr+1) * 2;
+        const T S = sqrtf(tr+1) * 2;
         qw = 0.25f * S;
         qx = (m21 - m12) / S;
         qy = (m02 - m20) / S;
         qz = (m10 - m01) / S;
     } else if ((m00 > m11) && (m00 > m22)) {
-        const float S = sqrtf(1.0f + m00 - m11 - m22) * 2.0f;
+        const T S = sqrtf(1.0f + m00 - m11 - m22) * 2.0f;
         qw = (m21 - m12) / S;
         qx = 0.25f * S;
         qy = (m01 + m10) / S;
         qz = (m02 + m20) / S;
     } else if (m11 > m22) {
-        const float S = sqrtf(1.0f + m11 - m00 - m22) * 2.0f;
+        const T S = sqrtf(1.0f + m11 - m00 - m22) * 2.0f;
         qw = (m02 - m20) / S;
         qx = (m01 + m10) / S;
         qy = 0.25f * S;
         qz = (m12 + m21) / S;
     } else {
-        const float S = sqrtf(1.0f + m22 - m00 - m11) * 2.0f;
+        const T S = sqrtf(1.0f + m22 - m00 - m11) * 2.0f;
         qw = (m10 - m01) / S;
         qx = (m02 + m20) / S;
         qy = (m12 + m21) / S;
@@ -119,22 +122,24 @@ void Quaternion::from_rotation_matrix(const Matrix3f &m)
 }
 
 // convert a vector from earth to body frame
-void Quaternion::earth_to_body(Vector3f &v) const
+template <typename T>
+void QuaternionT<T>::earth_to_body(Vector3<T> &v) const
 {
-    Matrix3f m;
+    Matrix3<T> m;
     rotation_matrix(m);
     v = m * v;
 }
 
 // create a quaternion from Euler angles
-void Quaternion::from_euler(float roll, float pitch, float yaw)
+template <typename T>
+void QuaternionT<T>::from_euler(T roll, T pitch, T yaw)
 {
-    const float cr2 = cosf(roll*0.5f);
-    const float cp2 = cosf(pitch*0.5f);
-    const float cy2 = cosf(yaw*0.5f);
-    const float sr2 = sinf(roll*0.5f);
-    const float sp2 = sinf(pitch*0.5f);
-    const float sy2 = sinf(yaw*0.5f);
+    const T cr2 = cosf(roll*0.5f);
+    const T cp2 = cosf(pitch*0.5f);
+    const T cy2 = cosf(yaw*0.5f);
+    const T sr2 = sinf(roll*0.5f);
+    const T sp2 = sinf(pitch*0.5f);
+    const T sy2 = sinf(yaw*0.5f);
 
     q1 = cr2*cp2*cy2 + sr2*sp2*sy2;
     q2 = sr2*cp2*cy2 - cr2*sp2*sy2;
@@ -143,17 +148,19 @@ void Quaternion::from_euler(float roll, float pitch, float yaw)
 }
 
 // create a quaternion from Euler angles
-void Quaternion::from_vector312(float roll ,float pitch, float yaw)
+template <typename T>
+void QuaternionT<T>::from_vector312(T roll ,T pitch, T yaw)
 {
-    Matrix3f m;
+    Matrix3<T> m;
     m.from_euler312(roll, pitch, yaw);
 
     from_rotation_matrix(m);
 }
 
-void Quaternion::from_axis_angle(Vector3f v)
+template <typename T>
+void QuaternionT<T>::from_axis_angle(Vector3<T> v)
 {
-    const float theta = v.length();
+    const T theta = v.length();
     if (is_zero(theta)) {
         q1 = 1.0f;
         q2=q3=q4=0.0f;
@@ -163,7 +170,8 @@ void Quaternion::from_axis_angle(Vector3f v)
     from_axis_angle(v,theta);
 }
 
-void Quaternion::from_axis_angle(const Vector3f &axis, float theta)
+template <typename T>
+void QuaternionT<T>::from_axis_angle(const Vector3<T> &axis, T theta)
 {
     // axis must be a unit vector as there is no check for length
     if (is_zero(theta)) {
@@ -171,7 +179,7 @@ void Quaternion::from_axis_angle(const Vector3f &axis, float theta)
         q2=q3=q4=0.0f;
         return;
     }
-    const float st2 = sinf(theta/2.0f);
+    const T st2 = sinf(theta/2.0f);
 
     q1 = cosf(theta/2.0f);
     q2 = axis.x * st2;
@@ -179,26 +187,29 @@ void Quaternion::from_axis_angle(const Vector3f &axis, float theta)
     q4 = axis.z * st2;
 }
 
-void Quaternion::rotate(const Vector3f &v)
+template <typename T>
+void QuaternionT<T>::rotate(const Vector3<T> &v)
 {
-    Quaternion r;
+    QuaternionT<T> r;
     r.from_axis_angle(v);
     (*this) *= r;
 }
 
-void Quaternion::to_axis_angle(Vector3f &v)
+template <typename T>
+void QuaternionT<T>::to_axis_angle(Vector3<T> &v)
 {
-    const float l = sqrtf(sq(q2)+sq(q3)+sq(q4));
-    v = Vector3f(q2,q3,q4);
+    const T l = sqrtf(sq(q2)+sq(q3)+sq(q4));
+    v = Vector3<T>(q2,q3,q4);
     if (!is_zero(l)) {
         v /= l;
         v *= wrap_PI(2.0f * atan2f(l,q1));
     }
 }
 
-void Quaternion::from_axis_angle_fast(Vector3f v)
+template <typename T>
+void QuaternionT<T>::from_axis_angle_fast(Vector3<T> v)
 {
-    const float theta = v.length();
+    const T theta = v.length();
     if (is_zero(theta)) {
         q1 = 1.0f;
         q2=q3=q4=0.0f;
@@ -208,11 +219,12 @@ void Quaternion::from_axis_angle_fast(Vector3f v)
     from_axis_angle_fast(v,theta);
 }
 
-void Quaternion::from_axis_angle_fast(const Vector3f &axis, float theta)
+template <typename T>
+void QuaternionT<T>::from_axis_angle_fast(const Vector3<T> &axis, T theta)
 {
-    const float t2 = theta/2.0f;
-    const float sqt2 = sq(t2);
-    const float st2 = t2-sqt2*t2/6.0f;
+    const T t2 = theta/2.0f;
+    const T sqt2 = sq(t2);
+    const T st2 = t2-sqt2*t2/6.0f;
 
     q1 = 1.0f-(sqt2/2.0f)+sq(sqt2)/24.0f;
     q2 = axis.x * st2;
@@ -220,28 +232,29 @@ void Quaternion::from_axis_angle_fast(const Vector3f &axis, float theta)
     q4 = axis.z * st2;
 }
 
-void Quaternion::rotate_fast(const Vector3f &v)
+template <typename T>
+void QuaternionT<T>::rotate_fast(const Vector3<T> &v)
 {
-    const float theta = v.length();
+    const T theta = v.length();
     if (is_zero(theta)) {
         return;
     }
-    const float t2 = theta/2.0f;
-    const float sqt2 = sq(t2);
-    float st2 = t2-sqt2*t2/6.0f;
+    const T t2 = theta/2.0f;
+    const T sqt2 = sq(t2);
+    T st2 = t2-sqt2*t2/6.0f;
     st2 /= theta;
 
     //"rotation quaternion"
-    const float w2 = 1.0f-(sqt2/2.0f)+sq(sqt2)/24.0f;
-    const float x2 = v.x * st2;
-    const float y2 = v.y * st2;
-    const float z2 = v.z * st2;
+    const T w2 = 1.0f-(sqt2/2.0f)+sq(sqt2)/24.0f;
+    const T x2 = v.x * st2;
+    const T y2 = v.y * st2;
+    const T z2 = v.z * st2;
 
     //copy our quaternion
-    const float w1 = q1;
-    const float x1 = q2;
-    const float y1 = q3;
-    const float z1 = q4;
+    const T w1 = q1;
+    const T x1 = q2;
+    const T y1 = q3;
+    const T z1 = q4;
 
     //do the multiply into our quaternion
     q1 = w1*w2 - x1*x2 - y1*y2 - z1*z2;
@@ -251,25 +264,29 @@ void Quaternion::rotate_fast(const Vector3f &v)
 }
 
 // get euler roll angle
-float Quaternion::get_euler_roll() const
+template <typename T>
+T QuaternionT<T>::get_euler_roll() const
 {
     return (atan2f(2.0f*(q1*q2 + q3*q4), 1.0f - 2.0f*(q2*q2 + q3*q3)));
 }
 
 // get euler pitch angle
-float Quaternion::get_euler_pitch() const
+template <typename T>
+T QuaternionT<T>::get_euler_pitch() const
 {
     return safe_asin(2.0f*(q1*q3 - q4*q2));
 }
 
 // get euler yaw angle
-float Quaternion::get_euler_yaw() const
+template <typename T>
+T QuaternionT<T>::get_euler_yaw() const
 {
     return atan2f(2.0f*(q1*q4 + q2*q3), 1.0f - 2.0f*(q3*q3 + q4*q4));
 }
 
 // create eulers from a quaternion
-void Quaternion::to_euler(float &roll, float &pitch, float &yaw) const
+template <typename T>
+void QuaternionT<T>::to_euler(T &roll, T &pitch, T &yaw) const
 {
     roll = get_euler_roll();
     pitch = get_euler_pitch();
@@ -277,28 +294,32 @@ void Quaternion::to_euler(float &roll, float &pitch, float &yaw) const
 }
 
 // create eulers from a quaternion
-Vector3f Quaternion::to_vector312(void) const
+template <typename T>
+Vector3<T> QuaternionT<T>::to_vector312(void) const
 {
-    Matrix3f m;
+    Matrix3<T> m;
     rotation_matrix(m);
     return m.to_euler312();
 }
 
-float Quaternion::length(void) const
+template <typename T>
+T QuaternionT<T>::length(void) const
 {
     return sqrtf(sq(q1) + sq(q2) + sq(q3) + sq(q4));
 }
 
-Quaternion Quaternion::inverse(void) const
+template <typename T>
+QuaternionT<T> QuaternionT<T>::inverse(void) const
 {
-    return Quaternion(q1, -q2, -q3, -q4);
+    return QuaternionT<T>(q1, -q2, -q3, -q4);
 }
 
-void Quaternion::normalize(void)
+template <typename T>
+void QuaternionT<T>::normalize(void)
 {
-    const float quatMag = length();
+    const T quatMag = length();
     if (!is_zero(quatMag)) {
-        const float quatMagInv = 1.0f/quatMag;
+        const T quatMagInv = 1.0f/quatMag;
         q1 *= quatMagInv;
         q2 *= quatMagInv;
         q3 *= quatMagInv;
@@ -306,18 +327,19 @@ void Quaternion::normalize(void)
     }
 }
 
-Quaternion Quaternion::operator*(const Quaternion &v) const
+template <typename T>
+QuaternionT<T> QuaternionT<T>::operator*(const QuaternionT<T> &v) const
 {
-    Quaternion ret;
-    const float &w1 = q1;
-    const float &x1 = q2;
-    const float &y1 = q3;
-    const float &z1 = q4;
+    QuaternionT<T> ret;
+    const T &w1 = q1;
+    const T &x1 = q2;
+    const T &y1 = q3;
+    const T &z1 = q4;
 
-    const float w2 = v.q1;
-    const float x2 = v.q2;
-    const float y2 = v.q3;
-    const float z2 = v.q4;
+    const T w2 = v.q1;
+    const T x2 = v.q2;
+    const T y2 = v.q3;
+    const T z2 = v.q4;
 
     ret.q1 = w1*w2 - x1*x2 - y1*y2 - z1*z2;
     ret.q2 = w1*x2 + x1*w2 + y1*z2 - z1*y2;
@@ -327,17 +349,18 @@ Quaternion Quaternion::operator*(const Quaternion &v) const
     return ret;
 }
 
-Quaternion &Quaternion::operator*=(const Quaternion &v)
+template <typename T>
+QuaternionT<T> &QuaternionT<T>::operator*=(const QuaternionT<T> &v)
 {
-    const float w1 = q1;
-    const float x1 = q2;
-    const float y1 = q3;
-    const float z1 = q4;
+    const T w1 = q1;
+    const T x1 = q2;
+    const T y1 = q3;
+    const T z1 = q4;
 
-    const float w2 = v.q1;
-    const float x2 = v.q2;
-    const float y2 = v.q3;
-    const float z2 = v.q4;
+    const T w2 = v.q1;
+    const T x2 = v.q2;
+    const T y2 = v.q3;
+    const T z2 = v.q4;
 
     q1 = w1*w2 - x1*x2 - y1*y2 - z1*z2;
     q2 = w1*x2 + x1*w2 + y1*z2 - z1*y2;
@@ -347,18 +370,19 @@ Quaternion &Quaternion::operator*=(const Quaternion &v)
     return *this;
 }
 
-Quaternion Quaternion::operator/(const Quaternion &v) const
+template <typename T>
+QuaternionT<T> QuaternionT<T>::operator/(const QuaternionT<T> &v) const
 {
-    Quaternion ret;
-    const float &quat0 = q1;
-    const float &quat1 = q2;
-    const float &quat2 = q3;
-    const float &quat3 = q4;
+    QuaternionT<T> ret;
+    const T &quat0 = q1;
+    const T &quat1 = q2;
+    const T &quat2 = q3;
+    const T &quat3 = q4;
 
-    const float rquat0 = v.q1;
-    const float rquat1 = v.q2;
-    const float rquat2 = v.q3;
-    const float rquat3 = v.q4;
+    const T rquat0 = v.q1;
+    const T rquat1 = v.q2;
+    const T rquat2 = v.q3;
+    const T rquat3 = v.q4;
 
     ret.q1 = (rquat0*quat0 + rquat1*quat1 + rquat2*quat2 + rquat3*quat3);
     ret.q2 = (rquat0*quat1 - rquat1*quat0 - rquat2*quat3 + rquat3*quat2);
@@ -368,7 +392,12 @@ Quaternion Quaternion::operator/(const Quaternion &v) const
 }
 
 // angular difference in radians between quaternions
-Quaternion Quaternion::angular_difference(const Quaternion &v) const
+template <typename T>
+QuaternionT<T> QuaternionT<T>::angular_difference(const QuaternionT<T> &v) const
 {
     return v.inverse() * *this;
 }
+
+// define for float and double
+template class QuaternionT<float>;
+template class QuaternionT<double>;
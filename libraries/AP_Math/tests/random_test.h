@@ -0,0 +1,58 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  repeatable random values and shapes for tests and benchmarks, so
+  failures can be reproduced and timings compared between runs
+ */
+
+#include <AP_Math/AP_Math.h>
+
+inline uint32_t &rand_state()
+{
+    static uint32_t state = 1;
+    return state;
+}
+
+// restart the sequence
+inline void rand_seed(uint32_t seed)
+{
+    rand_state() = seed;
+}
+
+// next value from a simple linear congruential generator
+inline uint32_t rand_next()
+{
+    uint32_t &state = rand_state();
+    state = state * 1103515245U + 12345U;
+    return state;
+}
+
+inline float rand_float(float min, float max)
+{
+    return min + (max - min) * ((rand_next() >> 8) & 0xFFFF) / 65535.0f;
+}
+
+// star shaped polygon of count points around centre, each between
+// min_radius and max_radius from it
+inline void make_polygon(Vector2f *points, uint16_t count, const Vector2f &centre, float min_radius, float max_radius)
+{
+    for (uint16_t i=0; i<count; i++) {
+        const float angle = M_2PI * i / count;
+        const float r = rand_float(min_radius, max_radius);
+        points[i] = centre + Vector2f{r * cosf(angle), r * sinf(angle)};
+    }
+}
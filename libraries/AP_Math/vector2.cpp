@@ -456,6 +456,25 @@ template float Vector2<float>::closest_distance_between_lines_squared(const Vect
 
 template void Vector2<float>::reflect(const Vector2<float> &n);
 
+// define the arithmetic for double
+template float Vector2<double>::length_squared(void) const;
+template float Vector2<double>::length(void) const;
+template double Vector2<double>::operator *(const Vector2<double> &v) const;
+template double Vector2<double>::operator %(const Vector2<double> &v) const;
+template Vector2<double> &Vector2<double>::operator *=(const double num);
+template Vector2<double> &Vector2<double>::operator /=(const double num);
+template Vector2<double> &Vector2<double>::operator -=(const Vector2<double> &v);
+template Vector2<double> &Vector2<double>::operator +=(const Vector2<double> &v);
+template Vector2<double> Vector2<double>::operator /(const double num) const;
+template Vector2<double> Vector2<double>::operator *(const double num) const;
+template Vector2<double> Vector2<double>::operator +(const Vector2<double> &v) const;
+template Vector2<double> Vector2<double>::operator -(const Vector2<double> &v) const;
+template Vector2<double> Vector2<double>::operator -(void) const;
+template bool Vector2<double>::operator ==(const Vector2<double> &v) const;
+template bool Vector2<double>::operator !=(const Vector2<double> &v) const;
+template bool Vector2<double>::is_nan(void) const;
+template bool Vector2<double>::is_inf(void) const;
+
 template bool Vector2<long>::operator ==(const Vector2<long> &v) const;
 
 // define for int
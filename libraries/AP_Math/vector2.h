@@ -47,6 +47,12 @@ struct Vector2
         : x(x0)
         , y(y0) {}
 
+    // conversion from another precision
+    template <typename U>
+    explicit constexpr Vector2<T>(const Vector2<U> &v)
+        : x(v.x)
+        , y(v.y) {}
+
     // function call operator
     void operator ()(const T x0, const T y0)
     {
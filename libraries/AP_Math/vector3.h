@@ -78,6 +78,13 @@ public:
         , y(y0)
         , z(z0) {}
 
+    // conversion from another precision
+    template <typename U>
+    explicit constexpr Vector3<T>(const Vector3<U> &v)
+        : x(v.x)
+        , y(v.y)
+        , z(v.z) {}
+
     // function call operator
     void operator ()(const T x0, const T y0, const T z0)
     {
@@ -52,6 +52,8 @@ void AP_Mission::init()
     // command list will be cleared if they do not match
     check_eeprom_version();
 
+    init_cmd_cache();
+
     // If Mission Clear bit is set then it should clear the mission, otherwise retain the mission.
     if (AP_MISSION_MASK_MISSION_CLEAR & _options) {
     	gcs().send_text(MAV_SEVERITY_INFO, "Clearing Mission");
@@ -197,6 +199,11 @@ bool AP_Mission::clear()
     // remove all commands
     _cmd_total.set_and_save(0);
 
+    {
+        WITH_SEMAPHORE(_rsem);
+        cmd_cache_clear();
+    }
+
     // clear index to commands
     _nav_cmd.index = AP_MISSION_CMD_INDEX_NONE;
     _do_cmd.index = AP_MISSION_CMD_INDEX_NONE;
@@ -530,6 +537,27 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+    // use a copy we have already decoded if we can
+    const Cmd_Cache_Entry *entry = cmd_cache_find(index);
+    if (entry != nullptr) {
+        cmd = entry->cmd;
+        _cmd_cache_hits++;
+        return true;
+    }
+    if (_cmd_cache_size > 0) {
+        _cmd_cache_misses++;
+    }
+
+    decode_cmd_from_storage(index, cmd);
+    cmd_cache_store(cmd);
+
+    // return success
+    return true;
+}
+
+/// decode_cmd_from_storage - decodes a command other than home from storage
+void AP_Mission::decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const
+{
     // Find out proper location in memory by using the start_byte position + the index
     // we can load a command, we don't process it yet
     // read WP position
@@ -576,9 +604,108 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
 
     // set command's index to it's position in eeprom
     cmd.index = index;
+}
 
-    // return success
-    return true;
+/*
+  allocate the cache of decoded commands. If it can hold the whole
+  mission each command has its own entry, otherwise the least
+  recently used entry is replaced
+ */
+void AP_Mission::init_cmd_cache()
+{
+    if (_cmd_cache != nullptr) {
+        return;
+    }
+    const uint16_t size = MIN(uint16_t(AP_MISSION_CMD_CACHE_SIZE), num_commands_max());
+    if (size == 0) {
+        return;
+    }
+    _cmd_cache = new Cmd_Cache_Entry[size];
+    if (_cmd_cache == nullptr) {
+        return;
+    }
+    WITH_SEMAPHORE(_rsem);
+    _cmd_cache_size = size;
+    _cmd_cache_whole_mission = (size == num_commands_max());
+    cmd_cache_clear();
+}
+
+// return the cache entry for a command, or nullptr if it isn't cached
+AP_Mission::Cmd_Cache_Entry *AP_Mission::cmd_cache_find(uint16_t index) const
+{
+    if (_cmd_cache_whole_mission) {
+        Cmd_Cache_Entry &entry = _cmd_cache[index];
+        return entry.cmd.index == index ? &entry : nullptr;
+    }
+    for (uint16_t i=0; i<_cmd_cache_size; i++) {
+        Cmd_Cache_Entry &entry = _cmd_cache[i];
+        if (entry.cmd.index == index) {
+            entry.last_used = ++_cmd_cache_counter;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// add a decoded command to the cache
+void AP_Mission::cmd_cache_store(const Mission_Command& cmd) const
+{
+    if (_cmd_cache_size == 0) {
+        return;
+    }
+    Cmd_Cache_Entry *entry;
+    if (_cmd_cache_whole_mission) {
+        entry = &_cmd_cache[cmd.index];
+    } else {
+        // use an empty entry, or else the least recently used
+        entry = &_cmd_cache[0];
+        for (uint16_t i=1; i<_cmd_cache_size && entry->cmd.index != AP_MISSION_CMD_INDEX_NONE; i++) {
+            Cmd_Cache_Entry &e = _cmd_cache[i];
+            if (e.cmd.index == AP_MISSION_CMD_INDEX_NONE || e.last_used < entry->last_used) {
+                entry = &e;
+            }
+        }
+    }
+    entry->cmd = cmd;
+    entry->last_used = ++_cmd_cache_counter;
+}
+
+// remove a command from the cache
+void AP_Mission::cmd_cache_invalidate(uint16_t index)
+{
+    Cmd_Cache_Entry *entry = cmd_cache_find(index);
+    if (entry != nullptr) {
+        entry->cmd.index = AP_MISSION_CMD_INDEX_NONE;
+    }
+}
+
+// remove all commands from the cache
+void AP_Mission::cmd_cache_clear()
+{
+    for (uint16_t i=0; i<_cmd_cache_size; i++) {
+        _cmd_cache[i].cmd.index = AP_MISSION_CMD_INDEX_NONE;
+        _cmd_cache[i].last_used = 0;
+    }
+}
+
+/*
+  decode the commands after a new nav command into the cache, ready
+  for when we look ahead or advance to them
+ */
+void AP_Mission::prefetch_cmds(uint16_t start_index)
+{
+    WITH_SEMAPHORE(_rsem);
+
+    // leave room for the commands we are running
+    const uint16_t count = MIN(uint16_t(AP_MISSION_CMD_PREFETCH), uint16_t(_cmd_cache_size/2));
+    const uint16_t end_index = MIN(uint16_t(start_index + count), uint16_t(_cmd_total));
+    for (uint16_t index = MAX(start_index, uint16_t(AP_MISSION_FIRST_REAL_COMMAND)); index < end_index; index++) {
+        if (cmd_cache_find(index) == nullptr) {
+            Mission_Command cmd;
+            decode_cmd_from_storage(index, cmd);
+            cmd_cache_store(cmd);
+        }
+    }
 }
 
 bool AP_Mission::stored_in_location(uint16_t id)
@@ -652,6 +779,9 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+    // the cached copy of this command is now stale
+    cmd_cache_invalidate(index);
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
 
@@ -1555,6 +1685,9 @@ bool AP_Mission::advance_current_nav_cmd(uint16_t starting_index)
         _flags.do_cmd_all_done = true;
     }
 
+    // get ready to look ahead from the new nav command
+    prefetch_cmds(_nav_cmd.index+1);
+
     // if we got this far we must have successfully advanced the nav command
     return true;
 }
@@ -40,6 +40,25 @@
 #define AP_MISSION_MASK_MISSION_CLEAR       (1<<0)  // If set then Clear the mission on boot
 #define AP_MISSION_MASK_DIST_TO_LAND_CALC   (1<<1)  // Allow distance to best landing calculation to be run on failsafe
 
+// number of decoded commands kept in RAM. Boards with plenty of memory
+// keep the whole mission
+#ifndef AP_MISSION_CMD_CACHE_SIZE
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_MISSION_CMD_CACHE_SIZE           0xFFFF  // whole mission
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MISSION_CMD_CACHE_SIZE           32
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define AP_MISSION_CMD_CACHE_SIZE           16
+#else
+#define AP_MISSION_CMD_CACHE_SIZE           0
+#endif
+#endif
+
+// number of commands after a new nav command to decode into the cache
+#ifndef AP_MISSION_CMD_PREFETCH
+#define AP_MISSION_CMD_PREFETCH             4
+#endif
+
 /// @class    AP_Mission
 /// @brief    Object managing Mission
 class AP_Mission {
@@ -284,7 +303,13 @@ public:
         _prev_nav_cmd_id(AP_MISSION_CMD_ID_NONE),
         _prev_nav_cmd_index(AP_MISSION_CMD_INDEX_NONE),
         _prev_nav_cmd_wp_index(AP_MISSION_CMD_INDEX_NONE),
-        _last_change_time_ms(0)
+        _last_change_time_ms(0),
+        _cmd_cache(nullptr),
+        _cmd_cache_size(0),
+        _cmd_cache_whole_mission(false),
+        _cmd_cache_counter(0),
+        _cmd_cache_hits(0),
+        _cmd_cache_misses(0)
     {
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (_singleton != nullptr) {
@@ -488,6 +513,13 @@ public:
     // returns true if the mission contains the requested items
     bool contains_item(MAV_CMD command) const;
 
+    // get the number of command reads answered from the cache of
+    // decoded commands, and the number decoded from storage
+    void get_cmd_cache_stats(uint32_t &hits, uint32_t &misses) const {
+        hits = _cmd_cache_hits;
+        misses = _cmd_cache_misses;
+    }
+
     // user settable parameters
     static const struct AP_Param::GroupInfo var_info[];
 
@@ -553,6 +585,25 @@ private:
     /// increment_jump_times_run - increments the recorded number of times the jump command has been run
     void increment_jump_times_run(Mission_Command& cmd, bool send_gcs_msg = true);
 
+    /// decode_cmd_from_storage - decodes a command other than home from storage
+    void decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const;
+
+    // entry in the cache of decoded commands
+    struct Cmd_Cache_Entry {
+        Mission_Command cmd;    // cmd.index is AP_MISSION_CMD_INDEX_NONE if empty
+        uint32_t last_used;     // for least recently used replacement
+    };
+
+    // command cache handling. Callers must hold _rsem
+    void init_cmd_cache();
+    Cmd_Cache_Entry *cmd_cache_find(uint16_t index) const;
+    void cmd_cache_store(const Mission_Command& cmd) const;
+    void cmd_cache_invalidate(uint16_t index);
+    void cmd_cache_clear();
+
+    // prefetch_cmds - decodes commands from start_index into the cache
+    void prefetch_cmds(uint16_t start_index);
+
     /// check_eeprom_version - checks version of missions stored in eeprom matches this library
     /// command list will be cleared if they do not match
     void check_eeprom_version();
@@ -592,6 +643,16 @@ private:
     // last time that mission changed
     uint32_t _last_change_time_ms;
 
+    // cache of decoded commands, so that advancing the mission and
+    // looking ahead for nav commands and jumps doesn't decode the
+    // same commands from storage again
+    Cmd_Cache_Entry *_cmd_cache;
+    uint16_t _cmd_cache_size;
+    bool _cmd_cache_whole_mission;  // true if each command has its own entry
+    mutable uint32_t _cmd_cache_counter;
+    mutable uint32_t _cmd_cache_hits;
+    mutable uint32_t _cmd_cache_misses;
+
     // multi-thread support. This is static so it can be used from
     // const functions
     static HAL_Semaphore _rsem;
@@ -109,6 +109,10 @@ bool MissionTest::verify_cmd(const AP_Mission::Mission_Command& cmd)
 void MissionTest::mission_complete(void)
 {
     hal.console->printf("\nMission Complete!\n");
+
+    uint32_t hits, misses;
+    mission.get_cmd_cache_stats(hits, misses);
+    hal.console->printf("command cache hits:%u misses:%u\n", (unsigned)hits, (unsigned)misses);
 }
 
 // run_mission_test - tests the stop and resume feature
@@ -16,24 +16,34 @@
  */
 #include "AP_NavEKF_core_common.h"
 
-NavEKF_core_common::Matrix24 NavEKF_core_common::KH;
-NavEKF_core_common::Matrix24 NavEKF_core_common::KHP;
-NavEKF_core_common::Matrix24 NavEKF_core_common::nextP;
-NavEKF_core_common::Vector28 NavEKF_core_common::Kfusion;
+template <typename T>
+NAVEKF_SCRATCH typename NavEKF_core_common<T>::Matrix24 NavEKF_core_common<T>::KH;
+template <typename T>
+NAVEKF_SCRATCH typename NavEKF_core_common<T>::Matrix24 NavEKF_core_common<T>::KHP;
+template <typename T>
+NAVEKF_SCRATCH typename NavEKF_core_common<T>::Matrix24 NavEKF_core_common<T>::nextP;
+template <typename T>
+NAVEKF_SCRATCH typename NavEKF_core_common<T>::Vector28 NavEKF_core_common<T>::Kfusion;
 
 /*
   fill common scratch variables, for detecting re-use of variables between loops in SITL
  */
-void NavEKF_core_common::fill_scratch_variables(void)
+template <typename T>
+void NavEKF_core_common<T>::fill_scratch_variables(void)
 {
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
     // fill the common variables with NaN, so we catch any cases in
     // SITL where they are used without initialisation. These are all
     // supposed to be scratch variables that are not used between
     // iterations
-    fill_nanf(&KH[0][0], sizeof(KH)/sizeof(float));
-    fill_nanf(&KHP[0][0], sizeof(KHP)/sizeof(float));
-    fill_nanf(&nextP[0][0], sizeof(nextP)/sizeof(float));
-    fill_nanf(&Kfusion[0], sizeof(Kfusion)/sizeof(float));
+    fill_nanf(&KH[0][0], sizeof(KH)/sizeof(ftype));
+    fill_nanf(&KHP[0][0], sizeof(KHP)/sizeof(ftype));
+    fill_nanf(&nextP[0][0], sizeof(nextP)/sizeof(ftype));
+    fill_nanf(&Kfusion[0], sizeof(Kfusion)/sizeof(ftype));
 #endif
 }
+
+template class NavEKF_core_common<float>;
+#if HAL_WITH_EKF3_DOUBLE
+template class NavEKF_core_common<double>;
+#endif
@@ -19,6 +19,37 @@
 #include <stdint.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
+#include <AP_HAL/AP_HAL_Boards.h>
+
+/*
+  allow EKF lanes to be stepped on their own threads. This is only
+  worthwhile on multi-core Linux boards and SITL, and is enabled with
+  the --enable-ekf-threads waf option. When disabled the scratch space
+  below stays in plain static storage
+ */
+#ifndef HAL_NAVEKF_CORE_THREADS
+#define HAL_NAVEKF_CORE_THREADS 0
+#endif
+
+/*
+  when lanes can run concurrently the scratch space must be per-thread
+ */
+#if HAL_NAVEKF_CORE_THREADS
+#define NAVEKF_SCRATCH thread_local
+#else
+#define NAVEKF_SCRATCH
+#endif
+
+/*
+  build EKF3 with its state vector, output predictor, covariance
+  matrix, Kalman gains and fusion arithmetic in double precision. The
+  IMU delta angle and velocity path stays in single precision. This
+  costs CPU and memory so is only suitable for boards with a double
+  precision FPU
+ */
+#ifndef HAL_WITH_EKF3_DOUBLE
+#define HAL_WITH_EKF3_DOUBLE 0
+#endif
 
 /*
   this declares a common parent class for AP_NavEKF2 and
@@ -28,11 +59,16 @@
   placing these in a common parent class we save a lot of memory, but
   we also save a lot of CPU (approx 10% on STM32F427) as the compiler
   is able to resolve the address of these variables at compile time,
-  which means significantly faster code
+  which means significantly faster code. When HAL_NAVEKF_CORE_THREADS
+  is enabled each thread gets its own copy of the scratch space.
+
+  The class is templated on the precision of the filter arithmetic, so
+  the scratch space is only shared between filters of the same precision
  */
+template <typename T>
 class NavEKF_core_common {
 public:
-    typedef float ftype;
+    typedef T ftype;
 #if MATH_CHECK_INDEXES
     typedef VectorN<ftype,28> Vector28;
     typedef VectorN<VectorN<ftype,24>,24> Matrix24;
@@ -42,11 +78,36 @@ public:
 #endif
 
 protected:
-    static Matrix24 KH;                   // intermediate result used for covariance updates
-    static Matrix24 KHP;                  // intermediate result used for covariance updates
-    static Matrix24 nextP;                // Predicted covariance matrix before addition of process noise to diagonals
-    static Vector28 Kfusion;              // intermediate fusion vector
+    static NAVEKF_SCRATCH Matrix24 KH;            // intermediate result used for covariance updates
+    static NAVEKF_SCRATCH Matrix24 KHP;           // intermediate result used for covariance updates
+    static NAVEKF_SCRATCH Matrix24 nextP;         // Predicted covariance matrix before addition of process noise to diagonals
+    static NAVEKF_SCRATCH Vector28 Kfusion;       // intermediate fusion vector
 
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
+
+    // constrain a value in the precision of the filter
+    static ftype constrain_ftype(const ftype amt, const ftype low, const ftype high) {
+        return constrain_value(amt, low, high);
+    }
 };
+
+extern template class NavEKF_core_common<float>;
+#if HAL_WITH_EKF3_DOUBLE
+extern template class NavEKF_core_common<double>;
+#endif
+
+// EKF3 state and vector types in the precision of the filter
+#if HAL_WITH_EKF3_DOUBLE
+typedef NavEKF_core_common<double> NavEKF3_core_common;
+typedef Vector2<double> Vector2F;
+typedef Vector3<double> Vector3F;
+typedef Matrix3<double> Matrix3F;
+typedef QuaternionD QuaternionF;
+#else
+typedef NavEKF_core_common<float> NavEKF3_core_common;
+typedef Vector2f Vector2F;
+typedef Vector3f Vector3F;
+typedef Matrix3f Matrix3F;
+typedef Quaternion QuaternionF;
+#endif
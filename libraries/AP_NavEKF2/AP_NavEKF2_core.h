@@ -59,7 +59,7 @@
 
 class AP_AHRS;
 
-class NavEKF2_core : public NavEKF_core_common
+class NavEKF2_core : public NavEKF_core_common<float>
 {
 public:
     // Constructor
@@ -604,6 +604,23 @@ const AP_Param::GroupInfo NavEKF3::var_info[] = {
     // @Units: mGauss
     AP_GROUPINFO("MAG_EF_LIM", 56, NavEKF3, _mag_ef_limit, 50),
 
+#if HAL_NAVEKF_CORE_THREADS
+    // @Param: THREADS
+    // @DisplayName: EKF lane threads
+    // @Description: Controls whether EKF lanes after the first are stepped on their own threads, in parallel with the first lane which stays in the main loop. This is only useful on boards with more than one CPU core. When set to 2 the thread for each lane is pinned to the CPU with the same number as the lane.
+    // @Values: 0:Disabled,1:Enabled,2:Enabled and pinned to CPU
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("THREADS", 57, NavEKF3, _coreThreads, 0),
+#endif
+
+    // @Param: VELPOS_BATCH
+    // @DisplayName: Batch velocity and position fusion
+    // @Description: When enabled the GPS velocity, position and height measurements accepted on each fusion step are fused with a single covariance update instead of one update per measurement. The result is the same to within rounding error and uses less CPU. If the batch update fails its health check the measurements are fused one at a time so that the bad measurement can be identified.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("VELPOS_BATCH", 58, NavEKF3, _velPosBatch, 0),
+
     AP_GROUPEND
 };
 
@@ -721,6 +738,21 @@ bool NavEKF3::InitialiseFilter(void)
         return false;
     }
 
+#if HAL_NAVEKF_CORE_THREADS
+    // start the lane threads once all cores are setup
+    if (_coreThreads > 0 && !coreThreadsStarted) {
+        coreThreadsStarted = true;
+        for (uint8_t i=1; i<num_cores; i++) {
+            const int8_t cpu = _coreThreads == 2 ? i : -1;
+            if (!core[i].thread_start(cpu)) {
+                gcs().send_text(MAV_SEVERITY_WARNING, "NavEKF3: lane %u thread failed", (unsigned)i);
+                continue;
+            }
+            coreThreadMask |= (1U<<i);
+        }
+    }
+#endif
+
     // Set the primary initially to be the lowest index
     primary = 0;
 
@@ -754,21 +786,56 @@ void NavEKF3::UpdateFilter(void)
 
     const AP_InertialSensor &ins = AP::ins();
 
+    const uint32_t update_start_us = AP_HAL::micros();
+
     bool statePredictEnabled[num_cores];
-    for (uint8_t i=0; i<num_cores; i++) {
-        // if we have not overrun by more than 3 IMU frames, and we
-        // have already used more than 1/3 of the CPU budget for this
-        // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
-            (AP_HAL::micros() - ins.get_last_update_usec()) > _frameTimeUsec/3) {
-            statePredictEnabled[i] = false;
-        } else {
-            statePredictEnabled[i] = true;
+#if HAL_NAVEKF_CORE_THREADS
+    if (coreThreadMask != 0) {
+        // lanes are running in parallel, so they are not competing
+        // for the CPU budget of this loop. Decide on prediction for
+        // all lanes before any of them run, then start the threaded
+        // lanes, run the rest here and wait for all of them to finish
+        const bool overBudget = (update_start_us - ins.get_last_update_usec()) > _frameTimeUsec/3;
+        for (uint8_t i=0; i<num_cores; i++) {
+            statePredictEnabled[i] = !(overBudget && core[i].getFramesSincePredict() < (_framesPerPrediction+3));
+            if (coreThreadMask & (1U<<i)) {
+                core[i].thread_update_start(statePredictEnabled[i]);
+            }
+        }
+        for (uint8_t i=0; i<num_cores; i++) {
+            if (!(coreThreadMask & (1U<<i))) {
+                core[i].UpdateFilter(statePredictEnabled[i]);
+            }
+        }
+        for (uint8_t i=0; i<num_cores; i++) {
+            if (coreThreadMask & (1U<<i)) {
+                core[i].thread_update_wait();
+            }
+        }
+    } else
+#endif
+    {
+        for (uint8_t i=0; i<num_cores; i++) {
+            // if we have not overrun by more than 3 IMU frames, and we
+            // have already used more than 1/3 of the CPU budget for this
+            // loop then suppress the prediction step. This allows
+            // multiple EKF instances to cooperate on scheduling
+            if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+                (AP_HAL::micros() - ins.get_last_update_usec()) > _frameTimeUsec/3) {
+                statePredictEnabled[i] = false;
+            } else {
+                statePredictEnabled[i] = true;
+            }
+            core[i].UpdateFilter(statePredictEnabled[i]);
         }
-        core[i].UpdateFilter(statePredictEnabled[i]);
     }
 
+    // record the time taken to step all lanes
+    const uint32_t update_dt_us = AP_HAL::micros() - update_start_us;
+    update_timing.count++;
+    update_timing.total_us += update_dt_us;
+    update_timing.max_us = MAX(update_timing.max_us, update_dt_us);
+
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
     // Don't start running the check until the primary core has started returned healthy for at least 10 seconds to avoid switching
     // due to initial alignment fluctuations and race conditions
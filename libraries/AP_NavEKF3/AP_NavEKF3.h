@@ -23,6 +23,7 @@
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
+#include <AP_NavEKF/AP_NavEKF_core_common.h>
 #include <AP_Airspeed/AP_Airspeed.h>
 #include <AP_Compass/AP_Compass.h>
 #include <AP_Logger/LogStructure.h>
@@ -448,6 +449,10 @@ private:
     AP_Int8  _flowUse;              // Controls if the optical flow data is fused into the main navigation estimator and/or the terrain estimator.
     AP_Float _hrt_filt_freq;        // frequency of output observer height rate complementary filter in Hz
     AP_Int16 _mag_ef_limit;         // limit on difference between WMM tables and learned earth field.
+#if HAL_NAVEKF_CORE_THREADS
+    AP_Int8 _coreThreads;           // 0 = step all lanes in the main thread, 1 = step lanes after the first on their own threads, 2 = as 1 and pin each thread to a CPU
+#endif
+    AP_Int8 _velPosBatch;           // 1 = fuse the accepted GPS velocity, position and height measurements with a single covariance update
 
 // Possible values for _flowUse
 #define FLOW_USE_NONE    0
@@ -484,11 +489,13 @@ private:
     const uint8_t sensorIntervalMin_ms = 50;       // The minimum allowed time between measurements from any non-IMU sensor (msec)
     const uint8_t flowIntervalMin_ms = 20;         // The minimum allowed time between measurements from optical flow sensors (msec)
 
+    // not bitfields, as these are set by lanes which may be running
+    // on their own threads
     struct {
-        bool enabled:1;
-        bool log_compass:1;
-        bool log_baro:1;
-        bool log_imu:1;
+        bool enabled;
+        bool log_compass;
+        bool log_baro;
+        bool log_imu;
     } logging;
 
     // time at start of current filter update
@@ -524,9 +531,23 @@ private:
 
     bool inhibitGpsVertVelUse;  // true when GPS vertical velocity use is prohibited
 
-    // origin set by one of the cores
+#if HAL_NAVEKF_CORE_THREADS
+    bool coreThreadsStarted;    // true once we have tried to start the lane threads
+    uint8_t coreThreadMask;     // bitmask of cores being stepped on their own thread
+#endif
+
+    // time taken to step all lanes in UpdateFilter()
+    struct {
+        uint32_t count;
+        uint64_t total_us;
+        uint32_t max_us;
+    } update_timing;
+
+    // origin set by one of the cores. Protected by common_origin_sem
+    // as lanes may be running on their own threads
     struct Location common_EKF_origin;
     bool common_origin_valid;
+    HAL_Semaphore common_origin_sem;
     
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
@@ -553,4 +574,5 @@ private:
     void Log_Write_Beacon(uint64_t time_us) const;
     void Log_Write_BodyOdom(uint64_t time_us) const;
     void Log_Write_State_Variances(uint64_t time_us) const;
+    void Log_Write_Timing(uint64_t time_us);
 };
@@ -91,8 +91,8 @@ void NavEKF3_core::FuseAirspeed()
             Kfusion[11] = SK_TAS[0]*(P[11][4]*SH_TAS[2] - P[11][22]*SH_TAS[2] + P[11][5]*SK_TAS[1] - P[11][23]*SK_TAS[1] + P[11][6]*vd*SH_TAS[0]);
             Kfusion[12] = SK_TAS[0]*(P[12][4]*SH_TAS[2] - P[12][22]*SH_TAS[2] + P[12][5]*SK_TAS[1] - P[12][23]*SK_TAS[1] + P[12][6]*vd*SH_TAS[0]);
         } else {
-            // zero indexes 10 to 12 = 3*4 bytes
-            memset(&Kfusion[10], 0, 12);
+            // zero indexes 10 to 12
+            memset(&Kfusion[10], 0, 3*sizeof(ftype));
         }
 
         if (!inhibitDelVelBiasStates) {
@@ -100,8 +100,8 @@ void NavEKF3_core::FuseAirspeed()
             Kfusion[14] = SK_TAS[0]*(P[14][4]*SH_TAS[2] - P[14][22]*SH_TAS[2] + P[14][5]*SK_TAS[1] - P[14][23]*SK_TAS[1] + P[14][6]*vd*SH_TAS[0]);
             Kfusion[15] = SK_TAS[0]*(P[15][4]*SH_TAS[2] - P[15][22]*SH_TAS[2] + P[15][5]*SK_TAS[1] - P[15][23]*SK_TAS[1] + P[15][6]*vd*SH_TAS[0]);
         } else {
-            // zero indexes 13 to 15 = 3*4 bytes
-            memset(&Kfusion[13], 0, 12);
+            // zero indexes 13 to 15
+            memset(&Kfusion[13], 0, 3*sizeof(ftype));
         }
 
         // zero Kalman gains to inhibit magnetic field state estimation
@@ -113,16 +113,16 @@ void NavEKF3_core::FuseAirspeed()
             Kfusion[20] = SK_TAS[0]*(P[20][4]*SH_TAS[2] - P[20][22]*SH_TAS[2] + P[20][5]*SK_TAS[1] - P[20][23]*SK_TAS[1] + P[20][6]*vd*SH_TAS[0]);
             Kfusion[21] = SK_TAS[0]*(P[21][4]*SH_TAS[2] - P[21][22]*SH_TAS[2] + P[21][5]*SK_TAS[1] - P[21][23]*SK_TAS[1] + P[21][6]*vd*SH_TAS[0]);
         } else {
-            // zero indexes 16 to 21 = 6*4 bytes
-            memset(&Kfusion[16], 0, 24);
+            // zero indexes 16 to 21
+            memset(&Kfusion[16], 0, 6*sizeof(ftype));
         }
 
         if (!inhibitWindStates) {
             Kfusion[22] = SK_TAS[0]*(P[22][4]*SH_TAS[2] - P[22][22]*SH_TAS[2] + P[22][5]*SK_TAS[1] - P[22][23]*SK_TAS[1] + P[22][6]*vd*SH_TAS[0]);
             Kfusion[23] = SK_TAS[0]*(P[23][4]*SH_TAS[2] - P[23][22]*SH_TAS[2] + P[23][5]*SK_TAS[1] - P[23][23]*SK_TAS[1] + P[23][6]*vd*SH_TAS[0]);
         } else {
-            // zero indexes 22 to 23 = 2*4 bytes
-            memset(&Kfusion[22], 0, 8);
+            // zero indexes 22 to 23
+            memset(&Kfusion[22], 0, 2*sizeof(ftype));
         }
 
         // calculate measurement innovation variance
@@ -274,7 +274,7 @@ void NavEKF3_core::FuseSideslip()
     const float R_BETA = 0.03f; // assume a sideslip angle RMS of ~10 deg
     Vector13 SH_BETA;
     Vector8 SK_BETA;
-    Vector3f vel_rel_wind;
+    Vector3F vel_rel_wind;
     Vector24 H_BETA;
     float innovBeta;
 
@@ -370,8 +370,8 @@ void NavEKF3_core::FuseSideslip()
             Kfusion[11] = SK_BETA[0]*(P[11][0]*SK_BETA[5] + P[11][1]*SK_BETA[4] - P[11][4]*SK_BETA[1] + P[11][5]*SK_BETA[2] + P[11][2]*SK_BETA[6] + P[11][6]*SK_BETA[3] - P[11][3]*SK_BETA[7] + P[11][22]*SK_BETA[1] - P[11][23]*SK_BETA[2]);
             Kfusion[12] = SK_BETA[0]*(P[12][0]*SK_BETA[5] + P[12][1]*SK_BETA[4] - P[12][4]*SK_BETA[1] + P[12][5]*SK_BETA[2] + P[12][2]*SK_BETA[6] + P[12][6]*SK_BETA[3] - P[12][3]*SK_BETA[7] + P[12][22]*SK_BETA[1] - P[12][23]*SK_BETA[2]);
         } else {
-            // zero indexes 10 to 12 = 3*4 bytes
-            memset(&Kfusion[10], 0, 12);
+            // zero indexes 10 to 12
+            memset(&Kfusion[10], 0, 3*sizeof(ftype));
         }
 
         if (!inhibitDelVelBiasStates) {
@@ -379,8 +379,8 @@ void NavEKF3_core::FuseSideslip()
             Kfusion[14] = SK_BETA[0]*(P[14][0]*SK_BETA[5] + P[14][1]*SK_BETA[4] - P[14][4]*SK_BETA[1] + P[14][5]*SK_BETA[2] + P[14][2]*SK_BETA[6] + P[14][6]*SK_BETA[3] - P[14][3]*SK_BETA[7] + P[14][22]*SK_BETA[1] - P[14][23]*SK_BETA[2]);
             Kfusion[15] = SK_BETA[0]*(P[15][0]*SK_BETA[5] + P[15][1]*SK_BETA[4] - P[15][4]*SK_BETA[1] + P[15][5]*SK_BETA[2] + P[15][2]*SK_BETA[6] + P[15][6]*SK_BETA[3] - P[15][3]*SK_BETA[7] + P[15][22]*SK_BETA[1] - P[15][23]*SK_BETA[2]);
         } else {
-            // zero indexes 13 to 15 = 3*4 bytes
-            memset(&Kfusion[13], 0, 12);
+            // zero indexes 13 to 15
+            memset(&Kfusion[13], 0, 3*sizeof(ftype));
         }
 
         // zero Kalman gains to inhibit magnetic field state estimation
@@ -392,16 +392,16 @@ void NavEKF3_core::FuseSideslip()
             Kfusion[20] = SK_BETA[0]*(P[20][0]*SK_BETA[5] + P[20][1]*SK_BETA[4] - P[20][4]*SK_BETA[1] + P[20][5]*SK_BETA[2] + P[20][2]*SK_BETA[6] + P[20][6]*SK_BETA[3] - P[20][3]*SK_BETA[7] + P[20][22]*SK_BETA[1] - P[20][23]*SK_BETA[2]);
             Kfusion[21] = SK_BETA[0]*(P[21][0]*SK_BETA[5] + P[21][1]*SK_BETA[4] - P[21][4]*SK_BETA[1] + P[21][5]*SK_BETA[2] + P[21][2]*SK_BETA[6] + P[21][6]*SK_BETA[3] - P[21][3]*SK_BETA[7] + P[21][22]*SK_BETA[1] - P[21][23]*SK_BETA[2]);
         } else {
-            // zero indexes 16 to 21 = 6*4 bytes
-            memset(&Kfusion[16], 0, 24);
+            // zero indexes 16 to 21
+            memset(&Kfusion[16], 0, 6*sizeof(ftype));
         }
 
         if (!inhibitWindStates) {
             Kfusion[22] = SK_BETA[0]*(P[22][0]*SK_BETA[5] + P[22][1]*SK_BETA[4] - P[22][4]*SK_BETA[1] + P[22][5]*SK_BETA[2] + P[22][2]*SK_BETA[6] + P[22][6]*SK_BETA[3] - P[22][3]*SK_BETA[7] + P[22][22]*SK_BETA[1] - P[22][23]*SK_BETA[2]);
             Kfusion[23] = SK_BETA[0]*(P[23][0]*SK_BETA[5] + P[23][1]*SK_BETA[4] - P[23][4]*SK_BETA[1] + P[23][5]*SK_BETA[2] + P[23][2]*SK_BETA[6] + P[23][6]*SK_BETA[3] - P[23][3]*SK_BETA[7] + P[23][22]*SK_BETA[1] - P[23][23]*SK_BETA[2]);
         } else {
-            // zero indexes 22 to 23 = 2*4 bytes
-            memset(&Kfusion[22], 0, 8);
+            // zero indexes 22 to 23
+            memset(&Kfusion[22], 0, 2*sizeof(ftype));
         }
 
         // calculate predicted sideslip angle and innovation using small angle approximation
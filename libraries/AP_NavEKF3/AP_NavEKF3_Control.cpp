@@ -66,7 +66,7 @@ void NavEKF3_core::setWindMagStateLearningMode()
         if (yawAlignComplete && useAirspeed()) {
             // if we have airspeed and a valid heading, set the wind states to the reciprocal of the vehicle heading
             // which assumes the vehicle has launched into the wind
-             Vector3f tempEuler;
+             Vector3F tempEuler;
             stateStruct.quat.to_euler(tempEuler.x, tempEuler.y, tempEuler.z);
             float windSpeed =  sqrtf(sq(stateStruct.velocity.x) + sq(stateStruct.velocity.y)) - tasDataDelayed.tas;
             stateStruct.wind_vel.x = windSpeed * cosf(tempEuler.z);
@@ -192,6 +192,25 @@ void NavEKF3_core::updateStateIndexLim()
     }
 }
 
+// return the state groups used by the covariance prediction
+uint8_t NavEKF3_core::activeStateGroups(void) const
+{
+    uint8_t activeStates = 0;
+    if (!inhibitDelAngBiasStates) {
+        activeStates |= NavEKF3_CovPrediction::STATES_DANG_BIAS;
+    }
+    if (!inhibitDelVelBiasStates) {
+        activeStates |= NavEKF3_CovPrediction::STATES_DVEL_BIAS;
+    }
+    if (!inhibitMagStates) {
+        activeStates |= NavEKF3_CovPrediction::STATES_MAG;
+    }
+    if (!inhibitWindStates) {
+        activeStates |= NavEKF3_CovPrediction::STATES_WIND;
+    }
+    return activeStates & NavEKF3_CovPrediction::activeStatesForIndexLim(stateIndexLim);
+}
+
 // Set inertial navigation aiding mode
 void NavEKF3_core::setAidingMode()
 {
@@ -493,6 +512,7 @@ void NavEKF3_core::setOrigin(const Location &loc)
     gcs().send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u origin set",(unsigned)imu_index);
 
     // put origin in frontend as well to ensure it stays in sync between lanes
+    WITH_SEMAPHORE(frontend->common_origin_sem);
     frontend->common_EKF_origin = EKF_origin;
     frontend->common_origin_valid = true;
 }
@@ -0,0 +1,79 @@
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/vectorN.h>
+#include <AP_NavEKF/AP_NavEKF_core_common.h>
+
+/*
+  covariance prediction kernel for the 24 state EKF3.
+
+  This holds the auto-coded covariance prediction equations, split
+  into one block per group of optional states so that groups which
+  are inhibited are not calculated at all. It has no dependency on
+  the rest of the EKF so it can be benchmarked on its own
+ */
+class NavEKF3_CovPrediction {
+public:
+    typedef NavEKF3_core_common::ftype ftype;
+    typedef NavEKF3_core_common::Matrix24 Matrix24;
+
+    // groups of states which can be inhibited, used as a bitmask
+    enum {
+        STATES_DANG_BIAS = (1U<<0),  // states 10-12
+        STATES_DVEL_BIAS = (1U<<1),  // states 13-15
+        STATES_MAG       = (1U<<2),  // states 16-21
+        STATES_WIND      = (1U<<3),  // states 22-23
+        STATES_ALL       = 0x0F,
+    };
+
+    struct Inputs {
+        ftype dt;               // covariance prediction time step (sec)
+        QuaternionF quat;       // quaternion defining rotation from local NED earth frame to body frame
+        Vector3f delAng;        // IMU delta angle (rad)
+        Vector3f delVel;        // IMU delta velocity (m/s)
+        Vector3F gyro_bias;     // delta angle bias state (rad)
+        Vector3F accel_bias;    // delta velocity bias state (m/s)
+        ftype delAngVar;        // delta angle noise variance (rad^2)
+        ftype delVelVar;        // delta velocity noise variance ((m/s)^2)
+    };
+
+    // calculate the upper triangle of the predicted covariance into
+    // nextP, before process noise is added to the optional states.
+    // Columns of state groups not in activeStates are zeroed. Rows
+    // and columns of P for inactive states are expected to be zero
+    static void predict(const Matrix24 &P, Matrix24 &nextP, const Inputs &in, uint8_t activeStates);
+
+    // return the state groups implied by a state index limit
+    static uint8_t activeStatesForIndexLim(uint8_t stateIndexLim);
+
+    // return the group a state belongs to, or zero for the states
+    // which can't be inhibited
+    static uint8_t stateGroup(uint8_t stateIndex);
+
+private:
+#if MATH_CHECK_INDEXES
+    typedef VectorN<ftype,8> Vector8;
+    typedef VectorN<ftype,11> Vector11;
+    typedef VectorN<ftype,21> Vector21;
+#else
+    typedef ftype Vector8[8];
+    typedef ftype Vector11[11];
+    typedef ftype Vector21[21];
+#endif
+
+    static void zeroColumns(Matrix24 &nextP, uint8_t first, uint8_t last);
+};
@@ -1,4 +1,5 @@
 #include "AP_NavEKF3.h"
+#include "AP_NavEKF3_core.h"
 
 #include <AP_HAL/HAL.h>
 #include <AP_Logger/AP_Logger.h>
@@ -329,14 +330,49 @@ void NavEKF3::Log_Write()
     Log_Write_State_Variances(time_us);
 
     // log EKF timing statistics every 5s
+    Log_Write_Timing(time_us);
+}
+
+void NavEKF3::Log_Write_Timing(uint64_t time_us)
+{
     static uint32_t lastTimingLogTime_ms = 0;
-    if (AP_HAL::millis() - lastTimingLogTime_ms > 5000) {
-        lastTimingLogTime_ms = AP_HAL::millis();
-        struct ekf_timing timing;
-        for (uint8_t i=0; i<activeCores(); i++) {
-            getTimingStatistics(i, timing);
-            Log_EKF_Timing("XKT", i, time_us, timing);
-        }
+    if (AP_HAL::millis() - lastTimingLogTime_ms <= 5000) {
+        return;
+    }
+    lastTimingLogTime_ms = AP_HAL::millis();
+
+    struct ekf_timing timing;
+    for (uint8_t i=0; i<activeCores(); i++) {
+        getTimingStatistics(i, timing);
+        Log_EKF_Timing("XKT", i, time_us, timing);
+    }
+
+    // per-lane CPU cost, and the main loop time taken to step all
+    // lanes. Comparing these with EK3_THREADS on and off shows the
+    // saving from running lanes in parallel
+    const uint32_t update_avg_us = update_timing.count ? update_timing.total_us / update_timing.count : 0;
+    for (uint8_t i=0; i<activeCores(); i++) {
+        uint32_t count, avg_us, max_us;
+        core[i].getUpdateTiming(count, avg_us, max_us);
+#if HAL_NAVEKF_CORE_THREADS
+        const uint8_t threaded = (coreThreadMask & (1U<<i)) ? 1 : 0;
+#else
+        const uint8_t threaded = 0;
+#endif
+        AP::logger().Write("XKTL",
+                           "TimeUS,C,Thr,Cnt,LAvg,LMax,UAvg,UMax",
+                           "s#--ssss",
+                           "F---FFFF",
+                           "QBBIIIII",
+                           time_us,
+                           i,
+                           threaded,
+                           count,
+                           avg_us,
+                           max_us,
+                           update_avg_us,
+                           update_timing.max_us);
     }
+    memset(&update_timing, 0, sizeof(update_timing));
 }
 
@@ -27,8 +27,8 @@ void NavEKF3_core::controlMagYawReset()
     }
 
     // Quaternion and delta rotation vector that are re-used for different calculations
-    Vector3f deltaRotVecTemp;
-    Quaternion deltaQuatTemp;
+    Vector3F deltaRotVecTemp;
+    QuaternionF deltaQuatTemp;
 
     bool flightResetAllowed = false;
     bool initialResetAllowed = false;
@@ -86,17 +86,17 @@ void NavEKF3_core::controlMagYawReset()
     if (magYawResetRequest || magStateResetRequest) {
 
         // get the euler angles from the current state estimate
-        Vector3f eulerAngles;
+        Vector3F eulerAngles;
         stateStruct.quat.to_euler(eulerAngles.x, eulerAngles.y, eulerAngles.z);
 
         // Use the Euler angles and magnetometer measurement to update the magnetic field states
         // and get an updated quaternion
-        Quaternion newQuat = calcQuatAndFieldStates(eulerAngles.x, eulerAngles.y);
+        QuaternionF newQuat = calcQuatAndFieldStates(eulerAngles.x, eulerAngles.y);
 
         // if a yaw reset has been requested, apply the updated quaternion to the current state
         if (magYawResetRequest) {
             // previous value used to calculate a reset delta
-            Quaternion prevQuat = stateStruct.quat;
+            QuaternionF prevQuat = stateStruct.quat;
 
             // calculate the variance for the rotation estimate expressed as a rotation vector
             // this will be used later to reset the quaternion state covariances
@@ -151,7 +151,7 @@ void NavEKF3_core::controlMagYawReset()
 void NavEKF3_core::realignYawGPS()
 {
     // get quaternion from existing filter states and calculate roll, pitch and yaw angles
-    Vector3f eulerAngles;
+    Vector3F eulerAngles;
     stateStruct.quat.to_euler(eulerAngles.x, eulerAngles.y, eulerAngles.z);
 
     if ((sq(gpsDataDelayed.vel.x) + sq(gpsDataDelayed.vel.y)) > 25.0f) {
@@ -219,11 +219,11 @@ void NavEKF3_core::alignYawAngle()
     Vector3f angleErrVarVec = calcRotVecVariances();
 
     if (yawAngDataDelayed.type == 2) {
-        Vector3f euler321;
+        Vector3F euler321;
         stateStruct.quat.to_euler(euler321.x, euler321.y, euler321.z);
         stateStruct.quat.from_euler(euler321.x, euler321.y, yawAngDataDelayed.yawAng);
     } else if (yawAngDataDelayed.type == 1) {
-        Vector3f euler312 = stateStruct.quat.to_vector312();
+        Vector3F euler312 = stateStruct.quat.to_vector312();
         stateStruct.quat.from_vector312(euler312.x, euler312.y, yawAngDataDelayed.yawAng);
     }
 
@@ -534,8 +534,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[11] = SK_MX[0]*(P[11][19] + P[11][1]*SH_MAG[0] - P[11][2]*SH_MAG[1] + P[11][3]*SH_MAG[2] + P[11][0]*SK_MX[2] - P[11][16]*SK_MX[1] + P[11][17]*SK_MX[4] - P[11][18]*SK_MX[3]);
                 Kfusion[12] = SK_MX[0]*(P[12][19] + P[12][1]*SH_MAG[0] - P[12][2]*SH_MAG[1] + P[12][3]*SH_MAG[2] + P[12][0]*SK_MX[2] - P[12][16]*SK_MX[1] + P[12][17]*SK_MX[4] - P[12][18]*SK_MX[3]);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitDelVelBiasStates) {
@@ -543,8 +543,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[14] = SK_MX[0]*(P[14][19] + P[14][1]*SH_MAG[0] - P[14][2]*SH_MAG[1] + P[14][3]*SH_MAG[2] + P[14][0]*SK_MX[2] - P[14][16]*SK_MX[1] + P[14][17]*SK_MX[4] - P[14][18]*SK_MX[3]);
                 Kfusion[15] = SK_MX[0]*(P[15][19] + P[15][1]*SH_MAG[0] - P[15][2]*SH_MAG[1] + P[15][3]*SH_MAG[2] + P[15][0]*SK_MX[2] - P[15][16]*SK_MX[1] + P[15][17]*SK_MX[4] - P[15][18]*SK_MX[3]);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
             // zero Kalman gains to inhibit magnetic field state estimation
             if (!inhibitMagStates) {
@@ -555,8 +555,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[20] = SK_MX[0]*(P[20][19] + P[20][1]*SH_MAG[0] - P[20][2]*SH_MAG[1] + P[20][3]*SH_MAG[2] + P[20][0]*SK_MX[2] - P[20][16]*SK_MX[1] + P[20][17]*SK_MX[4] - P[20][18]*SK_MX[3]);
                 Kfusion[21] = SK_MX[0]*(P[21][19] + P[21][1]*SH_MAG[0] - P[21][2]*SH_MAG[1] + P[21][3]*SH_MAG[2] + P[21][0]*SK_MX[2] - P[21][16]*SK_MX[1] + P[21][17]*SK_MX[4] - P[21][18]*SK_MX[3]);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             // zero Kalman gains to inhibit wind state estimation
@@ -564,8 +564,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[22] = SK_MX[0]*(P[22][19] + P[22][1]*SH_MAG[0] - P[22][2]*SH_MAG[1] + P[22][3]*SH_MAG[2] + P[22][0]*SK_MX[2] - P[22][16]*SK_MX[1] + P[22][17]*SK_MX[4] - P[22][18]*SK_MX[3]);
                 Kfusion[23] = SK_MX[0]*(P[23][19] + P[23][1]*SH_MAG[0] - P[23][2]*SH_MAG[1] + P[23][3]*SH_MAG[2] + P[23][0]*SK_MX[2] - P[23][16]*SK_MX[1] + P[23][17]*SK_MX[4] - P[23][18]*SK_MX[3]);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
 
             // set flags to indicate to other processes that fusion has been performed and is required on the next frame
@@ -611,8 +611,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[11] = SK_MY[0]*(P[11][20] + P[11][0]*SH_MAG[2] + P[11][1]*SH_MAG[1] + P[11][2]*SH_MAG[0] - P[11][3]*SK_MY[2] - P[11][17]*SK_MY[1] - P[11][16]*SK_MY[3] + P[11][18]*SK_MY[4]);
                 Kfusion[12] = SK_MY[0]*(P[12][20] + P[12][0]*SH_MAG[2] + P[12][1]*SH_MAG[1] + P[12][2]*SH_MAG[0] - P[12][3]*SK_MY[2] - P[12][17]*SK_MY[1] - P[12][16]*SK_MY[3] + P[12][18]*SK_MY[4]);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitDelVelBiasStates) {
@@ -620,8 +620,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[14] = SK_MY[0]*(P[14][20] + P[14][0]*SH_MAG[2] + P[14][1]*SH_MAG[1] + P[14][2]*SH_MAG[0] - P[14][3]*SK_MY[2] - P[14][17]*SK_MY[1] - P[14][16]*SK_MY[3] + P[14][18]*SK_MY[4]);
                 Kfusion[15] = SK_MY[0]*(P[15][20] + P[15][0]*SH_MAG[2] + P[15][1]*SH_MAG[1] + P[15][2]*SH_MAG[0] - P[15][3]*SK_MY[2] - P[15][17]*SK_MY[1] - P[15][16]*SK_MY[3] + P[15][18]*SK_MY[4]);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
 
             // zero Kalman gains to inhibit magnetic field state estimation
@@ -633,8 +633,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[20] = SK_MY[0]*(P[20][20] + P[20][0]*SH_MAG[2] + P[20][1]*SH_MAG[1] + P[20][2]*SH_MAG[0] - P[20][3]*SK_MY[2] - P[20][17]*SK_MY[1] - P[20][16]*SK_MY[3] + P[20][18]*SK_MY[4]);
                 Kfusion[21] = SK_MY[0]*(P[21][20] + P[21][0]*SH_MAG[2] + P[21][1]*SH_MAG[1] + P[21][2]*SH_MAG[0] - P[21][3]*SK_MY[2] - P[21][17]*SK_MY[1] - P[21][16]*SK_MY[3] + P[21][18]*SK_MY[4]);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             // zero Kalman gains to inhibit wind state estimation
@@ -642,8 +642,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[22] = SK_MY[0]*(P[22][20] + P[22][0]*SH_MAG[2] + P[22][1]*SH_MAG[1] + P[22][2]*SH_MAG[0] - P[22][3]*SK_MY[2] - P[22][17]*SK_MY[1] - P[22][16]*SK_MY[3] + P[22][18]*SK_MY[4]);
                 Kfusion[23] = SK_MY[0]*(P[23][20] + P[23][0]*SH_MAG[2] + P[23][1]*SH_MAG[1] + P[23][2]*SH_MAG[0] - P[23][3]*SK_MY[2] - P[23][17]*SK_MY[1] - P[23][16]*SK_MY[3] + P[23][18]*SK_MY[4]);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
 
             // set flags to indicate to other processes that fusion has been performed and is required on the next frame
@@ -689,8 +689,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[11] = SK_MZ[0]*(P[11][21] + P[11][0]*SH_MAG[1] - P[11][1]*SH_MAG[2] + P[11][3]*SH_MAG[0] + P[11][2]*SK_MZ[2] + P[11][18]*SK_MZ[1] + P[11][16]*SK_MZ[4] - P[11][17]*SK_MZ[3]);
                 Kfusion[12] = SK_MZ[0]*(P[12][21] + P[12][0]*SH_MAG[1] - P[12][1]*SH_MAG[2] + P[12][3]*SH_MAG[0] + P[12][2]*SK_MZ[2] + P[12][18]*SK_MZ[1] + P[12][16]*SK_MZ[4] - P[12][17]*SK_MZ[3]);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitDelVelBiasStates) {
@@ -698,8 +698,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[14] = SK_MZ[0]*(P[14][21] + P[14][0]*SH_MAG[1] - P[14][1]*SH_MAG[2] + P[14][3]*SH_MAG[0] + P[14][2]*SK_MZ[2] + P[14][18]*SK_MZ[1] + P[14][16]*SK_MZ[4] - P[14][17]*SK_MZ[3]);
                 Kfusion[15] = SK_MZ[0]*(P[15][21] + P[15][0]*SH_MAG[1] - P[15][1]*SH_MAG[2] + P[15][3]*SH_MAG[0] + P[15][2]*SK_MZ[2] + P[15][18]*SK_MZ[1] + P[15][16]*SK_MZ[4] - P[15][17]*SK_MZ[3]);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
 
             // zero Kalman gains to inhibit magnetic field state estimation
@@ -711,8 +711,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[20] = SK_MZ[0]*(P[20][21] + P[20][0]*SH_MAG[1] - P[20][1]*SH_MAG[2] + P[20][3]*SH_MAG[0] + P[20][2]*SK_MZ[2] + P[20][18]*SK_MZ[1] + P[20][16]*SK_MZ[4] - P[20][17]*SK_MZ[3]);
                 Kfusion[21] = SK_MZ[0]*(P[21][21] + P[21][0]*SH_MAG[1] - P[21][1]*SH_MAG[2] + P[21][3]*SH_MAG[0] + P[21][2]*SK_MZ[2] + P[21][18]*SK_MZ[1] + P[21][16]*SK_MZ[4] - P[21][17]*SK_MZ[3]);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             // zero Kalman gains to inhibit wind state estimation
@@ -720,8 +720,8 @@ void NavEKF3_core::FuseMagnetometer()
                 Kfusion[22] = SK_MZ[0]*(P[22][21] + P[22][0]*SH_MAG[1] - P[22][1]*SH_MAG[2] + P[22][3]*SH_MAG[0] + P[22][2]*SK_MZ[2] + P[22][18]*SK_MZ[1] + P[22][16]*SK_MZ[4] - P[22][17]*SK_MZ[3]);
                 Kfusion[23] = SK_MZ[0]*(P[23][21] + P[23][0]*SH_MAG[1] - P[23][1]*SH_MAG[2] + P[23][3]*SH_MAG[0] + P[23][2]*SK_MZ[2] + P[23][18]*SK_MZ[1] + P[23][16]*SK_MZ[4] - P[23][17]*SK_MZ[3]);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
 
             // set flags to indicate to other processes that fusion has been performed and is required on the next frame
@@ -892,7 +892,7 @@ void NavEKF3_core::fuseEulerYaw(bool usePredictedYaw, bool useExternalYawSensor)
         H_YAW[3] = t8*t14*(q0*t3+q0*t4-q0*t5+q0*t6+q1*q2*q3*2.0f)*2.0f;
 
         // Get the 321 euler angles
-        Vector3f euler321;
+        Vector3F euler321;
         stateStruct.quat.to_euler(euler321.x, euler321.y, euler321.z);
         yawAngPredicted = euler321.z;
 
@@ -931,7 +931,7 @@ void NavEKF3_core::fuseEulerYaw(bool usePredictedYaw, bool useExternalYawSensor)
         H_YAW[3] = t8*t14*(q0*t3-q0*t4+q0*t5+q0*t6-q1*q2*q3*2.0f)*2.0f;
 
         // Get the 321 euler angles
-        Vector3f euler312 = stateStruct.quat.to_vector312();
+        Vector3F euler312 = stateStruct.quat.to_vector312();
         yawAngPredicted = euler312.z;
 
         // set the yaw to zero and calculate the zero yaw rotation from body to earth frame
@@ -1144,8 +1144,8 @@ void NavEKF3_core::FuseDeclination(float declErr)
         Kfusion[11] = -t4*t13*(P[11][16]*magE-P[11][17]*magN);
         Kfusion[12] = -t4*t13*(P[12][16]*magE-P[12][17]*magN);
     } else {
-        // zero indexes 10 to 12 = 3*4 bytes
-        memset(&Kfusion[10], 0, 12);
+        // zero indexes 10 to 12
+        memset(&Kfusion[10], 0, 3*sizeof(ftype));
     }
 
     if (!inhibitDelVelBiasStates) {
@@ -1153,8 +1153,8 @@ void NavEKF3_core::FuseDeclination(float declErr)
         Kfusion[14] = -t4*t13*(P[14][16]*magE-P[14][17]*magN);
         Kfusion[15] = -t4*t13*(P[15][16]*magE-P[15][17]*magN);
     } else {
-        // zero indexes 13 to 15 = 3*4 bytes
-        memset(&Kfusion[13], 0, 12);
+        // zero indexes 13 to 15
+        memset(&Kfusion[13], 0, 3*sizeof(ftype));
     }
 
     if (!inhibitMagStates) {
@@ -1165,16 +1165,16 @@ void NavEKF3_core::FuseDeclination(float declErr)
         Kfusion[20] = -t4*t13*(P[20][16]*magE-P[20][17]*magN);
         Kfusion[21] = -t4*t13*(P[21][16]*magE-P[21][17]*magN);
     } else {
-        // zero indexes 16 to 21 = 6*4 bytes
-        memset(&Kfusion[16], 0, 24);
+        // zero indexes 16 to 21
+        memset(&Kfusion[16], 0, 6*sizeof(ftype));
     }
 
     if (!inhibitWindStates) {
         Kfusion[22] = -t4*t13*(P[22][16]*magE-P[22][17]*magN);
         Kfusion[23] = -t4*t13*(P[23][16]*magE-P[23][17]*magN);
     } else {
-        // zero indexes 22 to 23 = 2*4 bytes
-        memset(&Kfusion[22], 0, 8);
+        // zero indexes 22 to 23
+        memset(&Kfusion[22], 0, 2*sizeof(ftype));
     }
 
     // get the magnetic declination
@@ -1259,7 +1259,7 @@ void NavEKF3_core::alignMagStateDeclination()
     float magDecAng = MagDeclination();
 
     // rotate the NE values so that the declination matches the published value
-    Vector3f initMagNED = stateStruct.earth_magfield;
+    Vector3F initMagNED = stateStruct.earth_magfield;
     float magLengthNE = norm(initMagNED.x,initMagNED.y);
     stateStruct.earth_magfield.x = magLengthNE * cosf(magDecAng);
     stateStruct.earth_magfield.y = magLengthNE * sinf(magDecAng);
@@ -589,8 +589,17 @@ void NavEKF3_core::readGpsData()
             calcGpsGoodForFlight();
 
             // see if we can get an origin from the frontend
-            if (!validOrigin && frontend->common_origin_valid) {
-                setOrigin(frontend->common_EKF_origin);
+            if (!validOrigin) {
+                Location common_origin;
+                bool common_origin_valid;
+                {
+                    WITH_SEMAPHORE(frontend->common_origin_sem);
+                    common_origin = frontend->common_EKF_origin;
+                    common_origin_valid = frontend->common_origin_valid;
+                }
+                if (common_origin_valid) {
+                    setOrigin(common_origin);
+                }
             }
 
             // Read the GPS location in WGS-84 lat,long,height coordinates
@@ -621,7 +630,7 @@ void NavEKF3_core::readGpsData()
                     have_table_earth_field = true;
                     if (frontend->_mag_ef_limit > 0) {
                         // initialise earth field from tables
-                        stateStruct.earth_magfield = table_earth_field_ga;
+                        stateStruct.earth_magfield = Vector3F(table_earth_field_ga);
                     }
                 }
             }
@@ -981,9 +990,9 @@ void NavEKF3_core::learnInactiveBiases(void)
             // get filtered gyro and use the difference between the
             // corrected gyro on the active IMU and the inactive IMU
             // to move the inactive bias towards the right value
-            Vector3f filtered_gyro_active = ins.get_gyro(gyro_index_active) - (stateStruct.gyro_bias/dtEkfAvg);
-            Vector3f filtered_gyro_inactive = ins.get_gyro(i) - (inactiveBias[i].gyro_bias/dtEkfAvg);
-            Vector3f error = filtered_gyro_active - filtered_gyro_inactive;
+            Vector3F filtered_gyro_active = Vector3F(ins.get_gyro(gyro_index_active)) - (stateStruct.gyro_bias/dtEkfAvg);
+            Vector3F filtered_gyro_inactive = Vector3F(ins.get_gyro(i)) - (inactiveBias[i].gyro_bias/dtEkfAvg);
+            Vector3F error = filtered_gyro_active - filtered_gyro_inactive;
 
             // prevent a single large error from contaminating bias estimate
             const float bias_limit = radians(5);
@@ -1010,9 +1019,9 @@ void NavEKF3_core::learnInactiveBiases(void)
             // get filtered accel and use the difference between the
             // corrected accel on the active IMU and the inactive IMU
             // to move the inactive bias towards the right value
-            Vector3f filtered_accel_active = ins.get_accel(accel_index_active) - (stateStruct.accel_bias/dtEkfAvg);
-            Vector3f filtered_accel_inactive = ins.get_accel(i) - (inactiveBias[i].accel_bias/dtEkfAvg);
-            Vector3f error = filtered_accel_active - filtered_accel_inactive;
+            Vector3F filtered_accel_active = Vector3F(ins.get_accel(accel_index_active)) - (stateStruct.accel_bias/dtEkfAvg);
+            Vector3F filtered_accel_inactive = Vector3F(ins.get_accel(i)) - (inactiveBias[i].accel_bias/dtEkfAvg);
+            Vector3F error = filtered_accel_active - filtered_accel_inactive;
 
             // prevent a single large error from contaminating bias estimate
             const float bias_limit = 1.0; // m/s/s
@@ -165,7 +165,7 @@ void NavEKF3_core::EstimateTerrainOffset()
 
         if (!cantFuseFlowData) {
 
-            Vector3f relVelSensor;          // velocity of sensor relative to ground in sensor axes
+            Vector3F relVelSensor;          // velocity of sensor relative to ground in sensor axes
             Vector2f losPred;               // predicted optical flow angular rate measurement
             float q0 = stateStruct.quat[0]; // quaternion at optical flow measurement time
             float q1 = stateStruct.quat[1]; // quaternion at optical flow measurement time
@@ -285,7 +285,7 @@ void NavEKF3_core::EstimateTerrainOffset()
 void NavEKF3_core::FuseOptFlow()
 {
     Vector24 H_LOS;
-    Vector3f relVelSensor;
+    Vector3F relVelSensor;
     Vector14 SH_LOS;
     Vector2 losPred;
 
@@ -329,12 +329,12 @@ void NavEKF3_core::FuseOptFlow()
         // centre of the image on the ground assuming flat terrain
         Vector3f posOffsetBody = (*ofDataDelayed.body_offset) - accelPosOffset;
         if (!posOffsetBody.is_zero()) {
-            Vector3f posOffsetEarth = prevTnb.mul_transpose(posOffsetBody);
+            Vector3F posOffsetEarth = prevTnb.mul_transpose(Vector3F(posOffsetBody));
             range -= posOffsetEarth.z / prevTnb.c.z;
         }
 
         // calculate relative velocity in sensor frame including the relative motion due to rotation
-        relVelSensor = (prevTnb * stateStruct.velocity) + (ofDataDelayed.bodyRadXYZ % posOffsetBody);
+        relVelSensor = (prevTnb * stateStruct.velocity) + Vector3F(ofDataDelayed.bodyRadXYZ % posOffsetBody);
 
         // divide velocity by range to get predicted angular LOS rates relative to X and Y axes
         losPred[0] =  relVelSensor.y/range;
@@ -479,8 +479,8 @@ void NavEKF3_core::FuseOptFlow()
                 Kfusion[11] = t78*(P[11][0]*t2*t5-P[11][4]*t2*t7+P[11][1]*t2*t15+P[11][6]*t2*t10+P[11][2]*t2*t19-P[11][3]*t2*t22+P[11][5]*t2*t27);
                 Kfusion[12] = t78*(P[12][0]*t2*t5-P[12][4]*t2*t7+P[12][1]*t2*t15+P[12][6]*t2*t10+P[12][2]*t2*t19-P[12][3]*t2*t22+P[12][5]*t2*t27);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitDelVelBiasStates) {
@@ -488,8 +488,8 @@ void NavEKF3_core::FuseOptFlow()
                 Kfusion[14] = t78*(P[14][0]*t2*t5-P[14][4]*t2*t7+P[14][1]*t2*t15+P[14][6]*t2*t10+P[14][2]*t2*t19-P[14][3]*t2*t22+P[14][5]*t2*t27);
                 Kfusion[15] = t78*(P[15][0]*t2*t5-P[15][4]*t2*t7+P[15][1]*t2*t15+P[15][6]*t2*t10+P[15][2]*t2*t19-P[15][3]*t2*t22+P[15][5]*t2*t27);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitMagStates) {
@@ -500,16 +500,16 @@ void NavEKF3_core::FuseOptFlow()
                 Kfusion[20] = t78*(P[20][0]*t2*t5-P[20][4]*t2*t7+P[20][1]*t2*t15+P[20][6]*t2*t10+P[20][2]*t2*t19-P[20][3]*t2*t22+P[20][5]*t2*t27);
                 Kfusion[21] = t78*(P[21][0]*t2*t5-P[21][4]*t2*t7+P[21][1]*t2*t15+P[21][6]*t2*t10+P[21][2]*t2*t19-P[21][3]*t2*t22+P[21][5]*t2*t27);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             if (!inhibitWindStates) {
                 Kfusion[22] = t78*(P[22][0]*t2*t5-P[22][4]*t2*t7+P[22][1]*t2*t15+P[22][6]*t2*t10+P[22][2]*t2*t19-P[22][3]*t2*t22+P[22][5]*t2*t27);
                 Kfusion[23] = t78*(P[23][0]*t2*t5-P[23][4]*t2*t7+P[23][1]*t2*t15+P[23][6]*t2*t10+P[23][2]*t2*t19-P[23][3]*t2*t22+P[23][5]*t2*t27);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
 
         } else {
@@ -650,8 +650,8 @@ void NavEKF3_core::FuseOptFlow()
                 Kfusion[11] = -t78*(P[11][0]*t2*t5+P[11][5]*t2*t8-P[11][6]*t2*t10+P[11][1]*t2*t16-P[11][2]*t2*t19+P[11][3]*t2*t22+P[11][4]*t2*t27);
                 Kfusion[12] = -t78*(P[12][0]*t2*t5+P[12][5]*t2*t8-P[12][6]*t2*t10+P[12][1]*t2*t16-P[12][2]*t2*t19+P[12][3]*t2*t22+P[12][4]*t2*t27);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitDelVelBiasStates) {
@@ -659,8 +659,8 @@ void NavEKF3_core::FuseOptFlow()
                 Kfusion[14] = -t78*(P[14][0]*t2*t5+P[14][5]*t2*t8-P[14][6]*t2*t10+P[14][1]*t2*t16-P[14][2]*t2*t19+P[14][3]*t2*t22+P[14][4]*t2*t27);
                 Kfusion[15] = -t78*(P[15][0]*t2*t5+P[15][5]*t2*t8-P[15][6]*t2*t10+P[15][1]*t2*t16-P[15][2]*t2*t19+P[15][3]*t2*t22+P[15][4]*t2*t27);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitMagStates) {
@@ -671,16 +671,16 @@ void NavEKF3_core::FuseOptFlow()
                 Kfusion[20] = -t78*(P[20][0]*t2*t5+P[20][5]*t2*t8-P[20][6]*t2*t10+P[20][1]*t2*t16-P[20][2]*t2*t19+P[20][3]*t2*t22+P[20][4]*t2*t27);
                 Kfusion[21] = -t78*(P[21][0]*t2*t5+P[21][5]*t2*t8-P[21][6]*t2*t10+P[21][1]*t2*t16-P[21][2]*t2*t19+P[21][3]*t2*t22+P[21][4]*t2*t27);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             if (!inhibitWindStates) {
                 Kfusion[22] = -t78*(P[22][0]*t2*t5+P[22][5]*t2*t8-P[22][6]*t2*t10+P[22][1]*t2*t16-P[22][2]*t2*t19+P[22][3]*t2*t22+P[22][4]*t2*t27);
                 Kfusion[23] = -t78*(P[23][0]*t2*t5+P[23][5]*t2*t8-P[23][6]*t2*t10+P[23][1]*t2*t16-P[23][2]*t2*t19+P[23][3]*t2*t22+P[23][4]*t2*t27);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
         }
 
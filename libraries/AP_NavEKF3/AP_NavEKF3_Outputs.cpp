@@ -100,7 +100,7 @@ bool NavEKF3_core::getRangeBeaconDebug(uint8_t &ID, float &rng, float &innov, fl
     beaconPosNED = rngBcnFusionReport[rngBcnFuseDataReportIndex].beaconPosNED;  // beacon receiver NED position (m)
     offsetHigh = bcnPosDownOffsetMax;                                           // beacon system vertical pos offset upper estimate (m)
     offsetLow = bcnPosDownOffsetMin;                                            // beacon system vertical pos offset lower estimate (m)
-    posNED = receiverPos;                                                       // beacon system NED offset (m)
+    posNED = Vector3f(receiverPos);                                             // beacon system NED offset (m)
     rngBcnFuseDataReportIndex++;
     return true;
 }
@@ -133,7 +133,7 @@ bool NavEKF3_core::getHeightControlLimit(float &height) const
 // return the Euler roll, pitch and yaw angle in radians
 void NavEKF3_core::getEulerAngles(Vector3f &euler) const
 {
-    outputDataNew.quat.to_euler(euler.x, euler.y, euler.z);
+    Quaternion(outputDataNew.quat).to_euler(euler.x, euler.y, euler.z);
     euler = euler - _ahrs->get_trim();
 }
 
@@ -144,7 +144,7 @@ void NavEKF3_core::getGyroBias(Vector3f &gyroBias) const
         gyroBias.zero();
         return;
     }
-    gyroBias = stateStruct.gyro_bias / dtEkfAvg;
+    gyroBias = Vector3f(stateStruct.gyro_bias / dtEkfAvg);
 }
 
 // return accelerometer bias in m/s/s
@@ -154,7 +154,7 @@ void NavEKF3_core::getAccelBias(Vector3f &accelBias) const
         accelBias.zero();
         return;
     }
-    accelBias = stateStruct.accel_bias / dtEkfAvg;
+    accelBias = Vector3f(stateStruct.accel_bias / dtEkfAvg);
 }
 
 // return tilt error convergence metric
@@ -166,14 +166,14 @@ void NavEKF3_core::getTiltError(float &ang) const
 // return the transformation matrix from XYZ (body) to NED axes
 void NavEKF3_core::getRotationBodyToNED(Matrix3f &mat) const
 {
-    outputDataNew.quat.rotation_matrix(mat);
+    Quaternion(outputDataNew.quat).rotation_matrix(mat);
     mat = mat * _ahrs->get_rotation_vehicle_body_to_autopilot_body();
 }
 
 // return the quaternions defining the rotation from NED to XYZ (body) axes
 void NavEKF3_core::getQuaternion(Quaternion& ret) const
 {
-    ret = outputDataNew.quat;
+    ret = Quaternion(outputDataNew.quat);
 }
 
 // return the amount of yaw angle change due to the last yaw angle reset in radians
@@ -222,7 +222,7 @@ void NavEKF3_core::getWind(Vector3f &wind) const
 void NavEKF3_core::getVelNED(Vector3f &vel) const
 {
     // correct for the IMU position offset (EKF calculations are at the IMU)
-    vel = outputDataNew.velocity + velOffsetNED;
+    vel = Vector3f(outputDataNew.velocity) + velOffsetNED;
 }
 
 // Return the rate of change of vertical position in the down direction (dPosD/dt) of the body frame origin in m/s
@@ -401,13 +401,13 @@ bool NavEKF3_core::getOriginLLH(struct Location &loc) const
 // return earth magnetic field estimates in measurement units / 1000
 void NavEKF3_core::getMagNED(Vector3f &magNED) const
 {
-    magNED = stateStruct.earth_magfield * 1000.0f;
+    magNED = Vector3f(stateStruct.earth_magfield * 1000.0f);
 }
 
 // return body magnetic field estimates in measurement units / 1000
 void NavEKF3_core::getMagXYZ(Vector3f &magXYZ) const
 {
-    magXYZ = stateStruct.body_magfield*1000.0f;
+    magXYZ = Vector3f(stateStruct.body_magfield*1000.0f);
 }
 
 // return magnetometer offsets
@@ -426,7 +426,7 @@ bool NavEKF3_core::getMagOffsets(uint8_t mag_idx, Vector3f &magOffsets) const
             !inhibitMagStates &&
             _ahrs->get_compass()->healthy(magSelectIndex) &&
             variancesConverged) {
-        magOffsets = _ahrs->get_compass()->get_offsets(magSelectIndex) - stateStruct.body_magfield*1000.0f;
+        magOffsets = _ahrs->get_compass()->get_offsets(magSelectIndex) - Vector3f(stateStruct.body_magfield*1000.0f);
         return true;
     } else {
         magOffsets = _ahrs->get_compass()->get_offsets(magSelectIndex);
@@ -259,10 +259,10 @@ void NavEKF3_core::CorrectGPSForAntennaOffset(gps_elements &gps_data)
         // TODO use a filtered angular rate with a group delay that matches the GPS delay
         Vector3f angRate = imuDataDelayed.delAng * (1.0f/imuDataDelayed.delAngDT);
         Vector3f velOffsetBody = angRate % posOffsetBody;
-        Vector3f velOffsetEarth = prevTnb.mul_transpose(velOffsetBody);
+        Vector3f velOffsetEarth = Vector3f(prevTnb.mul_transpose(Vector3F(velOffsetBody)));
         gps_data.vel -= velOffsetEarth;
     }
-    Vector3f posOffsetEarth = prevTnb.mul_transpose(posOffsetBody);
+    Vector3f posOffsetEarth = Vector3f(prevTnb.mul_transpose(Vector3F(posOffsetBody)));
     gps_data.pos.x -= posOffsetEarth.x;
     gps_data.pos.y -= posOffsetEarth.y;
     gps_data.hgt += posOffsetEarth.z;
@@ -630,37 +630,28 @@ void NavEKF3_core::FuseVelPosNED()
             fuseData[5] = true;
         }
 
+        // adjust scaling on GPS measurement noise variances if not enough satellites
+        for (obsIndex=0; obsIndex<=4; obsIndex++) {
+            R_OBS[obsIndex] *= sq(gpsNoiseScaler);
+        }
+
+        // try to fuse all accepted measurements with one covariance update
+        bool fusedBatch = false;
+        if (frontend->_velPosBatch) {
+            for (obsIndex=0; obsIndex<=5; obsIndex++) {
+                if (fuseData[obsIndex]) {
+                    innovVelPos[obsIndex] = calcVelPosInnovation(obsIndex, observation[obsIndex]);
+                }
+            }
+            fusedBatch = FuseVelPosBatch(fuseData, R_OBS);
+        }
+
         // fuse measurements sequentially
-        for (obsIndex=0; obsIndex<=5; obsIndex++) {
+        for (obsIndex=0; obsIndex<=5 && !fusedBatch; obsIndex++) {
             if (fuseData[obsIndex]) {
                 stateIndex = 4 + obsIndex;
                 // calculate the measurement innovation, using states from a different time coordinate if fusing height data
-                // adjust scaling on GPS measurement noise variances if not enough satellites
-                if (obsIndex <= 2)
-                {
-                    innovVelPos[obsIndex] = stateStruct.velocity[obsIndex] - observation[obsIndex];
-                    R_OBS[obsIndex] *= sq(gpsNoiseScaler);
-                }
-                else if (obsIndex == 3 || obsIndex == 4) {
-                    innovVelPos[obsIndex] = stateStruct.position[obsIndex-3] - observation[obsIndex];
-                    R_OBS[obsIndex] *= sq(gpsNoiseScaler);
-                } else if (obsIndex == 5) {
-                    innovVelPos[obsIndex] = stateStruct.position[obsIndex-3] - observation[obsIndex];
-                    const float gndMaxBaroErr = 4.0f;
-                    const float gndBaroInnovFloor = -0.5f;
-
-                    if(getTouchdownExpected() && activeHgtSource == HGT_SOURCE_BARO) {
-                        // when a touchdown is expected, floor the barometer innovation at gndBaroInnovFloor
-                        // constrain the correction between 0 and gndBaroInnovFloor+gndMaxBaroErr
-                        // this function looks like this:
-                        //         |/
-                        //---------|---------
-                        //    ____/|
-                        //   /     |
-                        //  /      |
-                        innovVelPos[5] += constrain_float(-innovVelPos[5]+gndBaroInnovFloor, 0.0f, gndBaroInnovFloor+gndMaxBaroErr);
-                    }
-                }
+                innovVelPos[obsIndex] = calcVelPosInnovation(obsIndex, observation[obsIndex]);
 
                 // calculate the Kalman gain and calculate innovation variances
                 varInnovVelPos[obsIndex] = P[stateIndex][stateIndex] + R_OBS[obsIndex];
@@ -675,8 +666,8 @@ void NavEKF3_core::FuseVelPosNED()
                         Kfusion[i] = P[i][stateIndex]*SK;
                     }
                 } else {
-                    // zero indexes 10 to 12 = 3*4 bytes
-                    memset(&Kfusion[10], 0, 12);
+                    // zero indexes 10 to 12
+                    memset(&Kfusion[10], 0, 3*sizeof(ftype));
                 }
 
                 // inhibit delta velocity bias state estimation by setting Kalman gains to zero
@@ -685,8 +676,8 @@ void NavEKF3_core::FuseVelPosNED()
                         Kfusion[i] = P[i][stateIndex]*SK;
                     }
                 } else {
-                    // zero indexes 13 to 15 = 3*4 bytes
-                    memset(&Kfusion[13], 0, 12);
+                    // zero indexes 13 to 15
+                    memset(&Kfusion[13], 0, 3*sizeof(ftype));
                 }
 
                 // inhibit magnetic field state estimation by setting Kalman gains to zero
@@ -695,8 +686,8 @@ void NavEKF3_core::FuseVelPosNED()
                         Kfusion[i] = P[i][stateIndex]*SK;
                     }
                 } else {
-                    // zero indexes 16 to 21 = 6*4 bytes
-                    memset(&Kfusion[16], 0, 24);
+                    // zero indexes 16 to 21
+                    memset(&Kfusion[16], 0, 6*sizeof(ftype));
                 }
 
                 // inhibit wind state estimation by setting Kalman gains to zero
@@ -704,8 +695,8 @@ void NavEKF3_core::FuseVelPosNED()
                     Kfusion[22] = P[22][stateIndex]*SK;
                     Kfusion[23] = P[23][stateIndex]*SK;
                 } else {
-                    // zero indexes 22 to 23 = 2*4 bytes
-                    memset(&Kfusion[22], 0, 8);
+                    // zero indexes 22 to 23
+                    memset(&Kfusion[22], 0, 2*sizeof(ftype));
                 }
 
                 // update the covariance - take advantage of direct observation of a single state at index = stateIndex to reduce computations
@@ -779,6 +770,179 @@ void NavEKF3_core::FuseVelPosNED()
     hal.util->perf_end(_perf_FuseVelPosNED);
 }
 
+// calculate the innovation for one of the measurements fused by FuseVelPosNED()
+NavEKF3_core::ftype NavEKF3_core::calcVelPosInnovation(uint8_t obsIndex, ftype observation)
+{
+    if (obsIndex <= 2) {
+        return stateStruct.velocity[obsIndex] - observation;
+    }
+    ftype innovation = stateStruct.position[obsIndex-3] - observation;
+    if (obsIndex == 5) {
+        const float gndMaxBaroErr = 4.0f;
+        const float gndBaroInnovFloor = -0.5f;
+
+        if(getTouchdownExpected() && activeHgtSource == HGT_SOURCE_BARO) {
+            // when a touchdown is expected, floor the barometer innovation at gndBaroInnovFloor
+            // constrain the correction between 0 and gndBaroInnovFloor+gndMaxBaroErr
+            // this function looks like this:
+            //         |/
+            //---------|---------
+            //    ____/|
+            //   /     |
+            //  /      |
+            innovation += constrain_float(-innovation+gndBaroInnovFloor, 0.0f, gndBaroInnovFloor+gndMaxBaroErr);
+        }
+    }
+    return innovation;
+}
+
+/*
+  Fuse the accepted velocity, position and height measurements with a
+  single covariance update.
+
+  Each measurement directly observes one of states 4 to 9 and the
+  measurement errors are assumed to be uncorrelated, so this gives the
+  same result as fusing them sequentially, apart from rounding. The
+  covariance columns of the observed states are read once, the gains
+  come from a Cholesky factorisation of the innovation covariance for
+  the observed states and the covariance is then updated in one pass
+  over its upper triangle. The innovations must have been calculated
+  from the current states before calling.
+
+  Returns false without modifying the states or covariance if the
+  innovation covariance is not positive definite or the update would
+  make a variance negative. The caller then falls back to sequential
+  fusion so the faulty measurement can be identified.
+ */
+bool NavEKF3_core::FuseVelPosBatch(const bool fuseData[6], const Vector6 &R_OBS)
+{
+    uint8_t obsIndexes[6];
+    uint8_t numObs = 0;
+    for (uint8_t obsIndex=0; obsIndex<=5; obsIndex++) {
+        if (fuseData[obsIndex]) {
+            obsIndexes[numObs++] = obsIndex;
+        }
+    }
+    if (numObs == 0) {
+        return true;
+    }
+
+    // copy the covariance columns of the observed states, P*H'
+    ftype PHT[24][6];
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        for (uint8_t k=0; k<numObs; k++) {
+            PHT[i][k] = P[i][4+obsIndexes[k]];
+        }
+    }
+
+    // Cholesky factorisation of the innovation covariance H*P*H' + R
+    ftype L[6][6];
+    for (uint8_t k=0; k<numObs; k++) {
+        for (uint8_t m=0; m<=k; m++) {
+            ftype sum = PHT[4+obsIndexes[k]][m];
+            for (uint8_t n=0; n<m; n++) {
+                sum -= L[k][n] * L[m][n];
+            }
+            if (k == m) {
+                sum += R_OBS[obsIndexes[k]];
+                if (sum <= 0.0f) {
+                    return false;
+                }
+                L[k][k] = sqrt(sum);
+            } else {
+                L[k][m] = sum / L[m][m];
+            }
+        }
+    }
+
+    // solve for the Kalman gains, leaving them zero for inhibited states
+    const uint8_t activeStates = activeStateGroups();
+    ftype K[24][6];
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        const uint8_t group = NavEKF3_CovPrediction::stateGroup(i);
+        if (group != 0 && (activeStates & group) == 0) {
+            memset(K[i], 0, sizeof(K[i]));
+            continue;
+        }
+        // forward substitution with L then back substitution with L'
+        for (uint8_t k=0; k<numObs; k++) {
+            ftype sum = PHT[i][k];
+            for (uint8_t n=0; n<k; n++) {
+                sum -= L[k][n] * K[i][n];
+            }
+            K[i][k] = sum / L[k][k];
+        }
+        for (int8_t k=numObs-1; k>=0; k--) {
+            ftype sum = K[i][k];
+            for (uint8_t n=k+1; n<numObs; n++) {
+                sum -= L[n][k] * K[i][n];
+            }
+            K[i][k] = sum / L[k][k];
+        }
+    }
+
+    // check that we are not going to drive any variances negative
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        ftype varReduction = 0.0f;
+        for (uint8_t k=0; k<numObs; k++) {
+            varReduction += K[i][k] * PHT[i][k];
+        }
+        if (varReduction > P[i][i]) {
+            return false;
+        }
+    }
+
+    // update the upper triangle of the covariance, P = P - K*H*P, and mirror
+    // it to the lower triangle so no symmetry correction is needed
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        for (uint8_t j=i; j<=stateIndexLim; j++) {
+            ftype covReduction = 0.0f;
+            for (uint8_t k=0; k<numObs; k++) {
+                covReduction += K[i][k] * PHT[j][k];
+            }
+            P[i][j] -= covReduction;
+            P[j][i] = P[i][j];
+        }
+    }
+    ConstrainVariances();
+
+    // update states and renormalise the quaternions
+    for (uint8_t i=0; i<=stateIndexLim; i++) {
+        ftype correction = 0.0f;
+        for (uint8_t k=0; k<numObs; k++) {
+            correction += K[i][k] * innovVelPos[obsIndexes[k]];
+        }
+        statesArray[i] -= correction;
+    }
+    stateStruct.quat.normalize();
+
+    // record the innovation variances and good fusion status
+    for (uint8_t k=0; k<numObs; k++) {
+        const uint8_t obsIndex = obsIndexes[k];
+        varInnovVelPos[obsIndex] = PHT[4+obsIndex][k] + R_OBS[obsIndex];
+    }
+    if (fuseData[0]) {
+        faultStatus.bad_nvel = false;
+    }
+    if (fuseData[1]) {
+        faultStatus.bad_evel = false;
+    }
+    if (fuseData[2]) {
+        faultStatus.bad_dvel = false;
+    }
+    if (fuseData[3]) {
+        faultStatus.bad_npos = false;
+    }
+    if (fuseData[4]) {
+        faultStatus.bad_epos = false;
+    }
+    if (fuseData[5]) {
+        faultStatus.bad_dpos = false;
+    }
+
+    return true;
+}
+
 /********************************************************
 *                   MISC FUNCTIONS                      *
 ********************************************************/
@@ -800,7 +964,7 @@ void NavEKF3_core::selectHeightForFusion()
         if (sensor != nullptr) {
             Vector3f posOffsetBody = sensor->get_pos_offset() - accelPosOffset;
             if (!posOffsetBody.is_zero()) {
-                Vector3f posOffsetEarth = prevTnb.mul_transpose(posOffsetBody);
+                Vector3F posOffsetEarth = prevTnb.mul_transpose(Vector3F(posOffsetBody));
                 rangeDataDelayed.rng += posOffsetEarth.z / prevTnb.c.z;
             }
         }
@@ -963,7 +1127,7 @@ void NavEKF3_core::selectHeightForFusion()
 void NavEKF3_core::FuseBodyVel()
 {
     Vector24 H_VEL;
-    Vector3f bodyVelPred;
+    Vector3F bodyVelPred;
 
     // Copy required states to local variable names
     float q0  = stateStruct.quat[0];
@@ -986,7 +1150,7 @@ void NavEKF3_core::FuseBodyVel()
         // correct prediction for relative motion due to rotation
         // note - % operator overloaded for cross product
         if (imuDataDelayed.delAngDT > 0.001f) {
-            bodyVelPred += (imuDataDelayed.delAng * (1.0f / imuDataDelayed.delAngDT)) % posOffsetBody;
+            bodyVelPred += Vector3F((imuDataDelayed.delAng * (1.0f / imuDataDelayed.delAngDT)) % posOffsetBody);
         }
 
         // calculate observation jacobians and Kalman gains
@@ -1130,8 +1294,8 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[11] = t77*(P[11][5]*t4+P[11][4]*t9+P[11][0]*t14-P[11][6]*t11+P[11][1]*t18-P[11][2]*t21+P[11][3]*t24);
                 Kfusion[12] = t77*(P[12][5]*t4+P[12][4]*t9+P[12][0]*t14-P[12][6]*t11+P[12][1]*t18-P[12][2]*t21+P[12][3]*t24);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitDelVelBiasStates) {
@@ -1139,8 +1303,8 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[14] = t77*(P[14][5]*t4+P[14][4]*t9+P[14][0]*t14-P[14][6]*t11+P[14][1]*t18-P[14][2]*t21+P[14][3]*t24);
                 Kfusion[15] = t77*(P[15][5]*t4+P[15][4]*t9+P[15][0]*t14-P[15][6]*t11+P[15][1]*t18-P[15][2]*t21+P[15][3]*t24);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitMagStates) {
@@ -1151,16 +1315,16 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[20] = t77*(P[20][5]*t4+P[20][4]*t9+P[20][0]*t14-P[20][6]*t11+P[20][1]*t18-P[20][2]*t21+P[20][3]*t24);
                 Kfusion[21] = t77*(P[21][5]*t4+P[21][4]*t9+P[21][0]*t14-P[21][6]*t11+P[21][1]*t18-P[21][2]*t21+P[21][3]*t24);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             if (!inhibitWindStates) {
                 Kfusion[22] = t77*(P[22][5]*t4+P[22][4]*t9+P[22][0]*t14-P[22][6]*t11+P[22][1]*t18-P[22][2]*t21+P[22][3]*t24);
                 Kfusion[23] = t77*(P[23][5]*t4+P[23][4]*t9+P[23][0]*t14-P[23][6]*t11+P[23][1]*t18-P[23][2]*t21+P[23][3]*t24);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
         } else if (obsIndex == 1) {
             // calculate Y axis observation Jacobian
@@ -1302,8 +1466,8 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[11] = t77*(-P[11][4]*t3+P[11][5]*t8+P[11][0]*t15+P[11][6]*t12+P[11][1]*t18+P[11][2]*t22-P[11][3]*t25);
                 Kfusion[12] = t77*(-P[12][4]*t3+P[12][5]*t8+P[12][0]*t15+P[12][6]*t12+P[12][1]*t18+P[12][2]*t22-P[12][3]*t25);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitDelVelBiasStates) {
@@ -1311,8 +1475,8 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[14] = t77*(-P[14][4]*t3+P[14][5]*t8+P[14][0]*t15+P[14][6]*t12+P[14][1]*t18+P[14][2]*t22-P[14][3]*t25);
                 Kfusion[15] = t77*(-P[15][4]*t3+P[15][5]*t8+P[15][0]*t15+P[15][6]*t12+P[15][1]*t18+P[15][2]*t22-P[15][3]*t25);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitMagStates) {
@@ -1323,16 +1487,16 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[20] = t77*(-P[20][4]*t3+P[20][5]*t8+P[20][0]*t15+P[20][6]*t12+P[20][1]*t18+P[20][2]*t22-P[20][3]*t25);
                 Kfusion[21] = t77*(-P[21][4]*t3+P[21][5]*t8+P[21][0]*t15+P[21][6]*t12+P[21][1]*t18+P[21][2]*t22-P[21][3]*t25);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             if (!inhibitWindStates) {
                 Kfusion[22] = t77*(-P[22][4]*t3+P[22][5]*t8+P[22][0]*t15+P[22][6]*t12+P[22][1]*t18+P[22][2]*t22-P[22][3]*t25);
                 Kfusion[23] = t77*(-P[23][4]*t3+P[23][5]*t8+P[23][0]*t15+P[23][6]*t12+P[23][1]*t18+P[23][2]*t22-P[23][3]*t25);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
         } else if (obsIndex == 2) {
             // calculate Z axis observation Jacobian
@@ -1474,8 +1638,8 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[11] = t77*(P[11][4]*t4+P[11][0]*t14+P[11][6]*t9-P[11][5]*t11-P[11][1]*t17+P[11][2]*t20+P[11][3]*t24);
                 Kfusion[12] = t77*(P[12][4]*t4+P[12][0]*t14+P[12][6]*t9-P[12][5]*t11-P[12][1]*t17+P[12][2]*t20+P[12][3]*t24);
             } else {
-                // zero indexes 10 to 12 = 3*4 bytes
-                memset(&Kfusion[10], 0, 12);
+                // zero indexes 10 to 12
+                memset(&Kfusion[10], 0, 3*sizeof(ftype));
 
             }
 
@@ -1484,8 +1648,8 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[14] = t77*(P[14][4]*t4+P[14][0]*t14+P[14][6]*t9-P[14][5]*t11-P[14][1]*t17+P[14][2]*t20+P[14][3]*t24);
                 Kfusion[15] = t77*(P[15][4]*t4+P[15][0]*t14+P[15][6]*t9-P[15][5]*t11-P[15][1]*t17+P[15][2]*t20+P[15][3]*t24);
             } else {
-                // zero indexes 13 to 15 = 3*4 bytes
-                memset(&Kfusion[13], 0, 12);
+                // zero indexes 13 to 15
+                memset(&Kfusion[13], 0, 3*sizeof(ftype));
             }
 
             if (!inhibitMagStates) {
@@ -1496,16 +1660,16 @@ void NavEKF3_core::FuseBodyVel()
                 Kfusion[20] = t77*(P[20][4]*t4+P[20][0]*t14+P[20][6]*t9-P[20][5]*t11-P[20][1]*t17+P[20][2]*t20+P[20][3]*t24);
                 Kfusion[21] = t77*(P[21][4]*t4+P[21][0]*t14+P[21][6]*t9-P[21][5]*t11-P[21][1]*t17+P[21][2]*t20+P[21][3]*t24);
             } else {
-                // zero indexes 16 to 21 = 6*4 bytes
-                memset(&Kfusion[16], 0, 24);
+                // zero indexes 16 to 21
+                memset(&Kfusion[16], 0, 6*sizeof(ftype));
             }
 
             if (!inhibitWindStates) {
                 Kfusion[22] = t77*(P[22][4]*t4+P[22][0]*t14+P[22][6]*t9-P[22][5]*t11-P[22][1]*t17+P[22][2]*t20+P[22][3]*t24);
                 Kfusion[23] = t77*(P[23][4]*t4+P[23][0]*t14+P[23][6]*t9-P[23][5]*t11-P[23][1]*t17+P[23][2]*t20+P[23][3]*t24);
             } else {
-                // zero indexes 22 to 23 = 2*4 bytes
-                memset(&Kfusion[22], 0, 8);
+                // zero indexes 22 to 23
+                memset(&Kfusion[22], 0, 2*sizeof(ftype));
             }
         } else {
             return;
@@ -1639,7 +1803,7 @@ void NavEKF3_core::SelectBodyOdomFusion()
             // This is a hack to enable use of the existing body frame velocity fusion method
             // TODO write a dedicated observation model for wheel encoders
             usingWheelSensors = true;
-            bodyOdmDataDelayed.vel = prevTnb * velNED;
+            bodyOdmDataDelayed.vel = Vector3f(prevTnb * Vector3F(velNED));
             bodyOdmDataDelayed.body_offset = wheelOdmDataDelayed.hub_offset;
             bodyOdmDataDelayed.velErr = frontend->_wencOdmVelErr;
 
@@ -77,7 +77,7 @@ void NavEKF3_core::FuseRngBcn()
     bcn_pd = rngBcnDataDelayed.beacon_posNED.z + bcnPosOffsetNED.z;
 
     // predicted range
-    Vector3f deltaPosNED = stateStruct.position - rngBcnDataDelayed.beacon_posNED;
+    Vector3F deltaPosNED = stateStruct.position - Vector3F(rngBcnDataDelayed.beacon_posNED);
     rngPred = deltaPosNED.length();
 
     // calculate measurement innovation
@@ -151,8 +151,8 @@ void NavEKF3_core::FuseRngBcn()
             Kfusion[11] = -t26*(P[11][7]*t4*t9+P[11][8]*t3*t9+P[11][9]*t2*t9);
             Kfusion[12] = -t26*(P[12][7]*t4*t9+P[12][8]*t3*t9+P[12][9]*t2*t9);
         } else {
-            // zero indexes 10 to 12 = 3*4 bytes
-            memset(&Kfusion[10], 0, 12);
+            // zero indexes 10 to 12
+            memset(&Kfusion[10], 0, 3*sizeof(ftype));
         }
 
         if (!inhibitDelVelBiasStates) {
@@ -160,8 +160,8 @@ void NavEKF3_core::FuseRngBcn()
             Kfusion[14] = -t26*(P[14][7]*t4*t9+P[14][8]*t3*t9+P[14][9]*t2*t9);
             Kfusion[15] = -t26*(P[15][7]*t4*t9+P[15][8]*t3*t9+P[15][9]*t2*t9);
         } else {
-            // zero indexes 13 to 15 = 3*4 bytes
-            memset(&Kfusion[13], 0, 12);
+            // zero indexes 13 to 15
+            memset(&Kfusion[13], 0, 3*sizeof(ftype));
         }
 
         // only allow the range observations to modify the vertical states if we are using it as a height reference
@@ -181,20 +181,20 @@ void NavEKF3_core::FuseRngBcn()
             Kfusion[20] = -t26*(P[20][7]*t4*t9+P[20][8]*t3*t9+P[20][9]*t2*t9);
             Kfusion[21] = -t26*(P[21][7]*t4*t9+P[21][8]*t3*t9+P[21][9]*t2*t9);
         } else {
-            // zero indexes 16 to 21 = 6*4 bytes
-            memset(&Kfusion[16], 0, 24);
+            // zero indexes 16 to 21
+            memset(&Kfusion[16], 0, 6*sizeof(ftype));
         }
 
         if (!inhibitWindStates) {
             Kfusion[22] = -t26*(P[22][7]*t4*t9+P[22][8]*t3*t9+P[22][9]*t2*t9);
             Kfusion[23] = -t26*(P[23][7]*t4*t9+P[23][8]*t3*t9+P[23][9]*t2*t9);
         } else {
-            // zero indexes 22 to 23 = 2*4 bytes
-            memset(&Kfusion[22], 0, 8);
+            // zero indexes 22 to 23
+            memset(&Kfusion[22], 0, 2*sizeof(ftype));
         }
 
         // Calculate innovation using the selected offset value
-        Vector3f delta = stateStruct.position - rngBcnDataDelayed.beacon_posNED;
+        Vector3F delta = stateStruct.position - Vector3F(rngBcnDataDelayed.beacon_posNED);
         innovRngBcn = delta.length() - rngBcnDataDelayed.rng;
 
         // calculate the innovation consistency test ratio
@@ -336,7 +336,7 @@ void NavEKF3_core::FuseRngBcnStatic()
                 // position offset to be applied to the beacon system that minimises the range innovations
                 // The position estimate should be stable after 100 iterations so we use a simple dual
                 // hypothesis 1-state EKF to estimate the offset
-                Vector3f refPosNED;
+                Vector3F refPosNED;
                 refPosNED.x = receiverPos.x;
                 refPosNED.y = receiverPos.y;
                 refPosNED.z = stateStruct.position.z;
@@ -435,7 +435,7 @@ void NavEKF3_core::FuseRngBcnStatic()
         K_RNG[2] = -t35*(t27+receiverPosCov[2][0]*t9*t11*0.5f+receiverPosCov[2][1]*t9*t13*0.5f);
 
         // calculate range measurement innovation
-        Vector3f deltaPosNED = receiverPos - rngBcnDataDelayed.beacon_posNED;
+        Vector3F deltaPosNED = receiverPos - Vector3F(rngBcnDataDelayed.beacon_posNED);
         deltaPosNED.z -= bcnPosOffsetNED.z;
         innovRngBcn = deltaPosNED.length() - rngBcnDataDelayed.rng;
 
@@ -515,7 +515,7 @@ void NavEKF3_core::FuseRngBcnStatic()
 Run a single state Kalman filter to estimate the vertical position offset of the range beacon constellation
 Calculate using a high and low hypothesis and select the hypothesis with the lowest innovation sequence
 */
-void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehiclePosNED, bool aligning)
+void NavEKF3_core::CalcRangeBeaconPosDownOffset(float obsVar, Vector3F &vehiclePosNED, bool aligning)
 {
     // Handle height offsets between the primary height source and the range beacons by estimating
     // the beacon systems global vertical position offset using a single state Kalman filter
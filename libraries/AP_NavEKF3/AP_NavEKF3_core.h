@@ -29,6 +29,7 @@
 #include <AP_Math/vectorN.h>
 #include <AP_NavEKF/AP_NavEKF_core_common.h>
 #include <AP_NavEKF3/AP_NavEKF3_Buffer.h>
+#include <AP_NavEKF3/AP_NavEKF3_CovPrediction.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 
 // GPS pre-flight check bit locations
@@ -64,7 +65,7 @@
 
 class AP_AHRS;
 
-class NavEKF3_core : public NavEKF_core_common
+class NavEKF3_core : public NavEKF3_core_common
 {
 public:
     // Constructor
@@ -81,6 +82,22 @@ public:
     // The predict flag is set true when a new prediction cycle can be started
     void UpdateFilter(bool predict);
 
+#if HAL_NAVEKF_CORE_THREADS
+    // start a dedicated thread for stepping this core, optionally
+    // pinned to a CPU (cpu < 0 means not pinned)
+    bool thread_start(int8_t cpu);
+
+    // run UpdateFilter() on the core thread. Every call to
+    // thread_update_start() must be followed by thread_update_wait()
+    // before any other method is called on this core
+    void thread_update_start(bool predict);
+    void thread_update_wait(void);
+#endif
+
+    // get the number of UpdateFilter() steps and their average and
+    // maximum duration in microseconds since the last call
+    void getUpdateTiming(uint32_t &count, uint32_t &avg_us, uint32_t &max_us);
+
     // Check basic filter health metrics and return a consolidated health status
     bool healthy(void) const;
 
@@ -377,8 +394,10 @@ private:
     uint8_t imu_buffer_length;
     uint8_t obs_buffer_length;
 
-    typedef float ftype;
+    // ftype is the precision of the states, covariance and fusion
+    // arithmetic, see HAL_WITH_EKF3_DOUBLE
 #if MATH_CHECK_INDEXES
+    typedef VectorN<ftype,24> StateVector;
     typedef VectorN<ftype,2> Vector2;
     typedef VectorN<ftype,3> Vector3;
     typedef VectorN<ftype,4> Vector4;
@@ -403,6 +422,7 @@ private:
     typedef VectorN<VectorN<ftype,34>,50> Matrix34_50;
     typedef VectorN<uint32_t,50> Vector_u32_50;
 #else
+    typedef ftype StateVector[24];
     typedef ftype Vector2[2];
     typedef ftype Vector3[3];
     typedef ftype Vector4[4];
@@ -429,29 +449,29 @@ private:
 
     const AP_AHRS *_ahrs;
 
-    // the states are available in two forms, either as a Vector24, or
+    // the states are available in two forms, either as a StateVector, or
     // broken down as individual elements. Both are equivalent (same
     // memory)
     struct state_elements {
-        Quaternion  quat;           // quaternion defining rotation from local NED earth frame to body frame
-        Vector3f    velocity;       // velocity of IMU in local NED earth frame (m/sec)
-        Vector3f    position;       // position of IMU in local NED earth frame (m)
-        Vector3f    gyro_bias;      // body frame delta angle IMU bias vector (rad)
-        Vector3f    accel_bias;     // body frame delta velocity IMU bias vector (m/sec)
-        Vector3f    earth_magfield; // earth frame magnetic field vector (Gauss)
-        Vector3f    body_magfield;  // body frame magnetic field vector (Gauss)
-        Vector2f    wind_vel;       // horizontal North East wind velocity vector in local NED earth frame (m/sec)
+        QuaternionF quat;           // quaternion defining rotation from local NED earth frame to body frame
+        Vector3F    velocity;       // velocity of IMU in local NED earth frame (m/sec)
+        Vector3F    position;       // position of IMU in local NED earth frame (m)
+        Vector3F    gyro_bias;      // body frame delta angle IMU bias vector (rad)
+        Vector3F    accel_bias;     // body frame delta velocity IMU bias vector (m/sec)
+        Vector3F    earth_magfield; // earth frame magnetic field vector (Gauss)
+        Vector3F    body_magfield;  // body frame magnetic field vector (Gauss)
+        Vector2F    wind_vel;       // horizontal North East wind velocity vector in local NED earth frame (m/sec)
     };
 
     union {
-        Vector24 statesArray;
+        StateVector statesArray;
         struct state_elements stateStruct;
     };
 
     struct output_elements {
-        Quaternion  quat;           // quaternion defining rotation from local NED earth frame to body frame
-        Vector3f    velocity;       // velocity of body frame origin in local NED earth frame (m/sec)
-        Vector3f    position;       // position of body frame origin in local NED earth frame (m)
+        QuaternionF quat;           // quaternion defining rotation from local NED earth frame to body frame
+        Vector3F    velocity;       // velocity of body frame origin in local NED earth frame (m/sec)
+        Vector3F    position;       // position of body frame origin in local NED earth frame (m)
     };
 
     struct imu_elements {
@@ -535,8 +555,8 @@ private:
     // bias estimates for the IMUs that are enabled but not being used
     // by this core.
     struct {
-        Vector3f gyro_bias;
-        Vector3f accel_bias;
+        Vector3F gyro_bias;
+        Vector3F accel_bias;
     } inactiveBias[INS_MAX_INSTANCES];
 
     // update the navigation filter status
@@ -563,6 +583,13 @@ private:
     // fuse selected position, velocity and height measurements
     void FuseVelPosNED();
 
+    // calculate the innovation for one of the measurements fused by FuseVelPosNED()
+    ftype calcVelPosInnovation(uint8_t obsIndex, ftype observation);
+
+    // fuse the selected position, velocity and height measurements in a single
+    // covariance update. Returns false if the update was not applied
+    bool FuseVelPosBatch(const bool fuseData[6], const Vector6 &R_OBS);
+
     // fuse body frame velocity measurements
     void FuseBodyVel();
 
@@ -573,7 +600,7 @@ private:
     void FuseRngBcnStatic();
 
     // calculate the offset from EKF vertical position datum to the range beacon system datum
-    void CalcRangeBeaconPosDownOffset(float obsVar, Vector3f &vehiclePosNED, bool aligning);
+    void CalcRangeBeaconPosDownOffset(float obsVar, Vector3F &vehiclePosNED, bool aligning);
 
     // fuse magnetometer measurements
     void FuseMagnetometer();
@@ -597,7 +624,7 @@ private:
     void StoreQuatReset(void);
 
     // Rotate the stored output quaternion history through a quaternion rotation
-    void StoreQuatRotate(const Quaternion &deltaQuat);
+    void StoreQuatRotate(const QuaternionF &deltaQuat);
 
     // store altimeter data
     void StoreBaro();
@@ -696,7 +723,7 @@ private:
     void alignYawAngle();
 
     // and return attitude quaternion
-    Quaternion calcQuatAndFieldStates(float roll, float pitch);
+    QuaternionF calcQuatAndFieldStates(ftype roll, ftype pitch);
 
     // zero stored variables
     void InitialiseVariables();
@@ -844,6 +871,10 @@ private:
     // Update the state index limit based on which states are active
     void updateStateIndexLim(void);
 
+    // return a NavEKF3_CovPrediction mask of the state groups which are
+    // neither inhibited nor above the state index limit
+    uint8_t activeStateGroups(void) const;
+
     // correct GPS data for antenna position
     void CorrectGPSForAntennaOffset(gps_elements &gps_data);
 
@@ -871,7 +902,7 @@ private:
     obs_ring_buffer_t<tas_elements> storedTAS;      // TAS data buffer
     obs_ring_buffer_t<range_elements> storedRange;  // Range finder data buffer
     imu_ring_buffer_t<output_elements> storedOutput;// output state buffer
-    Matrix3f prevTnb;               // previous nav to body transformation used for INS earth rotation compensation
+    Matrix3F prevTnb;               // previous nav to body transformation used for INS earth rotation compensation
     ftype accNavMag;                // magnitude of navigation accel - used to adjust GPS obs variance (m/s^2)
     ftype accNavMagHoriz;           // magnitude of navigation accel in horizontal plane (m/s^2)
     Vector3f earthRateNED;          // earths angular rate vector in NED (rad/s)
@@ -916,7 +947,7 @@ private:
     bool allMagSensorsFailed;       // true if all magnetometer sensors have timed out on this flight and we are no longer using magnetometer data
     uint32_t lastSynthYawTime_ms;   // time stamp when synthetic yaw measurement was last fused to maintain covariance health (msec)
     uint32_t ekfStartTime_ms;       // time the EKF was started (msec)
-    Vector2f lastKnownPositionNE;   // last known position
+    Vector2F lastKnownPositionNE;   // last known position
     uint32_t lastDecayTime_ms;      // time of last decay of GPS position offset
     float velTestRatio;             // sum of squares of GPS velocity innovation divided by fail threshold
     float posTestRatio;             // sum of squares of GPS position innovation divided by fail threshold
@@ -968,8 +999,8 @@ private:
     output_elements outputDataNew;  // output state data at the current time step
     output_elements outputDataDelayed; // output state data at the current time step
     Vector3f delAngCorrection;      // correction applied to delta angles used by output observer to track the EKF
-    Vector3f velErrintegral;        // integral of output predictor NED velocity tracking error (m)
-    Vector3f posErrintegral;        // integral of output predictor NED position tracking error (m.sec)
+    Vector3F velErrintegral;        // integral of output predictor NED velocity tracking error (m)
+    Vector3F posErrintegral;        // integral of output predictor NED position tracking error (m.sec)
     float innovYaw;                 // compass yaw angle innovation (rad)
     uint32_t timeTasReceived_ms;    // time last TAS data was received (msec)
     bool gpsGoodToAlign;            // true when the GPS quality can be used to initialise the navigation system
@@ -990,7 +1021,7 @@ private:
     float posResetD;                // Change in Down position due to last in-flight reset in metres. Returned by getLastPosDowntReset
     uint32_t lastPosResetD_ms;      // System time at which the last position reset occurred. Returned by getLastPosDownReset
     float yawTestRatio;             // square of magnetometer yaw angle innovation divided by fail threshold
-    Quaternion prevQuatMagReset;    // Quaternion from the last time the magnetic field state reset condition test was performed
+    QuaternionF prevQuatMagReset;    // Quaternion from the last time the magnetic field state reset condition test was performed
     uint8_t fusionHorizonOffset;    // number of IMU samples that the fusion time horizon  has been shifted to prevent multiple EKF instances fusing data at the same time
     float hgtInnovFiltState;        // state used for fitering of the height innovations used for pre-flight checks
     uint8_t magSelectIndex;         // Index of the magnetometer that is being used by the EKF
@@ -1070,7 +1101,7 @@ private:
     uint32_t rngValidMeaTime_ms;    // time stamp from latest valid range measurement (msec)
     uint32_t flowMeaTime_ms;        // time stamp from latest flow measurement (msec)
     uint32_t gndHgtValidTime_ms;    // time stamp from last terrain offset state update (msec)
-    Matrix3f Tbn_flow;              // transformation matrix from body to nav axes at the middle of the optical flow sample period
+    Matrix3F Tbn_flow;              // transformation matrix from body to nav axes at the middle of the optical flow sample period
     Vector2 varInnovOptFlow;        // optical flow innovations variances (rad/sec)^2
     Vector2 innovOptFlow;           // optical flow LOS innovations (rad/sec)
     float Popt;                     // Optical flow terrain height state covariance (m^2)
@@ -1160,7 +1191,7 @@ private:
     uint32_t rngBcnLast3DmeasTime_ms;   // last time the beacon system returned a 3D fix (msec)
     bool rngBcnGoodToAlign;             // true when the range beacon systems 3D fix can be used to align the filter
     uint8_t lastRngBcnChecked;          // index of the last range beacon checked for data
-    Vector3f receiverPos;               // receiver NED position (m) - alignment 3 state filter
+    Vector3F receiverPos;               // receiver NED position (m) - alignment 3 state filter
     float receiverPosCov[3][3];         // Receiver position covariance (m^2) - alignment 3 state filter (
     bool rngBcnAlignmentStarted;        // True when the initial position alignment using range measurements has started
     bool rngBcnAlignmentCompleted;      // True when the initial position alignment using range measurements has finished
@@ -1217,7 +1248,7 @@ private:
     bool gpsYawResetRequest;        // true if the vehicle yaw needs to be reset to the GPS course
     float posDownAtLastMagReset;    // vertical position last time the mag states were reset (m)
     float yawInnovAtLastMagReset;   // magnetic yaw innovation last time the yaw and mag field states were reset (rad)
-    Quaternion quatAtLastMagReset;  // quaternion states last time the mag states were reset
+    QuaternionF quatAtLastMagReset;  // quaternion states last time the mag states were reset
 
     // flags indicating severe numerical errors in innovation variance calculation for different fusion operations
     struct {
@@ -1300,6 +1331,23 @@ private:
 
     // timing statistics
     struct ekf_timing timing;
+
+    // time spent in UpdateFilter()
+    struct {
+        uint32_t count;
+        uint64_t total_us;
+        uint32_t max_us;
+    } update_timing;
+
+#if HAL_NAVEKF_CORE_THREADS
+    // main loop for a core running on its own thread
+    void thread_main(void);
+
+    HAL_BinarySemaphore thread_start_sem;
+    HAL_BinarySemaphore thread_done_sem;
+    bool thread_predict;
+    int8_t thread_cpu;
+#endif
     
     // should we assume zero sideslip?
     bool assume_zero_sideslip(void) const;
@@ -0,0 +1,99 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF3/AP_NavEKF3_CovPrediction.h>
+
+/*
+  compare the covariance prediction when blocks are selected only by
+  the state index limit against selecting them by the active state
+  groups. The benchmark argument is the mask of active state groups
+ */
+
+typedef NavEKF3_CovPrediction CovPrediction;
+
+static const uint8_t group_first[] = { 10, 13, 16, 22 };
+static const uint8_t group_last[] = { 12, 15, 21, 23 };
+
+static CovPrediction::Matrix24 P;
+static CovPrediction::Matrix24 nextP;
+
+// setup a symmetric covariance with inactive rows and columns zeroed
+static void setup_covariance(uint8_t activeStates)
+{
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t j=0; j<=i; j++) {
+            P[i][j] = P[j][i] = (i == j) ? 0.1f : 0.001f * (i + j);
+        }
+    }
+    for (uint8_t g=0; g<4; g++) {
+        if (activeStates & (1U<<g)) {
+            continue;
+        }
+        for (uint8_t i=group_first[g]; i<=group_last[g]; i++) {
+            for (uint8_t j=0; j<24; j++) {
+                P[i][j] = P[j][i] = 0;
+            }
+        }
+    }
+}
+
+static CovPrediction::Inputs setup_inputs(void)
+{
+    CovPrediction::Inputs in;
+    in.dt = 0.012f;
+    in.quat.from_euler(0.1f, -0.2f, 1.0f);
+    in.delAng = Vector3f(0.001f, -0.002f, 0.0005f);
+    in.delVel = Vector3f(0.01f, 0.02f, -0.117f);
+    in.gyro_bias = Vector3F(1e-5f, -2e-5f, 1e-5f);
+    in.accel_bias = Vector3F(1e-4f, 0, -2e-4f);
+    in.delAngVar = 1e-8f;
+    in.delVelVar = 1e-6f;
+    return in;
+}
+
+// the state index limit EKF3 uses for a set of active state groups
+static uint8_t index_lim(uint8_t activeStates)
+{
+    if (activeStates & CovPrediction::STATES_WIND) {
+        return 23;
+    }
+    if (activeStates & CovPrediction::STATES_MAG) {
+        return 21;
+    }
+    if (activeStates & CovPrediction::STATES_DVEL_BIAS) {
+        return 15;
+    }
+    if (activeStates & CovPrediction::STATES_DANG_BIAS) {
+        return 12;
+    }
+    return 9;
+}
+
+static void BM_CovPredictionIndexLim(benchmark::State& state)
+{
+    const uint8_t activeStates = state.range_x();
+    const uint8_t mask = CovPrediction::activeStatesForIndexLim(index_lim(activeStates));
+    const CovPrediction::Inputs in = setup_inputs();
+    setup_covariance(activeStates);
+
+    while (state.KeepRunning()) {
+        CovPrediction::predict(P, nextP, in, mask);
+        gbenchmark_escape(&nextP);
+    }
+}
+
+static void BM_CovPredictionActiveStates(benchmark::State& state)
+{
+    const uint8_t activeStates = state.range_x();
+    const CovPrediction::Inputs in = setup_inputs();
+    setup_covariance(activeStates);
+
+    while (state.KeepRunning()) {
+        CovPrediction::predict(P, nextP, in, activeStates);
+        gbenchmark_escape(&nextP);
+    }
+}
+
+BENCHMARK(BM_CovPredictionIndexLim)->DenseRange(0, CovPrediction::STATES_ALL);
+BENCHMARK(BM_CovPredictionActiveStates)->DenseRange(0, CovPrediction::STATES_ALL);
+
+BENCHMARK_MAIN()
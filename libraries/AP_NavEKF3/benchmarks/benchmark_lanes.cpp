@@ -0,0 +1,148 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_Compass/AP_Compass.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  loop time of the real NavEKF3 for one to three lanes, with the lanes
+  stepped in the main thread and, when built with
+  --enable-ekf-threads, with lanes after the first on their own
+  threads. IMU data is fed through the INS HIL interface as Replay
+  does, with the clock stopped and advanced by one IMU period per
+  iteration so no iteration waits for a sample. The vehicle is at rest
+  with no GPS, so each iteration is a constant position mode step
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static AP_Baro barometer;
+static AP_GPS gps;
+static Compass compass;
+static AP_SerialManager serial_manager;
+static AP_Int32 logger_bitmask;
+static AP_Logger logger{logger_bitmask};
+static GCS_Dummy _gcs;
+static AP_AHRS_NavEKF ahrs{AP_AHRS_NavEKF::FLAG_ALWAYS_USE_EKF};
+
+static const uint8_t max_lanes = 3;
+
+// one filter per lane count and threading choice, as the lanes and
+// their threads are fixed when a filter is first initialised
+static NavEKF3 ekf3[max_lanes * 2];
+
+#define K(n) { AP_PARAM_GROUP, "K" #n "_", n + 1, &ekf3[n], {group_info : NavEKF3::var_info} }
+
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_GROUP, "INS_", 0, &ins, {group_info : AP_InertialSensor::var_info} },
+    K(0), K(1), K(2), K(3), K(4), K(5),
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+static const uint16_t imu_rate_hz = 400;
+static const uint32_t imu_period_us = 1000000UL / imu_rate_hz;
+static uint64_t sim_time_us = 1000000;
+
+// advance the clock by one IMU period and publish a sample on each IMU
+static void imu_step(void)
+{
+    sim_time_us += imu_period_us;
+    hal.scheduler->stop_clock(sim_time_us);
+
+    const float dt = imu_period_us * 1.0e-6f;
+    const Vector3f gyro(0.001f, -0.002f, 0.0005f);
+    const Vector3f accel(0.05f, -0.03f, -GRAVITY_MSS);
+    ins.set_delta_time(dt);
+    for (uint8_t i=0; i<max_lanes; i++) {
+        ins.set_gyro(i, gyro);
+        ins.set_accel(i, accel);
+        ins.set_delta_angle(i, gyro * dt, dt);
+        ins.set_delta_velocity(i, dt, accel * dt);
+    }
+    ins.update();
+}
+
+static void setup_ins(void)
+{
+    static bool done;
+    if (done) {
+        return;
+    }
+    done = true;
+    AP_Param::set_by_name("INS_GYR_CAL", AP_InertialSensor::GYRO_CAL_NEVER);
+    hal.scheduler->stop_clock(sim_time_us);
+    ins.set_hil_mode();
+    ins.init(imu_rate_hz);
+    // the HIL backend starts with one IMU, the first step adds the rest
+    imu_step();
+}
+
+// configure and initialise the filter for a lane count and threading
+// choice, running it until it has aligned
+static NavEKF3 &setup_ekf3(uint8_t lanes, uint8_t threads)
+{
+    setup_ins();
+
+    const uint8_t n = (lanes - 1) + threads * max_lanes;
+    char name[AP_MAX_NAME_SIZE+1];
+    hal.util->snprintf(name, sizeof(name), "K%u_IMU_MASK", n);
+    AP_Param::set_by_name(name, (1U<<lanes)-1);
+    hal.util->snprintf(name, sizeof(name), "K%u_GPS_TYPE", n);
+    AP_Param::set_by_name(name, 3);
+#if HAL_NAVEKF_CORE_THREADS
+    hal.util->snprintf(name, sizeof(name), "K%u_THREADS", n);
+    AP_Param::set_by_name(name, threads);
+#endif
+
+    NavEKF3 &ekf = ekf3[n];
+    ekf.set_enable(true);
+    for (uint16_t i=0; i<10*imu_rate_hz && !ekf.InitialiseFilter(); i++) {
+        imu_step();
+    }
+    for (uint16_t i=0; i<imu_rate_hz; i++) {
+        imu_step();
+        ekf.UpdateFilter();
+    }
+    return ekf;
+}
+
+static void run_lanes(benchmark::State& state, uint8_t threads)
+{
+    const uint8_t lanes = state.range_x();
+    NavEKF3 &ekf = setup_ekf3(lanes, threads);
+
+    while (state.KeepRunning()) {
+        imu_step();
+        ekf.UpdateFilter();
+    }
+    state.SetItemsProcessed(state.iterations() * lanes);
+}
+
+static void BM_EKF3LanesMainThread(benchmark::State& state)
+{
+    run_lanes(state, 0);
+}
+
+BENCHMARK(BM_EKF3LanesMainThread)->Arg(1)->Arg(2)->Arg(3);
+
+#if HAL_NAVEKF_CORE_THREADS
+static void BM_EKF3LanesThreaded(benchmark::State& state)
+{
+    run_lanes(state, 1);
+}
+
+BENCHMARK(BM_EKF3LanesThreaded)->Arg(2)->Arg(3);
+#endif
+
+BENCHMARK_MAIN()
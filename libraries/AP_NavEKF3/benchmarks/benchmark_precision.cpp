@@ -0,0 +1,200 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Baro/AP_Baro.h>
+#include <AP_Compass/AP_Compass.h>
+#include <AP_GPS/AP_GPS.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_InertialSensor/AP_InertialSensor.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_Param/AP_Param.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  position error of the real NavEKF3 over a 50km straight line flight,
+  in the precision the filter was built with. Build once with and once
+  without HAL_WITH_EKF3_DOUBLE to compare the two.
+
+  The vehicle aligns at rest, accelerates north to 50m/s and then
+  cruises. IMU data is fed through the INS HIL interface and GPS
+  through the GPS HIL interface as Replay does, with exact sensor data
+  so that the error is down to the filter arithmetic. Yaw comes from
+  the external yaw interface (EK3_MAG_CAL=5). The time is for one 50km
+  leg and the items processed are filter steps. The position is read
+  back through getPosNE(), which is single precision in both builds
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static AP_InertialSensor ins;
+static AP_Baro barometer;
+static AP_GPS gps;
+static Compass compass;
+static AP_SerialManager serial_manager;
+static AP_Int32 logger_bitmask;
+static AP_Logger logger{logger_bitmask};
+static GCS_Dummy _gcs;
+static AP_AHRS_NavEKF ahrs{AP_AHRS_NavEKF::FLAG_ALWAYS_USE_EKF};
+static NavEKF3 ekf3;
+
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_GROUP, "INS_", 0, &ins, {group_info : AP_InertialSensor::var_info} },
+    { AP_PARAM_GROUP, "EK3_", 1, &ekf3, {group_info : NavEKF3::var_info} },
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+static const uint16_t imu_rate_hz = 400;
+static const uint32_t imu_period_us = 1000000UL / imu_rate_hz;
+static const uint8_t gps_divider = 80;          // 5Hz GPS
+static const float gps_lag_s = 0.22f;           // lag AP_GPS reports for a HIL GPS
+static const float align_time_s = 20;
+static const float accel_time_s = 25;
+static const float cruise_speed = 50;           // m/s along north
+static const float leg_length = 50000;          // m
+static const int32_t home_lat = -353632621;
+static const int32_t home_lng = 1491652374;
+static const int32_t home_alt_cm = 58400;
+static const float earth_rate = 0.000072921f;  // rad/s
+static const double lat_scale = 0.011131884502145034; // m per 1e-7 degree, as Location uses
+
+static uint64_t sim_time_us = 1000000;
+static uint32_t sim_step_count;
+
+// distance north and speed of the vehicle t seconds after the start
+static void truth(double t, double &north, double &vel)
+{
+    const double accel = cruise_speed / accel_time_s;
+    if (t < align_time_s) {
+        north = 0;
+        vel = 0;
+        return;
+    }
+    t -= align_time_s;
+    if (t < accel_time_s) {
+        north = 0.5 * accel * t * t;
+        vel = accel * t;
+        return;
+    }
+    north = 0.5 * accel * accel_time_s * accel_time_s + cruise_speed * (t - accel_time_s);
+    vel = cruise_speed;
+}
+
+// advance the clock by one IMU period and publish the IMU, GPS and
+// yaw data for that time
+static void sim_step(void)
+{
+    sim_time_us += imu_period_us;
+    sim_step_count++;
+    hal.scheduler->stop_clock(sim_time_us);
+
+    const double t = sim_step_count * (double)imu_period_us * 1.0e-6;
+    const float dt = imu_period_us * 1.0e-6f;
+
+    // level and facing north, so the gyro senses the earth rate
+    const float lat_rad = radians(home_lat * 1.0e-7f);
+    const Vector3f gyro(earth_rate * cosf(lat_rad), 0, -earth_rate * sinf(lat_rad));
+    const bool accelerating = t >= align_time_s && t < align_time_s + accel_time_s;
+    const Vector3f accel(accelerating ? cruise_speed / accel_time_s : 0, 0, -GRAVITY_MSS);
+    ins.set_delta_time(dt);
+    ins.set_gyro(0, gyro);
+    ins.set_accel(0, accel);
+    ins.set_delta_angle(0, gyro * dt, dt);
+    ins.set_delta_velocity(0, dt, accel * dt);
+    ins.update();
+
+    if (sim_step_count % gps_divider != 0) {
+        return;
+    }
+
+    double north, vel;
+    truth(t - gps_lag_s, north, vel);
+    Location loc;
+    loc.lat = home_lat + (int32_t)(north / lat_scale + 0.5);
+    loc.lng = home_lng;
+    loc.alt = home_alt_cm;
+    gps.setHIL(0, AP_GPS::GPS_OK_FIX_3D, UNIX_OFFSET_MSEC + sim_time_us / 1000, loc,
+               Vector3f((float)vel, 0, 0), 12, 80);
+    gps.setHIL_Accuracy(0, 1.0f, 0.3f, 0.5f, 0.2f, true, 0);
+
+    ekf3.writeEulerYawAngle(0, radians(2), AP_HAL::millis(), 2);
+}
+
+// initialise the filter and fly it through alignment and the climb to
+// cruise speed
+static void setup_ekf3(void)
+{
+    static bool done;
+    if (done) {
+        return;
+    }
+    done = true;
+    AP_Param::set_by_name("INS_GYR_CAL", AP_InertialSensor::GYRO_CAL_NEVER);
+    AP_Param::set_by_name("EK3_IMU_MASK", 1);
+    AP_Param::set_by_name("EK3_GPS_TYPE", 0);
+    AP_Param::set_by_name("EK3_ALT_SOURCE", 2);
+    AP_Param::set_by_name("EK3_MAG_CAL", 5);
+    AP_Param::set_by_name("EK3_GPS_CHECK", 0);
+
+    hal.scheduler->stop_clock(sim_time_us);
+    ins.set_hil_mode();
+    ins.init(imu_rate_hz);
+    sim_step();
+
+    ekf3.set_enable(true);
+    for (uint16_t i=0; i<10*imu_rate_hz && !ekf3.InitialiseFilter(); i++) {
+        sim_step();
+    }
+    while (sim_step_count < (align_time_s + accel_time_s) * imu_rate_hz) {
+        sim_step();
+        ekf3.UpdateFilter();
+    }
+}
+
+// the largest and final horizontal position error over a 50km leg and
+// the number of steps where the filter reported itself unhealthy
+static void BM_EKF3Mission50km(benchmark::State& state)
+{
+    setup_ekf3();
+
+    Location origin;
+    if (!ekf3.getOriginLLH(-1, origin)) {
+        AP_HAL::panic("EKF3 has no origin");
+    }
+    const double origin_north = (origin.lat - home_lat) * lat_scale;
+    const uint32_t leg_steps = leg_length / cruise_speed * imu_rate_hz;
+    float max_error = 0;
+    float error = 0;
+    uint32_t unhealthy = 0;
+    uint32_t steps = 0;
+
+    while (state.KeepRunning()) {
+        for (uint32_t i=0; i<leg_steps; i++) {
+            sim_step();
+            ekf3.UpdateFilter();
+            if (!ekf3.healthy()) {
+                unhealthy++;
+            }
+            double north, vel;
+            truth(sim_step_count * (double)imu_period_us * 1.0e-6, north, vel);
+            Vector2f posNE;
+            ekf3.getPosNE(-1, posNE);
+            error = norm(float(posNE.x - (north - origin_north)), posNE.y);
+            max_error = MAX(max_error, error);
+        }
+        steps += leg_steps;
+    }
+
+    state.SetItemsProcessed(steps);
+    char label[80];
+    snprintf(label, sizeof(label), "max pos error %.1fmm, final %.1fmm, %u unhealthy steps",
+             (double)max_error * 1000, (double)error * 1000, (unsigned)unhealthy);
+    state.SetLabel(label);
+}
+
+BENCHMARK(BM_EKF3Mission50km);
+
+BENCHMARK_MAIN()
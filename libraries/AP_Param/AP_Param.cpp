@@ -77,11 +77,20 @@ uint16_t AP_Param::_parameter_count;
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
+// flat parameter table and name index
+AP_Param::ParamTableEntry *AP_Param::_param_table;
+AP_Param::NameIndexEntry *AP_Param::_name_index;
+uint16_t AP_Param::_param_table_size;
+uint16_t AP_Param::_name_index_size;
+bool AP_Param::_param_table_enabled = AP_PARAM_TABLE_DEFAULT;
+HAL_Semaphore AP_Param::_param_table_sem;
+
 struct AP_Param::param_override *AP_Param::param_overrides = nullptr;
 uint16_t AP_Param::num_param_overrides = 0;
 uint16_t AP_Param::num_read_only = 0;
 
-ObjectBuffer_TS<AP_Param::param_save> AP_Param::save_queue{30};
+ObjectBuffer_SPSC<AP_Param::param_save> AP_Param::save_queue{30};
+HAL_Semaphore AP_Param::save_sem;
 bool AP_Param::registered_save_handler;
 
 // we need a dummy object for the parameter save callback
@@ -444,32 +453,49 @@ const struct AP_Param::Info *AP_Param::find_by_header_group(struct Param_header
 
 // find the info structure given a header
 // return the Info structure and a pointer to the variables storage
-const struct AP_Param::Info *AP_Param::find_by_header(struct Param_header phdr, void **ptr)
+const struct AP_Param::Info *AP_Param::find_by_header(struct Param_header phdr, void **ptr, const uint16_t *key_index)
 {
+    if (key_index != nullptr) {
+        // key_index maps keys to their _var_info row
+        const uint16_t i = key_index[get_key(phdr)];
+        if (i >= _num_vars) {
+            return nullptr;
+        }
+        return find_by_header_vindex(phdr, ptr, i);
+    }
     // loop over all named variables
     for (uint16_t i=0; i<_num_vars; i++) {
-        uint8_t type = _var_info[i].type;
-        uint16_t key = _var_info[i].key;
-        if (key != get_key(phdr)) {
+        if (_var_info[i].key != get_key(phdr)) {
             // not the right key
             continue;
         }
-        if (type == AP_PARAM_GROUP) {
-            const struct GroupInfo *group_info = get_group_info(_var_info[i]);
-            if (group_info == nullptr) {
-                continue;
-            }
-            return find_by_header_group(phdr, ptr, i, group_info, 0, 0, 0);
+        const struct AP_Param::Info *info = find_by_header_vindex(phdr, ptr, i);
+        if (info != nullptr) {
+            return info;
         }
-        if (type == phdr.type) {
-            // found it
-            ptrdiff_t base;
-            if (!get_base(_var_info[i], base)) {
-                return nullptr;
-            }
-            *ptr = (void*)base;
-            return &_var_info[i];
+    }
+    return nullptr;
+}
+
+// find the info structure for a header in the _var_info row vindex
+const struct AP_Param::Info *AP_Param::find_by_header_vindex(struct Param_header phdr, void **ptr, uint16_t vindex)
+{
+    const uint8_t type = _var_info[vindex].type;
+    if (type == AP_PARAM_GROUP) {
+        const struct GroupInfo *group_info = get_group_info(_var_info[vindex]);
+        if (group_info == nullptr) {
+            return nullptr;
+        }
+        return find_by_header_group(phdr, ptr, vindex, group_info, 0, 0, 0);
+    }
+    if (type == phdr.type) {
+        // found it
+        ptrdiff_t base;
+        if (!get_base(_var_info[vindex], base)) {
+            return nullptr;
         }
+        *ptr = (void*)base;
+        return &_var_info[vindex];
     }
     return nullptr;
 }
@@ -846,10 +872,216 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 }
 
 
+// FNV-1a hash of a parameter name
+uint32_t AP_Param::name_hash(const char *name)
+{
+    uint32_t h = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i]; i++) {
+        h ^= (uint8_t)name[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+int AP_Param::name_index_compare(const void *a, const void *b)
+{
+    const NameIndexEntry *e1 = (const NameIndexEntry *)a;
+    const NameIndexEntry *e2 = (const NameIndexEntry *)b;
+    if (e1->hash != e2->hash) {
+        return e1->hash < e2->hash ? -1 : 1;
+    }
+    return int(e1->idx) - int(e2->idx);
+}
+
+/*
+  build the parameter table and name index from the parameter
+  tree. The names are those sent to the GCS, so this can't be done at
+  build time: they depend on frame type flags, enabled groups and
+  dynamically allocated objects. Names are not kept in the table, as
+  they can be regenerated from the token. Must be called with
+  _param_table_sem held
+ */
+bool AP_Param::build_param_table(void)
+{
+    invalidate_param_table();
+    const uint16_t count = count_parameters();
+    if (count == 0) {
+        return false;
+    }
+    _param_table = new ParamTableEntry[count];
+    _name_index = new NameIndexEntry[count];
+    if (_param_table == nullptr || _name_index == nullptr) {
+        invalidate_param_table();
+        return false;
+    }
+    ParamToken token;
+    enum ap_var_type type;
+    uint16_t n = 0;
+    uint16_t idx = 0;
+    for (AP_Param *ap = first(&token, &type);
+         ap != nullptr && idx < count;
+         ap = next_scalar(&token, &type), idx++) {
+        ParamTableEntry &t = _param_table[idx];
+        t.ap = ap;
+        t.token = token;
+        t.type = type;
+        if (type == AP_PARAM_NONE || type > AP_PARAM_FLOAT) {
+            continue;
+        }
+        char name[AP_MAX_NAME_SIZE+1];
+        ap->copy_name_token(token, name, sizeof(name), true);
+        name[AP_MAX_NAME_SIZE] = 0;
+        NameIndexEntry &e = _name_index[n++];
+        e.hash = name_hash(name);
+        e.idx = idx;
+    }
+    if (idx != count) {
+        // the tree changed under us
+        invalidate_param_table();
+        return false;
+    }
+    qsort(_name_index, n, sizeof(_name_index[0]), name_index_compare);
+    _name_index_size = n;
+    _param_table_size = count;
+    return true;
+}
+
+// free the parameter table. Must be called with _param_table_sem held
+void AP_Param::invalidate_param_table(void)
+{
+    delete[] _param_table;
+    delete[] _name_index;
+    _param_table = nullptr;
+    _name_index = nullptr;
+    _param_table_size = 0;
+    _name_index_size = 0;
+}
+
+/*
+  return true if the parameter table is enabled and matches the
+  parameter tree, rebuilding it if needed. Must be called with
+  _param_table_sem held
+ */
+bool AP_Param::param_table_current(void)
+{
+    if (!_param_table_enabled) {
+        return false;
+    }
+    if (_param_table != nullptr && count_parameters() == _param_table_size) {
+        return true;
+    }
+    return build_param_table();
+}
+
+// build the parameter table now, so the first GCS request doesn't
+// pay for it
+void AP_Param::update_param_table(void)
+{
+    WITH_SEMAPHORE(_param_table_sem);
+    param_table_current();
+}
+
+void AP_Param::set_param_table_enabled(bool enable)
+{
+    WITH_SEMAPHORE(_param_table_sem);
+    _param_table_enabled = enable;
+    if (!enable) {
+        invalidate_param_table();
+    }
+}
+
+/*
+  find a parameter by its exact name in the name index. Returns
+  nullptr if the name is not in the index
+ */
+AP_Param *AP_Param::find_in_name_index(const char *name, enum ap_var_type *ptype)
+{
+    WITH_SEMAPHORE(_param_table_sem);
+    if (!param_table_current()) {
+        return nullptr;
+    }
+    const uint32_t hash = name_hash(name);
+
+    // find the first entry with this hash
+    uint16_t lo = 0;
+    uint16_t hi = _name_index_size;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_name_index[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (uint16_t i=lo; i<_name_index_size && _name_index[i].hash == hash; i++) {
+        const ParamTableEntry &e = _param_table[_name_index[i].idx];
+        // copy_name_token looks the entry up in the var_info tree,
+        // so this also rejects entries which have moved
+        char ename[AP_MAX_NAME_SIZE+1];
+        ename[0] = 0;
+        e.ap->copy_name_token(e.token, ename, sizeof(ename), true);
+        ename[AP_MAX_NAME_SIZE] = 0;
+        if (strncmp(name, ename, AP_MAX_NAME_SIZE) == 0) {
+            *ptype = (enum ap_var_type)e.type;
+            return e.ap;
+        }
+    }
+    return nullptr;
+}
+
+/*
+  look up a parameter by index in the parameter table. Returns false
+  if the table is not available
+ */
+bool AP_Param::find_in_param_table(uint16_t idx, enum ap_var_type *ptype, ParamToken *token, AP_Param *&ap)
+{
+    WITH_SEMAPHORE(_param_table_sem);
+    if (!param_table_current()) {
+        return false;
+    }
+    if (idx >= _param_table_size) {
+        ap = nullptr;
+        return true;
+    }
+    const ParamTableEntry &e = _param_table[idx];
+    *token = e.token;
+    if (ptype != nullptr) {
+        *ptype = (enum ap_var_type)e.type;
+    }
+    ap = e.ap;
+    return true;
+}
+
 // Find a variable by name.
 //
+// The name index only holds the names sent to the GCS, so names
+// which differ in case, vectors by their base name, and parameters
+// hidden by frame type or disabled groups are found by walking the
+// var_info tree
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
+{
+    AP_Param *ap = find_in_name_index(name, ptype);
+    if (ap == nullptr) {
+        ap = find_by_walk(name, ptype);
+    }
+    if (ap != nullptr && flags != nullptr) {
+        uint32_t group_element = 0;
+        const struct GroupInfo *ginfo;
+        struct GroupNesting group_nesting {};
+        uint8_t idx;
+        ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
+        if (ginfo != nullptr) {
+            *flags = ginfo->flags;
+        }
+    }
+    return ap;
+}
+
+// Find a variable by walking the var_info tree
+//
+AP_Param *
+AP_Param::find_by_walk(const char *name, enum ap_var_type *ptype)
 {
     for (uint16_t i=0; i<_num_vars; i++) {
         uint8_t type = _var_info[i].type;
@@ -864,16 +1096,6 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
             }
             AP_Param *ap = find_group(name + len, i, 0, group_info, ptype);
             if (ap != nullptr) {
-                if (flags != nullptr) {
-                    uint32_t group_element = 0;
-                    const struct GroupInfo *ginfo;
-                    struct GroupNesting group_nesting {};
-                    uint8_t idx;
-                    ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
-                    if (ginfo != nullptr) {
-                        *flags = ginfo->flags;
-                    }
-                }
                 return ap;
             }
             // we continue looking as we want to allow top level
@@ -891,12 +1113,16 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
     return nullptr;
 }
 
-// Find a variable by index. Note that this is quite slow.
+// Find a variable by index. This is quite slow without the parameter
+// table.
 //
 AP_Param *
 AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
 {
     AP_Param *ap;
+    if (find_in_param_table(idx, ptype, token, ap)) {
+        return ap;
+    }
     uint16_t count=0;
     for (ap=AP_Param::first(token, ptype);
          ap && count < idx;
@@ -1137,7 +1363,13 @@ void AP_Param::save(bool force_save)
     struct param_save p;
     p.param = this;
     p.force_save = force_save;
-    while (!save_queue.push(p)) {
+    while (true) {
+        {
+            WITH_SEMAPHORE(save_sem);
+            if (save_queue.push(p)) {
+                break;
+            }
+        }
         // if we can't save to the queue
         if (hal.util->get_soft_armed()) {
             // if we are armed then don't sleep, instead we lose the
@@ -1395,6 +1627,42 @@ void AP_Param::setup_sketch_defaults(void)
 }
 
 
+/*
+  build a map from top level keys to their _var_info row, for
+  find_by_header(). Caller frees it with delete[]
+ */
+uint16_t *AP_Param::build_key_index(void)
+{
+    uint16_t *key_index = new uint16_t[_sentinal_key];
+    if (key_index == nullptr) {
+        return nullptr;
+    }
+    memset(key_index, 0xFF, _sentinal_key * sizeof(key_index[0]));
+    for (uint16_t i=0; i<_num_vars; i++) {
+        const uint16_t key = _var_info[i].key;
+        if (key < _sentinal_key && key_index[key] == 0xFFFF) {
+            key_index[key] = i;
+        }
+    }
+    return key_index;
+}
+
+/*
+  read n bytes of parameter storage at ofs, from the copy of the
+  storage in buf if we have one
+ */
+bool AP_Param::read_storage(const uint8_t *buf, void *dst, uint16_t ofs, uint8_t n)
+{
+    if (buf == nullptr) {
+        return _storage.read_block(dst, ofs, n);
+    }
+    if (ofs + n > _storage.size()) {
+        return false;
+    }
+    memcpy(dst, &buf[ofs], n);
+    return true;
+}
+
 // Load all variables from EEPROM
 //
 bool AP_Param::load_all()
@@ -1402,37 +1670,70 @@ bool AP_Param::load_all()
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
 
+    const uint32_t start_us = AP_HAL::micros();
     reload_defaults_file(false);
+    const uint32_t defaults_us = AP_HAL::micros() - start_us;
 
     if (!registered_save_handler) {
         registered_save_handler = true;
         hal.scheduler->register_io_process(FUNCTOR_BIND((&save_dummy), &AP_Param::save_io_handler, void));
     }
-    
+
+    /*
+      read the whole of parameter storage in one block and look up
+      headers by key, falling back to reading header by header and
+      scanning _var_info if we can't get the memory
+     */
+    uint8_t *buf = nullptr;
+#if AP_PARAM_LOAD_BULK
+    buf = new uint8_t[_storage.size()];
+    if (buf != nullptr && !_storage.read_block(buf, 0, _storage.size())) {
+        delete[] buf;
+        buf = nullptr;
+    }
+#endif
+    uint16_t *key_index = build_key_index();
+
+    bool found_sentinal = false;
     while (ofs < _storage.size()) {
-        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        if (!read_storage(buf, &phdr, ofs, sizeof(phdr))) {
+            break;
+        }
         // note that this is an || not an && for robustness
         // against power off while adding a variable
         if (is_sentinal(phdr)) {
             // we've reached the sentinal
             sentinal_offset = ofs;
-            return true;
+            found_sentinal = true;
+            break;
         }
 
         const struct AP_Param::Info *info;
         void *ptr;
 
-        info = find_by_header(phdr, &ptr);
+        info = find_by_header(phdr, &ptr, key_index);
         if (info != nullptr) {
-            _storage.read_block(ptr, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
+            read_storage(buf, ptr, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
         }
 
         ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
     }
 
-    // we didn't find the sentinal
-    Debug("no sentinal in load_all");
-    return false;
+    delete[] buf;
+    delete[] key_index;
+
+    if (!found_sentinal) {
+        // we didn't find the sentinal
+        Debug("no sentinal in load_all");
+        return false;
+    }
+
+    update_param_table();
+
+    hal.console->printf("Loaded parameters in %u ms (defaults %u ms)\n",
+                        unsigned((AP_HAL::micros() - start_us) / 1000U),
+                        unsigned(defaults_us / 1000U));
+    return true;
 }
 
 /*
@@ -1477,6 +1778,10 @@ void AP_Param::load_object_from_eeprom(const void *object_pointer, const struct
 
     // reset cached param counter as we may be loading a dynamic var_info
     _parameter_count = 0;
+    {
+        WITH_SEMAPHORE(_param_table_sem);
+        invalidate_param_table();
+    }
     
     if (!find_key_by_pointer(object_pointer, key)) {
         hal.console->printf("ERROR: Unable to find param pointer\n");
@@ -1720,6 +2025,16 @@ AP_Param *AP_Param::next_scalar(ParamToken *token, enum ap_var_type *ptype)
     return ap;
 }
 
+/// Returns the next scalar variable, which will have index next_idx
+AP_Param *AP_Param::next_scalar(ParamToken *token, enum ap_var_type *ptype, uint16_t next_idx)
+{
+    AP_Param *ap;
+    if (find_in_param_table(next_idx, ptype, token, ap)) {
+        return ap;
+    }
+    return next_scalar(token, ptype);
+}
+
 
 /// cast a variable to a float given its type
 float AP_Param::cast_to_float(enum ap_var_type type) const
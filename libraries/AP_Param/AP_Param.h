@@ -46,6 +46,24 @@
 #endif
 #endif
 
+/*
+  read all of parameter storage into RAM in one block in load_all(),
+  rather than header by header
+ */
+#ifndef AP_PARAM_LOAD_BULK
+#define AP_PARAM_LOAD_BULK (HAL_MEM_CLASS >= HAL_MEM_CLASS_300)
+#endif
+
+/*
+  keep a flat table of parameters in traversal order and a hash index
+  of their names, for find(), find_by_index() and parameter
+  streaming. Costs 20 bytes of RAM per parameter, around 20kB on a
+  copter, so is only on by default on boards with plenty of RAM
+ */
+#ifndef AP_PARAM_TABLE_DEFAULT
+#define AP_PARAM_TABLE_DEFAULT (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
 /*
   flags for variables in var_info and group tables
  */
@@ -454,6 +472,11 @@ public:
     /// as needed
     static AP_Param *       next_scalar(ParamToken *token, enum ap_var_type *ptype);
 
+    /// Returns the next scalar variable, given the index it will have
+    /// in the order of next_scalar(). Uses the parameter table when
+    /// available, otherwise walks on from token
+    static AP_Param *       next_scalar(ParamToken *token, enum ap_var_type *ptype, uint16_t next_idx);
+
     /// cast a variable to a float given its type
     float                   cast_to_float(enum ap_var_type type) const;
 
@@ -477,6 +500,10 @@ public:
 
     static void set_hide_disabled_groups(bool value) { _hide_disabled_groups = value; }
 
+    // enable or disable the parameter table and name index used by
+    // find(), find_by_index() and indexed next_scalar()
+    static void set_param_table_enabled(bool enable);
+
     // set frame type flags. Used to unhide frame specific parameters
     static void set_frame_type_flags(uint16_t flags_to_set) {
         _parameter_count = 0;
@@ -608,7 +635,18 @@ private:
                                     ptrdiff_t group_offset);
     static const struct Info *  find_by_header(
                                     struct Param_header phdr,
-                                    void **ptr);
+                                    void **ptr,
+                                    const uint16_t *key_index = nullptr);
+    static const struct Info *  find_by_header_vindex(
+                                    struct Param_header phdr,
+                                    void **ptr,
+                                    uint16_t vindex);
+    static uint16_t *           build_key_index(void);
+    static bool                 read_storage(
+                                    const uint8_t *buf,
+                                    void *dst,
+                                    uint16_t ofs,
+                                    uint8_t n);
     void                        add_vector3f_suffix(
                                     char *buffer,
                                     size_t buffer_size,
@@ -669,6 +707,40 @@ private:
     static uint16_t             _parameter_count;
     static const struct Info *  _var_info;
 
+    /*
+      flat table of the parameters sent to the GCS in traversal
+      order, so the index of a parameter is its position in the
+      table, and an index of their names sorted by name hash. Built
+      after load_all() or on first use and rebuilt when the parameter
+      count changes. Name index entries are checked against the
+      var_info tree before use, so a stale entry is only a miss
+     */
+    struct ParamTableEntry {
+        AP_Param *ap;
+        ParamToken token;
+        uint8_t type;
+    };
+    struct NameIndexEntry {
+        uint32_t hash;
+        uint16_t idx;
+    };
+    static ParamTableEntry *    _param_table;
+    static NameIndexEntry *     _name_index;
+    static uint16_t             _param_table_size;
+    static uint16_t             _name_index_size;
+    static bool                 _param_table_enabled;
+    static HAL_Semaphore        _param_table_sem;
+
+    static uint32_t name_hash(const char *name);
+    static int name_index_compare(const void *a, const void *b);
+    static bool build_param_table(void);
+    static void invalidate_param_table(void);
+    static bool param_table_current(void);
+    static void update_param_table(void);
+    static AP_Param *find_in_name_index(const char *name, enum ap_var_type *ptype);
+    static bool find_in_param_table(uint16_t idx, enum ap_var_type *ptype, ParamToken *token, AP_Param *&ap);
+    static AP_Param *find_by_walk(const char *name, enum ap_var_type *ptype);
+
     /*
       list of overridden values from load_defaults_file()
     */
@@ -694,7 +766,10 @@ private:
         AP_Param *param;
         bool force_save;
     };
-    static ObjectBuffer_TS<struct param_save> save_queue;
+    // save() may be called from any thread, so producers serialise
+    // on save_sem. The IO thread is the only consumer
+    static ObjectBuffer_SPSC<struct param_save> save_queue;
+    static HAL_Semaphore save_sem;
     static bool registered_save_handler;
 
     // background function for saving parameters
@@ -0,0 +1,90 @@
+#include <AP_gbenchmark.h>
+
+#include <stdio.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Param/AP_Param.h>
+
+/*
+  set_by_name throughput over a tree of 1000 parameters in 25 groups,
+  as when loading a parameter file or handling PARAM_SET, with and
+  without the name index
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class ParamGroup {
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Float p[40];
+};
+
+#define P(n) AP_GROUPINFO("P" #n, n, ParamGroup, p[n], 0)
+
+const AP_Param::GroupInfo ParamGroup::var_info[] = {
+    P(0),  P(1),  P(2),  P(3),  P(4),  P(5),  P(6),  P(7),  P(8),  P(9),
+    P(10), P(11), P(12), P(13), P(14), P(15), P(16), P(17), P(18), P(19),
+    P(20), P(21), P(22), P(23), P(24), P(25), P(26), P(27), P(28), P(29),
+    P(30), P(31), P(32), P(33), P(34), P(35), P(36), P(37), P(38), P(39),
+    AP_GROUPEND
+};
+
+static const uint8_t num_groups = 25;
+static const uint8_t params_per_group = 40;
+
+static AP_Int16 format_version;
+static ParamGroup groups[num_groups];
+
+#define G(n) { AP_PARAM_GROUP, "G" #n "_", n + 1, &groups[n], {group_info : ParamGroup::var_info} }
+
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_INT16, "FORMAT_VERSION", 0, &format_version, {def_value : 0} },
+    G(0),  G(1),  G(2),  G(3),  G(4),  G(5),  G(6),  G(7),  G(8),  G(9),
+    G(10), G(11), G(12), G(13), G(14), G(15), G(16), G(17), G(18), G(19),
+    G(20), G(21), G(22), G(23), G(24),
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+static char names[num_groups * params_per_group][AP_MAX_NAME_SIZE+1];
+
+static void make_names(void)
+{
+    for (uint8_t g=0; g<num_groups; g++) {
+        for (uint8_t i=0; i<params_per_group; i++) {
+            snprintf(names[g*params_per_group + i], sizeof(names[0]), "G%u_P%u", g, i);
+        }
+    }
+}
+
+static void set_all_by_name(benchmark::State& state)
+{
+    make_names();
+    const uint16_t num_names = ARRAY_SIZE(names);
+    uint16_t n = 0;
+    bool found = true;
+    while (state.KeepRunning()) {
+        found &= AP_Param::set_by_name(names[n], n);
+        n = (n + 1) % num_names;
+    }
+    gbenchmark_escape(&found);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SetByNameWalk(benchmark::State& state)
+{
+    AP_Param::set_param_table_enabled(false);
+    set_all_by_name(state);
+}
+
+static void BM_SetByNameIndexed(benchmark::State& state)
+{
+    AP_Param::set_param_table_enabled(true);
+    set_all_by_name(state);
+}
+
+BENCHMARK(BM_SetByNameWalk);
+BENCHMARK(BM_SetByNameIndexed);
+
+BENCHMARK_MAIN()
@@ -22,10 +22,18 @@
 #include "MissionItemProtocol_Waypoints.h"
 #include "MissionItemProtocol_Rally.h"
 #include "MissionItemProtocol_Fence.h"
+#include "GCS_MessageCache.h"
 #include "ap_message.h"
 
 #define GCS_DEBUG_SEND_MESSAGE_TIMINGS 0
 
+// per-message sent and skipped counts, logged as MAVR and sent as
+// NAMED_VALUE_INT one message at a time.  Costs under a kilobyte per
+// channel
+#ifndef HAL_GCS_MESSAGE_STATS_ENABLED
+#define HAL_GCS_MESSAGE_STATS_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
 // check if a message will fit in the payload space available
 #define PAYLOAD_SIZE(chan, id) (unsigned(GCS_MAVLINK::packet_overhead_chan(chan)+MAVLINK_MSG_ID_ ## id ## _LEN))
 #define HAVE_PAYLOAD_SPACE(chan, id) (comm_get_txspace(chan) >= PAYLOAD_SIZE(chan, id))
@@ -217,6 +225,7 @@ public:
     void send_vibration() const;
     void send_mount_status() const;
     void send_named_float(const char *name, float value) const;
+    void send_named_int(const char *name, int32_t value) const;
     void send_gimbal_report() const;
     void send_home_position() const;
     void send_gps_global_origin() const;
@@ -501,6 +510,8 @@ private:
                                                          // parameters for
                                                          // queued send
     uint32_t                    _queued_parameter_send_time_ms;
+    // time the current PARAM_REQUEST_LIST download started
+    uint32_t                    _queued_parameter_start_ms;
 
     /// Count the number of reportable parameters.
     ///
@@ -559,6 +570,54 @@ private:
     ap_message next_deferred_bucket_message_to_send();
     void find_next_bucket_to_send();
     void remove_message_from_bucket(int8_t bucket, ap_message id);
+    void reschedule_sending_bucket();
+
+    // stream messages are sent highest priority first within a
+    // bucket.  When the link is saturated low priority messages are
+    // skipped rather than delaying the rest of the bucket
+    enum class message_priority : uint8_t {
+        LOW,
+        NORMAL,
+        HIGH,
+    };
+    static message_priority get_ap_message_priority(const ap_message id);
+
+    // estimate of the link throughput, made from how fast the port
+    // drains our transmit buffer.  Stream messages spend tokens which
+    // are refilled at the estimated rate.  The estimate is only
+    // updated while the buffer stays occupied; a rate of zero means
+    // the link has never been seen saturated, and nothing is limited
+    struct {
+        float rate_bps;             // estimated link rate, bytes/second
+        float tokens;               // bytes we can send now
+        uint32_t last_refill_ms;
+        uint32_t window_start_ms;
+        uint32_t window_drained;    // bytes the port sent in this window
+        uint32_t last_tx_bytes;     // mavlink_comm_tx_bytes when last checked
+        uint16_t last_txspace;
+        uint16_t max_txspace;       // txspace with an empty buffer
+        bool window_idle;           // buffer emptied during this window
+    } link_budget;
+    void update_link_budget();
+    void spend_link_budget();
+    float link_budget_burst() const;
+    bool link_budget_allows(const ap_message id) const;
+
+#if HAL_GCS_MESSAGE_STATS_ENABLED
+    // count of stream messages sent and skipped, to compare the
+    // achieved rates with the requested ones
+    struct ap_message_stats_t {
+        uint32_t start_ms;          // start of the counting period
+        uint16_t sent;
+        uint16_t skipped;
+    } ap_message_stats[MSG_LAST];
+    // one message is reported per step, cycling through all of them
+    uint32_t ap_message_stats_step_ms;
+    uint32_t ap_message_stats_cycle_skipped;
+    uint8_t ap_message_stats_next;
+    static const uint16_t ap_message_stats_step_period_ms = 500;
+    void update_ap_message_stats();
+#endif
 
     // bitmask of IDs the code has spontaneously decided it wants to
     // send out.  Examples include HEARTBEAT (gcs_send_heartbeat)
@@ -600,6 +659,8 @@ private:
     uint16_t get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const;
 
     bool do_try_send_message(const ap_message id);
+    // send a message another channel packed in this pass
+    bool send_cached_message(const GCS_MessageCache::Entry &cached);
 
     // time when we missed sending a parameter for GCS
     static uint32_t reserve_param_space_start_ms;
@@ -632,8 +693,8 @@ private:
     };
 
     // queue of pending parameter requests and replies
-    static ObjectBuffer<pending_param_request> param_requests;
-    static ObjectBuffer<pending_param_reply> param_replies;
+    static ObjectBuffer_SPSC<pending_param_request> param_requests;
+    static ObjectBuffer_SPSC<pending_param_reply> param_replies;
 
     // have we registered the IO timer callback?
     static bool param_timer_registered;
@@ -862,6 +923,10 @@ public:
     void update_send();
     void update_receive();
 
+    // cache of messages packed in this pass of update_send, or
+    // nullptr if there is only one channel
+    GCS_MessageCache *get_message_cache() { return _message_cache; }
+
     // minimum amount of time (in microseconds) that must remain in
     // the main scheduler loop before we are allowed to send any
     // mavlink messages.  We want to prioritise the main flight
@@ -960,6 +1025,8 @@ private:
     // true if update_send has ever been called:
     bool update_send_has_been_called;
 
+    GCS_MessageCache *_message_cache;
+
     // handle passthru between two UARTs
     struct {
         bool enabled;
@@ -916,7 +916,21 @@ ap_message GCS_MAVLINK::next_deferred_bucket_message_to_send()
         return no_message_to_send;
     }
 
-    const int16_t next = bucket_message_ids_to_send.first_set();
+    // send the highest priority message in the bucket first
+    int16_t next = -1;
+    message_priority next_priority = message_priority::LOW;
+    Bitmask<MSG_LAST> remaining = bucket_message_ids_to_send;
+    for (int16_t i = remaining.first_set(); i != -1; i = remaining.first_set()) {
+        remaining.clear(i);
+        const message_priority priority = get_ap_message_priority((ap_message)i);
+        if (next == -1 || priority > next_priority) {
+            next = i;
+            next_priority = priority;
+            if (priority == message_priority::HIGH) {
+                break;
+            }
+        }
+    }
     if (next == -1) {
         // should not happen
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
@@ -928,6 +942,241 @@ ap_message GCS_MAVLINK::next_deferred_bucket_message_to_send()
     return (ap_message)next;
 }
 
+// reschedule the bucket we have just finished sending
+void GCS_MAVLINK::reschedule_sending_bucket()
+{
+    deferred_message_bucket_t &bucket = deferred_message_bucket[sending_bucket_id];
+    const uint32_t interval_ms = get_reschedule_interval_ms(bucket);
+    const uint16_t now16_ms = AP_HAL::millis16();
+    const uint16_t ms_since_due = now16_ms - bucket.last_sent_ms;
+    if (ms_since_due >= 2 * interval_ms) {
+        // we have missed a whole period, so this bucket's deadline
+        // has passed.  Start a new period now rather than sending the
+        // bucket again back-to-back to catch up, which would only make
+        // a saturated link worse
+        bucket.last_sent_ms = now16_ms;
+    } else {
+        bucket.last_sent_ms += interval_ms;
+    }
+    find_next_bucket_to_send();
+}
+
+GCS_MAVLINK::message_priority GCS_MAVLINK::get_ap_message_priority(const ap_message id)
+{
+    switch (id) {
+    // state a pilot or GCS operator needs to fly the vehicle:
+    case MSG_HEARTBEAT:
+    case MSG_ATTITUDE:
+    case MSG_LOCATION:
+    case MSG_SYS_STATUS:
+    case MSG_EXTENDED_SYS_STATE:
+    case MSG_VFR_HUD:
+    case MSG_GPS_RAW:
+    case MSG_BATTERY_STATUS:
+    case MSG_EKF_STATUS_REPORT:
+    case MSG_FENCE_STATUS:
+    case MSG_CURRENT_WAYPOINT:
+    case MSG_MISSION_ITEM_REACHED:
+    case MSG_NEXT_MISSION_REQUEST_WAYPOINTS:
+    case MSG_NEXT_MISSION_REQUEST_RALLY:
+    case MSG_NEXT_MISSION_REQUEST_FENCE:
+    case MSG_NEXT_PARAM:
+    case MSG_HOME:
+    case MSG_ORIGIN:
+    case MSG_MAG_CAL_REPORT:
+    case MSG_AUTOPILOT_VERSION:
+        return message_priority::HIGH;
+
+    // bulk sensor and diagnostic data:
+    case MSG_POWER_STATUS:
+    case MSG_MEMINFO:
+    case MSG_SERVO_OUTPUT_RAW:
+    case MSG_SERVO_OUT:
+    case MSG_RC_CHANNELS:
+    case MSG_RC_CHANNELS_RAW:
+    case MSG_RAW_IMU:
+    case MSG_SCALED_IMU:
+    case MSG_SCALED_IMU2:
+    case MSG_SCALED_IMU3:
+    case MSG_SCALED_PRESSURE:
+    case MSG_SCALED_PRESSURE2:
+    case MSG_SCALED_PRESSURE3:
+    case MSG_SENSOR_OFFSETS:
+    case MSG_GPS_RTK:
+    case MSG_GPS2_RTK:
+    case MSG_SYSTEM_TIME:
+    case MSG_AHRS:
+    case MSG_SIMSTATE:
+    case MSG_AHRS2:
+    case MSG_AHRS3:
+    case MSG_HWSTATUS:
+    case MSG_PID_TUNING:
+    case MSG_VIBRATION:
+    case MSG_RPM:
+    case MSG_ESC_TELEMETRY:
+        return message_priority::LOW;
+
+    default:
+        return message_priority::NORMAL;
+    }
+}
+
+// account for bytes written to the port since we last looked,
+// whoever wrote them, and measure how much the port has sent
+void GCS_MAVLINK::spend_link_budget()
+{
+    const uint32_t tx_bytes = mavlink_comm_tx_bytes[chan];
+    const uint16_t space = txspace();
+    const uint32_t written = tx_bytes - link_budget.last_tx_bytes;
+
+    // the port sent what we wrote plus however much the free space grew
+    const int32_t drained = int32_t(written) + int32_t(space) - int32_t(link_budget.last_txspace);
+    if (drained > 0) {
+        link_budget.window_drained += drained;
+    }
+    if (space >= link_budget.max_txspace) {
+        link_budget.max_txspace = space;
+        link_budget.window_idle = true;
+    }
+    if (!is_zero(link_budget.rate_bps)) {
+        link_budget.tokens = MAX(link_budget.tokens - written, -link_budget_burst());
+    }
+    link_budget.last_tx_bytes = tx_bytes;
+    link_budget.last_txspace = space;
+}
+
+// most bytes we let build up in the token bucket
+float GCS_MAVLINK::link_budget_burst() const
+{
+    return MAX(link_budget.rate_bps * 0.5f, 512.0f);
+}
+
+void GCS_MAVLINK::update_link_budget()
+{
+    spend_link_budget();
+
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t window_ms = now_ms - link_budget.window_start_ms;
+    if (window_ms >= 200) {
+        const float sample_bps = link_budget.window_drained * 1000.0f / window_ms;
+        if (!link_budget.window_idle) {
+            // the buffer never emptied, so the port was sending as
+            // fast as the link allows.  Drop to a lower rate at once,
+            // and rise slowly
+            if (is_zero(link_budget.rate_bps) || sample_bps < link_budget.rate_bps) {
+                link_budget.rate_bps = MAX(sample_bps, 1.0f);
+            } else {
+                link_budget.rate_bps = 0.8f * link_budget.rate_bps + 0.2f * sample_bps;
+            }
+        } else if (!is_zero(link_budget.rate_bps)) {
+            // the link kept up with us.  Let the estimate grow so we
+            // find out if it has more capacity
+            link_budget.rate_bps = MAX(link_budget.rate_bps * 1.1f, sample_bps);
+        }
+        link_budget.window_start_ms = now_ms;
+        link_budget.window_drained = 0;
+        link_budget.window_idle = false;
+    }
+
+    if (!is_zero(link_budget.rate_bps)) {
+        const float refill = link_budget.rate_bps * (now_ms - link_budget.last_refill_ms) * 0.001f;
+        link_budget.tokens = MIN(link_budget.tokens + refill, link_budget_burst());
+    }
+    link_budget.last_refill_ms = now_ms;
+}
+
+// returns true if a stream message may be sent now.  High priority
+// messages are only limited by the space in the transmit buffer;
+// lower priority messages must leave tokens in reserve
+bool GCS_MAVLINK::link_budget_allows(const ap_message id) const
+{
+    if (is_zero(link_budget.rate_bps)) {
+        // never seen the link saturated
+        return true;
+    }
+    switch (get_ap_message_priority(id)) {
+    case message_priority::HIGH:
+        return true;
+    case message_priority::NORMAL:
+        return link_budget.tokens > 0;
+    case message_priority::LOW:
+        return link_budget.tokens > 0.5f * link_budget_burst();
+    }
+    return true;
+}
+
+#if HAL_GCS_MESSAGE_STATS_ENABLED
+// report the requested and achieved rates of the next message we are
+// streaming, logging them and sending them to the GCS.  Each
+// message's counts cover the time since it was last reported.  At
+// the start of each cycle through the messages the link estimate and
+// the messages skipped in the last cycle are sent too
+void GCS_MAVLINK::update_ap_message_stats()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - ap_message_stats_step_ms < ap_message_stats_step_period_ms) {
+        return;
+    }
+    ap_message_stats_step_ms = now_ms;
+
+    for (uint8_t n=0; n<MSG_LAST; n++) {
+        const uint8_t i = ap_message_stats_next;
+        ap_message_stats_next = (i + 1) % MSG_LAST;
+
+        if (i == 0) {
+            if (txspace() >= 2*PAYLOAD_SIZE(chan, NAMED_VALUE_FLOAT)) {
+                send_named_float("LINK_BPS", link_budget.rate_bps);
+                send_named_float("LINK_SKIP", ap_message_stats_cycle_skipped);
+            }
+            ap_message_stats_cycle_skipped = 0;
+        }
+
+        ap_message_stats_t &stats = ap_message_stats[i];
+        uint16_t interval_ms = 0;
+        get_ap_message_interval((ap_message)i, interval_ms);
+        if (interval_ms == 0 && stats.sent == 0 && stats.skipped == 0) {
+            // not streamed; restart its period and move on
+            stats.start_ms = now_ms;
+            continue;
+        }
+
+        const uint32_t period_ms = MAX(now_ms - stats.start_ms, 1U);
+        const float req_hz = interval_ms == 0 ? 0.0f : 1000.0f / interval_ms;
+        const float hz = stats.sent * 1000.0f / period_ms;
+
+        AP_Logger *logger = AP_Logger::get_singleton();
+        if (logger != nullptr && logger->logging_started()) {
+            logger->Write("MAVR", "TimeUS,Chan,Id,ReqHz,Hz,Skip,Link",
+                          "s#-zz--", "F------", "QBBffHf",
+                          AP_HAL::micros64(),
+                          (uint8_t)chan,
+                          i,
+                          (double)req_hz,
+                          (double)hz,
+                          stats.skipped,
+                          (double)link_budget.rate_bps);
+        }
+
+        // rates are sent in centi-Hz
+        if (txspace() >= 3*PAYLOAD_SIZE(chan, NAMED_VALUE_INT)) {
+            char name[MAVLINK_MSG_NAMED_VALUE_INT_FIELD_NAME_LEN+1];
+            hal.util->snprintf(name, sizeof(name), "MREQ%u", (unsigned)i);
+            send_named_int(name, (int32_t)(req_hz * 100));
+            hal.util->snprintf(name, sizeof(name), "MHZ%u", (unsigned)i);
+            send_named_int(name, (int32_t)(hz * 100));
+            hal.util->snprintf(name, sizeof(name), "MSKP%u", (unsigned)i);
+            send_named_int(name, stats.skipped);
+        }
+
+        ap_message_stats_cycle_skipped += stats.skipped;
+        stats.start_ms = now_ms;
+        stats.sent = 0;
+        stats.skipped = 0;
+        break;
+    }
+}
+#endif // HAL_GCS_MESSAGE_STATS_ENABLED
+
 // call try_send_message if appropriate.  Incorporates debug code to
 // record how long it takes to send a message.  try_send_message is
 // expected to be overridden, not this function.
@@ -944,7 +1193,37 @@ bool GCS_MAVLINK::do_try_send_message(const ap_message id)
     void *data = hal.scheduler->disable_interrupts_save();
     uint32_t start_send_message_us = AP_HAL::micros();
 #endif
-    if (!try_send_message(id)) {
+    // if another channel has already packed this message in this
+    // pass then resend its payload rather than packing it again
+    GCS_MessageCache *cache = nullptr;
+    if (GCS_MessageCache::cacheable(id)) {
+        cache = gcs().get_message_cache();
+    }
+    const GCS_MessageCache::Entry *cached = nullptr;
+    if (cache != nullptr) {
+        cached = cache->find(id);
+    }
+    bool sent;
+    if (cached != nullptr) {
+        sent = send_cached_message(*cached);
+        if (sent) {
+            cache->hits++;
+        }
+    } else {
+        if (cache != nullptr) {
+            // hold the channel lock so that only our frame is captured
+            comm_send_lock(chan);
+            cache->capture_start(chan);
+        }
+        sent = try_send_message(id);
+        if (cache != nullptr) {
+            if (cache->capture_end(id)) {
+                cache->misses++;
+            }
+            comm_send_unlock(chan);
+        }
+    }
+    if (!sent) {
         // didn't fit in buffer...
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
         try_send_message_stats.no_space_for_message++;
@@ -963,6 +1242,21 @@ bool GCS_MAVLINK::do_try_send_message(const ap_message id)
     return true;
 }
 
+bool GCS_MAVLINK::send_cached_message(const GCS_MessageCache::Entry &cached)
+{
+    const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(cached.msgid);
+    if (entry == nullptr) {
+        return false;
+    }
+    if (txspace() < unsigned(packet_overhead() + entry->max_msg_len)) {
+        return false;
+    }
+    // finalizing for this channel applies its sequence number,
+    // MAVLink version and signing
+    send_message((const char *)cached.payload, entry);
+    return true;
+}
+
 int8_t GCS_MAVLINK::get_deferred_message_index(const ap_message id) const
 {
     for (uint8_t i=0; i<ARRAY_SIZE(deferred_message); i++) {
@@ -1031,6 +1325,11 @@ void GCS_MAVLINK::update_send()
         deferred_messages_initialised = true;
     }
 
+    update_link_budget();
+#if HAL_GCS_MESSAGE_STATS_ENABLED
+    update_ap_message_stats();
+#endif
+
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     uint32_t retry_deferred_body_start = AP_HAL::micros();
 #endif
@@ -1055,6 +1354,7 @@ void GCS_MAVLINK::update_send()
                 if (!do_try_send_message(deferred_message[next].id)) {
                     break;
                 }
+                spend_link_budget();
                 deferred_message[next].last_sent_ms += deferred_message[next].interval_ms;
                 next_deferred_message_to_send_cache = -1; // deferred_message_to_send will recalculate
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
@@ -1076,6 +1376,7 @@ void GCS_MAVLINK::update_send()
             if (!do_try_send_message(next)) {
                 break;
             }
+            spend_link_budget();
             pushed_ap_message_ids.clear(next);
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
             const uint32_t stop = AP_HAL::micros();
@@ -1090,15 +1391,25 @@ void GCS_MAVLINK::update_send()
 
         ap_message next = next_deferred_bucket_message_to_send();
         if (next != no_message_to_send) {
-            if (!do_try_send_message(next)) {
-                break;
+            if (!link_budget_allows(next)) {
+                // the link is saturated; skip this message for this
+                // period so higher priority messages keep their rates
+#if HAL_GCS_MESSAGE_STATS_ENABLED
+                ap_message_stats[next].skipped++;
+#endif
+            } else {
+                if (!do_try_send_message(next)) {
+                    break;
+                }
+                spend_link_budget();
+#if HAL_GCS_MESSAGE_STATS_ENABLED
+                ap_message_stats[next].sent++;
+#endif
             }
             bucket_message_ids_to_send.clear(next);
             if (bucket_message_ids_to_send.count() == 0) {
                 // we sent everything in the bucket.  Reschedule it.
-                deferred_message_bucket[sending_bucket_id].last_sent_ms +=
-                    get_reschedule_interval_ms(deferred_message_bucket[sending_bucket_id]);
-                find_next_bucket_to_send();
+                reschedule_sending_bucket();
             }
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
                 const uint32_t stop = AP_HAL::micros();
@@ -1935,6 +2246,12 @@ void GCS::update_send()
     if (_missionitemprotocol_fence != nullptr) {
         _missionitemprotocol_fence->update();
     }
+    if (_message_cache == nullptr && num_gcs() > 1) {
+        _message_cache = new GCS_MessageCache();
+    }
+    if (_message_cache != nullptr) {
+        _message_cache->new_pass();
+    }
     for (uint8_t i=0; i<num_gcs(); i++) {
         chan(i)->update_send();
     }
@@ -2236,6 +2553,13 @@ void GCS_MAVLINK::send_named_float(const char *name, float value) const
     mavlink_msg_named_value_float_send(chan, AP_HAL::millis(), float_name, value);
 }
 
+void GCS_MAVLINK::send_named_int(const char *name, int32_t value) const
+{
+    char int_name[MAVLINK_MSG_NAMED_VALUE_INT_FIELD_NAME_LEN+1] {};
+    strncpy(int_name, name, MAVLINK_MSG_NAMED_VALUE_INT_FIELD_NAME_LEN);
+    mavlink_msg_named_value_int_send(chan, AP_HAL::millis(), int_name, value);
+}
+
 void GCS_MAVLINK::send_home_position() const
 {
     if (!AP::ahrs().home_is_set()) {
@@ -16,7 +16,9 @@ const AP_FWVersion AP_FWVersion::fwver
     os_sw_version: 0
 };
 
-const struct GCS_MAVLINK::stream_entries GCS_MAVLINK::all_stream_entries[] {};
+const struct GCS_MAVLINK::stream_entries GCS_MAVLINK::all_stream_entries[] {
+    MAV_STREAM_TERMINATOR // must have this at end of stream_entries
+};
 
 /*
  *  GCS backend used for many examples and tools
@@ -44,6 +44,9 @@
 extern AP_HAL::UARTDriver	*mavlink_comm_port[MAVLINK_COMM_NUM_BUFFERS];
 extern bool gcs_alternative_active[MAVLINK_COMM_NUM_BUFFERS];
 
+/// total bytes written to each MAVLink port
+extern uint32_t mavlink_comm_tx_bytes[MAVLINK_COMM_NUM_BUFFERS];
+
 /// MAVLink system definition
 extern mavlink_system_t mavlink_system;
 
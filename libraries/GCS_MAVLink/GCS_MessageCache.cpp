@@ -0,0 +1,173 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GCS_MessageCache.h"
+
+#include <AP_Common/AP_Common.h>
+#include <string.h>
+
+/*
+  messages which are a single packet built only from vehicle state,
+  and the MAVLink message each is sent as.  Messages carrying
+  per-channel state (parameter and mission transfers, statustext,
+  per-link counters) must not be listed here
+ */
+static const struct {
+    ap_message id;
+    uint32_t msgid;
+} cacheable_messages[] {
+    { MSG_ATTITUDE,              MAVLINK_MSG_ID_ATTITUDE },
+    { MSG_LOCATION,              MAVLINK_MSG_ID_GLOBAL_POSITION_INT },
+    { MSG_SYS_STATUS,            MAVLINK_MSG_ID_SYS_STATUS },
+    { MSG_EXTENDED_SYS_STATE,    MAVLINK_MSG_ID_EXTENDED_SYS_STATE },
+    { MSG_VFR_HUD,               MAVLINK_MSG_ID_VFR_HUD },
+    { MSG_GPS_RAW,               MAVLINK_MSG_ID_GPS_RAW_INT },
+    { MSG_EKF_STATUS_REPORT,     MAVLINK_MSG_ID_EKF_STATUS_REPORT },
+    { MSG_NAV_CONTROLLER_OUTPUT, MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT },
+    { MSG_LOCAL_POSITION,        MAVLINK_MSG_ID_LOCAL_POSITION_NED },
+    { MSG_POWER_STATUS,          MAVLINK_MSG_ID_POWER_STATUS },
+    { MSG_SERVO_OUTPUT_RAW,      MAVLINK_MSG_ID_SERVO_OUTPUT_RAW },
+    { MSG_RC_CHANNELS,           MAVLINK_MSG_ID_RC_CHANNELS },
+    { MSG_RC_CHANNELS_RAW,       MAVLINK_MSG_ID_RC_CHANNELS_RAW },
+    { MSG_RAW_IMU,               MAVLINK_MSG_ID_RAW_IMU },
+    { MSG_SCALED_IMU,            MAVLINK_MSG_ID_SCALED_IMU },
+    { MSG_SCALED_IMU2,           MAVLINK_MSG_ID_SCALED_IMU2 },
+    { MSG_SCALED_IMU3,           MAVLINK_MSG_ID_SCALED_IMU3 },
+    { MSG_SCALED_PRESSURE,       MAVLINK_MSG_ID_SCALED_PRESSURE },
+    { MSG_SCALED_PRESSURE2,      MAVLINK_MSG_ID_SCALED_PRESSURE2 },
+    { MSG_SCALED_PRESSURE3,      MAVLINK_MSG_ID_SCALED_PRESSURE3 },
+    { MSG_SYSTEM_TIME,           MAVLINK_MSG_ID_SYSTEM_TIME },
+    { MSG_AHRS,                  MAVLINK_MSG_ID_AHRS },
+    { MSG_AHRS2,                 MAVLINK_MSG_ID_AHRS2 },
+    { MSG_AHRS3,                 MAVLINK_MSG_ID_AHRS3 },
+    { MSG_SIMSTATE,              MAVLINK_MSG_ID_SIMSTATE },
+    { MSG_HWSTATUS,              MAVLINK_MSG_ID_HWSTATUS },
+    { MSG_VIBRATION,             MAVLINK_MSG_ID_VIBRATION },
+};
+
+// returns the id of the MAVLink message an ap_message is sent as, or
+// UINT32_MAX if it can't be cached
+static uint32_t cacheable_msgid(const ap_message id)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(cacheable_messages); i++) {
+        if (cacheable_messages[i].id == id) {
+            return cacheable_messages[i].msgid;
+        }
+    }
+    return UINT32_MAX;
+}
+
+bool GCS_MessageCache::cacheable(const ap_message id)
+{
+    return cacheable_msgid(id) != UINT32_MAX;
+}
+
+const GCS_MessageCache::Entry *GCS_MessageCache::find(const ap_message id) const
+{
+    for (uint8_t i=0; i<num_entries; i++) {
+        if (entries[i].pass == pass && entries[i].id == id) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+// returns the slot to store id in: its old slot, a stale slot, or
+// the oldest slot
+GCS_MessageCache::Entry &GCS_MessageCache::entry_for(const ap_message id)
+{
+    for (uint8_t i=0; i<num_entries; i++) {
+        if (entries[i].id == id) {
+            return entries[i];
+        }
+    }
+    for (uint8_t i=0; i<num_entries; i++) {
+        if (entries[i].pass != pass) {
+            return entries[i];
+        }
+    }
+    Entry &ret = entries[next_entry];
+    next_entry = (next_entry + 1) % num_entries;
+    return ret;
+}
+
+void GCS_MessageCache::capture_start(const mavlink_channel_t chan)
+{
+    capture_chan = chan;
+    capture_len = 0;
+    capture_overflow = false;
+    capturing = true;
+}
+
+void GCS_MessageCache::capture(const mavlink_channel_t chan, const uint8_t *buf, uint8_t len)
+{
+    if (!capturing || chan != capture_chan) {
+        return;
+    }
+    if (capture_len + len > sizeof(capture_buf)) {
+        capture_overflow = true;
+        return;
+    }
+    memcpy(&capture_buf[capture_len], buf, len);
+    capture_len += len;
+}
+
+bool GCS_MessageCache::capture_end(const ap_message id)
+{
+    capturing = false;
+    if (capture_overflow || capture_len < MAVLINK_NUM_NON_PAYLOAD_BYTES) {
+        return false;
+    }
+    if (capture_buf[0] != MAVLINK_STX) {
+        // MAVLink1 frames lack the extension fields
+        return false;
+    }
+    const uint8_t len = capture_buf[1];
+    const uint8_t incompat_flags = capture_buf[2];
+    uint16_t frame_len = MAVLINK_NUM_NON_PAYLOAD_BYTES + len;
+    if (incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        frame_len += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    if (frame_len != capture_len) {
+        // nothing sent, more than one frame, or bytes from elsewhere
+        return false;
+    }
+    const uint32_t msgid = capture_buf[7] | (capture_buf[8] << 8) | ((uint32_t)capture_buf[9] << 16);
+    if (msgid != cacheable_msgid(id)) {
+        // some other message
+        return false;
+    }
+    const mavlink_msg_entry_t *msg_entry = mavlink_get_msg_entry(msgid);
+    if (msg_entry == nullptr || len > msg_entry->max_msg_len) {
+        return false;
+    }
+    uint16_t crc;
+    crc_init(&crc);
+    crc_accumulate_buffer(&crc, (const char *)&capture_buf[1], MAVLINK_CORE_HEADER_LEN + len);
+    crc_accumulate(msg_entry->crc_extra, &crc);
+    const uint8_t *ck = &capture_buf[MAVLINK_NUM_HEADER_BYTES + len];
+    if (ck[0] != (crc & 0xFF) || ck[1] != (crc >> 8)) {
+        return false;
+    }
+
+    Entry &entry = entry_for(id);
+    entry.pass = pass;
+    entry.msgid = msgid;
+    entry.id = id;
+    // MAVLink2 trims trailing zeros from the payload; put them back
+    memcpy(entry.payload, &capture_buf[MAVLINK_NUM_HEADER_BYTES], len);
+    memset(&entry.payload[len], 0, sizeof(entry.payload) - len);
+    return true;
+}
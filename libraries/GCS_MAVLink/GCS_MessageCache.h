@@ -0,0 +1,64 @@
+#pragma once
+
+#include "GCS_MAVLink.h"
+#include "ap_message.h"
+
+/*
+  cache of stream messages packed for one MAVLink channel during a
+  pass of GCS::update_send.  Other channels sending the same message
+  in the same pass re-sequence and re-sign the cached payload instead
+  of gathering the data and packing it again.
+
+  Packets are captured as they are written to the port, and are only
+  cached if exactly one complete MAVLink2 frame with a good checksum,
+  carrying the MAVLink message the ap_message is sent as, was written
+  while capturing.  The caller holds the channel's send lock while
+  capturing, so no other thread can write to the channel.
+ */
+class GCS_MessageCache {
+public:
+    struct Entry {
+        uint32_t pass;
+        uint32_t msgid;
+        ap_message id;
+        uint8_t payload[MAVLINK_MAX_PAYLOAD_LEN];
+    };
+
+    // start a new pass; entries from earlier passes are stale
+    void new_pass() { pass++; }
+
+    // returns true if the encoding of id does not depend on the
+    // channel it is sent on
+    static bool cacheable(const ap_message id);
+
+    // returns the entry for id packed in this pass, or nullptr
+    const Entry *find(const ap_message id) const;
+
+    // capture the bytes written to chan until capture_end is
+    // called.  comm_send_lock(chan) must be held until capture_end
+    void capture_start(const mavlink_channel_t chan);
+    void capture(const mavlink_channel_t chan, const uint8_t *buf, uint8_t len);
+    // stop capturing, caching the captured frame as id if it is
+    // usable.  Returns true if it was cached
+    bool capture_end(const ap_message id);
+
+    // messages sent from the cache and messages packed and cached
+    uint32_t hits;
+    uint32_t misses;
+
+private:
+    static const uint8_t num_entries = 8;
+    Entry entries[num_entries];
+    uint8_t next_entry;
+
+    // zero-filled entries are never current
+    uint32_t pass = 1;
+
+    bool capturing;
+    bool capture_overflow;
+    mavlink_channel_t capture_chan;
+    uint16_t capture_len;
+    uint8_t capture_buf[MAVLINK_MAX_PACKET_LEN];
+
+    Entry &entry_for(const ap_message id);
+};
@@ -22,8 +22,8 @@
 extern const AP_HAL::HAL& hal;
 
 // queue of pending parameter requests and replies
-ObjectBuffer<GCS_MAVLINK::pending_param_request> GCS_MAVLINK::param_requests(20);
-ObjectBuffer<GCS_MAVLINK::pending_param_reply> GCS_MAVLINK::param_replies(5);
+ObjectBuffer_SPSC<GCS_MAVLINK::pending_param_request> GCS_MAVLINK::param_requests(20);
+ObjectBuffer_SPSC<GCS_MAVLINK::pending_param_reply> GCS_MAVLINK::param_replies(5);
 
 bool GCS_MAVLINK::param_timer_registered;
 
@@ -46,11 +46,19 @@ GCS_MAVLINK::queued_param_send()
     const uint32_t tnow = AP_HAL::millis();
     const uint32_t tstart = AP_HAL::micros();
 
-    // use at most 30% of bandwidth on parameters. The constant 26 is
-    // 1/(1000 * 1/8 * 0.001 * 0.3)
-    const uint32_t link_bw = _port->bw_in_kilobytes_per_second();
-
-    uint32_t bytes_allowed = link_bw * (tnow - _queued_parameter_send_time_ms) * 26;
+    uint32_t bytes_allowed;
+    const bool link_measured = !is_zero(link_budget.rate_bps);
+    if (link_measured) {
+        // we have seen the link saturated, so we know what it can
+        // carry. Streams are slowed while parameters are sent, so
+        // use half of it on parameters
+        bytes_allowed = link_budget.rate_bps * 0.5f * (tnow - _queued_parameter_send_time_ms) * 0.001f;
+    } else {
+        // use at most 30% of bandwidth on parameters. The constant 26 is
+        // 1/(1000 * 1/8 * 0.001 * 0.3)
+        const uint32_t link_bw = _port->bw_in_kilobytes_per_second();
+        bytes_allowed = link_bw * (tnow - _queued_parameter_send_time_ms) * 26;
+    }
     const uint16_t size_for_one_param_value_msg = MAVLINK_MSG_ID_PARAM_VALUE_LEN + packet_overhead();
     if (bytes_allowed < size_for_one_param_value_msg) {
         bytes_allowed = size_for_one_param_value_msg;
@@ -61,8 +69,9 @@ GCS_MAVLINK::queued_param_send()
     uint32_t count = bytes_allowed / size_for_one_param_value_msg;
 
     // when we don't have flow control we really need to keep the
-    // param download very slow, or it tends to stall
-    if (!have_flow_control() && count > 5) {
+    // param download very slow, or it tends to stall, unless the
+    // allowance already comes from the measured link rate
+    if (!have_flow_control() && !link_measured && count > 5) {
         count = 5;
     }
     if (async_replies_sent_count >= count) {
@@ -82,8 +91,16 @@ GCS_MAVLINK::queued_param_send()
             _queued_parameter_count,
             _queued_parameter_index);
 
-        _queued_parameter = AP_Param::next_scalar(&_queued_parameter_token, &_queued_parameter_type);
         _queued_parameter_index++;
+        _queued_parameter = AP_Param::next_scalar(&_queued_parameter_token, &_queued_parameter_type, _queued_parameter_index);
+        if (_queued_parameter == nullptr) {
+            const uint32_t download_ms = AP_HAL::millis() - _queued_parameter_start_ms;
+            AP::logger().Write("PRMD", "TimeUS,Chan,Count,Time", "s#-s", "F--C", "QBHI",
+                               AP_HAL::micros64(),
+                               (uint8_t)chan,
+                               _queued_parameter_index,
+                               download_ms);
+        }
 
         if (AP_HAL::micros() - tstart > 1000) {
             // don't use more than 1ms sending blocks of parameters
@@ -215,6 +232,7 @@ void GCS_MAVLINK::handle_param_request_list(const mavlink_message_t &msg)
     _queued_parameter_index = 0;
     _queued_parameter_count = AP_Param::count_parameters();
     _queued_parameter_send_time_ms = AP_HAL::millis(); // avoid initial flooding
+    _queued_parameter_start_ms = _queued_parameter_send_time_ms;
 }
 
 void GCS_MAVLINK::handle_param_request_read(const mavlink_message_t &msg)
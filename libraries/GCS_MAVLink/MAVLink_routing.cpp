@@ -27,7 +27,12 @@ extern const AP_HAL::HAL& hal;
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) :
+    num_routes(0),
+    route_index{},
+    sysid_channels{},
+    route_channels(0)
+{}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -134,41 +139,50 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
         return true;
     }
 
-    // forward on any channels matching the targets
-    bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-    
-        // Skip if channel is private and the target system or component IDs do not match
-        if ((GCS_MAVLINK::is_private(routes[i].channel)) &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
+    // find the channels matching the targets
+    uint8_t channels;
+    if (broadcast_system) {
+        channels = route_channels;
+    } else if (broadcast_component || !match_system) {
+        channels = sysid_channels[target_system];
+    } else {
+        channels = channels_for_route(target_system, target_component);
+    }
+
+    // private channels only get messages addressed to exactly the
+    // system and component seen on them
+    uint8_t private_channels = 0;
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (GCS_MAVLINK::is_private((mavlink_channel_t)(MAVLINK_COMM_0 + i))) {
+            private_channels |= (1U<<i);
         }
+    }
+    channels &= ~private_channels;
+    if (target_system != -1 && target_component != -1) {
+        channels |= channels_for_route(target_system, target_component) & private_channels;
+    }
 
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
+    // never send back out the incoming channel
+    channels &= ~(1U<<(in_channel-MAVLINK_COMM_0));
+    const bool forwarded = (channels != 0);
 
-            if (in_channel != routes[i].channel && !sent_to_chan[routes[i].channel]) {
-                
-                if (comm_get_txspace(routes[i].channel) >= ((uint16_t)msg.len) +
-                    GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+    // forward on the channels matching the targets
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(channels & (1U<<i))) {
+            continue;
+        }
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) >= ((uint16_t)msg.len) +
+            GCS_MAVLINK::packet_overhead_chan(channel)) {
 #if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_channel,
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
+            ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                     msg.msgid,
+                     (unsigned)in_channel,
+                     (unsigned)channel,
+                     (int)target_system,
+                     (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
+            _mavlink_resend_uart(channel, &msg);
         }
     }
 
@@ -195,29 +209,24 @@ void MAVLink_routing::send_to_components(uint32_t msgid, const char *pkt, uint8_
 
 void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entry_t *entry, const uint8_t pkt_len)
 {
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
+    // channels on which our system ID has been seen
+    const uint8_t channels = sysid_channels[mavlink_system.sysid];
 
-    // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid != mavlink_system.sysid) {
-            // our system ID hasn't been seen on this link
-            continue;
-        }
-        if (sent_to_chan[routes[i].channel]) {
-            // we've already send it on this link
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(channels & (1U<<i))) {
             continue;
         }
-        if (comm_get_txspace(routes[i].channel) <
-            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) <
+            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(channel)) {
             // it doesn't fit on this channel
             continue;
         }
 #if ROUTING_DEBUG
-        ::printf("send msg %u on chan %u sysid=%u compid=%u\n",
+        ::printf("send msg %u on chan %u sysid=%u\n",
                  entry->msgid,
-                 (unsigned)routes[i].channel,
-                 (unsigned)routes[i].sysid,
-                 (unsigned)routes[i].compid);
+                 (unsigned)channel,
+                 (unsigned)mavlink_system.sysid);
 #endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (entry->max_msg_len > pkt_len) {
@@ -225,13 +234,12 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                           entry->max_msg_len, pkt_len);
         }
 #endif
-        _mav_finalize_message_chan_send(routes[i].channel,
+        _mav_finalize_message_chan_send(channel,
                                         entry->msgid,
                                         pkt,
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
-        sent_to_chan[routes[i].channel] = true;
     }
 }
 
@@ -260,23 +268,30 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
 */
 void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0 ||
         (msg.sysid == mavlink_system.sysid &&
          msg.compid == mavlink_system.compid)) {
         return;
     }
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    if (channels_for_route(msg.sysid, msg.compid) & (1U<<(in_channel-MAVLINK_COMM_0))) {
+        // known route. Only a heartbeat can tell us more about it
+        if (msg.msgid != MAVLINK_MSG_ID_HEARTBEAT) {
+            return;
+        }
+        for (uint8_t i=0; i<num_routes; i++) {
+            if (routes[i].sysid == msg.sysid &&
+                routes[i].compid == msg.compid &&
+                routes[i].channel == in_channel) {
+                if (routes[i].mavtype == 0) {
+                    routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+                }
+                break;
             }
-            break;
         }
+        return;
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
+    if (num_routes < MAVLINK_MAX_ROUTES) {
+        const uint8_t i = num_routes;
         routes[i].sysid = msg.sysid;
         routes[i].compid = msg.compid;
         routes[i].channel = in_channel;
@@ -284,6 +299,7 @@ void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_me
             routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
         }
         num_routes++;
+        add_route_to_index(msg.sysid, msg.compid, in_channel);
 #if ROUTING_DEBUG
         ::printf("learned route %u %u via %u\n",
                  (unsigned)msg.sysid,
@@ -294,6 +310,58 @@ void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_me
 }
 
 
+/*
+  slot in route_index to start searching for sysid/compid, using
+  Fibonacci hashing of the 16 bit sysid/compid key
+*/
+uint8_t MAVLink_routing::route_index_hash(uint8_t sysid, uint8_t compid)
+{
+    return uint16_t(((sysid << 8) | compid) * 40503U) >> (16 - route_index_bits);
+}
+
+/*
+  return mask of channels sysid/compid has been seen on
+*/
+uint8_t MAVLink_routing::channels_for_route(uint8_t sysid, uint8_t compid) const
+{
+    uint8_t slot = route_index_hash(sysid, compid);
+    for (uint8_t n=0; n<route_index_size; n++) {
+        const route_index_entry &entry = route_index[slot];
+        if (entry.channels == 0) {
+            // unused entry; sysid/compid has not been seen
+            return 0;
+        }
+        if (entry.sysid == sysid && entry.compid == compid) {
+            return entry.channels;
+        }
+        slot = (slot + 1) & (route_index_size - 1);
+    }
+    return 0;
+}
+
+void MAVLink_routing::add_route_to_index(uint8_t sysid, uint8_t compid, mavlink_channel_t channel)
+{
+    const uint8_t channel_mask = 1U<<(channel-MAVLINK_COMM_0);
+    sysid_channels[sysid] |= channel_mask;
+    route_channels |= channel_mask;
+
+    uint8_t slot = route_index_hash(sysid, compid);
+    for (uint8_t n=0; n<route_index_size; n++) {
+        route_index_entry &entry = route_index[slot];
+        if (entry.channels == 0) {
+            entry.sysid = sysid;
+            entry.compid = compid;
+            entry.channels = channel_mask;
+            return;
+        }
+        if (entry.sysid == sysid && entry.compid == compid) {
+            entry.channels |= channel_mask;
+            return;
+        }
+        slot = (slot + 1) & (route_index_size - 1);
+    }
+}
+
 /*
   special handling for heartbeat messages. To ensure routing
   propagation heartbeat messages need to be forwarded on all channels
@@ -311,11 +379,7 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
-            mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
-        }
-    }
+    mask &= ~channels_for_route(msg.sysid, msg.compid);
 
     if (mask == 0) {
         // nothing to send to
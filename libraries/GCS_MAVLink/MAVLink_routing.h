@@ -45,8 +45,7 @@ public:
     bool find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel);
 
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    // the routes in the order they were learned
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
@@ -54,7 +53,32 @@ private:
         mavlink_channel_t channel;
         uint8_t mavtype;
     } routes[MAVLINK_MAX_ROUTES];
-    
+
+    // hashed index of the channels each sysid/compid has been seen
+    // on, so forwarding a message doesn't scan the routes. Routes are
+    // never removed, so open addressing with linear probing is used
+    // and the table never fills
+    static const uint8_t route_index_bits = 6;
+    static const uint8_t route_index_size = 1U<<route_index_bits;
+    static_assert(route_index_size >= 2*MAVLINK_MAX_ROUTES, "route index too small");
+    static_assert(MAVLINK_COMM_NUM_BUFFERS <= 8, "channel masks are 8 bits");
+    struct route_index_entry {
+        uint8_t sysid;
+        uint8_t compid;
+        uint8_t channels;   // mask of channels, zero if entry is unused
+    } route_index[route_index_size];
+
+    // mask of channels each sysid has been seen on, for any compid
+    uint8_t sysid_channels[256];
+
+    // mask of channels any route has been learned on
+    uint8_t route_channels;
+
+    static uint8_t route_index_hash(uint8_t sysid, uint8_t compid);
+    // return mask of channels sysid/compid has been seen on
+    uint8_t channels_for_route(uint8_t sysid, uint8_t compid) const;
+    void add_route_to_index(uint8_t sysid, uint8_t compid, mavlink_channel_t channel);
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
     
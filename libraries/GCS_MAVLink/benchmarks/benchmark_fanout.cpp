@@ -0,0 +1,153 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Scheduler/AP_Scheduler.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  cost of sending the stream messages on one to
+  MAVLINK_COMM_NUM_BUFFERS links through GCS::update_send. Each
+  iteration pushes ATTITUDE, GLOBAL_POSITION_INT and RAW_IMU to every
+  link and runs one update_send pass, so the messages go through
+  GCS_MAVLINK::do_try_send_message and the message cache as they do
+  in a vehicle. With one link there is no cache and every link packs
+  its own messages; compare the time per item against that
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// a port which accepts everything written to it
+class NullUART : public AP_HAL::UARTDriver {
+public:
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    uint32_t available() override { return 0; }
+    uint32_t txspace() override { return 8192; }
+    int16_t read() override { return -1; }
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+};
+
+static Quaternion quat{0.9f, 0.1f, 0.2f, 0.3f};
+static Vector3f velocity{3.0f, -2.0f, 0.5f};
+static Vector3f accel{0.1f, 0.2f, -9.8f};
+static Vector3f gyro{0.01f, 0.02f, 0.03f};
+
+// a link which gathers the vehicle state for the stream messages and
+// sends them, as the vehicle try_send_message functions do
+class GCS_MAVLINK_Bench : public GCS_MAVLINK_Dummy {
+public:
+    GCS_MAVLINK_Bench(GCS_MAVLINK_Parameters &params, AP_HAL::UARTDriver &uart, mavlink_channel_t _chan) :
+        GCS_MAVLINK_Dummy(params, uart)
+    {
+        chan = _chan;
+        mavlink_comm_port[chan] = &uart;
+    }
+
+private:
+
+    bool try_send_message(enum ap_message id) override {
+        switch (id) {
+        case MSG_ATTITUDE: {
+            CHECK_PAYLOAD_SIZE(ATTITUDE);
+            quat.normalize();
+            float roll, pitch, yaw;
+            quat.to_euler(roll, pitch, yaw);
+            mavlink_msg_attitude_send(chan, 1000,
+                                      roll, pitch, yaw,
+                                      gyro.x, gyro.y, gyro.z);
+            break;
+        }
+        case MSG_LOCATION: {
+            CHECK_PAYLOAD_SIZE(GLOBAL_POSITION_INT);
+            Matrix3f rot;
+            quat.rotation_matrix(rot);
+            const Vector3f vel = rot * velocity;
+            mavlink_msg_global_position_int_send(chan, 1000,
+                                                 -353632620, 1491652300,
+                                                 584000, 10000,
+                                                 vel.x * 100, vel.y * 100, vel.z * 100,
+                                                 wrap_360_cd(degrees(atan2f(vel.y, vel.x)) * 100));
+            break;
+        }
+        case MSG_RAW_IMU:
+            CHECK_PAYLOAD_SIZE(RAW_IMU);
+            mavlink_msg_raw_imu_send(chan, 1000000,
+                                     accel.x * 1000.0f / GRAVITY_MSS,
+                                     accel.y * 1000.0f / GRAVITY_MSS,
+                                     accel.z * 1000.0f / GRAVITY_MSS,
+                                     gyro.x * 1000.0f,
+                                     gyro.y * 1000.0f,
+                                     gyro.z * 1000.0f,
+                                     100, 200, 300, 0, 2500);
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+};
+
+static NullUART uart;
+
+class GCS_Bench : public GCS_Dummy {
+public:
+    // never hold messages back for the main loop
+    uint16_t min_loop_time_remaining_for_message_send_us() const override { return 0; }
+
+    // add links writing to the null port until there are num_links
+    void add_links(const uint8_t num_links) {
+        while (_num_gcs < num_links && _num_gcs < MAVLINK_COMM_NUM_BUFFERS) {
+            _chan[_num_gcs] = new GCS_MAVLINK_Bench(chan_parameters[_num_gcs], uart, (mavlink_channel_t)_num_gcs);
+            _num_gcs++;
+        }
+    }
+};
+
+AP_SerialManager _serialmanager;
+static AP_Scheduler scheduler;
+static AP_Int32 logger_bitmask;
+static AP_Logger logger{logger_bitmask};
+GCS_Bench _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+static const ap_message ids[] { MSG_ATTITUDE, MSG_LOCATION, MSG_RAW_IMU };
+
+static uint32_t tx_bytes()
+{
+    uint32_t ret = 0;
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        ret += mavlink_comm_tx_bytes[i];
+    }
+    return ret;
+}
+
+static void BM_SendFanOut(benchmark::State& state)
+{
+    _gcs.add_links(state.range_x());
+    const uint32_t start_bytes = tx_bytes();
+    while (state.KeepRunning()) {
+        for (const ap_message id : ids) {
+            gcs().send_message(id);
+        }
+        gcs().update_send();
+    }
+    state.SetItemsProcessed(state.iterations() * gcs().num_gcs() * ARRAY_SIZE(ids));
+    state.SetBytesProcessed(tx_bytes() - start_bytes);
+}
+
+BENCHMARK(BM_SendFanOut)->DenseRange(1, MAVLINK_COMM_NUM_BUFFERS);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,130 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <GCS_MAVLink/MAVLink_routing.h>
+
+/*
+  routing throughput for a mesh of range_x() other systems and
+  components: two GCS, a companion computer and gimbal on our system
+  id, and other vehicles with their own companions spread over the
+  remaining links. Each iteration passes the message mix of one
+  telemetry period through check_and_forward: heartbeats, broadcast
+  telemetry, and commands and parameter requests targeted at
+  particular systems and components
+ */
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class GCS_Bench : public GCS_Dummy {
+public:
+    // let routing look up every channel. They have no ports, so
+    // nothing is actually written
+    GCS_Bench() { _num_gcs = MAVLINK_COMM_NUM_BUFFERS - 1; }
+};
+
+AP_SerialManager _serialmanager;
+GCS_Bench _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+struct sender {
+    uint8_t sysid;
+    uint8_t compid;
+    mavlink_channel_t chan;
+    bool gcs;
+};
+
+static const uint8_t max_senders = 20;
+static const uint8_t max_messages = max_senders * 4;
+
+static struct {
+    mavlink_channel_t chan;
+    mavlink_message_t msg;
+} mix[max_messages];
+
+static sender get_sender(uint8_t k)
+{
+    switch (k) {
+    case 0:
+        return sender{255, MAV_COMP_ID_MISSIONPLANNER, MAVLINK_COMM_0, true};
+    case 1:
+        return sender{254, MAV_COMP_ID_MISSIONPLANNER, MAVLINK_COMM_1, true};
+    case 2:
+        return sender{1, MAV_COMP_ID_ONBOARD_COMPUTER, MAVLINK_COMM_2, false};
+    case 3:
+        return sender{1, MAV_COMP_ID_GIMBAL, MAVLINK_COMM_2, false};
+    default:
+        // other vehicles and their companion computers
+        return sender{uint8_t(10 + (k - 4) / 2),
+                      uint8_t((k & 1) ? MAV_COMP_ID_ONBOARD_COMPUTER : MAV_COMP_ID_AUTOPILOT1),
+                      (mavlink_channel_t)(MAVLINK_COMM_3 + (k % 2)),
+                      false};
+    }
+}
+
+// build the message mix for num_senders senders, returning the
+// number of messages
+static uint8_t build_mix(uint8_t num_senders)
+{
+    uint8_t n = 0;
+    for (uint8_t k=0; k<num_senders; k++) {
+        const sender s = get_sender(k);
+        mix[n].chan = s.chan;
+        mavlink_msg_heartbeat_pack(s.sysid, s.compid, &mix[n++].msg,
+                                   s.gcs ? MAV_TYPE_GCS : MAV_TYPE_QUADROTOR,
+                                   MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+        if (s.gcs) {
+            // commands for us, and for another vehicle in the mesh
+            mix[n].chan = s.chan;
+            mavlink_msg_command_long_pack(s.sysid, s.compid, &mix[n++].msg,
+                                          1, 1, MAV_CMD_DO_SET_MODE, 0,
+                                          1, 4, 0, 0, 0, 0, 0);
+            mix[n].chan = s.chan;
+            mavlink_msg_command_long_pack(s.sysid, s.compid, &mix[n++].msg,
+                                          10, 1, MAV_CMD_DO_SET_MODE, 0,
+                                          1, 4, 0, 0, 0, 0, 0);
+            // parameter request for the companion computer
+            mix[n].chan = s.chan;
+            mavlink_msg_param_request_read_pack(s.sysid, s.compid, &mix[n++].msg,
+                                                1, MAV_COMP_ID_ONBOARD_COMPUTER,
+                                                "SR0_EXTRA1", -1);
+        } else {
+            // broadcast telemetry, and a reply to the first GCS
+            mix[n].chan = s.chan;
+            mavlink_msg_attitude_pack(s.sysid, s.compid, &mix[n++].msg,
+                                      1000, 0.1f, 0.2f, 0.3f, 0, 0, 0);
+            mix[n].chan = s.chan;
+            mavlink_msg_mission_ack_pack(s.sysid, s.compid, &mix[n++].msg,
+                                         255, MAV_COMP_ID_MISSIONPLANNER,
+                                         MAV_MISSION_ACCEPTED, MAV_MISSION_TYPE_MISSION);
+        }
+    }
+    return n;
+}
+
+static void BM_CheckAndForward(benchmark::State& state)
+{
+    const uint8_t num_messages = build_mix(state.range_x());
+    MAVLink_routing routing;
+    // learn the routes before timing
+    for (uint8_t i=0; i<num_messages; i++) {
+        routing.check_and_forward(mix[i].chan, mix[i].msg);
+    }
+    bool local = false;
+    while (state.KeepRunning()) {
+        for (uint8_t i=0; i<num_messages; i++) {
+            local ^= routing.check_and_forward(mix[i].chan, mix[i].msg);
+        }
+        gbenchmark_escape(&local);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * num_messages);
+}
+
+BENCHMARK(BM_CheckAndForward)->Arg(4)->Arg(12)->Arg(20);
+
+BENCHMARK_MAIN()
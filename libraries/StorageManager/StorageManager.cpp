@@ -154,7 +154,7 @@ bool StorageAccess::read_block(void *data, uint16_t addr, size_t n) const
             addr -= length;
             continue;
         }
-        uint8_t count = n;
+        size_t count = n;
         if (count+addr > length) {
             // the data crosses a boundary between two areas
             count = length - addr;